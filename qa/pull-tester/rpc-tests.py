@@ -126,6 +126,7 @@ testScripts = [
     'invalidtxrequest.py', # NOTE: needs dynamic_hash to pass
     'abandonconflict.py',
     'p2p-versionbits-warning.py',
+    'stratum.py',
 ]
 if ENABLE_ZMQ:
     testScripts.append('zmq_test.py')
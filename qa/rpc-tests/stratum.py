@@ -0,0 +1,201 @@
+#!/usr/bin/env python2
+# Copyright (c) 2019 The Duality Blockchain Solutions developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#
+# Test the built-in Stratum server with a minimal client
+#
+
+from test_framework.test_framework import DynamicTestFramework
+from test_framework.util import *
+
+from binascii import a2b_hex, b2a_hex
+from hashlib import sha256
+import json
+import socket
+
+def stratum_port(n):
+    return 13000 + n + os.getpid()%999
+
+def dblsha(b):
+    return sha256(sha256(b).digest()).digest()
+
+def decode_prevhash(h):
+    # eight byte-swapped 32-bit words of the hash in internal byte order
+    b = a2b_hex(h)
+    internal = b''.join(b[i:i+4][::-1] for i in range(0, 32, 4))
+    return b2a_hex(internal[::-1]).decode('ascii')
+
+class StratumClient(object):
+    def __init__(self, port):
+        self.sock = socket.create_connection(('127.0.0.1', port), 60)
+        self.buf = b''
+        self.next_id = 1
+        self.notifications = []
+
+    def send(self, method, params):
+        id = self.next_id
+        self.next_id += 1
+        self.sock.sendall(json.dumps({'id': id, 'method': method, 'params': params}).encode('ascii') + b'\n')
+        return id
+
+    def read_message(self):
+        while b'\n' not in self.buf:
+            data = self.sock.recv(4096)
+            if not data:
+                raise AssertionError('stratum connection closed')
+            self.buf += data
+        line, self.buf = self.buf.split(b'\n', 1)
+        return json.loads(line.decode('ascii'))
+
+    def response(self, id):
+        while True:
+            msg = self.read_message()
+            if 'method' in msg:
+                self.notifications.append(msg)
+            elif msg['id'] == id:
+                return msg
+
+    def request(self, method, params):
+        return self.response(self.send(method, params))
+
+    def notification(self, method):
+        while True:
+            for msg in self.notifications:
+                if msg['method'] == method:
+                    self.notifications.remove(msg)
+                    return msg['params']
+            msg = self.read_message()
+            if 'method' in msg:
+                self.notifications.append(msg)
+
+    def close(self):
+        self.sock.close()
+
+class StratumTest(DynamicTestFramework):
+
+    def setup_chain(self):
+        print("Initializing test directory "+self.options.tmpdir)
+        initialize_chain_clean(self.options.tmpdir, 1)
+
+    def setup_network(self):
+        self.nodes = []
+        self.is_network_split = False
+        self.port = stratum_port(0)
+        # every hash is a share until the worker asks for more
+        self.nodes.append(start_node(0, self.options.tmpdir, ["-debug=stratum", "-stratum", "-stratumport=%d" % self.port, "-stratumdifficulty=0.0001"]))
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.generate(1) # Mine a block to leave initial block download
+
+        info = node.getstratuminfo()
+        assert_equal(info['enabled'], True)
+        assert_equal(info['bind'], '127.0.0.1:%d' % self.port)
+
+        client = StratumClient(self.port)
+        resp = client.request('mining.subscribe', ['stratum.py'])
+        assert_equal(resp['error'], None)
+        extranonce1 = resp['result'][1]
+        assert_equal(len(extranonce1), 8)
+        assert_equal(resp['result'][2], 4)
+        assert_equal(client.notification('mining.set_difficulty'), [0.0001])
+
+        # shares are only taken from authorized workers
+        resp = client.request('mining.submit', ['worker1', '1', '00000000', '00000000', '00000000'])
+        assert_equal(resp['error'][0], 24)
+        resp = client.request('mining.authorize', ['worker1', 'x'])
+        assert_equal(resp['result'], True)
+
+        # the job is built on the current tip
+        job = client.notification('mining.notify')
+        assert_equal(decode_prevhash(job[1]), node.getbestblockhash())
+        assert_equal(job[8], True)
+
+        # submit nonces until one of them makes a block, every one is a share
+        height = node.getblockcount()
+        extranonce2 = '0000002a'
+        accepted = 0
+        rejected = 1
+        nonce = 0
+        while node.getblockcount() == height:
+            assert(nonce < 40000)
+            ids = [client.send('mining.submit', ['worker1', job[0], extranonce2, job[7], '%08x' % (nonce + i)]) for i in range(100)]
+            for id in ids:
+                resp = client.response(id)
+                if resp['result'] == True:
+                    accepted += 1
+                else:
+                    # shares of the old job after the block was found
+                    assert_equal(resp['error'][0], 21)
+                    rejected += 1
+            nonce += 100
+
+        # the block has the coinbase the client put together from the job
+        block = node.getblock(node.getbestblockhash())
+        coinbase = a2b_hex(job[2] + extranonce1 + extranonce2 + job[3])
+        assert_equal(block['tx'][0], b2a_hex(dblsha(coinbase)[::-1]).decode('ascii'))
+
+        # a job for the new tip is pushed, and old jobs are gone
+        job = client.notification('mining.notify')
+        while decode_prevhash(job[1]) != node.getbestblockhash():
+            job = client.notification('mining.notify')
+        assert_equal(job[8], True)
+
+        info = node.getstratuminfo()
+        assert_equal(info['blocks'], 1)
+        assert_equal(info['height'], node.getblockcount() + 1)
+        worker = info['workers'][0]
+        assert_equal(worker['worker'], 'worker1')
+        assert_equal(worker['accepted'], accepted)
+        assert_equal(worker['rejected'], rejected)
+        assert_equal(worker['blocks'], 1)
+        assert(worker['hashespersec'] > 0)
+
+        # duplicate and unknown job
+        resp = client.request('mining.submit', ['worker1', job[0], extranonce2, job[7], '00000000'])
+        assert_equal(resp['result'], True)
+        resp = client.request('mining.submit', ['worker1', job[0], extranonce2, job[7], '00000000'])
+        assert_equal(resp['error'][0], 22)
+        resp = client.request('mining.submit', ['worker1', 'ffffffff', extranonce2, job[7], '00000001'])
+        assert_equal(resp['error'][0], 21)
+
+        # ntime before the template's
+        resp = client.request('mining.submit', ['worker1', job[0], extranonce2, '%08x' % (int(job[7], 16) - 1), '00000001'])
+        assert_equal(resp['error'][0], 20)
+
+        # a worker asking for a high difficulty has its easy shares rejected
+        resp = client.request('mining.suggest_difficulty', [1000000000])
+        assert_equal(resp['result'], True)
+        assert_equal(client.notification('mining.set_difficulty'), [1000000000])
+        resp = client.request('mining.submit', ['worker1', job[0], extranonce2, job[7], '00000002'])
+        assert_equal(resp['error'][0], 23)
+
+        # a new block from elsewhere cleans the jobs of all workers
+        node.generate(1)
+        job2 = client.notification('mining.notify')
+        while decode_prevhash(job2[1]) != node.getbestblockhash():
+            job2 = client.notification('mining.notify')
+        assert_equal(job2[8], True)
+        resp = client.request('mining.submit', ['worker1', job[0], extranonce2, job[7], '00000003'])
+        assert_equal(resp['error'][0], 21)
+
+        worker = node.getstratuminfo()['workers'][0]
+        assert_equal(worker['accepted'], accepted + 1)
+        assert_equal(worker['rejected'], rejected + 5)
+        assert_equal(worker['rejectreasons']['duplicate'], 1)
+        assert_equal(worker['rejectreasons']['low-difficulty'], 1)
+        assert_equal(worker['rejectreasons']['time-out-of-range'], 1)
+        assert_equal(worker['rejectreasons']['unauthorized'], 1)
+
+        # a second worker gets its own extranonce1
+        client2 = StratumClient(self.port)
+        resp = client2.request('mining.subscribe', [])
+        assert(resp['result'][1] != extranonce1)
+        assert_equal(len(node.getstratuminfo()['workers']), 2)
+        client2.close()
+        client.close()
+
+if __name__ == '__main__':
+    StratumTest().main()
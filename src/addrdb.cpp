@@ -18,9 +18,173 @@
 
 #include <boost/filesystem.hpp>
 
+namespace
+{
+/** Bytes of the hash of a journal record kept as its checksum */
+const size_t JOURNAL_CHECKSUM_SIZE = 4;
+
+/** The checksum at the end of a snapshot, journals carry it to tell which snapshot they follow */
+bool ReadSnapshotHash(const boost::filesystem::path& pathSnapshot, uint256& hash)
+{
+    FILE* file = fopen(pathSnapshot.string().c_str(), "rb");
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: Failed to open file %s", __func__, pathSnapshot.string());
+    try {
+        if (fseek(filein.Get(), -(long)sizeof(uint256), SEEK_END))
+            return error("%s: Failed to seek in file %s", __func__, pathSnapshot.string());
+        filein >> hash;
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+    return true;
+}
+
+/**
+ * Journal format: network magic and the checksum of the snapshot, followed
+ * by records made of a serialized change and the first bytes of its hash.
+ */
+template <typename T>
+bool AppendJournal(const boost::filesystem::path& pathSnapshot, const boost::filesystem::path& pathJournal, const std::vector<T>& vChanges)
+{
+    if (vChanges.empty())
+        return true;
+
+    CDataStream ssJournal(SER_DISK, CLIENT_VERSION);
+    if (!boost::filesystem::exists(pathJournal) || boost::filesystem::file_size(pathJournal) == 0) {
+        uint256 hashSnapshot;
+        if (!ReadSnapshotHash(pathSnapshot, hashSnapshot))
+            return false;
+        ssJournal << FLATDATA(Params().MessageStart());
+        ssJournal << hashSnapshot;
+    }
+    for (const T& change : vChanges) {
+        size_t nStart = ssJournal.size();
+        ssJournal << change;
+        uint256 hash = Hash(ssJournal.begin() + nStart, ssJournal.end());
+        ssJournal.write((const char*)hash.begin(), JOURNAL_CHECKSUM_SIZE);
+    }
+
+    FILE* file = fopen(pathJournal.string().c_str(), "ab");
+    CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+    if (fileout.IsNull())
+        return error("%s: Failed to open file %s", __func__, pathJournal.string());
+
+    try {
+        fileout << ssJournal;
+    } catch (const std::exception& e) {
+        return error("%s: Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout.Get());
+    fileout.fclose();
+
+    return true;
+}
+
+/** Read the changes journaled after the snapshot with checksum hashSnapshot, a torn last record is cut off */
+template <typename T>
+bool ReadJournal(const boost::filesystem::path& pathJournal, const uint256& hashSnapshot, std::vector<T>& vChanges)
+{
+    if (!boost::filesystem::exists(pathJournal))
+        return true;
+
+    FILE* file = fopen(pathJournal.string().c_str(), "rb");
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: Failed to open file %s", __func__, pathJournal.string());
+
+    uint64_t fileSize = boost::filesystem::file_size(pathJournal);
+    std::vector<unsigned char> vchData(fileSize);
+    try {
+        if (fileSize > 0)
+            filein.read((char*)&vchData[0], fileSize);
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+    filein.fclose();
+
+    CDataStream ssJournal(vchData, SER_DISK, CLIENT_VERSION);
+    unsigned char pchMsgTmp[4] = {};
+    uint256 hashIn;
+    try {
+        ssJournal >> FLATDATA(pchMsgTmp);
+        ssJournal >> hashIn;
+    } catch (const std::exception& e) {
+        hashIn.SetNull();
+    }
+    if (memcmp(pchMsgTmp, Params().MessageStart(), sizeof(pchMsgTmp)) || hashIn != hashSnapshot) {
+        // written before the last snapshot, which already has its changes
+        LogPrintf("%s: Removing outdated %s\n", __func__, pathJournal.filename().string());
+        boost::filesystem::remove(pathJournal);
+        return true;
+    }
+
+    uint64_t nValidSize = fileSize - ssJournal.size();
+    while (!ssJournal.empty()) {
+        try {
+            T change;
+            ssJournal >> change;
+            uint256 hash = Hash(vchData.begin() + nValidSize, vchData.end() - ssJournal.size());
+            unsigned char pchChecksum[JOURNAL_CHECKSUM_SIZE];
+            ssJournal.read((char*)pchChecksum, sizeof(pchChecksum));
+            if (memcmp(pchChecksum, hash.begin(), sizeof(pchChecksum)))
+                break;
+            vChanges.push_back(change);
+            nValidSize = fileSize - ssJournal.size();
+        } catch (const std::exception& e) {
+            break;
+        }
+    }
+
+    if (nValidSize < fileSize) {
+        LogPrintf("%s: Dropping %u incomplete bytes at the end of %s\n", __func__, fileSize - nValidSize, pathJournal.filename().string());
+        boost::filesystem::resize_file(pathJournal, nValidSize);
+    }
+
+    return true;
+}
+
+bool JournalNeedsCompaction(const boost::filesystem::path& pathSnapshot, const boost::filesystem::path& pathJournal)
+{
+    if (!boost::filesystem::exists(pathSnapshot))
+        return true;
+    if (!boost::filesystem::exists(pathJournal))
+        return false;
+    uint64_t nJournalSize = boost::filesystem::file_size(pathJournal);
+    return nJournalSize >= DB_JOURNAL_COMPACT_MIN_SIZE &&
+           nJournalSize * 100 > boost::filesystem::file_size(pathSnapshot) * DB_JOURNAL_COMPACT_PERCENT;
+}
+
+void RemoveJournal(const boost::filesystem::path& pathJournal)
+{
+    // a journal left behind is recognized as outdated when read
+    try {
+        boost::filesystem::remove(pathJournal);
+    } catch (const boost::filesystem::filesystem_error& e) {
+        LogPrintf("%s: Failed to remove %s - %s\n", __func__, pathJournal.string(), e.what());
+    }
+}
+} // namespace
+
+void CBanChange::Apply(banmap_t& banSet) const
+{
+    switch (nType) {
+    case SET:
+        banSet[subNet] = banEntry;
+        break;
+    case ERASE:
+        banSet.erase(subNet);
+        break;
+    case CLEAR:
+        banSet.clear();
+        break;
+    }
+}
+
 CBanDB::CBanDB()
 {
     pathBanlist = GetDataDir() / "banlist.dat";
+    pathJournal = GetDataDir() / "banlist.journal";
 }
 
 bool CBanDB::Write(const banmap_t& banSet)
@@ -56,6 +220,7 @@ bool CBanDB::Write(const banmap_t& banSet)
     // replace existing banlist.dat, if any, with new banlist.dat.XXXX
     if (!RenameOver(pathTmp, pathBanlist))
         return error("%s: Rename-into-place failed", __func__);
+    RemoveJournal(pathJournal);
 
     return true;
 }
@@ -109,12 +274,41 @@ bool CBanDB::Read(banmap_t& banSet)
         return error("%s: Deserialize or I/O error - %s", __func__, e.what());
     }
 
+    std::vector<CBanChange> vChanges;
+    try {
+        if (!ReadJournal(pathJournal, hashIn, vChanges))
+            return false;
+    } catch (const boost::filesystem::filesystem_error& e) {
+        return error("%s: I/O error - %s", __func__, e.what());
+    }
+    for (const CBanChange& change : vChanges)
+        change.Apply(banSet);
+
     return true;
 }
 
+bool CBanDB::AppendChanges(const std::vector<CBanChange>& vChanges)
+{
+    try {
+        return AppendJournal(pathBanlist, pathJournal, vChanges);
+    } catch (const boost::filesystem::filesystem_error& e) {
+        return error("%s: I/O error - %s", __func__, e.what());
+    }
+}
+
+bool CBanDB::NeedsCompaction() const
+{
+    try {
+        return JournalNeedsCompaction(pathBanlist, pathJournal);
+    } catch (const boost::filesystem::filesystem_error& e) {
+        return true;
+    }
+}
+
 CAddrDB::CAddrDB()
 {
     pathAddr = GetDataDir() / "peers.dat";
+    pathJournal = GetDataDir() / "peers.journal";
 }
 
 bool CAddrDB::Write(const CAddrMan& addr)
@@ -150,6 +344,7 @@ bool CAddrDB::Write(const CAddrMan& addr)
     // replace existing peers.dat, if any, with new peers.dat.XXXX
     if (!RenameOver(pathTmp, pathAddr))
         return error("%s: Rename-into-place failed", __func__);
+    RemoveJournal(pathJournal);
 
     return true;
 }
@@ -188,7 +383,19 @@ bool CAddrDB::Read(CAddrMan& addr)
     if (hashIn != hashTmp)
         return error("%s: Checksum mismatch, data corrupted", __func__);
 
-    return Read(addr, ssPeers);
+    if (!Read(addr, ssPeers))
+        return false;
+
+    std::vector<CAddrManChange> vChanges;
+    try {
+        if (!ReadJournal(pathJournal, hashIn, vChanges))
+            return false;
+    } catch (const boost::filesystem::filesystem_error& e) {
+        return error("%s: I/O error - %s", __func__, e.what());
+    }
+    addr.ApplyChanges(vChanges);
+
+    return true;
 }
 
 bool CAddrDB::Read(CAddrMan& addr, CDataStream& ssPeers)
@@ -211,4 +418,22 @@ bool CAddrDB::Read(CAddrMan& addr, CDataStream& ssPeers)
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+bool CAddrDB::AppendChanges(const std::vector<CAddrManChange>& vChanges)
+{
+    try {
+        return AppendJournal(pathAddr, pathJournal, vChanges);
+    } catch (const boost::filesystem::filesystem_error& e) {
+        return error("%s: I/O error - %s", __func__, e.what());
+    }
+}
+
+bool CAddrDB::NeedsCompaction() const
+{
+    try {
+        return JournalNeedsCompaction(pathAddr, pathJournal);
+    } catch (const boost::filesystem::filesystem_error& e) {
+        return true;
+    }
+}
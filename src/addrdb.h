@@ -8,16 +8,23 @@
 #ifndef DYNAMIC_ADDRDB_H
 #define DYNAMIC_ADDRDB_H
 
+#include "netaddress.h"
 #include "serialize.h"
 
 #include <boost/filesystem/path.hpp>
 #include <map>
 #include <string>
+#include <vector>
 
-class CSubNet;
 class CAddrMan;
+class CAddrManChange;
 class CDataStream;
 
+/** The journal of a file is folded into a new snapshot once it grows past this percentage of the snapshot */
+static const unsigned int DB_JOURNAL_COMPACT_PERCENT = 50;
+/** Journals smaller than this are never compacted, rewriting small files saves little */
+static const uint64_t DB_JOURNAL_COMPACT_MIN_SIZE = 64 * 1024;
+
 typedef enum BanReason {
     BanReasonUnknown = 0,
     BanReasonNodeMisbehaving = 1,
@@ -78,29 +85,73 @@ public:
 
 typedef std::map<CSubNet, CBanEntry> banmap_t;
 
-/** Access to the (IP) address database (peers.dat) */
+/** A change made to the banlist, see CBanDB */
+class CBanChange
+{
+public:
+    enum Type : uint8_t {
+        SET = 1,
+        ERASE = 2,
+        CLEAR = 3,
+    };
+
+    uint8_t nType;
+    CSubNet subNet;
+    CBanEntry banEntry; //!< SET only
+
+    CBanChange() : nType(0) {}
+    CBanChange(uint8_t nTypeIn, const CSubNet& subNetIn = CSubNet(), const CBanEntry& banEntryIn = CBanEntry())
+        : nType(nTypeIn), subNet(subNetIn), banEntry(banEntryIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(nType);
+        READWRITE(subNet);
+        READWRITE(banEntry);
+    }
+
+    void Apply(banmap_t& banSet) const;
+};
+
+/**
+ * Access to the (IP) address database (peers.dat)
+ *
+ * peers.dat is a snapshot of the address manager. Changes made after it was
+ * written are appended to peers.journal, which is replayed on top of it when
+ * reading. Write replaces the snapshot and drops the journal.
+ */
 class CAddrDB
 {
 private:
     boost::filesystem::path pathAddr;
+    boost::filesystem::path pathJournal;
 
 public:
     CAddrDB();
     bool Write(const CAddrMan& addr);
     bool Read(CAddrMan& addr);
     bool Read(CAddrMan& addr, CDataStream& ssPeers);
+    bool AppendChanges(const std::vector<CAddrManChange>& vChanges);
+    //! Whether the journal is large enough, or the snapshot missing, to Write a new snapshot
+    bool NeedsCompaction() const;
 };
 
-/** Access to the banlist database (banlist.dat) */
+/** Access to the banlist database (banlist.dat), journaled to banlist.journal like peers.dat */
 class CBanDB
 {
 private:
     boost::filesystem::path pathBanlist;
+    boost::filesystem::path pathJournal;
 
 public:
     CBanDB();
     bool Write(const banmap_t& banSet);
     bool Read(banmap_t& banSet);
+    bool AppendChanges(const std::vector<CBanChange>& vChanges);
+    bool NeedsCompaction() const;
 };
 
 #endif // DYNAMIC_ADDRDB_H
\ No newline at end of file
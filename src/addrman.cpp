@@ -332,6 +332,21 @@ bool CAddrMan::Add_(const CAddress& addr, const CNetAddr& source, int64_t nTimeP
     return fNew;
 }
 
+bool CAddrMan::AddAndRecord_(const CAddress& addr, const CNetAddr& source, int64_t nTimePenalty)
+{
+    if (!fRecordChanges)
+        return Add_(addr, source, nTimePenalty);
+
+    CAddrInfo* pinfo = Find(addr);
+    int64_t nTimeBefore = pinfo ? pinfo->nTime : 0;
+    ServiceFlags nServicesBefore = pinfo ? pinfo->nServices : NODE_NONE;
+    bool fNew = Add_(addr, source, nTimePenalty);
+    pinfo = Find(addr);
+    if (fNew || (pinfo && (pinfo->nTime != nTimeBefore || pinfo->nServices != nServicesBefore)))
+        vChanges.emplace_back(CAddrManChange::ADD, addr, source, nTimePenalty);
+    return fNew;
+}
+
 void CAddrMan::Attempt_(const CService& addr, bool fCountFailure, int64_t nTime)
 {
     CAddrInfo* pinfo = Find(addr);
@@ -171,6 +171,43 @@ public:
 //! the maximum number of nodes to return in a getaddr call
 #define ADDRMAN_GETADDR_MAX 2500
 
+/**
+ * A change made to the address manager, recorded so that it can be appended
+ * to the peers.dat journal instead of rewriting the whole table
+ */
+class CAddrManChange
+{
+public:
+    enum Type : uint8_t {
+        ADD = 1,
+        GOOD = 2,
+        ATTEMPT = 3,
+        ATTEMPT_FAILED = 4, //!< attempt counted as a failure
+        CONNECTED = 5,
+        SERVICES = 6,       //!< services of addr replace the known ones
+    };
+
+    uint8_t nType;
+    CAddress addr;
+    CNetAddr source; //!< ADD only
+    int64_t nTime;   //!< time penalty for ADD, time of the event for the others, unused for SERVICES
+
+    CAddrManChange() : nType(0), nTime(0) {}
+    CAddrManChange(uint8_t nTypeIn, const CAddress& addrIn, const CNetAddr& sourceIn, int64_t nTimeIn)
+        : nType(nTypeIn), addr(addrIn), source(sourceIn), nTime(nTimeIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(nType);
+        READWRITE(addr);
+        READWRITE(source);
+        READWRITE(nTime);
+    }
+};
+
 /** 
  * Stochastical (IP) address manager 
  */
@@ -210,6 +247,12 @@ private:
     // discriminate entries based on port. Should be false on mainnet/testnet and can be true on devnet/regtest
     bool discriminatePorts;
 
+    //! whether changes are recorded in vChanges
+    bool fRecordChanges;
+
+    //! changes since the last call to TakeChanges
+    std::vector<CAddrManChange> vChanges;
+
 protected:
     //! secret key to randomize bucket select with
     uint256 nKey;
@@ -242,6 +285,9 @@ protected:
     //! Add an entry to the "new" table.
     bool Add_(const CAddress& addr, const CNetAddr& source, int64_t nTimePenalty);
 
+    //! Add an entry and record it for the journal if it is new or its time or services were refreshed.
+    bool AddAndRecord_(const CAddress& addr, const CNetAddr& source, int64_t nTimePenalty);
+
     //! Mark an entry as attempted to connect.
     void Attempt_(const CService& addr, bool fCountFailure, int64_t nTime);
 
@@ -471,9 +517,10 @@ public:
         nTried = 0;
         nNew = 0;
         nLastGood = 1; //Initially at 1 so that "never" is strictly worse.
+        vChanges.clear();
     }
 
-    CAddrMan(bool _discriminatePorts = false) : discriminatePorts(_discriminatePorts)
+    CAddrMan(bool _discriminatePorts = false) : discriminatePorts(_discriminatePorts), fRecordChanges(false)
     {
         Clear();
     }
@@ -509,7 +556,7 @@ public:
         LOCK(cs);
         bool fRet = false;
         Check();
-        fRet |= Add_(addr, source, nTimePenalty);
+        fRet |= AddAndRecord_(addr, source, nTimePenalty);
         Check();
         if (fRet)
             LogPrint("addrman", "Added %s from %s: %i tried, %i new\n", addr.ToStringIPPort(), source.ToString(), nTried, nNew);
@@ -522,8 +569,10 @@ public:
         LOCK(cs);
         int nAdd = 0;
         Check();
-        for (std::vector<CAddress>::const_iterator it = vAddr.begin(); it != vAddr.end(); it++)
-            nAdd += Add_(*it, source, nTimePenalty) ? 1 : 0;
+        for (std::vector<CAddress>::const_iterator it = vAddr.begin(); it != vAddr.end(); it++) {
+            if (AddAndRecord_(*it, source, nTimePenalty))
+                nAdd++;
+        }
         Check();
         if (nAdd)
             LogPrint("addrman", "Added %i addresses from %s: %i tried, %i new\n", nAdd, source.ToString(), nTried, nNew);
@@ -537,6 +586,8 @@ public:
         Check();
         Good_(addr, nTime);
         Check();
+        if (fRecordChanges)
+            vChanges.emplace_back(CAddrManChange::GOOD, CAddress(addr, NODE_NONE), CNetAddr(), nTime);
     }
 
     //! Mark an entry as connection attempted to.
@@ -546,6 +597,8 @@ public:
         Check();
         Attempt_(addr, fCountFailure, nTime);
         Check();
+        if (fRecordChanges)
+            vChanges.emplace_back(fCountFailure ? CAddrManChange::ATTEMPT_FAILED : CAddrManChange::ATTEMPT, CAddress(addr, NODE_NONE), CNetAddr(), nTime);
     }
 
     /**
@@ -583,6 +636,8 @@ public:
         Check();
         Connected_(addr, nTime);
         Check();
+        if (fRecordChanges)
+            vChanges.emplace_back(CAddrManChange::CONNECTED, CAddress(addr, NODE_NONE), CNetAddr(), nTime);
     }
 
     void SetServices(const CService& addr, ServiceFlags nServices)
@@ -591,6 +646,54 @@ public:
         Check();
         SetServices_(addr, nServices);
         Check();
+        if (fRecordChanges)
+            vChanges.emplace_back(CAddrManChange::SERVICES, CAddress(addr, nServices), CNetAddr(), 0);
+    }
+
+    //! Start or stop recording the changes to journal, see CAddrManChange
+    void SetRecordChanges(bool fRecord)
+    {
+        LOCK(cs);
+        fRecordChanges = fRecord;
+        if (!fRecord)
+            vChanges.clear();
+    }
+
+    //! Take the changes recorded since the last call
+    std::vector<CAddrManChange> TakeChanges()
+    {
+        LOCK(cs);
+        std::vector<CAddrManChange> vRet;
+        vRet.swap(vChanges);
+        return vRet;
+    }
+
+    //! Put back changes taken that could not be journaled, ahead of the ones recorded since
+    void RequeueChanges(const std::vector<CAddrManChange>& vRequeue)
+    {
+        LOCK(cs);
+        if (fRecordChanges)
+            vChanges.insert(vChanges.begin(), vRequeue.begin(), vRequeue.end());
+    }
+
+    //! Replay changes read back from a journal
+    void ApplyChanges(const std::vector<CAddrManChange>& vApply)
+    {
+        LOCK(cs);
+        Check();
+        for (const CAddrManChange& change : vApply) {
+            if (change.nType == CAddrManChange::ADD)
+                Add_(change.addr, change.source, change.nTime);
+            else if (change.nType == CAddrManChange::GOOD)
+                Good_(change.addr, change.nTime);
+            else if (change.nType == CAddrManChange::ATTEMPT || change.nType == CAddrManChange::ATTEMPT_FAILED)
+                Attempt_(change.addr, change.nType == CAddrManChange::ATTEMPT_FAILED, change.nTime);
+            else if (change.nType == CAddrManChange::CONNECTED)
+                Connected_(change.addr, change.nTime);
+            else if (change.nType == CAddrManChange::SERVICES)
+                SetServices_(change.addr, change.addr.nServices);
+        }
+        Check();
     }
 };
 
@@ -7,6 +7,7 @@
 #include "amount.h"
 #include "base58.h"
 #include "bdap/fees.h"
+#include "bdap/parsedtx.h"
 #include "coins.h"
 #include "bdap/utils.h"
 #include "utilmoneystr.h"
@@ -87,6 +88,48 @@ bool UndoDeleteDomainEntry(const CDomainEntry& entry)
     return false;
 }
 
+std::string CBDAPNotification::GetOpString() const
+{
+    return BDAPFromOp(op);
+}
+
+const UniValue& CBDAPNotification::GetEntryJson() const
+{
+    if (!fEntryBuilt) {
+        oEntry = UniValue(UniValue::VOBJ);
+        BuildBDAPJson(entry, oEntry);
+        fEntryBuilt = true;
+    }
+    return oEntry;
+}
+
+const std::string& CBDAPNotification::GetRecordJson() const
+{
+    if (strRecordJson.empty())
+        strRecordJson = GetEntryJson().write();
+    return strRecordJson;
+}
+
+const std::string& CBDAPNotification::GetHistoryJson() const
+{
+    if (strHistoryJson.empty()) {
+        UniValue oHistory = GetEntryJson();
+        oHistory.push_back(Pair("op", GetOpString()));
+        strHistoryJson = oHistory.write();
+    }
+    return strHistoryJson;
+}
+
+const std::vector<unsigned char>& CBDAPNotification::GetRaw() const
+{
+    if (vchRaw.empty()) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << (unsigned char)op << entry;
+        vchRaw.assign(ss.begin(), ss.end());
+    }
+    return vchRaw;
+}
+
 bool CDomainEntryDB::AddDomainEntry(const CDomainEntry& entry, const int op) 
 { 
     bool writeState = false;
@@ -96,31 +139,31 @@ bool CDomainEntryDB::AddDomainEntry(const CDomainEntry& entry, const int op)
                          && Write(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
     }
     if (writeState)
-        AddDomainEntryIndex(entry, op);
+        NotifyDomainEntry(entry, op);
 
     return writeState;
 }
 
-void CDomainEntryDB::AddDomainEntryIndex(const CDomainEntry& entry, const int op) 
+void CDomainEntryDB::NotifyDomainEntry(const CDomainEntry& entry, const int op)
 {
-    UniValue oName(UniValue::VOBJ);
-    if (BuildBDAPJson(entry, oName)) {
-        CharString vchOperationType = vchFromString(BDAPFromOp(op));
-        GetMainSignals().NotifyBDAPUpdate(oName.write().c_str(), reinterpret_cast<char*>(vchOperationType.data()));
-        WriteDomainEntryIndexHistory(entry, op);
-    }
+    // Nothing is built during reindex and IBD unless somebody listens
+    if (GetMainSignals().NotifyBDAPUpdate.empty())
+        return;
+
+    CBDAPNotification notification(entry, op);
+    GetMainSignals().NotifyBDAPUpdate(notification);
 }
 
 bool CDomainEntryDB::ReadDomainEntry(const std::vector<unsigned char>& vchObjectPath, CDomainEntry& entry) 
 {
     LOCK(cs_bdap_entry);
-    return CDBWrapper::Read(make_pair(std::string("dc"), vchObjectPath), entry);
+    return Read(make_pair(std::string("dc"), vchObjectPath), entry);
 }
 
 bool CDomainEntryDB::ReadDomainEntryPubKey(const std::vector<unsigned char>& vchPubKey, CDomainEntry& entry) 
 {
     LOCK(cs_bdap_entry);
-    return CDBWrapper::Read(make_pair(std::string("pk"), vchPubKey), entry);
+    return Read(make_pair(std::string("pk"), vchPubKey), entry);
 }
 
 bool CDomainEntryDB::EraseDomainEntry(const std::vector<unsigned char>& vchObjectPath) 
@@ -132,7 +175,7 @@ bool CDomainEntryDB::EraseDomainEntry(const std::vector<unsigned char>& vchObjec
         return false;
     }
 
-    return CDBWrapper::Erase(make_pair(std::string("dc"), vchObjectPath));
+    return Erase(make_pair(std::string("dc"), vchObjectPath));
 }
 
 bool CDomainEntryDB::EraseDomainEntryPubKey(const std::vector<unsigned char>& vchPubKey) 
@@ -142,19 +185,19 @@ bool CDomainEntryDB::EraseDomainEntryPubKey(const std::vector<unsigned char>& vc
     if (!ReadDomainEntryPubKey(vchPubKey, entry)) 
         return false;
 
-    return CDBWrapper::Erase(make_pair(std::string("pk"), vchPubKey));
+    return Erase(make_pair(std::string("pk"), vchPubKey));
 }
 
 bool CDomainEntryDB::DomainEntryExists(const std::vector<unsigned char>& vchObjectPath)
 {
     LOCK(cs_bdap_entry);
-    return CDBWrapper::Exists(make_pair(std::string("dc"), vchObjectPath));
+    return Exists(make_pair(std::string("dc"), vchObjectPath));
 }
 
 bool CDomainEntryDB::DomainEntryExistsPubKey(const std::vector<unsigned char>& vchPubKey) 
 {
     LOCK(cs_bdap_entry);
-    return CDBWrapper::Exists(make_pair(std::string("pk"), vchPubKey));
+    return Exists(make_pair(std::string("pk"), vchPubKey));
 }
 
 bool CDomainEntryDB::RemoveExpired(int& entriesRemoved)
@@ -192,29 +235,6 @@ bool CDomainEntryDB::RemoveExpired(int& entriesRemoved)
     return true;
 }
 
-void CDomainEntryDB::WriteDomainEntryIndexHistory(const CDomainEntry& entry, const int op) 
-{
-    if (IsArgSet("-zmqpubbdaphistory")) {
-        UniValue oName(UniValue::VOBJ);
-        BuildBDAPJson(entry, oName);
-        oName.push_back(Pair("op", BDAPFromOp(op)));
-        GetMainSignals().NotifyBDAPUpdate(oName.write().c_str(), "bdap_history");
-    }
-}
-
-void CDomainEntryDB::WriteDomainEntryIndex(const CDomainEntry& entry, const int op) 
-{
-    if (IsArgSet("-zmqpubbdaprecord")) {
-        UniValue oName(UniValue::VOBJ);
-        CDynamicAddress address(EncodeBase58(entry.WalletAddress));
-        oName.push_back(Pair("address", address.ToString()));
-        oName.push_back(Pair("expires_on", entry.nExpireTime));
-        oName.push_back(Pair("dht_publickey", HexStr(entry.DHTPublicKey)));
-        GetMainSignals().NotifyBDAPUpdate(oName.write().c_str(), "bdap_record");
-    }
-    WriteDomainEntryIndexHistory(entry, op);
-}
-
 bool CDomainEntryDB::UpdateDomainEntry(const std::vector<unsigned char>& vchObjectPath, const CDomainEntry& entry)
 {
     LOCK(cs_bdap_entry);
@@ -232,7 +252,7 @@ bool CDomainEntryDB::UpdateDomainEntry(const std::vector<unsigned char>& vchObje
     writeState = Update(make_pair(std::string("dc"), entry.vchFullObjectPath()), entry) 
                     && Update(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
     if (writeState)
-        AddDomainEntryIndex(entry, OP_BDAP_MODIFY);
+        NotifyDomainEntry(entry, OP_BDAP_MODIFY);
 
     return writeState;
 }
@@ -438,11 +458,38 @@ static bool CommonDataCheck(const CDomainEntry& entry, const vchCharString& vvch
     return true;
 }
 
-static bool CheckNewDomainEntryTxInputs(const CDomainEntry& entry, const CScript& scriptOp, const vchCharString& vvchOpParameters, const uint256& txHash,
+void PreCheckDomainEntryTx(const CTransactionRef& tx, CBDAPParsedTx& parsed)
+{
+    parsed.fDataValid = true;
+    if (parsed.strOpType != "bdap_delete_account") {
+        std::vector<unsigned char> vchData;
+        std::vector<unsigned char> vchHash;
+        int nDataOut;
+        bool bData = GetBDAPData(tx, vchData, vchHash, nDataOut);
+        std::string errorMessage;
+        if (bData && !parsed.entry.UnserializeFromData(vchData, vchHash)) {
+            parsed.fDataValid = false;
+            parsed.strDataError = "BDAP_CONSENSUS_ERROR: ERRCODE: 3601 - " + _("UnserializeFromData data in tx failed!");
+            return;
+        }
+        if (!parsed.entry.ValidateValues(errorMessage)) {
+            parsed.fDataValid = false;
+            parsed.strDataError = "BDAP_CONSENSUS_ERROR: ERRCODE: 3602 - " + errorMessage;
+            return;
+        }
+        parsed.entry.txHash = tx->GetHash();
+        parsed.fParamsValid = CommonDataCheck(parsed.entry, parsed.vvchArgs, parsed.strParamsError);
+    }
+    parsed.fAmounts = ExtractAmountsFromTx(tx, parsed.dataAmount, parsed.opAmount);
+}
+
+static bool CheckNewDomainEntryTxInputs(const CDomainEntry& entry, const CBDAPParsedTx& parsed, const uint256& txHash,
                                std::string& errorMessage, bool fJustCheck)
 {
-    if (!CommonDataCheck(entry, vvchOpParameters, errorMessage))
+    if (!parsed.fParamsValid) {
+        errorMessage = parsed.strParamsError;
         return error(errorMessage.c_str());
+    }
 
     if (fJustCheck)
         return true;
@@ -533,12 +580,14 @@ static bool CheckDeleteDomainEntryTxInputs(const CDomainEntry& entry, const CScr
     return FlushLevelDB();
 }
 
-static bool CheckUpdateDomainEntryTxInputs(CDomainEntry& entry, const CScript& scriptOp, const vchCharString& vvchOpParameters, const uint256& txHash, const int& nMonths, const uint32_t& nBlockTime,
+static bool CheckUpdateDomainEntryTxInputs(CDomainEntry& entry, const CScript& scriptOp, const CBDAPParsedTx& parsed, const uint256& txHash, const int& nMonths, const uint32_t& nBlockTime,
                                   std::string& errorMessage, bool fJustCheck)
 {
     //if exists, check for owner's signature
-    if (!CommonDataCheck(entry, vvchOpParameters, errorMessage))
+    if (!parsed.fParamsValid) {
+        errorMessage = parsed.strParamsError;
         return error(errorMessage.c_str());
+    }
 
     if (fJustCheck)
         return true;
@@ -604,9 +653,13 @@ static bool CheckMoveDomainEntryTxInputs(const CDomainEntry& entry, const CScrip
     return false;
 }
 
-bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, const int& op1, const int& op2, const std::vector<std::vector<unsigned char> >& vvchArgs, 
-                                const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage) 
+bool CheckDomainEntryTx(const CTransactionRef& tx, const CBDAPParsedTx& parsed, const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage) 
 {
+    const CScript& scriptOp = parsed.scriptOp;
+    const int& op1 = parsed.op1;
+    const int& op2 = parsed.op2;
+    const vchCharString& vvchArgs = parsed.vvchArgs;
+
     if (tx->IsCoinBase() && !fJustCheck && !bSanityCheck)
     {
         LogPrintf("*Trying to add BDAP entry in coinbase transaction, skipping...");
@@ -615,31 +668,16 @@ bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, cons
 
     LogPrint("bdap", "%s -- BDAP nHeight=%d, chainActive.Tip()=%d, op1=%s, op2=%s, hash=%s justcheck=%s\n", __func__, nHeight, chainActive.Tip()->nHeight, BDAPFromOp(op1).c_str(), BDAPFromOp(op2).c_str(), tx->GetHash().ToString().c_str(), fJustCheck ? "JUSTCHECK" : "BLOCK");
 
-    // unserialize BDAP from txn, check if the entry is valid and does not conflict with a previous entry
-    CDomainEntry entry;
-    std::vector<unsigned char> vchData;
-    std::vector<unsigned char> vchHash;
-    int nDataOut;
-    const std::string strOperationType = GetBDAPOpTypeString(op1, op2);
-    if (strOperationType != "bdap_delete_account") {
-        bool bData = GetBDAPData(tx, vchData, vchHash, nDataOut);
-        if(bData && !entry.UnserializeFromData(vchData, vchHash))
-        {
-            errorMessage = "BDAP_CONSENSUS_ERROR: ERRCODE: 3601 - " + _("UnserializeFromData data in tx failed!");
-            LogPrintf("%s -- %s \n", __func__, errorMessage);
-            return error(errorMessage.c_str());
-        }
-
-        if(!entry.ValidateValues(errorMessage))
-        {
-            errorMessage = "BDAP_CONSENSUS_ERROR: ERRCODE: 3602 - " + errorMessage;
-            LogPrintf("%s -- %s \n", __func__, errorMessage);
-            return error(errorMessage.c_str());
-        }
-
-        entry.txHash = tx->GetHash();
-        entry.nHeight = nHeight;
+    // the entry was unserialized and value checked by PreCheckDomainEntryTx
+    if (!parsed.fDataValid) {
+        errorMessage = parsed.strDataError;
+        LogPrintf("%s -- %s \n", __func__, errorMessage);
+        return error(errorMessage.c_str());
     }
+    CDomainEntry entry = parsed.entry;
+    const std::string& strOperationType = parsed.strOpType;
+    if (strOperationType != "bdap_delete_account")
+        entry.nHeight = nHeight;
 
     CAmount monthlyFee, oneTimeFee, depositFee;
     if (strOperationType == "bdap_new_account") {
@@ -664,8 +702,9 @@ bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, cons
         LogPrint("bdap", "%s -- nMonths %d, monthlyFee %d, oneTimeFee %d, depositFee %d\n", __func__, 
                                 nMonths, FormatMoney(monthlyFee), FormatMoney(oneTimeFee), FormatMoney(depositFee));
         // extract amounts from tx.
-        CAmount dataAmount, opAmount;
-        if (!ExtractAmountsFromTx(tx, dataAmount, opAmount)) {
+        const CAmount& dataAmount = parsed.dataAmount;
+        const CAmount& opAmount = parsed.opAmount;
+        if (!parsed.fAmounts) {
             errorMessage = "Unable to extract BDAP amounts from transaction";
             return false;
         }
@@ -692,7 +731,7 @@ bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, cons
         }
         entry.nExpireTime = AddMonthsToBlockTime(nBlockTime, nMonths);
 
-        return CheckNewDomainEntryTxInputs(entry, scriptOp, vvchArgs, tx->GetHash(), errorMessage, fJustCheck);
+        return CheckNewDomainEntryTxInputs(entry, parsed, tx->GetHash(), errorMessage, fJustCheck);
     }
     else if (strOperationType == "bdap_delete_account") {
         uint16_t nMonths = 0;
@@ -726,8 +765,9 @@ bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, cons
         LogPrint("bdap", "%s -- nMonths %d, monthlyFee %d, oneTimeFee %d, depositFee %d\n", __func__, 
                                 nMonths, FormatMoney(monthlyFee), FormatMoney(oneTimeFee), FormatMoney(depositFee));
         // extract amounts from tx.
-        CAmount dataAmount, opAmount;
-        if (!ExtractAmountsFromTx(tx, dataAmount, opAmount)) {
+        const CAmount& dataAmount = parsed.dataAmount;
+        const CAmount& opAmount = parsed.opAmount;
+        if (!parsed.fAmounts) {
             errorMessage = "Unable to extract BDAP amounts from transaction";
             return false;
         }
@@ -751,7 +791,7 @@ bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, cons
                                 FormatMoney(dataAmount), FormatMoney(monthlyFee));
         }
         // Add previous expire date plus additional months
-        return CheckUpdateDomainEntryTxInputs(entry, scriptOp, vvchArgs, tx->GetHash(), nMonths, nBlockTime, errorMessage, fJustCheck);
+        return CheckUpdateDomainEntryTxInputs(entry, scriptOp, parsed, tx->GetHash(), nMonths, nBlockTime, errorMessage, fJustCheck);
     }
     else if (strOperationType == "bdap_move_account") {
         uint16_t nMonths = 0;
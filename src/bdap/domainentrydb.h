@@ -10,19 +10,52 @@
 #include "sync.h"
 
 class CCoinsViewCache;
+struct CBDAPParsedTx;
 
 static CCriticalSection cs_bdap_entry;
 
 const BDAP::ObjectType DEFAULT_ACCOUNT_TYPE = BDAP::ObjectType::BDAP_DEFAULT_TYPE;
 
-class CDomainEntryDB : public CDBWrapper {
+/**
+ * A BDAP account change as handed to NotifyBDAPUpdate subscribers. The JSON
+ * and binary encodings are built on first use and shared by every topic.
+ */
+class CBDAPNotification {
+private:
+    const CDomainEntry& entry;
+    const int op;
+
+    mutable UniValue oEntry;
+    mutable bool fEntryBuilt;
+    mutable std::string strRecordJson;
+    mutable std::string strHistoryJson;
+    mutable std::vector<unsigned char> vchRaw;
+
+    const UniValue& GetEntryJson() const;
+
+public:
+    CBDAPNotification(const CDomainEntry& entryIn, const int opIn) : entry(entryIn), op(opIn), fEntryBuilt(false) {}
+
+    const CDomainEntry& GetEntry() const { return entry; }
+    int GetOp() const { return op; }
+    std::string GetOpString() const;
+
+    //! The account as returned by BDAP RPCs
+    const std::string& GetRecordJson() const;
+    //! The account with the operation that changed it
+    const std::string& GetHistoryJson() const;
+    //! Operation code byte followed by the network serialized account
+    const std::vector<unsigned char>& GetRaw() const;
+};
+
+class CDomainEntryDB : public CStagedDBWrapper {
 public:
-    CDomainEntryDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "bdap-entries", nCacheSize, fMemory, fWipe, obfuscate) {
+    CDomainEntryDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CStagedDBWrapper(GetDataDir() / "blocks" / "bdap-entries", nCacheSize, fMemory, fWipe, obfuscate) {
     }
 
     // Add, Read, Modify, ModifyRDN, Delete, List, Search, Bind, and Compare
     bool AddDomainEntry(const CDomainEntry& entry, const int op);
-    void AddDomainEntryIndex(const CDomainEntry& entry, const int op);
+    void NotifyDomainEntry(const CDomainEntry& entry, const int op);
     bool ReadDomainEntry(const std::vector<unsigned char>& vchObjectPath, CDomainEntry& entry);
     bool ReadDomainEntryPubKey(const std::vector<unsigned char>& vchPubKey, CDomainEntry& entry);
     bool EraseDomainEntry(const std::vector<unsigned char>& vchObjectPath);
@@ -30,8 +63,6 @@ public:
     bool DomainEntryExists(const std::vector<unsigned char>& vchObjectPath);
     bool DomainEntryExistsPubKey(const std::vector<unsigned char>& vchPubKey);
     bool RemoveExpired(int& entriesRemoved);
-    void WriteDomainEntryIndex(const CDomainEntry& entry, const int op);
-    void WriteDomainEntryIndexHistory(const CDomainEntry& entry, const int op);
     bool UpdateDomainEntry(const std::vector<unsigned char>& vchObjectPath, const CDomainEntry& entry);
     bool CleanupLevelDB(int& nRemoved);
     bool ListDirectories(const std::vector<unsigned char>& vchObjectLocation, const unsigned int& nResultsPerPage, const unsigned int& nPage, UniValue& oDomainEntryList, const BDAP::ObjectType& accountType = DEFAULT_ACCOUNT_TYPE, const std::string searchString = "");
@@ -50,8 +81,8 @@ bool UndoDeleteDomainEntry(const CDomainEntry& entry);
 bool CheckDomainEntryDB();
 bool FlushLevelDB();
 void CleanupLevelDB(int& nRemoved);
-bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, const int& op1, const int& op2, const std::vector<std::vector<unsigned char> >& vvchArgs, 
-                                const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage);
+void PreCheckDomainEntryTx(const CTransactionRef& tx, CBDAPParsedTx& parsed);
+bool CheckDomainEntryTx(const CTransactionRef& tx, const CBDAPParsedTx& parsed, const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage);
 
 extern CDomainEntryDB *pDomainEntryDB;
 
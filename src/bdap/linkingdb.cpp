@@ -6,6 +6,7 @@
 
 #include "amount.h"
 #include "bdap/fees.h"
+#include "bdap/parsedtx.h"
 #include "bdap/utils.h"
 #include "base58.h"
 #include "utilmoneystr.h"
@@ -40,7 +41,7 @@ bool CLinkDB::AddLinkIndex(const vchCharString& vvchOpParameters, const uint256&
 bool CLinkDB::ReadLinkIndex(const std::vector<unsigned char>& vchPubKey, uint256& txid)
 {
     LOCK(cs_link);
-    return CDBWrapper::Read(make_pair(std::string("pubkey"), vchPubKey), txid);
+    return Read(make_pair(std::string("pubkey"), vchPubKey), txid);
 }
 
 bool CLinkDB::EraseLinkIndex(const std::vector<unsigned char>& vchPubKey, const std::vector<unsigned char>& vchSharedPubKey)
@@ -52,17 +53,17 @@ bool CLinkDB::EraseLinkIndex(const std::vector<unsigned char>& vchPubKey, const
 
     bool result = false;
     LOCK(cs_link);
-    result = CDBWrapper::Erase(make_pair(std::string("pubkey"), vchPubKey));
+    result = Erase(make_pair(std::string("pubkey"), vchPubKey));
     if (!result)
         return false;
 
-    return CDBWrapper::Erase(make_pair(std::string("pubkey"), vchSharedPubKey));
+    return Erase(make_pair(std::string("pubkey"), vchSharedPubKey));
 }
 
 bool CLinkDB::LinkExists(const std::vector<unsigned char>& vchPubKey)
 {
     LOCK(cs_link);
-    return CDBWrapper::Exists(make_pair(std::string("pubkey"), vchPubKey));
+    return Exists(make_pair(std::string("pubkey"), vchPubKey));
 }
 
 bool GetLinkIndex(const std::vector<unsigned char>& vchPubKey, uint256& txid)
@@ -126,22 +127,40 @@ static bool CommonLinkParameterCheck(const vchCharString& vvchOpParameters, std:
     return true;
 }
 
-static bool CheckNewLinkTx(const CScript& scriptData, const vchCharString& vvchOpParameters, const uint256& txid, std::string& errorMessage, bool fJustCheck)
+static bool CheckLinkDataScript(const CScript& scriptData, std::string& errorMessage)
 {
-    if (!CommonLinkParameterCheck(vvchOpParameters, errorMessage))
-        return error(errorMessage.c_str());
-
     if (!scriptData.IsUnspendable()) {
         errorMessage = "CheckNewLinkTx failed! Data script should be unspendable.";
-        return error(errorMessage.c_str());
+        return false;
     }
     CTxOut txout(0, scriptData);
     size_t nSize = GetSerializeSize(txout, SER_DISK,0)+148u;
     LogPrint("bdap", "%s -- scriptData.size() = %u, Serialize Size = %u \n", __func__, scriptData.size(), nSize);
     if (nSize > MAX_BDAP_LINK_DATA_SIZE) {
         errorMessage = "CheckNewLinkTx failed! Data script is too large.";
+        return false;
+    }
+    return true;
+}
+
+void PreCheckLinkTx(const CTransactionRef& tx, CBDAPParsedTx& parsed)
+{
+    parsed.fDataValid = GetBDAPDataScript(tx, parsed.scriptData);
+    if (!parsed.fDataValid)
+        return;
+
+    parsed.fAmounts = ExtractAmountsFromTx(tx, parsed.dataAmount, parsed.opAmount);
+    parsed.fParamsValid = CommonLinkParameterCheck(parsed.vvchArgs, parsed.strParamsError) && CheckLinkDataScript(parsed.scriptData, parsed.strParamsError);
+}
+
+static bool CheckNewLinkTx(const CBDAPParsedTx& parsed, const uint256& txid, std::string& errorMessage, bool fJustCheck)
+{
+    const vchCharString& vvchOpParameters = parsed.vvchArgs;
+    if (!parsed.fParamsValid) {
+        errorMessage = parsed.strParamsError;
         return error(errorMessage.c_str());
     }
+
     if (fJustCheck)
         return true;
 
@@ -163,9 +182,11 @@ static bool CheckNewLinkTx(const CScript& scriptData, const vchCharString& vvchO
     return true;
 }
 
-bool CheckLinkTx(const CTransactionRef& tx, const int& op1, const int& op2, const std::vector<std::vector<unsigned char> >& vvchArgs, 
-                                const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage) 
+bool CheckLinkTx(const CTransactionRef& tx, const CBDAPParsedTx& parsed, const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage) 
 {
+    const int& op1 = parsed.op1;
+    const int& op2 = parsed.op2;
+
     if (tx->IsCoinBase() && !fJustCheck && !bSanityCheck) {
         LogPrintf("%s -- Trying to add BDAP link in coinbase transaction, skipping...\n", __func__);
         return true;
@@ -173,18 +194,18 @@ bool CheckLinkTx(const CTransactionRef& tx, const int& op1, const int& op2, cons
 
     LogPrint("bdap", "%s -- *** BDAP link nHeight=%d, chainActive.Tip()=%d, op1=%s, op2=%s, hash=%s justcheck=%s\n", __func__, nHeight, chainActive.Tip()->nHeight, BDAPFromOp(op1).c_str(), BDAPFromOp(op2).c_str(), tx->GetHash().ToString().c_str(), fJustCheck ? "JUSTCHECK" : "BLOCK");
 
-    CScript scriptData;
-    if (!GetBDAPDataScript(tx, scriptData))
+    // data script and amounts were extracted by PreCheckLinkTx
+    if (!parsed.fDataValid)
         return false;
 
-    // extract amounts from tx.
-    CAmount dataAmount, opAmount;
-    if (!ExtractAmountsFromTx(tx, dataAmount, opAmount)) {
+    const CAmount& dataAmount = parsed.dataAmount;
+    const CAmount& opAmount = parsed.opAmount;
+    if (!parsed.fAmounts) {
         errorMessage = "Unable to extract BDAP amounts from transaction";
         return false;
     }
 
-    const std::string strOperationType = GetBDAPOpTypeString(op1, op2);
+    const std::string& strOperationType = parsed.strOpType;
 
     CAmount monthlyFee, oneTimeFee, depositFee;
     if (strOperationType == "bdap_new_link_request") {
@@ -212,7 +233,7 @@ bool CheckLinkTx(const CTransactionRef& tx, const int& op1, const int& op2, cons
             LogPrint("bdap", "%s -- Valid BDAP deposit fee amount for new BDAP request link. Deposit paid %d, should be %d\n", __func__, 
                                     FormatMoney(opAmount), FormatMoney(depositFee));
         }
-        return CheckNewLinkTx(scriptData, vvchArgs, tx->GetHash(), errorMessage, fJustCheck);
+        return CheckNewLinkTx(parsed, tx->GetHash(), errorMessage, fJustCheck);
     }
     else if (strOperationType == "bdap_new_link_accept") {
         uint16_t nMonths = 0;
@@ -238,7 +259,7 @@ bool CheckLinkTx(const CTransactionRef& tx, const int& op1, const int& op2, cons
             LogPrint("bdap", "%s -- Valid BDAP deposit fee amount for new BDAP accept link. Deposit paid %d, should be %d\n", __func__, 
                                     FormatMoney(opAmount), FormatMoney(depositFee));
         }
-        return CheckNewLinkTx(scriptData, vvchArgs, tx->GetHash(), errorMessage, fJustCheck);
+        return CheckNewLinkTx(parsed, tx->GetHash(), errorMessage, fJustCheck);
     }
 
     return false;
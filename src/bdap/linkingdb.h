@@ -9,13 +9,14 @@
 #include "dbwrapper.h"
 #include "sync.h"
 
+struct CBDAPParsedTx;
 class uint256;
 
 static CCriticalSection cs_link;
 
-class CLinkDB : public CDBWrapper {
+class CLinkDB : public CStagedDBWrapper {
 public:
-    CLinkDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "links", nCacheSize, fMemory, fWipe, obfuscate) {
+    CLinkDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CStagedDBWrapper(GetDataDir() / "blocks" / "links", nCacheSize, fMemory, fWipe, obfuscate) {
     }
 
     bool AddLinkIndex(const vchCharString& vvchOpParameters, const uint256& txid);
@@ -29,8 +30,8 @@ bool UndoLinkData(const std::vector<unsigned char>& vchPubKey, const std::vector
 bool GetLinkIndex(const std::vector<unsigned char>& vchPubKey, uint256& txid);
 bool CheckLinkDB();
 bool FlushLinkDB();
-bool CheckLinkTx(const CTransactionRef& tx, const int& op1, const int& op2, const std::vector<std::vector<unsigned char> >& vvchArgs, 
-                                const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage);
+void PreCheckLinkTx(const CTransactionRef& tx, CBDAPParsedTx& parsed);
+bool CheckLinkTx(const CTransactionRef& tx, const CBDAPParsedTx& parsed, const bool fJustCheck, const int& nHeight, const uint32_t& nBlockTime, const bool bSanityCheck, std::string& errorMessage);
 
 bool CheckPreviousLinkInputs(const std::string& strOpType, const CScript& scriptOp, const std::vector<std::vector<unsigned char>>& vvchOpParameters, std::string& errorMessage, bool fJustCheck);
 
@@ -11,6 +11,7 @@
 #include "bdap/vgp/include/encryption.h" // for VGP DecryptBDAPData
 #include "dht/ed25519.h"
 #include "pubkey.h"
+#include "utiltime.h"
 #include "wallet/wallet.h"
 
 CLinkManager* pLinkManager = NULL;
@@ -172,10 +173,32 @@ bool CLinkManager::GetLinkPrivateKey(const std::vector<unsigned char>& vchSender
     return false;
 }
 
+void CLinkManager::AddLink(const CLink& record)
+{
+    AssertLockHeld(cs_link);
+    std::map<uint256, CLink>::iterator it = m_Links.find(record.LinkID);
+    if (it != m_Links.end()) {
+        const CLink& prev = it->second;
+        m_LinkIDsByState[prev.nLinkState].erase(prev.LinkID);
+        m_LinkIDsByFQDN[prev.RequestorFullObjectPath].erase(prev.LinkID);
+        m_LinkIDsByFQDN[prev.RecipientFullObjectPath].erase(prev.LinkID);
+        if (!prev.SubjectID.IsNull())
+            m_LinkIDsBySubjectID.erase(prev.SubjectID);
+    }
+    m_Links[record.LinkID] = record;
+    m_LinkIDsByState[record.nLinkState].insert(record.LinkID);
+    m_LinkIDsByFQDN[record.RequestorFullObjectPath].insert(record.LinkID);
+    m_LinkIDsByFQDN[record.RecipientFullObjectPath].insert(record.LinkID);
+    if (!record.SubjectID.IsNull())
+        m_LinkIDsBySubjectID[record.SubjectID] = record.LinkID;
+}
+
 bool CLinkManager::FindLink(const uint256& id, CLink& link)
 {
-    if (m_Links.count(id) > 0) {
-        link = m_Links.at(id);
+    LOCK(cs_link);
+    std::map<uint256, CLink>::const_iterator it = m_Links.find(id);
+    if (it != m_Links.end()) {
+        link = it->second;
         return true;
     }
     return false;
@@ -183,15 +206,13 @@ bool CLinkManager::FindLink(const uint256& id, CLink& link)
 
 bool CLinkManager::FindLinkBySubjectID(const uint256& subjectID, CLink& getLink)
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        if (link.second.SubjectID == subjectID) // pending request
-        {
-            getLink = link.second;
-            return true;
-        }
-    }
-    return false;
+    LOCK(cs_link);
+    std::map<uint256, uint256>::const_iterator it = m_LinkIDsBySubjectID.find(subjectID);
+    if (it == m_LinkIDsBySubjectID.end())
+        return false;
+
+    getLink = m_Links.at(it->second);
+    return true;
 }
 
 void CLinkManager::ProcessQueue()
@@ -202,66 +223,146 @@ void CLinkManager::ProcessQueue()
     if (pwalletMain->IsLocked())
         return;
 
-    // make sure we are not stuck in an infinite loop
-    size_t size = QueueSize();
-    size_t counter = 0;
-    LogPrintf("CLinkManager::%s -- Start links in queue = %d\n", __func__, size);
-    while (!linkQueue.empty() && size > counter)
-    {
-        // TODO (BDAP): Do we need to lock the queue while processing?
-        CLinkStorage storage = linkQueue.front();
-        ProcessLink(storage);
-        linkQueue.pop();
-        counter++;
+    LOCK(cs_link);
+    if (linkQueue.empty())
+        return;
+
+    // links queued after a drain started are picked up by extending it
+    if (!fQueueDraining) {
+        nQueueDrainProcessed = 0;
+        fQueueDraining = true;
     }
-    LogPrintf("CLinkManager::%s -- Finished links in queue = %d\n", __func__, QueueSize());
+    nQueueDrainTotal = nQueueDrainProcessed + linkQueue.size();
+    LogPrintf("CLinkManager::%s -- Scheduled links in queue = %d\n", __func__, linkQueue.size());
 }
 
-bool CLinkManager::ListMyPendingRequests(std::vector<CLink>& vchLinks)
+void CLinkManager::DoMaintenance()
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        if (link.second.nLinkState == 1 && link.second.fRequestFromMe) // pending request
-        {
-            vchLinks.push_back(link.second);
+    if (!fQueueDraining)
+        return;
+
+    int64_t nTimeStart = GetTimeMillis();
+    while (GetTimeMillis() - nTimeStart < LINK_QUEUE_MAX_TICK_MILLIS) {
+        if (!pwalletMain || pwalletMain->IsLocked()) {
+            // the remaining links stay queued until the wallet is unlocked again
+            LogPrintf("CLinkManager::%s -- Wallet locked, paused with links in queue = %d\n", __func__, QueueSize());
+            fQueueDraining = false;
+            return;
+        }
+
+        // ProcessLink reads DHT keys from the wallet, keep cs_wallet before cs_link
+        LOCK2(pwalletMain->cs_wallet, cs_link);
+        for (size_t i = 0; i < LINK_QUEUE_BATCH_SIZE; i++) {
+            // links that can not be processed yet are queued again, so stop at the total
+            if (linkQueue.empty() || nQueueDrainProcessed >= nQueueDrainTotal) {
+                fQueueDraining = false;
+                LogPrintf("CLinkManager::%s -- Finished processing %d links, links in queue = %d\n", __func__, nQueueDrainProcessed.load(), linkQueue.size());
+                return;
+            }
+            CLinkStorage storage = linkQueue.front();
+            linkQueue.pop();
+            ProcessLink(storage);
+            nQueueDrainProcessed++;
         }
     }
-    return true;
 }
 
-bool CLinkManager::ListMyPendingAccepts(std::vector<CLink>& vchLinks)
+bool CLinkManager::GetQueueProgress(size_t& nProcessed, size_t& nTotal) const
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        //LogPrintf("%s -- link:\n%s\n", __func__, link.second.ToString());
-        if (link.second.nLinkState == 1 && (!link.second.fRequestFromMe || (link.second.fRequestFromMe && link.second.fAcceptFromMe))) // pending accept
-        {
-            vchLinks.push_back(link.second);
+    nProcessed = nQueueDrainProcessed;
+    nTotal = nQueueDrainTotal;
+    return fQueueDraining;
+}
+
+static bool IsMyPendingRequest(const CLink& link)
+{
+    return link.fRequestFromMe;
+}
+
+static bool IsMyPendingAccept(const CLink& link)
+{
+    return !link.fRequestFromMe || link.fAcceptFromMe;
+}
+
+static bool IsMyPending(const CLink& link)
+{
+    return IsMyPendingRequest(link) || IsMyPendingAccept(link);
+}
+
+static bool IsMyCompleted(const CLink& link)
+{
+    return !link.txHashRequest.IsNull();
+}
+
+void CLinkManager::ListLinks(const uint8_t nState, bool (*fnMatch)(const CLink&), const CLinkFilter& filter, std::vector<CLink>& vchLinks, size_t* pnTotal)
+{
+    LOCK(cs_link);
+    // walk the smallest candidate set: one account's links or every link in the state
+    const std::set<uint256>* pSetIDs = nullptr;
+    if (!filter.vchRequestor.empty() || !filter.vchRecipient.empty()) {
+        std::map<std::vector<unsigned char>, std::set<uint256>>::const_iterator it = m_LinkIDsByFQDN.find(filter.vchRequestor.empty() ? filter.vchRecipient : filter.vchRequestor);
+        if (it != m_LinkIDsByFQDN.end())
+            pSetIDs = &it->second;
+    }
+    else {
+        std::map<uint8_t, std::set<uint256>>::const_iterator it = m_LinkIDsByState.find(nState);
+        if (it != m_LinkIDsByState.end())
+            pSetIDs = &it->second;
+    }
+
+    size_t nTotal = 0;
+    if (pSetIDs) {
+        for (const uint256& id : *pSetIDs) {
+            const CLink& link = m_Links.at(id);
+            if (link.nLinkState != nState || !fnMatch(link))
+                continue;
+            if (!filter.vchRequestor.empty() && link.RequestorFullObjectPath != filter.vchRequestor)
+                continue;
+            if (!filter.vchRecipient.empty() && link.RecipientFullObjectPath != filter.vchRecipient)
+                continue;
+            if (nTotal >= filter.nSkip && (filter.nCount == 0 || nTotal - filter.nSkip < filter.nCount))
+                vchLinks.push_back(link);
+            nTotal++;
         }
     }
+    if (pnTotal)
+        *pnTotal = nTotal;
+}
+
+bool CLinkManager::ListMyPendingRequests(std::vector<CLink>& vchLinks, const CLinkFilter& filter, size_t* pnTotal)
+{
+    ListLinks(BDAP::LinkState::pending_state, IsMyPendingRequest, filter, vchLinks, pnTotal);
     return true;
 }
 
-bool CLinkManager::ListMyCompleted(std::vector<CLink>& vchLinks)
+bool CLinkManager::ListMyPendingAccepts(std::vector<CLink>& vchLinks, const CLinkFilter& filter, size_t* pnTotal)
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        if (link.second.nLinkState == 2 && !link.second.txHashRequest.IsNull()) // completed link
-        {
-            vchLinks.push_back(link.second);
-        }
-    }
+    ListLinks(BDAP::LinkState::pending_state, IsMyPendingAccept, filter, vchLinks, pnTotal);
     return true;
 }
 
-bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly)
+bool CLinkManager::ListMyPending(std::vector<CLink>& vchLinks, const CLinkFilter& filter, size_t* pnTotal)
 {
+    ListLinks(BDAP::LinkState::pending_state, IsMyPending, filter, vchLinks, pnTotal);
+    return true;
+}
 
+bool CLinkManager::ListMyCompleted(std::vector<CLink>& vchLinks, const CLinkFilter& filter, size_t* pnTotal)
+{
+    ListLinks(BDAP::LinkState::complete_state, IsMyCompleted, filter, vchLinks, pnTotal);
+    return true;
+}
+
+bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly)
+{
     if (!pwalletMain) {
+        LOCK(cs_link);
         linkQueue.push(storage);
         return true;
     }
 
+    LOCK2(pwalletMain->cs_wallet, cs_link);
+
     if (fStoreInQueueOnly || pwalletMain->IsLocked()) {
         linkQueue.push(storage);
         return true;
@@ -320,7 +421,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                         //LogPrintf("%s -- link request = %s\n", __func__, record.ToString());
                     }
                     LogPrint("bdap", "%s -- Clear text link request added to map id = %s\n", __func__, linkID.ToString());
-                    m_Links[linkID] = record;
+                    AddLink(record);
 
                 }
                 else
@@ -377,7 +478,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                         //LogPrintf("%s -- link accept = %s\n", __func__, record.ToString());
                     }
                     LogPrint("bdap", "%s -- Clear text accept added to map id = %s, %s\n", __func__, linkID.ToString(), record.ToString());
-                    m_Links[linkID] = record;
+                    AddLink(record);
                 }
                 else
                     LogPrintf("%s -- Warning! Link accept found with an invalid signature proof! Link requestor = %s, recipient = %s, pubkey = %s\n", __func__, link.RequestorFQDN(), link.RecipientFQDN(), stringFromVch(storage.vchLinkPubKey));
@@ -464,7 +565,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- link request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link request from me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        AddLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link request GetBDAPData failed.\n", __func__);
@@ -549,7 +650,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- link request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link request for me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        AddLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link request GetBDAPData failed.\n", __func__);
@@ -626,7 +727,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- accept request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link accept from me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        AddLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link accept GetBDAPData failed.\n", __func__);
@@ -704,7 +805,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- accept request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link accept for me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        AddLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link accept GetBDAPData failed.\n", __func__);
@@ -731,19 +832,25 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
 
 std::vector<CLinkInfo> CLinkManager::GetCompletedLinkInfo(const std::vector<unsigned char>& vchFullObjectPath)
 {
+    LOCK(cs_link);
     std::vector<CLinkInfo> vchLinkInfo;
-    for(const std::pair<uint256, CLink>& link : m_Links)
+    std::map<std::vector<unsigned char>, std::set<uint256>>::const_iterator itFQDN = m_LinkIDsByFQDN.find(vchFullObjectPath);
+    if (itFQDN == m_LinkIDsByFQDN.end())
+        return vchLinkInfo;
+
+    for (const uint256& id : itFQDN->second)
     {
-        if (link.second.nLinkState == 2) // completed link
+        const CLink& link = m_Links.at(id);
+        if (link.nLinkState == 2) // completed link
         {
-            if (link.second.RequestorFullObjectPath == vchFullObjectPath)
+            if (link.RequestorFullObjectPath == vchFullObjectPath)
             {
-                CLinkInfo linkInfo(link.second.RecipientFullObjectPath, link.second.RecipientPubKey, link.second.RequestorPubKey);
+                CLinkInfo linkInfo(link.RecipientFullObjectPath, link.RecipientPubKey, link.RequestorPubKey);
                 vchLinkInfo.push_back(linkInfo);
             }
-            else if (link.second.RecipientFullObjectPath == vchFullObjectPath)
+            else if (link.RecipientFullObjectPath == vchFullObjectPath)
             {
-                CLinkInfo linkInfo(link.second.RequestorFullObjectPath, link.second.RequestorPubKey, link.second.RecipientPubKey);
+                CLinkInfo linkInfo(link.RequestorFullObjectPath, link.RequestorPubKey, link.RecipientPubKey);
                 vchLinkInfo.push_back(linkInfo);
             }
         }
@@ -768,12 +875,14 @@ int CLinkManager::IsMyMessage(const uint256& subjectID, const uint256& messageID
 
 void CLinkManager::LoadLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey)
 {
+    LOCK(cs_link);
     if (m_LinkMessageInfo.count(subjectID) == 0)
         m_LinkMessageInfo[subjectID] = vchPubKey;
 }
 
 bool CLinkManager::GetLinkMessageInfo(const uint256& subjectID, std::vector<unsigned char>& vchPubKey)
 {
+    LOCK(cs_link);
     std::map<uint256, std::vector<unsigned char>>::iterator it = m_LinkMessageInfo.find(subjectID);
     if (it != m_LinkMessageInfo.end()) {
         vchPubKey = it->second;
@@ -6,11 +6,14 @@
 #define DYNAMIC_BDAP_LINKMANAGER_H
 
 #include "bdap/linkstorage.h"
+#include "sync.h"
 #include "uint256.h"
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -134,11 +137,36 @@ public:
     std::string ToString() const;
 };
 
+// Number of queued links processed per lock acquisition when draining the queue
+static const size_t LINK_QUEUE_BATCH_SIZE = 50;
+// Upper bound on the time one maintenance tick spends draining the queue
+static const int64_t LINK_QUEUE_MAX_TICK_MILLIS = 250;
+
+/** Counterparty filter and page window for the link list queries */
+struct CLinkFilter {
+    std::vector<unsigned char> vchRequestor; // empty matches any requestor
+    std::vector<unsigned char> vchRecipient; // empty matches any recipient
+    size_t nSkip;
+    size_t nCount; // 0 returns every match after nSkip
+
+    CLinkFilter() : vchRequestor(), vchRecipient(), nSkip(0), nCount(0) {}
+};
+
 class CLinkManager {
 private:
+    mutable CCriticalSection cs_link;
     std::queue<CLinkStorage> linkQueue;
     std::map<uint256, CLink> m_Links;
     std::map<uint256, std::vector<unsigned char>> m_LinkMessageInfo;
+    // Secondary indexes into m_Links, kept in sync by AddLink
+    std::map<uint8_t, std::set<uint256>> m_LinkIDsByState;
+    std::map<std::vector<unsigned char>, std::set<uint256>> m_LinkIDsByFQDN;
+    std::map<uint256, uint256> m_LinkIDsBySubjectID;
+
+    // Queue draining progress, updated by DoMaintenance
+    std::atomic<bool> fQueueDraining;
+    std::atomic<size_t> nQueueDrainTotal;
+    std::atomic<size_t> nQueueDrainProcessed;
 
 public:
     CLinkManager() {
@@ -147,22 +175,41 @@ public:
 
     inline void SetNull()
     {
+        LOCK(cs_link);
         std::queue<CLinkStorage> emptyQueue;
         linkQueue = emptyQueue;
         m_Links.clear();
+        m_LinkIDsByState.clear();
+        m_LinkIDsByFQDN.clear();
+        m_LinkIDsBySubjectID.clear();
+        fQueueDraining = false;
+        nQueueDrainTotal = 0;
+        nQueueDrainProcessed = 0;
     }
 
-    std::size_t QueueSize() const { return linkQueue.size(); }
-    std::size_t LinkCount() const { return m_Links.size(); }
+    std::size_t QueueSize() const { LOCK(cs_link); return linkQueue.size(); }
+    std::size_t LinkCount() const { LOCK(cs_link); return m_Links.size(); }
 
     bool ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly = false);
+    /** Schedule the queued links for processing by DoMaintenance, returns immediately */
     void ProcessQueue();
+    /** Process queued links in batches while the wallet stays unlocked */
+    void DoMaintenance();
+    /** Progress of the current (or last) queue drain */
+    bool GetQueueProgress(size_t& nProcessed, size_t& nTotal) const;
 
     bool FindLink(const uint256& id, CLink& link);
     bool FindLinkBySubjectID(const uint256& subjectID, CLink& getLink);
-    bool ListMyPendingRequests(std::vector<CLink>& vchLinks);
-    bool ListMyPendingAccepts(std::vector<CLink>& vchLinks);
-    bool ListMyCompleted(std::vector<CLink>& vchLinks);
+    /**
+     * The list queries only visit the links in the matching state, or in the
+     * counterparty's links when the filter names one. Results are ordered by
+     * link id so consecutive pages are stable; pnTotal receives the number of
+     * matches before paging.
+     */
+    bool ListMyPendingRequests(std::vector<CLink>& vchLinks, const CLinkFilter& filter = CLinkFilter(), size_t* pnTotal = nullptr);
+    bool ListMyPendingAccepts(std::vector<CLink>& vchLinks, const CLinkFilter& filter = CLinkFilter(), size_t* pnTotal = nullptr);
+    bool ListMyPending(std::vector<CLink>& vchLinks, const CLinkFilter& filter = CLinkFilter(), size_t* pnTotal = nullptr);
+    bool ListMyCompleted(std::vector<CLink>& vchLinks, const CLinkFilter& filter = CLinkFilter(), size_t* pnTotal = nullptr);
     std::vector<CLinkInfo> GetCompletedLinkInfo(const std::vector<unsigned char>& vchFullObjectPath);
     int IsMyMessage(const uint256& subjectID, const uint256& messageID, const int64_t& timestamp);
     void LoadLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey);
@@ -170,6 +217,8 @@ public:
     bool GetAllMessagesByType(const std::vector<unsigned char> vchMessageType);
 
 private:
+    void AddLink(const CLink& record);
+    void ListLinks(const uint8_t nState, bool (*fnMatch)(const CLink&), const CLinkFilter& filter, std::vector<CLink>& vchLinks, size_t* pnTotal);
     bool IsLinkFromMe(const std::vector<unsigned char>& vchLinkPubKey);
     bool IsLinkForMe(const std::vector<unsigned char>& vchLinkPubKey, const std::vector<unsigned char>& vchSharedPubKey);
     bool GetLinkPrivateKey(const std::vector<unsigned char>& vchSenderPubKey, const std::vector<unsigned char>& vchSharedPubKey, std::array<char, 32>& sharedSeed, std::string& strErrorMessage);
@@ -28,6 +28,14 @@ void ProcessLinkQueue()
     pLinkManager->ProcessQueue();
 }
 
+void DoLinkQueueMaintenance()
+{
+    if (!pLinkManager)
+        return;
+
+    pLinkManager->DoMaintenance();
+}
+
 void LoadLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey)
 {
     if (!pLinkManager)
@@ -138,6 +138,7 @@ public:
 
 void ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly = false);
 void ProcessLinkQueue();
+void DoLinkQueueMaintenance();
 void LoadLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey);
 
 #endif // DYNAMIC_BDAP_LINKSTORAGE_H
\ No newline at end of file
@@ -0,0 +1,35 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bdap/parsedtx.h"
+
+#include "bdap/domainentrydb.h"
+#include "bdap/linkingdb.h"
+#include "bdap/utils.h"
+#include "policy/policy.h"
+
+bool ParseBDAPTx(const CTransactionRef& tx, CBDAPParsedTx& parsed)
+{
+    parsed.SetNull();
+    parsed.fParsed = true;
+    if (tx->nVersion != BDAP_TX_VERSION)
+        return false;
+
+    if (!GetBDAPOpScript(tx, parsed.scriptOp, parsed.vvchArgs, parsed.op1, parsed.op2))
+        return false;
+
+    parsed.fBDAPOp = true;
+    parsed.strOpType = GetBDAPOpTypeString(parsed.op1, parsed.op2);
+    // ValidateBDAPInputs rejects these before looking at the operation
+    if (parsed.vvchArgs.size() > 3 || parsed.vvchArgs.size() < 1)
+        return true;
+
+    if (parsed.strOpType == "bdap_new_account" || parsed.strOpType == "bdap_update_account" || parsed.strOpType == "bdap_delete_account") {
+        PreCheckDomainEntryTx(tx, parsed);
+    }
+    else if (parsed.strOpType == "bdap_new_link_request" || parsed.strOpType == "bdap_new_link_accept") {
+        PreCheckLinkTx(tx, parsed);
+    }
+    return true;
+}
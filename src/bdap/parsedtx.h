@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_BDAP_PARSEDTX_H
+#define DYNAMIC_BDAP_PARSEDTX_H
+
+#include "amount.h"
+#include "bdap/bdap.h"
+#include "bdap/domainentry.h"
+#include "primitives/transaction.h"
+#include "script/script.h"
+
+#include <string>
+
+/**
+ * A BDAP transaction after parsing and the checks that do not need any
+ * database or chain state. ConnectBlock fills these in parallel so the serial
+ * database checks only read the results and never deserialize twice.
+ */
+struct CBDAPParsedTx
+{
+    bool fParsed; //!< ParseBDAPTx has run for this transaction
+    bool fBDAPOp; //!< the transaction has a BDAP operation script
+    CScript scriptOp;
+    vchCharString vvchArgs;
+    int op1;
+    int op2;
+    std::string strOpType;
+
+    //! Account entry decoded from the data output (account operations)
+    CDomainEntry entry;
+    //! Data script of the transaction (link operations)
+    CScript scriptData;
+    //! Entry or link data was found, decoded and passed value checks
+    bool fDataValid;
+    std::string strDataError;
+
+    bool fAmounts;
+    CAmount dataAmount;
+    CAmount opAmount;
+
+    //! Result of CommonDataCheck or CommonLinkParameterCheck
+    bool fParamsValid;
+    std::string strParamsError;
+
+    CBDAPParsedTx()
+    {
+        SetNull();
+    }
+
+    void SetNull()
+    {
+        fParsed = false;
+        fBDAPOp = false;
+        scriptOp.clear();
+        vvchArgs.clear();
+        op1 = -1;
+        op2 = -1;
+        strOpType.clear();
+        entry.SetNull();
+        scriptData.clear();
+        fDataValid = false;
+        strDataError.clear();
+        fAmounts = false;
+        dataAmount = 0;
+        opAmount = 0;
+        fParamsValid = false;
+        strParamsError.clear();
+    }
+};
+
+/** Parse a BDAP transaction and run its context-free checks. Safe to call from any thread. */
+bool ParseBDAPTx(const CTransactionRef& tx, CBDAPParsedTx& parsed);
+
+#endif // DYNAMIC_BDAP_PARSEDTX_H
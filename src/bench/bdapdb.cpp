@@ -0,0 +1,77 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "bdap/domainentry.h"
+#include "dbwrapper.h"
+#include "random.h"
+
+#include <boost/filesystem.hpp>
+
+// Number of BDAP account entries in one simulated block
+static const int BDAP_ENTRIES_PER_BLOCK = 500;
+
+static std::vector<CDomainEntry> MakeBDAPBlockEntries(int nHeight)
+{
+    std::vector<CDomainEntry> vEntries;
+    for (int i = 0; i < BDAP_ENTRIES_PER_BLOCK; i++) {
+        CDomainEntry entry;
+        entry.DomainComponent = vchFromString("bdap.io");
+        entry.OrganizationalUnit = vchFromString("public");
+        entry.ObjectID = vchFromString(strprintf("user%d-%d", nHeight, i));
+        entry.CommonName = vchFromString(strprintf("User %d %d", nHeight, i));
+        entry.WalletAddress = vchFromString("DJx3ZhSVPyXDa5ZrnVH3vvSeXwnkXy4SJU");
+        entry.DHTPublicKey = vchFromString(GetRandHash().GetHex());
+        entry.txHash = GetRandHash();
+        entry.nHeight = nHeight;
+        vEntries.push_back(entry);
+    }
+    return vEntries;
+}
+
+// Mirrors CDomainEntryDB::AddDomainEntry followed by the existence check the next transaction does
+template <typename DB>
+static void AddBDAPBlockEntries(DB& db, const std::vector<CDomainEntry>& vEntries)
+{
+    for (const CDomainEntry& entry : vEntries) {
+        db.Write(std::make_pair(std::string("dc"), entry.vchFullObjectPath()), entry);
+        db.Write(std::make_pair(std::string("pk"), entry.DHTPublicKey), entry);
+        assert(db.Exists(std::make_pair(std::string("dc"), entry.vchFullObjectPath())));
+    }
+}
+
+// One LevelDB write per side database record, as ConnectBlock did before staging
+static void BDAPBlockWrites_Direct(benchmark::State& state)
+{
+    boost::filesystem::path ph = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CDBWrapper db(ph, 8 << 20);
+        int nHeight = 0;
+        while (state.KeepRunning()) {
+            AddBDAPBlockEntries(db, MakeBDAPBlockEntries(++nHeight));
+        }
+    }
+    boost::filesystem::remove_all(ph);
+}
+
+// Writes staged in memory and committed in a single batch per block
+static void BDAPBlockWrites_Staged(benchmark::State& state)
+{
+    boost::filesystem::path ph = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        CStagedDBWrapper db(ph, 8 << 20);
+        int nHeight = 0;
+        while (state.KeepRunning()) {
+            db.BeginBlockScope();
+            AddBDAPBlockEntries(db, MakeBDAPBlockEntries(++nHeight));
+            db.EndBlockScope(true);
+            db.CommitStaged(false);
+        }
+    }
+    boost::filesystem::remove_all(ph);
+}
+
+BENCHMARK(BDAPBlockWrites_Direct);
+BENCHMARK(BDAPBlockWrites_Staged);
@@ -4,6 +4,8 @@
 
 #include "bench.h"
 
+#include "chainparams.h"
+#include "chainparamsbase.h"
 #include "key.h"
 #include "random.h"
 #include "validation.h"
@@ -16,6 +18,7 @@ main(int argc, char** argv)
     ECC_Start();
     SetupEnvironment();
     fPrintToDebugLog = false; // don't want to write to debug.log file
+    SelectParams(CBaseChainParams::MAIN); // benchmarks that need another chain restore this one
 
     benchmark::BenchRunner::RunAll();
 
@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "miner/miner-util.h"
+#include "primitives/transaction.h"
+#include "random.h"
+#include "script/script.h"
+#include "sync.h"
+#include "txmempool.h"
+#include "utiltime.h"
+#include "version.h"
+
+// A third of the transactions spend an output of an earlier mempool transaction
+static const int ASSEMBLE_CHILD_PERCENT = 33;
+// Chains stay below the default ancestor limit
+static const uint64_t ASSEMBLE_MAX_ANCESTORS = 24;
+// Half of the transactions spending confirmed coins are old enough to be mined free
+static const int ASSEMBLE_FREE_PERCENT = 50;
+
+static void FillAssembleMempool(CTxMemPool& pool, size_t nTxs)
+{
+    FastRandomContext rand;
+    std::vector<CTransactionRef> vecTxs;
+    std::vector<uint32_t> vecSpent;
+
+    LOCK(pool.cs);
+    for (size_t i = 0; i < nTxs; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(72, 1);
+        tx.vout.resize(2);
+        for (CTxOut& out : tx.vout) {
+            out.nValue = 10 * COIN;
+            out.scriptPubKey = CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 2) << OP_EQUALVERIFY << OP_CHECKSIG;
+        }
+
+        // Spend an unspent output of a recent transaction, or a confirmed coin
+        bool fChild = false;
+        if (!vecTxs.empty() && (int)(rand.rand32() % 100) < ASSEMBLE_CHILD_PERCENT) {
+            size_t nParent = vecTxs.size() - 1 - rand.rand32() % std::min(vecTxs.size(), (size_t)1000);
+            CTxMemPool::txiter parent = pool.mapTx.find(vecTxs[nParent]->GetHash());
+            if (vecSpent[nParent] < vecTxs[nParent]->vout.size() && parent->GetCountWithAncestors() < ASSEMBLE_MAX_ANCESTORS) {
+                tx.vin[0].prevout = COutPoint(vecTxs[nParent]->GetHash(), vecSpent[nParent]++);
+                fChild = true;
+            }
+        }
+        if (!fChild)
+            tx.vin[0].prevout = COutPoint(GetRandHash(), 0);
+
+        // Fee rates between 1 and 50 times the minimum relay fee
+        CTransactionRef txRef = MakeTransactionRef(std::move(tx));
+        CAmount nFee = (1 + rand.rand32() % 50) * ::GetSerializeSize(*txRef, SER_NETWORK, PROTOCOL_VERSION);
+        // Confirmed coins age, so the priority area has candidates to sort
+        double dPriority = 0.0;
+        CAmount nInChainValue = 0;
+        if (!fChild) {
+            nInChainValue = txRef->GetValueOut() + nFee;
+            dPriority = AllowFreeThreshold() * (rand.rand32() % 100) / (100 - ASSEMBLE_FREE_PERCENT);
+        }
+        pool.addUnchecked(txRef->GetHash(), CTxMemPoolEntry(txRef, nFee, GetTime(), dPriority, 1, nInChainValue, false, 1, LockPoints()));
+        vecTxs.push_back(txRef);
+        vecSpent.push_back(0);
+    }
+}
+
+static void AssembleBlock(benchmark::State& state, size_t nTxs)
+{
+    CTxMemPool pool(CFeeRate(0));
+    FillAssembleMempool(pool, nTxs);
+
+    while (state.KeepRunning()) {
+        CBlockTemplate blocktemplate;
+        blocktemplate.block.vtx.emplace_back();
+        LOCK(pool.cs);
+        BlockAssembler assembler(pool, blocktemplate, 2, GetTime());
+        assembler.AddTransactions();
+        assert(assembler.nBlockTx > 0);
+    }
+}
+
+static void AssembleBlock_10k(benchmark::State& state)
+{
+    AssembleBlock(state, 10000);
+}
+
+static void AssembleBlock_50k(benchmark::State& state)
+{
+    AssembleBlock(state, 50000);
+}
+
+static void AssembleBlock_100k(benchmark::State& state)
+{
+    AssembleBlock(state, 100000);
+}
+
+BENCHMARK(AssembleBlock_10k);
+BENCHMARK(AssembleBlock_50k);
+BENCHMARK(AssembleBlock_100k);
@@ -0,0 +1,122 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "bloom.h"
+#include "governance-object.h"
+#include "governance-recon.h"
+#include "protocol.h"
+#include "random.h"
+#include "streams.h"
+#include "version.h"
+
+#include <iostream>
+
+// Two simulated nodes: a synced peer and a restarted node that lost part of the votes
+static const size_t GOVERNANCE_SIM_OBJECTS = 200;
+static const size_t GOVERNANCE_SIM_VOTES_PER_OBJECT = 1000;
+static const size_t GOVERNANCE_SIM_MISSING_PER_OBJECT = 10;
+
+struct GovernanceSimNode {
+    std::vector<std::pair<uint256, std::vector<uint256> > > vecObjects;
+};
+
+static void MakeGovernanceSimNodes(GovernanceSimNode& peer, GovernanceSimNode& restarted)
+{
+    for (size_t i = 0; i < GOVERNANCE_SIM_OBJECTS; i++) {
+        uint256 nObjectHash = GetRandHash();
+        std::vector<uint256> vecVotes;
+        for (size_t j = 0; j < GOVERNANCE_SIM_VOTES_PER_OBJECT; j++) {
+            vecVotes.push_back(GetRandHash());
+        }
+        peer.vecObjects.emplace_back(nObjectHash, vecVotes);
+        restarted.vecObjects.emplace_back(nObjectHash, std::vector<uint256>(vecVotes.begin() + GOVERNANCE_SIM_MISSING_PER_OBJECT, vecVotes.end()));
+    }
+}
+
+static size_t InvBytes(size_t nInvs)
+{
+    return nInvs * ::GetSerializeSize(CInv(MSG_GOVERNANCE_OBJECT_VOTE, uint256()), SER_NETWORK, PROTOCOL_VERSION);
+}
+
+// Per-object vote requests with a bloom filter of the votes we have, as before reconciliation
+static void GovernanceSync_BloomFilters(benchmark::State& state)
+{
+    GovernanceSimNode peer, restarted;
+    MakeGovernanceSimNodes(peer, restarted);
+    bool fReported = false;
+
+    while (state.KeepRunning()) {
+        size_t nRequestBytes = 0;
+        size_t nInvs = 0;
+        for (size_t i = 0; i < GOVERNANCE_SIM_OBJECTS; i++) {
+            CBloomFilter filter(20000, GOVERNANCE_FILTER_FP_RATE, GetRandInt(999999), BLOOM_UPDATE_ALL);
+            for (const auto& nVoteHash : restarted.vecObjects[i].second) {
+                filter.insert(nVoteHash);
+            }
+            CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+            ss << restarted.vecObjects[i].first << filter;
+            nRequestBytes += ss.size();
+
+            CBloomFilter received;
+            uint256 nProp;
+            ss >> nProp >> received;
+            for (const auto& nVoteHash : peer.vecObjects[i].second) {
+                if (!received.contains(nVoteHash)) {
+                    nInvs++;
+                }
+            }
+        }
+        if (!fReported) {
+            std::cout << "GovernanceSync_BloomFilters-bytes," << nRequestBytes << "," << InvBytes(nInvs) << "\n";
+            fReported = true;
+        }
+    }
+}
+
+// One reconciliation request covering every object
+static void GovernanceSync_Reconciliation(benchmark::State& state)
+{
+    GovernanceSimNode peer, restarted;
+    MakeGovernanceSimNodes(peer, restarted);
+    bool fReported = false;
+
+    while (state.KeepRunning()) {
+        CGovernanceReconRequest request;
+        request.InitKeys();
+        for (const auto& objPair : restarted.vecObjects) {
+            request.AddObject(objPair.first, objPair.second);
+        }
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << request;
+        size_t nRequestBytes = ss.size();
+
+        CGovernanceReconRequest received;
+        ss >> received;
+        size_t nInvs = 0;
+        size_t nMissingSent = 0;
+        for (size_t i = 0; i < GOVERNANCE_SIM_OBJECTS; i++) {
+            const CGovernanceReconSketch& sketch = received.vecSketches[i];
+            const std::vector<uint256>& vecVotes = peer.vecObjects[i].second;
+            std::vector<bool> vecDiffer = received.GetDifferingBuckets(sketch, vecVotes);
+            for (size_t j = 0; j < vecVotes.size(); j++) {
+                if (vecDiffer[received.GetBucket(sketch, vecVotes[j])]) {
+                    nInvs++;
+                    if (j < GOVERNANCE_SIM_MISSING_PER_OBJECT) {
+                        nMissingSent++;
+                    }
+                }
+            }
+        }
+        assert(nMissingSent == GOVERNANCE_SIM_OBJECTS * GOVERNANCE_SIM_MISSING_PER_OBJECT);
+        if (!fReported) {
+            std::cout << "GovernanceSync_Reconciliation-bytes," << nRequestBytes << "," << InvBytes(nInvs) << "\n";
+            fReported = true;
+        }
+    }
+}
+
+BENCHMARK(GovernanceSync_BloomFilters);
+BENCHMARK(GovernanceSync_Reconciliation);
@@ -0,0 +1,1168 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "bdap/stealth.h"
+#include "blockencodings.h"
+#include "chainparams.h"
+#include "chainparamsbase.h"
+#include "consensus/consensus.h"
+#include "consensus/validation.h"
+#include "dynode-payments.h"
+#include "dynode-sync.h"
+#include "dynode.h"
+#include "dynodeman.h"
+#include "hash.h"
+#include "instantsend.h"
+#include "key.h"
+#include "miner/miner-util.h"
+#include "net.h"
+#include "net_processing.h"
+#include "netbase.h"
+#include "netmessagemaker.h"
+#include "pow.h"
+#include "protocol.h"
+#include "random.h"
+#include "script/interpreter.h"
+#include "script/standard.h"
+#include "streams.h"
+#include "txdb.h"
+#include "txmempool.h"
+#include "util.h"
+#include "utiltime.h"
+#include "validation.h"
+#include "validationinterface.h"
+#include "version.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <tuple>
+
+#include <boost/filesystem.hpp>
+
+/*
+ * In-process network simulation.
+ *
+ * net_processing keeps its state in globals (cs_main, chainActive, mempool,
+ * mapNodeState), as do dnodeman, dynodeSync and instantsend, so a process
+ * holds a single real node. The benchmarks run that node's
+ * ProcessMessages and SendMessages the way the message handler thread does,
+ * over mock connections to simulated peers with latency and bandwidth. The
+ * peers stand in for the rest of the network: they hand the node new blocks,
+ * transactions and dynode messages, answer its requests and fetch what it
+ * announces. The dynodes are registered with the node up front and their
+ * keys are known, so the peers sign for them. Each benchmark prints how long
+ * the node took to get an object from one peer to the others, including its
+ * own processing time:
+ *
+ *   <name>-ms,median,90th percentile,max,messages,bytes
+ *
+ * while the bench timing is the CPU cost of a whole run.
+ */
+
+/** Conditions of every link in a simulated network */
+struct NetSimProfile {
+    const char* name;
+    int64_t nLatency;    //!< one way, in microseconds
+    uint64_t nBandwidth; //!< bytes per second, in each direction
+};
+
+static const NetSimProfile NETSIM_LAN = {"lan", 1000, 125000000};
+static const NetSimProfile NETSIM_WAN = {"wan", 100000, 1250000};
+
+static const size_t NETSIM_PEERS = 8;
+/** The first peers are connections the node made, the others connected to it */
+static const size_t NETSIM_OUTBOUND_PEERS = 4;
+static const size_t NETSIM_BLOCK_TXS = 1000;
+/** Share of the block the node and each peer are missing from their mempools */
+static const int NETSIM_MEMPOOL_MISSING_PERCENT = 2;
+static const size_t NETSIM_RELAY_TXS = 200;
+static const size_t NETSIM_LOCK_REQUESTS = 20;
+static const size_t NETSIM_DYNODES = 500;
+/** Value of the coins, low enough to lock them with InstantSend (SPORK_5_INSTANTSEND_MAX_VALUE) */
+static const CAmount NETSIM_COIN_VALUE = 100 * COIN;
+static const CAmount NETSIM_TX_FEE = COIN / 1000;
+
+/** Highest block of the benchmarks run before, NewPoWValidBlock announces every height once per process */
+static int nNetSimHeight = 0;
+
+/** CConnman with nodes the simulation connects instead of sockets */
+class CNetSimConnman : public CConnman
+{
+public:
+    CNetSimConnman() : CConnman(0x1337, 0x1337) {}
+
+    void AddNode(CNode* pnode)
+    {
+        LOCK(cs_vNodes);
+        vNodes.push_back(pnode);
+    }
+
+    void RemoveNodes()
+    {
+        std::vector<CNode*> vRemoved;
+        {
+            LOCK(cs_vNodes);
+            vRemoved.swap(vNodes);
+        }
+        for (CNode* pnode : vRemoved) {
+            bool fUpdateConnectionTime = false;
+            GetNodeSignals().FinalizeNode(pnode->GetId(), fUpdateConnectionTime);
+        }
+    }
+};
+
+/** The node's end of a simulated link */
+class CNetSimNode : public CNode
+{
+public:
+    CNetSimNode(NodeId id, const CAddress& addrIn, int nMyStartingHeightIn, bool fInboundIn) : CNode(id, NODE_NETWORK, nMyStartingHeightIn, INVALID_SOCKET, addrIn, 0, id + 1, "", fInboundIn) {}
+
+    /** Take what PushMessage queued, in the order the socket handler writes it */
+    std::vector<unsigned char> TakeSendData()
+    {
+        std::vector<unsigned char> vchData;
+        LOCK(cs_vSend);
+        for (const std::vector<unsigned char>& vch : vSendMsg)
+            vchData.insert(vchData.end(), vch.begin(), vch.end());
+        vSendMsg.clear();
+        for (std::deque<CQueuedNetMsg>& queue : vSendQueue) {
+            for (const CQueuedNetMsg& msg : queue) {
+                vchData.insert(vchData.end(), msg.header.begin(), msg.header.end());
+                vchData.insert(vchData.end(), msg.data.begin(), msg.data.end());
+            }
+            queue.clear();
+        }
+        nSendBytes += vchData.size();
+        nSendSize = 0;
+        nSendQueueSize = 0;
+        nSendOffset = 0;
+        fPauseSend = false;
+        return vchData;
+    }
+};
+
+/** A dynode the fixture registered, with the keys to sign for it */
+struct NetSimDynode {
+    COutPoint outpoint;
+    CService addr;
+    CKey key;
+    CPubKey pubKey;
+};
+
+/**
+ * Chain state of the node on regtest in a temporary data directory, with
+ * coins to spend and optionally registered dynodes. The chain params
+ * selected before are restored and the dynode state is cleared when it
+ * goes away.
+ */
+class NetSimSetup
+{
+public:
+    std::unique_ptr<CNetSimConnman> connman;
+    std::vector<NetSimDynode> vDynodes;
+
+    NetSimSetup();
+    ~NetSimSetup();
+
+    /** Spend the first nTxs coins, the transactions' outputs become the coins */
+    std::vector<CTransactionRef> Spend(size_t nTxs);
+    /** A block on the tip with the transactions */
+    std::shared_ptr<const CBlock> CreateBlock(const std::vector<CTransactionRef>& vtx) const;
+    /** Connect a block with the transactions without going through the network */
+    std::shared_ptr<const CBlock> Mine(const std::vector<CTransactionRef>& vtx) const;
+
+    /**
+     * Fund and confirm the collateral of nDynodes dynodes, register them in
+     * dnodeman and finish the dynode sync, the way a synced node sees the
+     * network. The clock is mocked from here on.
+     */
+    void RegisterDynodes(size_t nDynodes);
+    /** A ping of a dynode, signed now */
+    CDynodePing CreatePing(const NetSimDynode& dn) const;
+    /** A broadcast of a dynode with a new ping, signed now */
+    CDynodeBroadcast CreateBroadcast(const NetSimDynode& dn) const;
+    /** Move the mocked clock on */
+    void AdvanceTime(int64_t nSeconds);
+
+private:
+    const std::string strPrevChain;
+    ECCVerifyHandle globalVerifyHandle;
+    boost::filesystem::path pathTemp;
+    std::unique_ptr<CCoinsViewDB> pcoinsdbview;
+    std::unique_ptr<PeerLogicValidation> peerLogic;
+    CKey key;
+    CScript scriptPubKey;
+    std::vector<std::pair<COutPoint, CAmount> > vCoins;
+    /** What the premine left after the coins, pays the collateral */
+    std::pair<COutPoint, CAmount> coinReserve;
+    CKey keyCollateral;
+    int64_t nMockTime;
+
+    void Sign(CMutableTransaction& tx) const;
+};
+
+NetSimSetup::NetSimSetup() : strPrevChain(Params().NetworkIDString()), nMockTime(0)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CChainParams& chainparams = Params();
+    ClearDatadirCache();
+    pathTemp = boost::filesystem::temp_directory_path() / strprintf("bench_dynamic_%lu_%i", (unsigned long)GetTime(), (int)(GetRand(100000)));
+    boost::filesystem::create_directories(pathTemp);
+    ForceSetArg("-datadir", pathTemp.string());
+    pblocktree = new CBlockTreeDB(1 << 20, true);
+    pcoinsdbview.reset(new CCoinsViewDB(1 << 23, true));
+    pcoinsTip = new CCoinsViewCache(pcoinsdbview.get());
+    InitBlockIndex(chainparams);
+    {
+        CValidationState state;
+        bool ok = ActivateBestChain(state, chainparams);
+        assert(ok);
+    }
+
+    connman.reset(new CNetSimConnman());
+    CConnman::Options connOptions;
+    connOptions.nLocalServices = NODE_NETWORK;
+    connOptions.nMaxConnections = DEFAULT_MAX_PEER_CONNECTIONS;
+    connOptions.nMaxOutbound = MAX_OUTBOUND_CONNECTIONS;
+    connOptions.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    connOptions.nReceiveFloodSize = 1000 * DEFAULT_MAXRECEIVEBUFFER;
+    connman->Init(connOptions);
+    RegisterNodeSignals(GetNodeSignals());
+    peerLogic.reset(new PeerLogicValidation(connman.get()));
+    RegisterValidationInterface(peerLogic.get());
+
+    // The first block pays the premine, which funds all transactions and the dynodes' collateral once it matured
+    key.MakeNewKey(true);
+    scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+    CTransactionRef coinbase = Mine(std::vector<CTransactionRef>())->vtx[0];
+    while (chainActive.Height() < std::max(COINBASE_MATURITY, nNetSimHeight))
+        Mine(std::vector<CTransactionRef>());
+
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = COutPoint(coinbase->GetHash(), 0);
+    tx.vout.assign(NETSIM_BLOCK_TXS, CTxOut(NETSIM_COIN_VALUE, scriptPubKey));
+    const CAmount nReserve = coinbase->vout[0].nValue - NETSIM_BLOCK_TXS * NETSIM_COIN_VALUE - NETSIM_TX_FEE;
+    tx.vout.emplace_back(nReserve, scriptPubKey);
+    Sign(tx);
+    const uint256 hash = tx.GetHash();
+    Mine(std::vector<CTransactionRef>(1, MakeTransactionRef(std::move(tx))));
+    for (size_t i = 0; i < NETSIM_BLOCK_TXS; i++)
+        vCoins.emplace_back(COutPoint(hash, i), NETSIM_COIN_VALUE);
+    coinReserve = std::make_pair(COutPoint(hash, NETSIM_BLOCK_TXS), nReserve);
+}
+
+NetSimSetup::~NetSimSetup()
+{
+    nNetSimHeight = std::max(nNetSimHeight, chainActive.Height());
+    dnodeman.Clear();
+    instantsend.Clear();
+    dynodeSync.Reset();
+    SetMockTime(0);
+    UnregisterValidationInterface(peerLogic.get());
+    UnregisterNodeSignals(GetNodeSignals());
+    peerLogic.reset();
+    connman.reset();
+    UnloadBlockIndex();
+    delete pcoinsTip;
+    pcoinsTip = NULL;
+    pcoinsdbview.reset();
+    delete pblocktree;
+    pblocktree = NULL;
+    boost::filesystem::remove_all(pathTemp);
+    ClearDatadirCache();
+    SelectParams(strPrevChain);
+}
+
+void NetSimSetup::Sign(CMutableTransaction& tx) const
+{
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, tx, 0, SIGHASH_ALL);
+    bool ok = key.Sign(hash, vchSig);
+    assert(ok);
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    tx.vin[0].scriptSig = CScript() << vchSig;
+}
+
+std::vector<CTransactionRef> NetSimSetup::Spend(size_t nTxs)
+{
+    std::vector<CTransactionRef> vtx;
+    for (size_t i = 0; i < nTxs; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = vCoins[i].first;
+        tx.vout.assign(1, CTxOut(vCoins[i].second - NETSIM_TX_FEE, scriptPubKey));
+        Sign(tx);
+        vtx.push_back(MakeTransactionRef(std::move(tx)));
+        vCoins[i] = std::make_pair(COutPoint(vtx.back()->GetHash(), 0), vtx.back()->vout[0].nValue);
+    }
+    return vtx;
+}
+
+std::shared_ptr<const CBlock> NetSimSetup::CreateBlock(const std::vector<CTransactionRef>& vtx) const
+{
+    const CChainParams& chainparams = Params();
+    std::unique_ptr<CBlockTemplate> pblocktemplate = CreateNewBlock(chainparams, scriptPubKey);
+    CBlock& block = pblocktemplate->block;
+
+    // Replace mempool-selected txns with just coinbase plus passed-in txns
+    block.vtx.resize(1);
+    block.vtx.insert(block.vtx.end(), vtx.begin(), vtx.end());
+    // IncrementExtraNonce creates a valid coinbase and merkleRoot
+    unsigned int nExtraNonce = 0;
+    IncrementExtraNonce(block, chainActive.Tip(), nExtraNonce);
+
+    while (!CheckProofOfWork(block.GetHash(), block.nBits, chainparams.GetConsensus()))
+        ++block.nNonce;
+    return std::make_shared<const CBlock>(block);
+}
+
+std::shared_ptr<const CBlock> NetSimSetup::Mine(const std::vector<CTransactionRef>& vtx) const
+{
+    std::shared_ptr<const CBlock> pblock = CreateBlock(vtx);
+    ProcessNewBlock(Params(), pblock, true, NULL);
+    assert(chainActive.Tip()->GetBlockHash() == pblock->GetHash());
+    return pblock;
+}
+
+void NetSimSetup::RegisterDynodes(size_t nDynodes)
+{
+    keyCollateral.MakeNewKey(true);
+    const CPubKey pubKeyCollateral = keyCollateral.GetPubKey();
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = coinReserve.first;
+    tx.vout.assign(nDynodes, CTxOut(1000 * COIN, GetScriptForDestination(pubKeyCollateral.GetID())));
+    const CAmount nReserve = coinReserve.second - nDynodes * 1000 * COIN - NETSIM_TX_FEE;
+    tx.vout.emplace_back(nReserve, scriptPubKey);
+    Sign(tx);
+    const uint256 hash = tx.GetHash();
+    Mine(std::vector<CTransactionRef>(1, MakeTransactionRef(std::move(tx))));
+    coinReserve = std::make_pair(COutPoint(hash, nDynodes), nReserve);
+
+    // broadcasts must not be signed before the block confirming the collateral
+    nMockTime = std::max(GetTime(), chainActive.Tip()->GetBlockTime());
+    SetMockTime(nMockTime);
+    for (size_t i = 0; i < nDynodes; i++) {
+        NetSimDynode dn;
+        dn.outpoint = COutPoint(hash, i);
+        dn.addr = LookupNumeric(strprintf("10.1.%d.%d", i / 256, i % 256).c_str(), Params().GetDefaultPort());
+        dn.key.MakeNewKey(true);
+        dn.pubKey = dn.key.GetPubKey();
+        int nDos = 0;
+        bool ok = dnodeman.CheckDnbAndUpdateDynodeList(NULL, CreateBroadcast(dn), nDos, *connman);
+        assert(ok && dnodeman.Has(dn.outpoint));
+        vDynodes.push_back(dn);
+    }
+
+    dynodeSync.Reset();
+    while (!dynodeSync.IsSynced())
+        dynodeSync.SwitchToNextAsset(*connman);
+}
+
+CDynodePing NetSimSetup::CreatePing(const NetSimDynode& dn) const
+{
+    CDynodePing dnp(dn.outpoint);
+    bool ok = dnp.Sign(dn.key, dn.pubKey);
+    assert(ok);
+    return dnp;
+}
+
+CDynodeBroadcast NetSimSetup::CreateBroadcast(const NetSimDynode& dn) const
+{
+    CDynodeBroadcast dnb(dn.addr, dn.outpoint, keyCollateral.GetPubKey(), dn.pubKey, PROTOCOL_VERSION);
+    dnb.lastPing = CreatePing(dn);
+    bool ok = dnb.Sign(keyCollateral);
+    assert(ok);
+    return dnb;
+}
+
+void NetSimSetup::AdvanceTime(int64_t nSeconds)
+{
+    assert(nMockTime != 0);
+    nMockTime += nSeconds;
+    SetMockTime(nMockTime);
+}
+
+/** One direction of a connection, messages go out one after another at the link's bandwidth */
+struct NetSimLink {
+    int64_t nBusyUntil = 0;
+    bool fFlushScheduled = false;
+};
+
+struct NetSimPeer {
+    std::unique_ptr<CNetSimNode> pnode;
+    NetSimLink linkToNode;
+    NetSimLink linkFromNode;
+    bool fVersionSent = false;
+    bool fConnected = false;
+};
+
+/**
+ * Event loop running the node and its peers on a simulated clock.
+ *
+ * The node's processing takes as long on the simulated clock as it took
+ * for real. Its inventory trickle timers are drawn by SendMessages from
+ * the real clock, so the loop takes each timer over once drawn and fires
+ * it at the simulated time it was drawn for.
+ */
+class CNetSim
+{
+public:
+    typedef std::function<void(size_t nPeer, const std::string& strCommand, CDataStream& vRecv)> ReceiveFunction;
+
+    const NetSimProfile profile;
+    uint64_t nMessages;
+    uint64_t nBytes;
+
+private:
+    struct Event {
+        int64_t nTime;
+        uint64_t nSeq;
+        bool fTimer; //!< doesn't keep the loop running
+        std::function<void()> fn;
+
+        bool operator>(const Event& other) const
+        {
+            return std::tie(nTime, nSeq) > std::tie(other.nTime, other.nSeq);
+        }
+    };
+
+    CNetSimConnman& connman;
+    std::vector<NetSimPeer> vPeers;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > queueEvents;
+    std::function<void(size_t)> fnConnected;
+    ReceiveFunction fnReceive;
+    FastRandomContext rand;
+    std::atomic<bool> flagInterruptMsgProc;
+    int64_t nNow;
+    int64_t nRoundStart;
+    int64_t nNodeBusyUntil;
+    uint64_t nSeq;
+    uint64_t nWorkEvents;
+    bool fNodeWorkScheduled;
+    bool fNodeTimerScheduled;
+
+    void Schedule(int64_t nTime, std::function<void()> fn, bool fTimer = false)
+    {
+        if (!fTimer)
+            nWorkEvents++;
+        queueEvents.push(Event{std::max(nTime, nNow), nSeq++, fTimer, std::move(fn)});
+    }
+
+    /** Send data over a link, each message arrives once its last byte did */
+    void Transmit(NetSimLink& link, const std::vector<unsigned char>& vchData, int64_t nTime, std::function<void(std::list<CNetMessage>&)> fnDeliver)
+    {
+        const int64_t nStart = std::max(link.nBusyUntil, nTime);
+        const char* pch = (const char*)vchData.data();
+        unsigned int nLeft = vchData.size();
+        // CNetMessage can't be copied, the message is handed over in a list of its own
+        std::shared_ptr<std::list<CNetMessage> > msgs;
+        while (nLeft > 0) {
+            if (!msgs) {
+                msgs = std::make_shared<std::list<CNetMessage> >();
+                msgs->emplace_back(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
+            }
+            CNetMessage& msg = msgs->front();
+            int handled = msg.in_data ? msg.readData(pch, nLeft) : msg.readHeader(pch, nLeft);
+            assert(handled > 0);
+            pch += handled;
+            nLeft -= handled;
+            if (msg.complete()) {
+                const uint64_t nSent = vchData.size() - nLeft;
+                Schedule(nStart + nSent * 1000000 / profile.nBandwidth + profile.nLatency, [fnDeliver, msgs]() { fnDeliver(*msgs); });
+                msgs.reset();
+                nMessages++;
+            }
+        }
+        assert(!msgs);
+        nBytes += vchData.size();
+        link.nBusyUntil = nStart + vchData.size() * 1000000 / profile.nBandwidth;
+    }
+
+    /** Like the socket handler, hand a complete message to the node's message handler */
+    void ReceiveNode(size_t nPeer, std::list<CNetMessage>& msgs)
+    {
+        CNode* pnode = vPeers[nPeer].pnode.get();
+        msgs.front().nTime = GetTimeMicros();
+        {
+            LOCK(pnode->cs_vProcessMsg);
+            pnode->nProcessQueueSize += msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+            pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), msgs);
+            pnode->fPauseRecv = pnode->nProcessQueueSize > connman.GetReceiveFloodSize();
+        }
+        ScheduleNode(false);
+    }
+
+    void ReceivePeer(size_t nPeer, std::list<CNetMessage>& msgs)
+    {
+        NetSimPeer& peer = vPeers[nPeer];
+        CNetMessage& msg = msgs.front();
+        const std::string strCommand = msg.hdr.GetCommand();
+        msg.vRecv.SetVersion(PROTOCOL_VERSION);
+        if (strCommand == NetMsgType::VERSION) {
+            if (!peer.fVersionSent)
+                SendVersion(nPeer);
+            Send(nPeer, CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::VERACK));
+        } else if (strCommand == NetMsgType::VERACK) {
+            peer.fConnected = true;
+            if (fnConnected)
+                fnConnected(nPeer);
+        } else if (strCommand == NetMsgType::PING) {
+            uint64_t nonce = 0;
+            msg.vRecv >> nonce;
+            Send(nPeer, CNetMsgMaker(PROTOCOL_VERSION).Make(NetMsgType::PONG, nonce));
+        } else if (fnReceive) {
+            fnReceive(nPeer, strCommand, msg.vRecv);
+        }
+    }
+
+    void SendVersion(size_t nPeer)
+    {
+        vPeers[nPeer].fVersionSent = true;
+        const CAddress addrNode(CService(), NODE_NONE);
+        const CAddress addrMe(CService(), NODE_NETWORK);
+        Send(nPeer, CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::VERSION, PROTOCOL_VERSION, (uint64_t)NODE_NETWORK, GetTime(), addrNode, addrMe, rand.rand64(), std::string("/netsim/"), chainActive.Height(), true));
+    }
+
+    void ScheduleNode(bool fTimer)
+    {
+        bool& fScheduled = fTimer ? fNodeTimerScheduled : fNodeWorkScheduled;
+        if (fScheduled)
+            return;
+        fScheduled = true;
+        Schedule(std::max(nNow, nNodeBusyUntil), [this, &fScheduled]() {
+            fScheduled = false;
+            RunNode();
+        }, fTimer);
+    }
+
+    bool NodeHasWork()
+    {
+        for (const NetSimPeer& peer : vPeers) {
+            LOCK(peer.pnode->cs_vProcessMsg);
+            if (!peer.pnode->vProcessMsg.empty() || !peer.pnode->vRecvGetData.empty())
+                return true;
+        }
+        return false;
+    }
+
+    /** One pass of the message handler thread over all peers, as long as it has work */
+    void RunNode()
+    {
+        const int64_t nStart = GetTimeMicros();
+        bool fMoreWork;
+        do {
+            fMoreWork = false;
+            for (NetSimPeer& peer : vPeers) {
+                CNode* pnode = peer.pnode.get();
+                fMoreWork |= ProcessMessages(pnode, connman, flagInterruptMsgProc) && !pnode->fPauseSend;
+                LOCK(pnode->cs_sendProcessing);
+                SendMessages(pnode, connman, flagInterruptMsgProc);
+            }
+        } while (fMoreWork);
+        const int64_t nEnd = GetTimeMicros();
+        nNodeBusyUntil = nNow + nEnd - nStart;
+
+        for (size_t i = 0; i < vPeers.size(); i++) {
+            CNetSimNode* pnode = vPeers[i].pnode.get();
+            FlushNode(i, nNodeBusyUntil);
+            // 0 until SendMessages drew the timer, the maximum once we took it over
+            if (pnode->nNextInvSend != 0 && pnode->nNextInvSend != std::numeric_limits<int64_t>::max()) {
+                const int64_t nDelay = std::max(pnode->nNextInvSend - nEnd, (int64_t)0);
+                pnode->nNextInvSend = std::numeric_limits<int64_t>::max();
+                Schedule(nNodeBusyUntil + nDelay, [this, pnode]() {
+                    pnode->nNextInvSend = 0;
+                    ScheduleNode(true);
+                }, true);
+            }
+        }
+    }
+
+    /** Write what the node queued for a peer once the link is free, so the send priorities apply */
+    void FlushNode(size_t nPeer, int64_t nTime)
+    {
+        NetSimLink& link = vPeers[nPeer].linkFromNode;
+        if (link.nBusyUntil > nTime) {
+            if (!link.fFlushScheduled) {
+                link.fFlushScheduled = true;
+                Schedule(link.nBusyUntil, [this, nPeer, &link]() {
+                    link.fFlushScheduled = false;
+                    FlushNode(nPeer, nNow);
+                });
+            }
+            return;
+        }
+        std::vector<unsigned char> vchData = vPeers[nPeer].pnode->TakeSendData();
+        if (!vchData.empty())
+            Transmit(link, vchData, nTime, [this, nPeer](std::list<CNetMessage>& msgs) { ReceivePeer(nPeer, msgs); });
+        // a full send buffer paused the node
+        if (NodeHasWork())
+            ScheduleNode(false);
+    }
+
+public:
+    CNetSim(const NetSimProfile& profileIn, CNetSimConnman& connmanIn) : profile(profileIn), nMessages(0), nBytes(0), connman(connmanIn), vPeers(NETSIM_PEERS), rand(true), flagInterruptMsgProc(false), nNow(0), nRoundStart(0), nNodeBusyUntil(0), nSeq(0), nWorkEvents(0), fNodeWorkScheduled(false), fNodeTimerScheduled(false) {}
+
+    ~CNetSim()
+    {
+        connman.RemoveNodes();
+    }
+
+    int64_t Elapsed() const { return nNow - nRoundStart; }
+
+    /** Connect the peers to the node and let them finish the handshake, fnConnectedIn sends what a peer tells the node afterwards */
+    void Connect(const std::function<void(size_t nPeer)>& fnConnectedIn)
+    {
+        fnConnected = fnConnectedIn;
+        for (size_t i = 0; i < vPeers.size(); i++) {
+            const bool fInbound = i >= NETSIM_OUTBOUND_PEERS;
+            const CAddress addr(LookupNumeric(strprintf("10.0.%d.1", i + 1).c_str(), Params().GetDefaultPort()), NODE_NETWORK);
+            vPeers[i].pnode.reset(new CNetSimNode(i, addr, chainActive.Height(), fInbound));
+            GetNodeSignals().InitializeNode(vPeers[i].pnode.get(), connman);
+            connman.AddNode(vPeers[i].pnode.get());
+            if (fInbound)
+                SendVersion(i);
+            else
+                FlushNode(i, nNow);
+        }
+        Run(nullptr);
+        fnConnected = nullptr;
+        for (const NetSimPeer& peer : vPeers)
+            assert(peer.fConnected && peer.pnode->fSuccessfullyConnected);
+    }
+
+    /** Start measuring from now */
+    void BeginRound()
+    {
+        nRoundStart = nNow;
+        nMessages = 0;
+        nBytes = 0;
+    }
+
+    /** Let the node send what it queued outside the loop */
+    void Wake()
+    {
+        ScheduleNode(false);
+    }
+
+    /** Frame a message like CConnman::PushMessage and send it from a peer to the node */
+    void Send(size_t nPeer, CSerializedNetMsg&& msg)
+    {
+        size_t nMessageSize = msg.data.size();
+        std::vector<unsigned char> vchFrame;
+        vchFrame.reserve(CMessageHeader::HEADER_SIZE + nMessageSize);
+        uint256 hash = Hash(msg.data.data(), msg.data.data() + nMessageSize);
+        CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), nMessageSize);
+        memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+        CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, vchFrame, 0, hdr};
+        vchFrame.insert(vchFrame.end(), msg.data.begin(), msg.data.end());
+        Transmit(vPeers[nPeer].linkToNode, vchFrame, nNow, [this, nPeer](std::list<CNetMessage>& msgs) { ReceiveNode(nPeer, msgs); });
+    }
+
+    /** Run until nothing but the node's timers is left, fnReceiveIn gets what the node sends the peers */
+    void Run(const ReceiveFunction& fnReceiveIn)
+    {
+        fnReceive = fnReceiveIn;
+        while (nWorkEvents > 0) {
+            Event event = queueEvents.top();
+            queueEvents.pop();
+            if (!event.fTimer)
+                nWorkEvents--;
+            nNow = event.nTime;
+            event.fn();
+        }
+        fnReceive = nullptr;
+        // the peers speak the protocol, the node has no reason to drop them
+        for (const NetSimPeer& peer : vPeers)
+            assert(!peer.pnode->fDisconnect);
+    }
+};
+
+/** Propagation times and traffic gathered over all runs of a benchmark */
+struct NetSimResults {
+    std::vector<int64_t> vTimes;
+    uint64_t nMessages = 0;
+    uint64_t nBytes = 0;
+    uint64_t nRuns = 0;
+
+    void Add(const CNetSim& net)
+    {
+        nMessages += net.nMessages;
+        nBytes += net.nBytes;
+        nRuns++;
+    }
+
+    void Report(const std::string& strName, const NetSimProfile& profile)
+    {
+        if (vTimes.empty() || nRuns == 0)
+            return;
+        std::sort(vTimes.begin(), vTimes.end());
+        std::cout << strName << "_" << profile.name << "-ms,"
+                  << vTimes[vTimes.size() / 2] / 1000.0 << ","
+                  << vTimes[vTimes.size() * 9 / 10] / 1000.0 << ","
+                  << vTimes.back() / 1000.0 << ","
+                  << nMessages / nRuns << "," << nBytes / nRuns << "\n";
+    }
+};
+
+/**
+ * Block relay through the node. Peer 0 finds a block of NETSIM_BLOCK_TXS
+ * transactions the node mostly has in its mempool. With full blocks the
+ * peers ask for headers announcements and fetch the block with getdata;
+ * with compact blocks they ask for high bandwidth mode and complete the
+ * block with getblocktxn.
+ */
+static void NetSimBlockRelay(benchmark::State& state, const NetSimProfile& profile, bool fCompact)
+{
+    NetSimSetup setup;
+    CNetSim sim(profile, *setup.connman);
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    sim.Connect([&](size_t nPeer) {
+        if (fCompact)
+            sim.Send(nPeer, msgMaker.Make(NetMsgType::SENDCMPCT, true, (uint64_t)1));
+        else
+            sim.Send(nPeer, msgMaker.Make(NetMsgType::SENDHEADERS));
+        // the peer is at the node's tip, so new blocks can be announced to it right away
+        sim.Send(nPeer, msgMaker.Make(NetMsgType::HEADERS, std::vector<CBlock>(1, CBlock(chainActive.Tip()->GetBlockHeader()))));
+    });
+    FastRandomContext rand(true);
+    NetSimResults results;
+
+    while (state.KeepRunning()) {
+        std::vector<CTransactionRef> vtx = setup.Spend(NETSIM_BLOCK_TXS);
+        {
+            LOCK(cs_main);
+            for (const CTransactionRef& tx : vtx) {
+                if ((int)rand.randrange(100) < NETSIM_MEMPOOL_MISSING_PERCENT)
+                    continue;
+                CValidationState validationState;
+                bool ok = AcceptToMemoryPool(mempool, validationState, tx, false, NULL);
+                assert(ok);
+            }
+        }
+        std::shared_ptr<const CBlock> pblock = setup.CreateBlock(vtx);
+        // the header hash is known up front, computing it is proof of work, not relay
+        const uint256 hashBlock = pblock->GetHash();
+        std::vector<bool> vHave(NETSIM_PEERS, false);
+        std::vector<bool> vRequested(NETSIM_PEERS, false);
+        vHave[0] = true;
+        auto fnHave = [&](size_t nPeer) {
+            vHave[nPeer] = true;
+            results.vTimes.push_back(sim.Elapsed());
+        };
+
+        sim.BeginRound();
+        if (fCompact)
+            sim.Send(0, msgMaker.Make(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(*pblock)));
+        else
+            sim.Send(0, msgMaker.Make(NetMsgType::HEADERS, std::vector<CBlock>(1, CBlock(pblock->GetBlockHeader()))));
+        sim.Run([&](size_t nPeer, const std::string& strCommand, CDataStream& vRecv) {
+            if (strCommand == NetMsgType::GETDATA) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                for (const CInv& inv : vInv) {
+                    if (inv.hash != hashBlock || !vHave[nPeer])
+                        continue;
+                    if (inv.type == MSG_CMPCT_BLOCK)
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs(*pblock)));
+                    else if (inv.type == MSG_BLOCK)
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+                }
+            } else if (strCommand == NetMsgType::GETBLOCKTXN) {
+                BlockTransactionsRequest req;
+                vRecv >> req;
+                BlockTransactions resp(req);
+                for (size_t i = 0; i < req.indexes.size(); i++)
+                    resp.txn[i] = pblock->vtx[req.indexes[i]];
+                sim.Send(nPeer, msgMaker.Make(NetMsgType::BLOCKTXN, resp));
+            } else if (vHave[nPeer]) {
+                return;
+            } else if (strCommand == NetMsgType::HEADERS || strCommand == NetMsgType::INV) {
+                bool fAnnounced = false;
+                if (strCommand == NetMsgType::HEADERS) {
+                    std::vector<CBlock> vHeaders;
+                    vRecv >> vHeaders;
+                    for (const CBlock& header : vHeaders)
+                        fAnnounced |= header.hashMerkleRoot == pblock->hashMerkleRoot;
+                } else {
+                    std::vector<CInv> vInv;
+                    vRecv >> vInv;
+                    for (const CInv& inv : vInv)
+                        fAnnounced |= inv.hash == hashBlock;
+                }
+                if (fAnnounced && !vRequested[nPeer]) {
+                    vRequested[nPeer] = true;
+                    sim.Send(nPeer, msgMaker.Make(NetMsgType::GETDATA, std::vector<CInv>(1, CInv(MSG_BLOCK, hashBlock))));
+                }
+            } else if (strCommand == NetMsgType::CMPCTBLOCK) {
+                CBlockHeaderAndShortTxIDs cmpctblock;
+                vRecv >> cmpctblock;
+                if (cmpctblock.header.hashMerkleRoot != pblock->hashMerkleRoot || vRequested[nPeer])
+                    return;
+                BlockTransactionsRequest req;
+                req.blockhash = hashBlock;
+                for (size_t i = 1; i < cmpctblock.BlockTxCount(); i++) {
+                    if ((int)rand.randrange(100) < NETSIM_MEMPOOL_MISSING_PERCENT)
+                        req.indexes.push_back(i);
+                }
+                if (req.indexes.empty()) {
+                    fnHave(nPeer);
+                } else {
+                    vRequested[nPeer] = true;
+                    sim.Send(nPeer, msgMaker.Make(NetMsgType::GETBLOCKTXN, req));
+                }
+            } else if (strCommand == NetMsgType::BLOCK || strCommand == NetMsgType::BLOCKTXN) {
+                fnHave(nPeer);
+            }
+        });
+        results.Add(sim);
+        LOCK(cs_main);
+        assert(chainActive.Tip()->GetBlockHash() == hashBlock);
+    }
+
+    results.Report(fCompact ? "NetSim_BlockRelayCompact" : "NetSim_BlockRelayFull", profile);
+}
+
+/**
+ * Transactions entering the network at random peers at once. The node
+ * fetches and accepts them and trickles them on to the other peers, which
+ * fetch them in turn. Also reports inv entries per peer and transaction.
+ */
+static void NetSimTxRelay(benchmark::State& state, const NetSimProfile& profile)
+{
+    NetSimSetup setup;
+    CNetSim sim(profile, *setup.connman);
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    sim.Connect(nullptr);
+    FastRandomContext rand(true);
+    NetSimResults results;
+    uint64_t nInvsReceived = 0;
+
+    while (state.KeepRunning()) {
+        std::vector<CTransactionRef> vtx = setup.Spend(NETSIM_RELAY_TXS);
+        std::map<uint256, CTransactionRef> mapTx;
+        std::vector<std::set<uint256> > vHave(NETSIM_PEERS);
+        std::vector<std::set<uint256> > vRequested(NETSIM_PEERS);
+
+        sim.BeginRound();
+        for (const CTransactionRef& tx : vtx) {
+            const uint256& hash = tx->GetHash();
+            const size_t nOrigin = rand.randrange(NETSIM_PEERS);
+            mapTx.emplace(hash, tx);
+            vHave[nOrigin].insert(hash);
+            sim.Send(nOrigin, msgMaker.Make(NetMsgType::INV, std::vector<CInv>(1, CInv(MSG_TX, hash))));
+        }
+        sim.Run([&](size_t nPeer, const std::string& strCommand, CDataStream& vRecv) {
+            if (strCommand == NetMsgType::INV) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                std::vector<CInv> vGetData;
+                for (const CInv& inv : vInv) {
+                    if (inv.type != MSG_TX)
+                        continue;
+                    nInvsReceived++;
+                    if (!vHave[nPeer].count(inv.hash) && vRequested[nPeer].insert(inv.hash).second)
+                        vGetData.push_back(inv);
+                }
+                if (!vGetData.empty())
+                    sim.Send(nPeer, msgMaker.Make(NetMsgType::GETDATA, vGetData));
+            } else if (strCommand == NetMsgType::GETDATA) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                for (const CInv& inv : vInv) {
+                    if (inv.type == MSG_TX && vHave[nPeer].count(inv.hash))
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::TX, *mapTx.at(inv.hash)));
+                }
+            } else if (strCommand == NetMsgType::TX) {
+                CTransactionRef tx;
+                vRecv >> tx;
+                if (vHave[nPeer].insert(tx->GetHash()).second)
+                    results.vTimes.push_back(sim.Elapsed());
+            }
+        });
+        results.Add(sim);
+        assert(mempool.size() == vtx.size());
+
+        // confirm them so the next run spends confirmed coins again, the peers ignore the announcement
+        setup.Mine(vtx);
+        sim.Wake();
+        sim.Run(nullptr);
+    }
+
+    results.Report("NetSim_TxRelay", profile);
+    if (results.nRuns > 0)
+        std::cout << "NetSim_TxRelay_" << profile.name << "-fanout," << (double)nInvsReceived / results.nRuns / NETSIM_RELAY_TXS / NETSIM_PEERS << "\n";
+}
+
+/**
+ * InstantSend lock requests entering the network at random peers at once.
+ * The quorum dynodes of each request are spread over the peers and vote
+ * once their peer has the request; the node validates, counts and relays
+ * the votes. A peer has the lock with the request and SIGNATURES_REQUIRED
+ * votes.
+ */
+static void NetSimInstantSend(benchmark::State& state, const NetSimProfile& profile)
+{
+    NetSimSetup setup;
+    setup.RegisterDynodes(NETSIM_DYNODES);
+    CNetSim sim(profile, *setup.connman);
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    sim.Connect(nullptr);
+    FastRandomContext rand(true);
+    NetSimResults results;
+
+    // the dynodes are spread over the peers in turn
+    std::map<COutPoint, size_t> mapDynodeIndex;
+    for (size_t i = 0; i < setup.vDynodes.size(); i++)
+        mapDynodeIndex.emplace(setup.vDynodes[i].outpoint, i);
+    const int nConfirmationsRequired = Params().GetConsensus().nInstantSendConfirmationsRequired;
+    const int nMinProtocol = std::max(MIN_INSTANTSEND_PROTO_VERSION, dnpayments.GetMinDynodePaymentsProto());
+    // lock requests spend coins one less than nInstantSendConfirmationsRequired blocks deep
+    auto fnMine = [&](const std::vector<CTransactionRef>& vtx) {
+        for (int i = 0; i < nConfirmationsRequired - 1; i++) {
+            setup.AdvanceTime(Params().GetConsensus().nPowTargetSpacing);
+            setup.Mine(i == 0 ? vtx : std::vector<CTransactionRef>());
+        }
+        sim.Wake();
+        sim.Run(nullptr);
+    };
+    fnMine(std::vector<CTransactionRef>());
+
+    while (state.KeepRunning()) {
+        std::vector<CTransactionRef> vtx = setup.Spend(NETSIM_LOCK_REQUESTS);
+        std::map<uint256, CTxLockRequest> mapRequests;
+        std::map<uint256, CTxLockVote> mapVotes;
+        // votes of the dynodes behind each peer, by request
+        std::vector<std::map<uint256, std::vector<CInv> > > vPeerVotes(NETSIM_PEERS);
+        for (const CTransactionRef& tx : vtx) {
+            const uint256& txHash = tx->GetHash();
+            const COutPoint& outpoint = tx->vin[0].prevout;
+            mapRequests.emplace(txHash, CTxLockRequest(tx));
+            CDynodeMan::rank_pair_vec_t vecDynodeRanks;
+            bool ok = dnodeman.GetDynodeRanks(vecDynodeRanks, GetUTXOHeight(outpoint) + nConfirmationsRequired - 2, nMinProtocol);
+            assert(ok);
+            for (const auto& rankPair : vecDynodeRanks) {
+                if (rankPair.first > COutPointLock::SIGNATURES_TOTAL)
+                    continue;
+                const size_t nDynode = mapDynodeIndex.at(rankPair.second.outpoint);
+                const NetSimDynode& dn = setup.vDynodes[nDynode];
+                CTxLockVote vote(txHash, outpoint, dn.outpoint);
+                ok = vote.Sign(dn.key, dn.pubKey);
+                assert(ok);
+                const uint256 hashVote = vote.GetHash();
+                mapVotes.emplace(hashVote, vote);
+                vPeerVotes[nDynode % NETSIM_PEERS][txHash].push_back(CInv(MSG_TXLOCK_VOTE, hashVote));
+            }
+        }
+        std::vector<std::set<uint256> > vHave(NETSIM_PEERS);
+        std::vector<std::set<uint256> > vRequested(NETSIM_PEERS);
+        std::map<std::pair<size_t, uint256>, int> mapVoteCount;
+        std::set<std::pair<size_t, uint256> > setLocked;
+
+        auto fnCheckLock = [&](size_t nPeer, const uint256& txHash) {
+            const std::pair<size_t, uint256> key = std::make_pair(nPeer, txHash);
+            if (vHave[nPeer].count(txHash) && mapVoteCount[key] >= COutPointLock::SIGNATURES_REQUIRED && setLocked.insert(key).second)
+                results.vTimes.push_back(sim.Elapsed());
+        };
+        auto fnHaveVote = [&](size_t nPeer, const uint256& hashVote) {
+            if (!vHave[nPeer].insert(hashVote).second)
+                return;
+            const uint256 txHash = mapVotes.at(hashVote).GetTxHash();
+            mapVoteCount[std::make_pair(nPeer, txHash)]++;
+            fnCheckLock(nPeer, txHash);
+        };
+        // the peer's dynodes vote once it has the request, after it in the order the node gets them
+        auto fnHaveRequest = [&](size_t nPeer, const uint256& txHash) {
+            if (!vHave[nPeer].insert(txHash).second)
+                return;
+            fnCheckLock(nPeer, txHash);
+            const std::vector<CInv>& vInvVotes = vPeerVotes[nPeer][txHash];
+            for (const CInv& inv : vInvVotes)
+                fnHaveVote(nPeer, inv.hash);
+            if (!vInvVotes.empty())
+                sim.Send(nPeer, msgMaker.Make(NetMsgType::INV, vInvVotes));
+        };
+
+        sim.BeginRound();
+        for (const CTransactionRef& tx : vtx) {
+            const uint256& txHash = tx->GetHash();
+            const size_t nOrigin = rand.randrange(NETSIM_PEERS);
+            sim.Send(nOrigin, msgMaker.Make(NetMsgType::INV, std::vector<CInv>(1, CInv(MSG_TXLOCK_REQUEST, txHash))));
+            fnHaveRequest(nOrigin, txHash);
+        }
+        sim.Run([&](size_t nPeer, const std::string& strCommand, CDataStream& vRecv) {
+            if (strCommand == NetMsgType::INV) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                std::vector<CInv> vGetData;
+                for (const CInv& inv : vInv) {
+                    if (inv.type != MSG_TXLOCK_REQUEST && inv.type != MSG_TXLOCK_VOTE)
+                        continue;
+                    if (!vHave[nPeer].count(inv.hash) && vRequested[nPeer].insert(inv.hash).second)
+                        vGetData.push_back(inv);
+                }
+                if (!vGetData.empty())
+                    sim.Send(nPeer, msgMaker.Make(NetMsgType::GETDATA, vGetData));
+            } else if (strCommand == NetMsgType::GETDATA) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                for (const CInv& inv : vInv) {
+                    if (!vHave[nPeer].count(inv.hash))
+                        continue;
+                    if (inv.type == MSG_TXLOCK_REQUEST)
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::TXLOCKREQUEST, mapRequests.at(inv.hash)));
+                    else if (inv.type == MSG_TXLOCK_VOTE)
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::TXLOCKVOTE, mapVotes.at(inv.hash)));
+                }
+            } else if (strCommand == NetMsgType::TXLOCKREQUEST) {
+                CTxLockRequest txLockRequest;
+                vRecv >> txLockRequest;
+                fnHaveRequest(nPeer, txLockRequest.GetHash());
+            } else if (strCommand == NetMsgType::TXLOCKVOTE) {
+                CTxLockVote vote;
+                vRecv >> vote;
+                fnHaveVote(nPeer, vote.GetHash());
+            }
+        });
+        results.Add(sim);
+        assert(setLocked.size() == NETSIM_PEERS * vtx.size());
+        for (const CTransactionRef& tx : vtx)
+            assert(instantsend.IsLockedInstantSendTransaction(tx->GetHash()));
+
+        fnMine(vtx);
+    }
+
+    results.Report("NetSim_InstantSendLock", profile);
+}
+
+/**
+ * Dynode messages from all dynodes flooding the network at once, entering
+ * at random peers: pings, or broadcasts as when the dynodes restart. Each
+ * round is a ping interval after the last one, on a new block.
+ */
+static void NetSimDynodeMessages(benchmark::State& state, const NetSimProfile& profile, bool fBroadcasts)
+{
+    NetSimSetup setup;
+    setup.RegisterDynodes(NETSIM_DYNODES);
+    CNetSim sim(profile, *setup.connman);
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    sim.Connect(nullptr);
+    FastRandomContext rand(true);
+    NetSimResults results;
+    const int nInvType = fBroadcasts ? MSG_DYNODE_ANNOUNCE : MSG_DYNODE_PING;
+
+    while (state.KeepRunning()) {
+        setup.AdvanceTime(DYNODE_MIN_DNP_SECONDS);
+        setup.Mine(std::vector<CTransactionRef>());
+        sim.Wake();
+        sim.Run(nullptr);
+
+        std::map<uint256, CDynodePing> mapPings;
+        std::map<uint256, CDynodeBroadcast> mapBroadcasts;
+        std::vector<std::set<uint256> > vHave(NETSIM_PEERS);
+        std::vector<std::set<uint256> > vRequested(NETSIM_PEERS);
+        std::vector<std::vector<CInv> > vAnnounce(NETSIM_PEERS);
+        for (const NetSimDynode& dn : setup.vDynodes) {
+            uint256 hash;
+            if (fBroadcasts) {
+                CDynodeBroadcast dnb = setup.CreateBroadcast(dn);
+                hash = dnb.GetHash();
+                mapBroadcasts.emplace(hash, dnb);
+            } else {
+                CDynodePing dnp = setup.CreatePing(dn);
+                hash = dnp.GetHash();
+                mapPings.emplace(hash, dnp);
+            }
+            const size_t nOrigin = rand.randrange(NETSIM_PEERS);
+            vHave[nOrigin].insert(hash);
+            vAnnounce[nOrigin].push_back(CInv(nInvType, hash));
+        }
+
+        sim.BeginRound();
+        for (size_t i = 0; i < NETSIM_PEERS; i++) {
+            if (!vAnnounce[i].empty())
+                sim.Send(i, msgMaker.Make(NetMsgType::INV, vAnnounce[i]));
+        }
+        sim.Run([&](size_t nPeer, const std::string& strCommand, CDataStream& vRecv) {
+            if (strCommand == NetMsgType::INV) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                std::vector<CInv> vGetData;
+                for (const CInv& inv : vInv) {
+                    if (inv.type == nInvType && !vHave[nPeer].count(inv.hash) && vRequested[nPeer].insert(inv.hash).second)
+                        vGetData.push_back(inv);
+                }
+                if (!vGetData.empty())
+                    sim.Send(nPeer, msgMaker.Make(NetMsgType::GETDATA, vGetData));
+            } else if (strCommand == NetMsgType::GETDATA) {
+                std::vector<CInv> vInv;
+                vRecv >> vInv;
+                for (const CInv& inv : vInv) {
+                    if (inv.type != nInvType || !vHave[nPeer].count(inv.hash))
+                        continue;
+                    if (fBroadcasts)
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::DNANNOUNCE, mapBroadcasts.at(inv.hash)));
+                    else
+                        sim.Send(nPeer, msgMaker.Make(NetMsgType::DNPING, mapPings.at(inv.hash)));
+                }
+            } else if (strCommand == NetMsgType::DNANNOUNCE || strCommand == NetMsgType::DNPING) {
+                uint256 hash;
+                if (strCommand == NetMsgType::DNANNOUNCE) {
+                    CDynodeBroadcast dnb;
+                    vRecv >> dnb;
+                    hash = dnb.GetHash();
+                } else {
+                    CDynodePing dnp;
+                    vRecv >> dnp;
+                    hash = dnp.GetHash();
+                }
+                if (vHave[nPeer].insert(hash).second)
+                    results.vTimes.push_back(sim.Elapsed());
+            }
+        });
+        results.Add(sim);
+        // the node only relays what it accepted
+        for (const std::set<uint256>& setHave : vHave)
+            assert(setHave.size() == setup.vDynodes.size());
+    }
+
+    results.Report(fBroadcasts ? "NetSim_DynodeBroadcasts" : "NetSim_DynodePings", profile);
+}
+
+static void NetSim_BlockRelayFull_LAN(benchmark::State& state) { NetSimBlockRelay(state, NETSIM_LAN, false); }
+static void NetSim_BlockRelayFull_WAN(benchmark::State& state) { NetSimBlockRelay(state, NETSIM_WAN, false); }
+static void NetSim_BlockRelayCompact_LAN(benchmark::State& state) { NetSimBlockRelay(state, NETSIM_LAN, true); }
+static void NetSim_BlockRelayCompact_WAN(benchmark::State& state) { NetSimBlockRelay(state, NETSIM_WAN, true); }
+static void NetSim_TxRelay_LAN(benchmark::State& state) { NetSimTxRelay(state, NETSIM_LAN); }
+static void NetSim_TxRelay_WAN(benchmark::State& state) { NetSimTxRelay(state, NETSIM_WAN); }
+static void NetSim_InstantSendLock_LAN(benchmark::State& state) { NetSimInstantSend(state, NETSIM_LAN); }
+static void NetSim_InstantSendLock_WAN(benchmark::State& state) { NetSimInstantSend(state, NETSIM_WAN); }
+static void NetSim_DynodePings_LAN(benchmark::State& state) { NetSimDynodeMessages(state, NETSIM_LAN, false); }
+static void NetSim_DynodePings_WAN(benchmark::State& state) { NetSimDynodeMessages(state, NETSIM_WAN, false); }
+static void NetSim_DynodeBroadcasts_LAN(benchmark::State& state) { NetSimDynodeMessages(state, NETSIM_LAN, true); }
+static void NetSim_DynodeBroadcasts_WAN(benchmark::State& state) { NetSimDynodeMessages(state, NETSIM_WAN, true); }
+
+BENCHMARK(NetSim_BlockRelayFull_LAN);
+BENCHMARK(NetSim_BlockRelayFull_WAN);
+BENCHMARK(NetSim_BlockRelayCompact_LAN);
+BENCHMARK(NetSim_BlockRelayCompact_WAN);
+BENCHMARK(NetSim_TxRelay_LAN);
+BENCHMARK(NetSim_TxRelay_WAN);
+BENCHMARK(NetSim_InstantSendLock_LAN);
+BENCHMARK(NetSim_InstantSendLock_WAN);
+BENCHMARK(NetSim_DynodePings_LAN);
+BENCHMARK(NetSim_DynodePings_WAN);
+BENCHMARK(NetSim_DynodeBroadcasts_LAN);
+BENCHMARK(NetSim_DynodeBroadcasts_WAN);
@@ -50,7 +50,8 @@ uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256& txhash) const
 }
 
 
-ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef> >& extra_txn)
+ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef> >& extra_txn,
+    const std::vector<const CCompactBlockTxSource*>& sources)
 {
     if (cmpctblock.header.IsNull() || (cmpctblock.shorttxids.empty() && cmpctblock.prefilledtxn.empty()))
         return READ_STATUS_INVALID;
@@ -137,15 +138,21 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         }
     }
 
-    for (size_t i = 0; i < extra_txn.size(); i++) {
-        uint64_t shortid = cmpctblock.GetShortID(extra_txn[i].first);
+    // Counter of where each transaction was found, NULL for the mempool
+    std::vector<size_t*> txn_counter(txn_available.size(), NULL);
+    source_count.assign(sources.size(), 0);
+
+    // Returns false once nothing is missing anymore
+    auto fnAddTx = [&](const uint256& hash, const CTransactionRef& tx, size_t& count) {
+        uint64_t shortid = cmpctblock.GetShortID(hash);
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
-                txn_available[idit->second] = extra_txn[i].second;
+                txn_available[idit->second] = tx;
                 have_txn[idit->second] = true;
+                txn_counter[idit->second] = &count;
                 mempool_count++;
-                extra_count++;
+                count++;
             } else {
                 // If we find two mempool/extra txn that match the short id, just
                 // request it.
@@ -154,20 +161,32 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
                 // Note that we dont want duplication between extra_txn and mempool to
                 // trigger this case, so we compare hashes first
                 if (txn_available[idit->second] &&
-                    txn_available[idit->second]->GetHash() != extra_txn[i].second->GetHash()) {
+                    txn_available[idit->second]->GetHash() != tx->GetHash()) {
                     txn_available[idit->second].reset();
                     mempool_count--;
-                    extra_count--;
+                    if (txn_counter[idit->second])
+                        (*txn_counter[idit->second])--;
                 }
             }
         }
         // Though ideally we'd continue scanning for the two-txn-match-shortid case,
         // the performance win of an early exit here is too good to pass up and worth
         // the extra risk.
-        if (mempool_count == shorttxids.size())
+        return mempool_count != shorttxids.size();
+    };
+
+    for (size_t i = 0; i < extra_txn.size() && mempool_count != shorttxids.size(); i++) {
+        // the extra pool is a ring buffer that may not be full yet
+        if (!extra_txn[i].second)
+            continue;
+        if (!fnAddTx(extra_txn[i].first, extra_txn[i].second, extra_count))
             break;
     }
 
+    for (size_t i = 0; i < sources.size() && mempool_count != shorttxids.size(); i++) {
+        sources[i]->ForEachTx([&](const CTransactionRef& tx) { return fnAddTx(tx->GetHash(), tx, source_count[i]); });
+    }
+
     LogPrint("cmpctblock", "Initialized PartiallyDownloadedBlock for block %s using a cmpctblock of size %lu\n", cmpctblock.header.GetHash().ToString(), GetSerializeSize(cmpctblock, SER_NETWORK, PROTOCOL_VERSION));
 
     return READ_STATUS_OK;
@@ -215,7 +234,10 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
         return READ_STATUS_CHECKBLOCK_FAILED;
     }
 
-    LogPrint("cmpctblock", "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size());
+    size_t nFromSources = 0;
+    for (size_t count : source_count)
+        nFromSources += count;
+    LogPrint("cmpctblock", "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool, %lu from other sources) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, nFromSources, vtx_missing.size());
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing)
             LogPrint("cmpctblock", "Reconstructed block %s required tx %s\n", hash.ToString(), tx->GetHash().ToString());
@@ -7,10 +7,26 @@
 
 #include "primitives/block.h"
 
+#include <functional>
 #include <memory>
+#include <string>
 
 class CTxMemPool;
 
+/**
+ * A store of transactions outside the mempool that compact blocks can be
+ * reconstructed from, saving a GETBLOCKTXN round trip for each transaction
+ * it knows. Sources are consulted after the mempool and the extra pool.
+ */
+class CCompactBlockTxSource
+{
+public:
+    virtual ~CCompactBlockTxSource() {}
+    virtual std::string GetName() const = 0;
+    /** Call fn for every transaction of the source, stop when it returns false */
+    virtual void ForEachTx(const std::function<bool(const CTransactionRef&)>& fn) const = 0;
+};
+
 // Dumb helper to handle CTransaction compression at serialize-time
 struct TransactionCompressor {
 private:
@@ -205,6 +221,7 @@ class PartiallyDownloadedBlock
 protected:
     std::vector<CTransactionRef> txn_available;
     size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
+    std::vector<size_t> source_count; // per source passed to InitData, also included in mempool_count
     CTxMemPool* pool;
 
 public:
@@ -212,8 +229,16 @@ public:
     PartiallyDownloadedBlock(CTxMemPool* poolIn) : pool(poolIn) {}
 
     // extra_txn is a list of extra transactions to look at, in <hash, reference> form
-    ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef> >& extra_txn);
+    // sources are looked at last, for whatever transactions are still missing
+    ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef> >& extra_txn,
+        const std::vector<const CCompactBlockTxSource*>& sources = std::vector<const CCompactBlockTxSource*>());
     bool IsTxAvailable(size_t index) const;
+
+    size_t GetPrefilledCount() const { return prefilled_count; }
+    /** Transactions found locally, from the mempool, the extra pool and the sources */
+    size_t GetFoundCount() const { return mempool_count; }
+    size_t GetExtraCount() const { return extra_count; }
+    const std::vector<size_t>& GetSourceCounts() const { return source_count; }
     ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
 };
 
@@ -7,6 +7,7 @@
 
 #include "dbwrapper.h"
 
+#include "memusage.h"
 #include "random.h"
 #include "util.h"
 
@@ -198,6 +199,280 @@ void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
 void CDBIterator::SeekToLast() { piter->SeekToLast(); }
 void CDBIterator::Next() { piter->Next(); }
 
+namespace
+{
+/**
+ * Merges a snapshot of staged changes over a LevelDB iterator. Staged values
+ * shadow database values with the same key and staged erases hide them.
+ */
+class CStagedIterator : public leveldb::Iterator
+{
+private:
+    typedef CStagedDBWrapper::staged_map staged_map;
+
+    std::unique_ptr<leveldb::Iterator> base;
+    const staged_map staged;
+    //! current staged position; staged.end() when exhausted in either direction
+    staged_map::const_iterator it;
+    bool fForward;
+    bool fValid;
+    bool fCurrentStaged;
+
+    void StepBack()
+    {
+        if (it == staged.begin())
+            it = staged.end();
+        else
+            --it;
+    }
+
+    void FindForward()
+    {
+        while (true) {
+            bool fBase = base->Valid();
+            bool fStaged = it != staged.end();
+            if (!fBase && !fStaged) {
+                fValid = false;
+                return;
+            }
+            int cmp = !fBase ? 1 : (!fStaged ? -1 : base->key().compare(it->first));
+            if (cmp < 0) {
+                fValid = true;
+                fCurrentStaged = false;
+                return;
+            }
+            if (cmp == 0)
+                base->Next();
+            if (!it->second.first) {
+                fValid = true;
+                fCurrentStaged = true;
+                return;
+            }
+            ++it;
+        }
+    }
+
+    void FindBackward()
+    {
+        while (true) {
+            bool fBase = base->Valid();
+            bool fStaged = it != staged.end();
+            if (!fBase && !fStaged) {
+                fValid = false;
+                return;
+            }
+            int cmp = !fBase ? -1 : (!fStaged ? 1 : base->key().compare(it->first));
+            if (cmp > 0) {
+                fValid = true;
+                fCurrentStaged = false;
+                return;
+            }
+            if (cmp == 0)
+                base->Prev();
+            if (!it->second.first) {
+                fValid = true;
+                fCurrentStaged = true;
+                return;
+            }
+            StepBack();
+        }
+    }
+
+public:
+    CStagedIterator(leveldb::Iterator* baseIn, staged_map&& stagedIn)
+        : base(baseIn), staged(std::move(stagedIn)), it(staged.end()), fForward(true), fValid(false), fCurrentStaged(false) {}
+
+    bool Valid() const override { return fValid; }
+
+    void SeekToFirst() override
+    {
+        base->SeekToFirst();
+        it = staged.begin();
+        fForward = true;
+        FindForward();
+    }
+
+    void SeekToLast() override
+    {
+        base->SeekToLast();
+        it = staged.end();
+        StepBack();
+        fForward = false;
+        FindBackward();
+    }
+
+    void Seek(const leveldb::Slice& target) override
+    {
+        base->Seek(target);
+        it = staged.lower_bound(target.ToString());
+        fForward = true;
+        FindForward();
+    }
+
+    void Next() override
+    {
+        assert(fValid);
+        if (!fForward) {
+            // Reposition both sides just past the current key
+            std::string strKey = key().ToString();
+            base->Seek(strKey);
+            if (base->Valid() && base->key() == leveldb::Slice(strKey))
+                base->Next();
+            it = staged.upper_bound(strKey);
+            fForward = true;
+        } else if (fCurrentStaged) {
+            ++it;
+        } else {
+            base->Next();
+        }
+        FindForward();
+    }
+
+    void Prev() override
+    {
+        assert(fValid);
+        if (fForward) {
+            // Reposition both sides just before the current key
+            std::string strKey = key().ToString();
+            base->Seek(strKey);
+            if (base->Valid())
+                base->Prev();
+            else
+                base->SeekToLast();
+            it = staged.lower_bound(strKey);
+            StepBack();
+            fForward = false;
+        } else if (fCurrentStaged) {
+            StepBack();
+        } else {
+            base->Prev();
+        }
+        FindBackward();
+    }
+
+    leveldb::Slice key() const override
+    {
+        return fCurrentStaged ? leveldb::Slice(it->first) : base->key();
+    }
+
+    leveldb::Slice value() const override
+    {
+        return fCurrentStaged ? leveldb::Slice(it->second.second) : base->value();
+    }
+
+    leveldb::Status status() const override { return base->status(); }
+};
+} // namespace
+
+const std::pair<bool, std::string>* CStagedDBWrapper::FindStaged(const std::string& strKey) const
+{
+    AssertLockHeld(cs_staged);
+    staged_map::const_iterator it = mapBlockStaged.find(strKey);
+    if (it != mapBlockStaged.end())
+        return &it->second;
+    it = mapStaged.find(strKey);
+    if (it != mapStaged.end())
+        return &it->second;
+    return NULL;
+}
+
+void CStagedDBWrapper::Stage(const std::string& strKey, bool fErase, const std::string& strValue)
+{
+    LOCK(cs_staged);
+    staged_map& layer = fBlockScope ? mapBlockStaged : mapStaged;
+    std::pair<staged_map::iterator, bool> ret = layer.insert(std::make_pair(strKey, std::make_pair(fErase, strValue)));
+    if (ret.second) {
+        nStagedBytes += strKey.size() + strValue.size();
+    } else {
+        nStagedBytes -= ret.first->second.second.size();
+        nStagedBytes += strValue.size();
+        ret.first->second = std::make_pair(fErase, strValue);
+    }
+}
+
+CDBIterator* CStagedDBWrapper::NewIterator()
+{
+    staged_map snapshot;
+    {
+        LOCK(cs_staged);
+        if (mapStaged.empty() && mapBlockStaged.empty())
+            return CDBWrapper::NewIterator();
+        snapshot = mapStaged;
+        for (const auto& entry : mapBlockStaged)
+            snapshot[entry.first] = entry.second;
+    }
+    return new CDBIterator(*this, new CStagedIterator(pdb->NewIterator(iteroptions), std::move(snapshot)));
+}
+
+bool CStagedDBWrapper::IsEmpty()
+{
+    std::unique_ptr<CDBIterator> it(NewIterator());
+    it->SeekToFirst();
+    return !(it->Valid());
+}
+
+void CStagedDBWrapper::BeginBlockScope()
+{
+    LOCK(cs_staged);
+    assert(!fBlockScope && mapBlockStaged.empty());
+    fBlockScope = true;
+}
+
+void CStagedDBWrapper::EndBlockScope(bool fKeep)
+{
+    LOCK(cs_staged);
+    for (auto& entry : mapBlockStaged) {
+        nStagedBytes -= entry.first.size() + entry.second.second.size();
+        if (!fKeep)
+            continue;
+        std::pair<staged_map::iterator, bool> ret = mapStaged.insert(entry);
+        if (ret.second) {
+            nStagedBytes += entry.first.size() + entry.second.second.size();
+        } else {
+            nStagedBytes -= ret.first->second.second.size();
+            nStagedBytes += entry.second.second.size();
+            ret.first->second = std::move(entry.second);
+        }
+    }
+    mapBlockStaged.clear();
+    fBlockScope = false;
+}
+
+bool CStagedDBWrapper::CommitStaged(bool fSync)
+{
+    LOCK(cs_staged);
+    if (mapStaged.empty())
+        return true;
+
+    CDBBatch batch(*this);
+    for (const auto& entry : mapStaged) {
+        if (entry.second.first)
+            batch.EraseRaw(entry.first);
+        else
+            batch.WriteRaw(entry.first, entry.second.second);
+    }
+    LogPrint("dbwrapper", "%s -- committing %u staged changes (%u bytes)\n", __func__, mapStaged.size(), batch.SizeEstimate());
+    if (!WriteBatch(batch, fSync))
+        return false;
+
+    for (const auto& entry : mapStaged)
+        nStagedBytes -= entry.first.size() + entry.second.second.size();
+    mapStaged.clear();
+    return true;
+}
+
+bool CStagedDBWrapper::HasStaged() const
+{
+    LOCK(cs_staged);
+    return !mapStaged.empty() || !mapBlockStaged.empty();
+}
+
+size_t CStagedDBWrapper::DynamicMemoryUsage() const
+{
+    LOCK(cs_staged);
+    return memusage::DynamicUsage(mapStaged) + memusage::DynamicUsage(mapBlockStaged) + nStagedBytes;
+}
+
 namespace dbwrapper_private
 {
 void HandleError(const leveldb::Status& status)
@@ -11,6 +11,7 @@
 #include "clientversion.h"
 #include "serialize.h"
 #include "streams.h"
+#include "sync.h"
 #include "util.h"
 #include "utilstrencodings.h"
 #include "version.h"
@@ -51,6 +52,7 @@ const std::vector<unsigned char>& GetObfuscateKey(const CDBWrapper& w);
 class CDBBatch
 {
     friend class CDBWrapper;
+    friend class CStagedDBWrapper;
 
 private:
     const CDBWrapper& parent;
@@ -113,6 +115,20 @@ public:
     }
 
     size_t SizeEstimate() const { return size_estimate; }
+
+private:
+    //! Queue an already serialized (and obfuscated) key/value pair
+    void WriteRaw(const std::string& strKey, const std::string& strValue)
+    {
+        batch.Put(strKey, strValue);
+        size_estimate += 3 + (strKey.size() > 127) + strKey.size() + (strValue.size() > 127) + strValue.size();
+    }
+
+    void EraseRaw(const std::string& strKey)
+    {
+        batch.Delete(strKey);
+        size_estimate += 2 + (strKey.size() > 127) + strKey.size();
+    }
 };
 
 class CDBIterator
@@ -181,6 +197,7 @@ public:
 class CDBWrapper
 {
     friend const std::vector<unsigned char>& dbwrapper_private::GetObfuscateKey(const CDBWrapper& w);
+    friend class CStagedDBWrapper;
 
 private:
     //! custom environment this database is using (may be NULL in case of default environment)
@@ -371,4 +388,129 @@ public:
     }
 };
 
+/**
+ * A CDBWrapper whose writes and erases are held in memory until
+ * CommitStaged() is called, so that all changes reach LevelDB in one batch.
+ * Read, Exists and iterators see staged values before they are committed.
+ *
+ * While a block scope is open, changes go to a separate layer that
+ * EndBlockScope() either merges into the pending set or drops, so a block
+ * that fails validation leaves nothing behind.
+ */
+class CStagedDBWrapper : public CDBWrapper
+{
+public:
+    //! serialized key -> (erased, serialized value)
+    typedef std::map<std::string, std::pair<bool, std::string> > staged_map;
+
+private:
+    mutable CCriticalSection cs_staged;
+
+    //! changes waiting for CommitStaged()
+    staged_map mapStaged;
+
+    //! changes made inside the current block scope
+    staged_map mapBlockStaged;
+
+    bool fBlockScope;
+
+    //! bytes held by staged keys and values
+    size_t nStagedBytes;
+
+    template <typename K>
+    static std::string SerializeKey(const K& key)
+    {
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
+        ssKey << key;
+        return std::string(ssKey.begin(), ssKey.end());
+    }
+
+    //! Returns the newest staged change for strKey, or NULL if there is none
+    const std::pair<bool, std::string>* FindStaged(const std::string& strKey) const;
+
+    void Stage(const std::string& strKey, bool fErase, const std::string& strValue);
+
+public:
+    CStagedDBWrapper(const boost::filesystem::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false)
+        : CDBWrapper(path, nCacheSize, fMemory, fWipe, obfuscate), fBlockScope(false), nStagedBytes(0) {}
+
+    template <typename K, typename V>
+    bool Read(const K& key, V& value) const
+    {
+        {
+            LOCK(cs_staged);
+            const std::pair<bool, std::string>* pstaged = FindStaged(SerializeKey(key));
+            if (pstaged) {
+                if (pstaged->first)
+                    return false;
+                try {
+                    CDataStream ssValue(pstaged->second.data(), pstaged->second.data() + pstaged->second.size(), SER_DISK, CLIENT_VERSION);
+                    ssValue.Xor(obfuscate_key);
+                    ssValue >> value;
+                } catch (const std::exception&) {
+                    return false;
+                }
+                return true;
+            }
+        }
+        return CDBWrapper::Read(key, value);
+    }
+
+    template <typename K>
+    bool Exists(const K& key) const
+    {
+        {
+            LOCK(cs_staged);
+            const std::pair<bool, std::string>* pstaged = FindStaged(SerializeKey(key));
+            if (pstaged)
+                return !pstaged->first;
+        }
+        return CDBWrapper::Exists(key);
+    }
+
+    //! fSync is ignored; the whole staged set is synced by CommitStaged()
+    template <typename K, typename V>
+    bool Write(const K& key, const V& value, bool fSync = false)
+    {
+        CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+        ssValue.reserve(DBWRAPPER_PREALLOC_VALUE_SIZE);
+        ssValue << value;
+        ssValue.Xor(obfuscate_key);
+        Stage(SerializeKey(key), false, std::string(ssValue.begin(), ssValue.end()));
+        return true;
+    }
+
+    template <typename K, typename V>
+    bool Update(const K& key, const V& value)
+    {
+        return Write(key, value);
+    }
+
+    template <typename K>
+    bool Erase(const K& key, bool fSync = false)
+    {
+        Stage(SerializeKey(key), true, std::string());
+        return true;
+    }
+
+    //! Iterate over the database with staged changes applied
+    CDBIterator* NewIterator();
+
+    bool IsEmpty();
+
+    //! Start collecting changes for a block separately from the pending set
+    void BeginBlockScope();
+
+    //! Close the block scope, keeping its changes only if fKeep is true
+    void EndBlockScope(bool fKeep);
+
+    //! Write all pending changes to LevelDB in a single batch
+    bool CommitStaged(bool fSync = true);
+
+    bool HasStaged() const;
+
+    size_t DynamicMemoryUsage() const;
+};
+
 #endif // DYNAMIC_DBWRAPPER_H
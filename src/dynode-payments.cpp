@@ -223,6 +223,8 @@ void CDynodePayments::Clear()
     LOCK2(cs_mapDynodeBlocks, cs_mapDynodePaymentVotes);
     mapDynodeBlocks.clear();
     mapDynodePaymentVotes.clear();
+    mapScheduledPayees.clear();
+    fScheduledPayeesDirty = true;
 }
 
 bool CDynodePayments::UpdateLastVote(const CDynodePaymentVote& vote)
@@ -483,30 +485,63 @@ bool CDynodePayments::GetBlockPayee(int nBlockHeight, CScript& payeeRet) const
     return it != mapDynodeBlocks.end() && it->second.GetBestPayee(payeeRet);
 }
 
+// Rebuild the cache of best payees for the next 8 blocks, when a vote was added or the tip moved
+void CDynodePayments::UpdateScheduledPayees() const
+{
+    AssertLockHeld(cs_mapDynodeBlocks);
+
+    if (!fScheduledPayeesDirty && nScheduledPayeesHeight == nCachedBlockHeight)
+        return;
+
+    mapScheduledPayees.clear();
+    CScript payee;
+    for (int h = nCachedBlockHeight; h <= nCachedBlockHeight + 8; h++) {
+        if (GetBlockPayee(h, payee))
+            mapScheduledPayees.emplace(h, payee);
+    }
+    nScheduledPayeesHeight = nCachedBlockHeight;
+    fScheduledPayeesDirty = false;
+}
+
 // Is this Dynode scheduled to get paid soon?
 // -- Only look ahead up to 8 blocks to allow for propagation of the latest 2 blocks of votes
 bool CDynodePayments::IsScheduled(const dynode_info_t& dnInfo, int nNotBlockHeight) const
+{
+    return IsScheduled(GetScriptForDestination(dnInfo.pubKeyCollateralAddress.GetID()), nNotBlockHeight);
+}
+
+bool CDynodePayments::IsScheduled(const CScript& dnpayee, int nNotBlockHeight) const
 {
     LOCK(cs_mapDynodeBlocks);
 
     if (!dynodeSync.IsDynodeListSynced())
         return false;
 
-    CScript dnpayee;
-    dnpayee = GetScriptForDestination(dnInfo.pubKeyCollateralAddress.GetID());
-
-    CScript payee;
-    for (int64_t h = nCachedBlockHeight; h <= nCachedBlockHeight + 8; h++) {
-        if (h == nNotBlockHeight)
-            continue;
-        if (GetBlockPayee(h, payee) && dnpayee == payee) {
+    UpdateScheduledPayees();
+    for (const auto& payeepair : mapScheduledPayees) {
+        if (payeepair.first != nNotBlockHeight && payeepair.second == dnpayee)
             return true;
-        }
     }
 
     return false;
 }
 
+void CDynodePayments::GetScheduledPayees(int nNotBlockHeight, std::set<CScript>& setPayeesRet) const
+{
+    setPayeesRet.clear();
+
+    LOCK(cs_mapDynodeBlocks);
+
+    if (!dynodeSync.IsDynodeListSynced())
+        return;
+
+    UpdateScheduledPayees();
+    for (const auto& payeepair : mapScheduledPayees) {
+        if (payeepair.first != nNotBlockHeight)
+            setPayeesRet.insert(payeepair.second);
+    }
+}
+
 bool CDynodePayments::AddOrUpdatePaymentVote(const CDynodePaymentVote& vote)
 {
     uint256 blockHash = uint256();
@@ -524,6 +559,7 @@ bool CDynodePayments::AddOrUpdatePaymentVote(const CDynodePaymentVote& vote)
 
     auto it = mapDynodeBlocks.emplace(vote.nBlockHeight, CDynodeBlockPayees(vote.nBlockHeight)).first;
     it->second.AddPayee(vote);
+    fScheduledPayeesDirty = true;
 
     LogPrint("dnpayments", "CDynodePayments::AddOrUpdatePaymentVote -- added, hash=%s\n", nVoteHash.ToString());
 
@@ -537,76 +573,124 @@ bool CDynodePayments::HasVerifiedPaymentVote(const uint256& hashIn) const
     return it != mapDynodePaymentVotes.end() && it->second.IsVerified();
 }
 
+void CDynodeBlockPayees::UpdateBestPayee(size_t nIndex)
+{
+    if (nBestPayee < 0) {
+        nBestPayee = nIndex;
+        return;
+    }
+    int nVotes = vecPayees[nIndex].GetVoteCount();
+    int nBestVotes = vecPayees[nBestPayee].GetVoteCount();
+    if (nVotes > nBestVotes || (nVotes == nBestVotes && (int)nIndex < nBestPayee))
+        nBestPayee = nIndex;
+}
+
+void CDynodeBlockPayees::RebuildIndex()
+{
+    LOCK(cs_vecPayees);
+
+    mapPayeeIndex.clear();
+    mapVoterPayee.clear();
+    nBestPayee = -1;
+    for (size_t i = 0; i < vecPayees.size(); i++) {
+        mapPayeeIndex.emplace(vecPayees[i].GetPayee(), i);
+        UpdateBestPayee(i);
+    }
+}
+
 void CDynodeBlockPayees::AddPayee(const CDynodePaymentVote& vote)
 {
     LOCK(cs_vecPayees);
 
     uint256 nVoteHash = vote.GetHash();
 
-    for (auto& payee : vecPayees) {
-        if (payee.GetPayee() == vote.payee) {
-            payee.AddVoteHash(nVoteHash);
-            return;
-        }
+    mapVoterPayee[vote.dynodeOutpoint] = vote.payee;
+
+    auto it = mapPayeeIndex.find(vote.payee);
+    if (it != mapPayeeIndex.end()) {
+        vecPayees[it->second].AddVoteHash(nVoteHash);
+        UpdateBestPayee(it->second);
+        return;
     }
     CDynodePayee payeeNew(vote.payee, nVoteHash);
     vecPayees.push_back(payeeNew);
+    mapPayeeIndex.emplace(vote.payee, vecPayees.size() - 1);
+    UpdateBestPayee(vecPayees.size() - 1);
 }
 
 bool CDynodeBlockPayees::GetBestPayee(CScript& payeeRet) const
 {
     LOCK(cs_vecPayees);
 
-    if (!vecPayees.size()) {
+    if (nBestPayee < 0) {
         LogPrint("dnpayments", "CDynodeBlockPayees::GetBestPayee -- ERROR: couldn't find any payee\n");
         return false;
     }
 
-    int nVotes = -1;
-    for (const auto& payee : vecPayees) {
-        if (payee.GetVoteCount() > nVotes) {
-            payeeRet = payee.GetPayee();
-            nVotes = payee.GetVoteCount();
-        }
-    }
+    payeeRet = vecPayees[nBestPayee].GetPayee();
+    return true;
+}
 
-    return (nVotes > -1);
+int CDynodeBlockPayees::GetBestPayeeVoteCount() const
+{
+    LOCK(cs_vecPayees);
+
+    return nBestPayee < 0 ? 0 : vecPayees[nBestPayee].GetVoteCount();
 }
 
 bool CDynodeBlockPayees::HasPayeeWithVotes(const CScript& payeeIn, int nVotesReq) const
 {
     LOCK(cs_vecPayees);
 
+    auto it = mapPayeeIndex.find(payeeIn);
+    return it != mapPayeeIndex.end() && vecPayees[it->second].GetVoteCount() >= nVotesReq;
+}
+
+bool CDynodeBlockPayees::GetVoterPayee(const COutPoint& outpoint, CScript& payeeRet) const
+{
+    LOCK(cs_vecPayees);
+
+    auto it = mapVoterPayee.find(outpoint);
+    if (it == mapVoterPayee.end())
+        return false;
+
+    payeeRet = it->second;
+    return true;
+}
+
+bool CDynodeBlockPayees::HasAllVoters() const
+{
+    LOCK(cs_vecPayees);
+
+    size_t nVotes = 0;
     for (const auto& payee : vecPayees) {
-        if (payee.GetVoteCount() >= nVotesReq && payee.GetPayee() == payeeIn) {
-            return true;
-        }
+        nVotes += payee.GetVoteCount();
     }
+    return mapVoterPayee.size() >= nVotes;
+}
 
-    //LogPrint("dnpayments", "CDynodeBlockPayees::HasPayeeWithVotes -- ERROR: couldn't find any payee with %d+ votes\n", nVotesReq);
-    return false;
+void CDynodeBlockPayees::AddVoter(const COutPoint& outpoint, const CScript& payee)
+{
+    LOCK(cs_vecPayees);
+
+    mapVoterPayee[outpoint] = payee;
 }
 
 bool CDynodeBlockPayees::IsTransactionValid(const CTransaction& txNew, const int nHeight) const
 {
     LOCK(cs_vecPayees);
 
-    int nMaxSignatures = 0;
+    int nMaxSignatures = nBestPayee < 0 ? 0 : vecPayees[nBestPayee].GetVoteCount();
     std::string strPayeesPossible = "";
-    CAmount nDynodePayment = GetFluidDynodeReward(nHeight);
 
     //require at least DNPAYMENTS_SIGNATURES_REQUIRED signatures
 
-    for (const auto& payee : vecPayees) {
-        if (payee.GetVoteCount() >= nMaxSignatures) {
-            nMaxSignatures = payee.GetVoteCount();
-        }
-    }
-
     // if we don't have at least DNPAYMENTS_SIGNATURES_REQUIRED signatures on a payee, approve whichever is the longest chain
     if (nMaxSignatures < DNPAYMENTS_SIGNATURES_REQUIRED)
         return true;
 
+    CAmount nDynodePayment = GetFluidDynodeReward(nHeight);
+
     for (const auto& payee : vecPayees) {
         if (payee.GetVoteCount() >= DNPAYMENTS_SIGNATURES_REQUIRED) {
             for (const auto& txout : txNew.vout) {
@@ -688,6 +772,7 @@ void CDynodePayments::CheckAndRemove()
             LogPrint("dnpayments", "CDynodePayments::CheckAndRemove -- Removing old Dynode payment: nBlockHeight=%d\n", vote.nBlockHeight);
             mapDynodePaymentVotes.erase(it++);
             mapDynodeBlocks.erase(vote.nBlockHeight);
+            fScheduledPayeesDirty = true;
         } else {
             ++it;
         }
@@ -825,6 +910,10 @@ void CDynodePayments::CheckBlockVotes(int nBlockHeight)
     if (!dynodeSync.IsWinnersListSynced())
         return;
 
+    // This only feeds the debug log, don't rank every Dynode each block for nothing
+    if (!LogAcceptCategory("dnpayments"))
+        return;
+
     CDynodeMan::rank_pair_vec_t dns;
     if (!dnodeman.GetDynodeRanks(dns, nBlockHeight - 101, GetMinDynodePaymentsProto())) {
         LogPrintf("CDynodePayments::CheckBlockVotes -- nBlockHeight=%d, GetDynodeRanks failed\n", nBlockHeight);
@@ -837,29 +926,26 @@ void CDynodePayments::CheckBlockVotes(int nBlockHeight)
 
     LOCK2(cs_mapDynodeBlocks, cs_mapDynodePaymentVotes);
 
-    int i{0};
-    for (const auto& dn : dns) {
-        CScript payee;
-        bool found = false;
-
-        const auto it = mapDynodeBlocks.find(nBlockHeight);
-        if (it != mapDynodeBlocks.end()) {
-            for (const auto& p : it->second.vecPayees) {
-                for (const auto& voteHash : p.GetVoteHashes()) {
-                    const auto itVote = mapDynodePaymentVotes.find(voteHash);
-                    if (itVote == mapDynodePaymentVotes.end()) {
-                        debugStr += strprintf("    - could not find vote %s\n",
-                            voteHash.ToString());
-                        continue;
-                    }
-                    if (itVote->second.dynodeOutpoint == dn.second.outpoint) {
-                        payee = itVote->second.payee;
-                        found = true;
-                        break;
-                    }
+    const auto it = mapDynodeBlocks.find(nBlockHeight);
+    if (it != mapDynodeBlocks.end() && !it->second.HasAllVoters()) {
+        // votes loaded from disk are not indexed by voter yet
+        for (const auto& p : it->second.vecPayees) {
+            for (const auto& voteHash : p.GetVoteHashes()) {
+                const auto itVote = mapDynodePaymentVotes.find(voteHash);
+                if (itVote == mapDynodePaymentVotes.end()) {
+                    debugStr += strprintf("    - could not find vote %s\n",
+                        voteHash.ToString());
+                    continue;
                 }
+                it->second.AddVoter(itVote->second.dynodeOutpoint, itVote->second.payee);
             }
         }
+    }
+
+    int i{0};
+    for (const auto& dn : dns) {
+        CScript payee;
+        bool found = it != mapDynodeBlocks.end() && it->second.GetVoterPayee(dn.second.outpoint, payee);
 
         if (found) {
             CTxDestination address1;
@@ -76,15 +76,30 @@ public:
 // Keep track of votes for payees from Dynodes
 class CDynodeBlockPayees
 {
+private:
+    // Position of each payee in vecPayees
+    std::map<CScript, size_t> mapPayeeIndex;
+    // Index in vecPayees of the payee with the most votes, the first one added
+    // wins a tie. Vote counts only grow, so it is only compared against the
+    // payee that just got a vote instead of searching all payees.
+    int nBestPayee;
+    // Payee each Dynode voted for, filled as votes are added
+    std::map<COutPoint, CScript> mapVoterPayee;
+
+    void UpdateBestPayee(size_t nIndex);
+    void RebuildIndex();
+
 public:
     int nBlockHeight;
     std::vector<CDynodePayee> vecPayees;
 
-    CDynodeBlockPayees() : nBlockHeight(0),
+    CDynodeBlockPayees() : nBestPayee(-1),
+                           nBlockHeight(0),
                            vecPayees()
     {
     }
-    CDynodeBlockPayees(int nBlockHeightIn) : nBlockHeight(nBlockHeightIn),
+    CDynodeBlockPayees(int nBlockHeightIn) : nBestPayee(-1),
+                                             nBlockHeight(nBlockHeightIn),
                                              vecPayees()
     {
     }
@@ -96,11 +111,19 @@ public:
     {
         READWRITE(nBlockHeight);
         READWRITE(vecPayees);
+        if (ser_action.ForRead())
+            RebuildIndex();
     }
 
     void AddPayee(const CDynodePaymentVote& vote);
     bool GetBestPayee(CScript& payeeRet) const;
+    int GetBestPayeeVoteCount() const;
     bool HasPayeeWithVotes(const CScript& payeeIn, int nVotesReq) const;
+    /// Payee voted for by a Dynode, only known for votes added since startup
+    bool GetVoterPayee(const COutPoint& outpoint, CScript& payeeRet) const;
+    /// Whether every vote for this block has its voter indexed
+    bool HasAllVoters() const;
+    void AddVoter(const COutPoint& outpoint, const CScript& payee);
 
     bool IsTransactionValid(const CTransaction& txNew, int nHeight) const;
 
@@ -189,13 +212,21 @@ private:
     // Keep track of current block height
     int nCachedBlockHeight;
 
+    // Best payee of each block in the IsScheduled window, rebuilt after a vote
+    // is added or the tip moves. Protected by cs_mapDynodeBlocks.
+    mutable std::map<int, CScript> mapScheduledPayees;
+    mutable int nScheduledPayeesHeight;
+    mutable bool fScheduledPayeesDirty;
+
+    void UpdateScheduledPayees() const;
+
 public:
     std::map<uint256, CDynodePaymentVote> mapDynodePaymentVotes;
     std::map<int, CDynodeBlockPayees> mapDynodeBlocks;
     std::map<COutPoint, int> mapDynodesLastVote;
     std::map<COutPoint, int> mapDynodesDidNotVote;
 
-    CDynodePayments() : nStorageCoeff(1.25), nMinBlocksToStore(5000) {}
+    CDynodePayments() : nStorageCoeff(1.25), nMinBlocksToStore(5000), nScheduledPayeesHeight(-1), fScheduledPayeesDirty(true) {}
 
     ADD_SERIALIZE_METHODS;
 
@@ -220,6 +251,8 @@ public:
     bool GetBlockPayee(int nBlockHeight, CScript& payeeRet) const;
     bool IsTransactionValid(const CTransaction& txNew, int nBlockHeight) const;
     bool IsScheduled(const dynode_info_t& dnInfo, int nNotBlockHeight) const;
+    bool IsScheduled(const CScript& dnpayee, int nNotBlockHeight) const;
+    void GetScheduledPayees(int nNotBlockHeight, std::set<CScript>& setPayeesRet) const;
 
     bool UpdateLastVote(const CDynodePaymentVote& vote);
 
@@ -442,7 +442,10 @@ void CDynodeSync::SendGovernanceSyncRequest(CNode* pnode, CConnman& connman)
 {
     CNetMsgMaker msgMaker(pnode->GetSendVersion());
 
-    if (pnode->nVersion >= GOVERNANCE_FILTER_PROTO_VERSION) {
+    if (pnode->nVersion >= GOVERNANCE_RECON_PROTO_VERSION) {
+        // only the objects and votes we are missing are sent back
+        governance.RequestGovernanceReconciliation(pnode, connman);
+    } else if (pnode->nVersion >= GOVERNANCE_FILTER_PROTO_VERSION) {
         CBloomFilter filter;
         filter.clear();
 
@@ -17,6 +17,7 @@
 #include "messagesigner.h"
 #include "netbase.h"
 #include "script/standard.h"
+#include "ui_interface.h"
 #include "util.h"
 #include "validation.h"
 #ifdef ENABLE_WALLET
@@ -90,6 +91,7 @@ bool CDynode::UpdateFromNewBroadcast(CDynodeBroadcast& dnb, CConnman& connman)
             return false;
         }
     }
+    uiInterface.NotifyDynodeChanged(outpoint, CT_UPDATED);
     return true;
 }
 
@@ -138,6 +140,17 @@ void CDynode::Check(bool fForce)
     AssertLockHeld(cs_main);
     LOCK(cs);
 
+    int nActiveStateBefore = nActiveState;
+    CheckState(fForce);
+    if (nActiveState != nActiveStateBefore) {
+        uiInterface.NotifyDynodeChanged(outpoint, CT_UPDATED);
+    }
+}
+
+void CDynode::CheckState(bool fForce)
+{
+    AssertLockHeld(cs);
+
     if (ShutdownRequested())
         return;
 
@@ -929,6 +942,7 @@ bool CDynodePing::CheckAndUpdate(CDynode* pdn, bool fFromNewBroadcast, int& nDos
     // let's store this ping as the last one
     LogPrint("dynode", "CDynodePing::CheckAndUpdate -- Dynode ping accepted, Dynode=%s\n", dynodeOutpoint.ToStringShort());
     pdn->lastPing = *this;
+    uiInterface.NotifyDynodeChanged(pdn->outpoint, CT_UPDATED);
 
     // and update dnodeman.mapSeenDynodeBroadcast.lastPing which is probably outdated
     CDynodeBroadcast dnb(*pdn);
@@ -159,6 +159,9 @@ private:
     // critical section to protect the inner data structures
     mutable CCriticalSection cs;
 
+    // state transitions behind Check(), which notifies the UI when nActiveState changes
+    void CheckState(bool fForce);
+
 public:
     enum state {
         DYNODE_PRE_ENABLED,
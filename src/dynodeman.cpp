@@ -22,8 +22,11 @@
 #include "script/standard.h"
 #include "ui_interface.h"
 #include "util.h"
+#include "validationinterface.h"
 #include "warnings.h"
 
+#include <unordered_set>
+
 /** Dynode manager */
 CDynodeMan dnodeman;
 
@@ -86,6 +89,7 @@ bool CDynodeMan::Add(CDynode& dn)
     LogPrint("dynode", "CDynodeMan::Add -- Adding new Dynode: addr=%s, %i now\n", dn.addr.ToString(), size() + 1);
     mapDynodes[dn.outpoint] = dn;
     fDynodesAdded = true;
+    uiInterface.NotifyDynodeChanged(dn.outpoint, CT_NEW);
     return true;
 }
 
@@ -207,6 +211,8 @@ void CDynodeMan::CheckAndRemove(CConnman& connman)
                 mWeAskedForDynodeListEntry.erase(it->first);
                 // and finally remove it from the list
                 it->second.FlagGovernanceItemsAsDirty();
+                mapCollateralInfo.erase(it->first);
+                uiInterface.NotifyDynodeChanged(it->first, CT_DELETED);
                 mapDynodes.erase(it++);
                 fDynodesRemoved = true;
             } else {
@@ -363,7 +369,11 @@ void CDynodeMan::CheckAndRemove(CConnman& connman)
 void CDynodeMan::Clear()
 {
     LOCK(cs);
+    for (const auto& dnpair : mapDynodes) {
+        uiInterface.NotifyDynodeChanged(dnpair.first, CT_DELETED);
+    }
     mapDynodes.clear();
+    mapCollateralInfo.clear();
     mAskedUsForDynodeList.clear();
     mWeAskedForDynodeList.clear();
     mWeAskedForDynodeListEntry.clear();
@@ -537,25 +547,36 @@ bool CDynodeMan::GetNextDynodeInQueueForPayment(int nBlockHeight, bool fFilterSi
     */
 
     int nDnCount = CountDynodes();
+    int nMinProtocol = dnpayments.GetMinDynodePaymentsProto();
+    int nTipHeight = chainActive.Height();
+    int64_t nAdjustedTime = GetAdjustedTime();
+
+    // payees in the blocks up to 8 entries ahead of current block
+    std::set<CScript> setScheduledPayees;
+    dnpayments.GetScheduledPayees(nBlockHeight, setScheduledPayees);
 
     for (const auto& dnpair : mapDynodes) {
         if (!dnpair.second.IsValidForPayment())
             continue;
 
         // //check protocol version
-        if (dnpair.second.nProtocolVersion < dnpayments.GetMinDynodePaymentsProto())
+        if (dnpair.second.nProtocolVersion < nMinProtocol)
             continue;
 
-        //it's in the list (up to 8 entries ahead of current block to allow propagation) -- so let's skip it
-        if (dnpayments.IsScheduled(dnpair.second, nBlockHeight))
+        //it's too new, wait for a cycle
+        if (fFilterSigTime && dnpair.second.sigTime + (nDnCount * 2.6 * 60) > nAdjustedTime)
             continue;
 
-        //it's too new, wait for a cycle
-        if (fFilterSigTime && dnpair.second.sigTime + (nDnCount * 2.6 * 60) > GetAdjustedTime())
+        const collateral_info_t* pCollateral = GetCollateralInfo(dnpair.first, dnpair.second);
+        if (!pCollateral)
+            continue;
+
+        //it's in the list (up to 8 entries ahead of current block to allow propagation) -- so let's skip it
+        if (setScheduledPayees.count(pCollateral->scriptPayee))
             continue;
 
         //make sure it has at least as many confirmations as there are Dynodes
-        if (GetUTXOConfirmations(dnpair.first) < nDnCount)
+        if (nTipHeight - pCollateral->nHeight + 1 < nDnCount)
             continue;
 
         vecDynodeLastPaid.push_back(std::make_pair(dnpair.second.GetLastPaidBlock(), &dnpair.second));
@@ -607,6 +628,7 @@ dynode_info_t CDynodeMan::FindRandomNotInVec(const std::vector<COutPoint>& vecTo
 
     int nCountEnabled = CountEnabled(nProtocolVersion);
     int nCountNotExcluded = nCountEnabled - vecToExclude.size();
+    std::unordered_set<COutPoint, SaltedOutpointHasher> setToExclude(vecToExclude.begin(), vecToExclude.end());
 
     LogPrintf("CDynodeMan::FindRandomNotInVec -- %d enabled Dynodes, %d Dynodes to choose from\n", nCountEnabled, nCountNotExcluded);
     if (nCountNotExcluded < 1)
@@ -621,20 +643,12 @@ dynode_info_t CDynodeMan::FindRandomNotInVec(const std::vector<COutPoint>& vecTo
     FastRandomContext insecure_rand;
     // shuffle pointers
     std::random_shuffle(vpDynodesShuffled.begin(), vpDynodesShuffled.end(), insecure_rand);
-    bool fExclude;
 
     // loop through
     for (const auto& pdn : vpDynodesShuffled) {
         if (pdn->nProtocolVersion < nProtocolVersion || !pdn->IsEnabled())
             continue;
-        fExclude = false;
-        for (const auto& outpointToExclude : vecToExclude) {
-            if (pdn->outpoint == outpointToExclude) {
-                fExclude = true;
-                break;
-            }
-        }
-        if (fExclude)
+        if (setToExclude.count(pdn->outpoint))
             continue;
         // found the one not in vecToExclude
         LogPrint("dynode", "CDynodeMan::FindRandomNotInVec -- found, Dynode=%s\n", pdn->outpoint.ToStringShort());
@@ -1732,6 +1746,61 @@ void CDynodeMan::SetDynodeLastPing(const COutPoint& outpoint, const CDynodePing&
     }
 }
 
+const CDynodeMan::collateral_info_t* CDynodeMan::GetCollateralInfo(const COutPoint& outpoint, const CDynode& dn)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs);
+
+    auto it = mapCollateralInfo.find(outpoint);
+    if (it != mapCollateralInfo.end())
+        return &it->second;
+
+    // -1 means UTXO is yet unknown or already spent, check again next time
+    int nHeight = GetUTXOHeight(outpoint);
+    if (nHeight < 0)
+        return nullptr;
+
+    collateral_info_t info;
+    info.nHeight = nHeight;
+    info.scriptPayee = GetScriptForDestination(dn.pubKeyCollateralAddress.GetID());
+    return &mapCollateralInfo.emplace(outpoint, info).first->second;
+}
+
+void CDynodeMan::UpdateCollateralInfo(const CBlockIndex* pindex)
+{
+    LOCK2(cs_main, cs);
+
+    // forget removed Dynodes and collaterals a reorg may have moved
+    auto it = mapCollateralInfo.begin();
+    while (it != mapCollateralInfo.end()) {
+        if (it->second.nHeight > pindex->nHeight || !mapDynodes.count(it->first)) {
+            mapCollateralInfo.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& dnpair : mapDynodes) {
+        GetCollateralInfo(dnpair.first, dnpair.second);
+    }
+}
+
+void CDynodeMan::SyncTransaction(const CTransaction& tx, const CBlockIndex* pindex, int posInBlock)
+{
+    if (!pindex || posInBlock == CMainSignals::SYNC_TRANSACTION_NOT_IN_BLOCK)
+        return;
+
+    LOCK(cs);
+
+    if (mapCollateralInfo.empty())
+        return;
+
+    // collateral spent in a connected block, GetCollateralInfo will see it as spent from now on
+    for (const CTxIn& txin : tx.vin) {
+        mapCollateralInfo.erase(txin.prevout);
+    }
+}
+
 void CDynodeMan::UpdatedBlockTip(const CBlockIndex* pindex)
 {
     nCachedBlockHeight = pindex->nHeight;
@@ -1739,6 +1808,8 @@ void CDynodeMan::UpdatedBlockTip(const CBlockIndex* pindex)
 
     CheckSameAddr();
 
+    UpdateCollateralInfo(pindex);
+
     if (fDynodeMode) {
         // normal wallet does not need to update this every block, doing update on rpc call should be enough
         UpdateLastPaid(pindex);
@@ -49,6 +49,13 @@ private:
 
     // map to hold all DNs
     std::map<COutPoint, CDynode> mapDynodes;
+
+    struct collateral_info_t {
+        int nHeight;
+        CScript scriptPayee;
+    };
+    // confirmation height and payee script of each DN collateral, refreshed on block connect
+    std::map<COutPoint, collateral_info_t> mapCollateralInfo;
     // who's asked for the Dynode list and the last time
     std::map<CService, int64_t> mAskedUsForDynodeList;
     // who we asked for the Dynode list and the last time
@@ -88,6 +95,10 @@ private:
 
     void PushPsegInvs(CNode* pnode, const CDynode& dn);
 
+    /// Cached collateral info, looked up in the coins view on a miss. Requires cs_main and cs.
+    const collateral_info_t* GetCollateralInfo(const COutPoint& outpoint, const CDynode& dn);
+    void UpdateCollateralInfo(const CBlockIndex* pindex);
+
 public:
     // Keep track of all broadcasts I've seen
     std::map<uint256, std::pair<int64_t, CDynodeBroadcast> > mapSeenDynodeBroadcast;
@@ -236,6 +247,7 @@ public:
     void SetDynodeLastPing(const COutPoint& outpoint, const CDynodePing& dnp);
 
     void UpdatedBlockTip(const CBlockIndex* pindex);
+    void SyncTransaction(const CTransaction& tx, const CBlockIndex* pindex, int posInBlock);
 
     void WarnDynodeDaemonUpdates();
 
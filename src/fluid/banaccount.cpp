@@ -45,7 +45,7 @@ CBanAccount::CBanAccount(const CScript& fluidScript, const std::vector<unsigned
     FluidScript = CharVectorFromString(ScriptToAsmStr(fluidScript));
 }
 
-CBanAccountDB::CBanAccountDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "banned-accounts", nCacheSize, fMemory, fWipe, obfuscate)
+CBanAccountDB::CBanAccountDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CStagedDBWrapper(GetDataDir() / "blocks" / "banned-accounts", nCacheSize, fMemory, fWipe, obfuscate)
 {
 }
 
@@ -83,5 +83,5 @@ bool CBanAccountDB::RecordExists(const std::vector<unsigned char>& vchFullObject
 {
     LOCK(cs_ban_account);
     CBanAccount entry;
-    return CDBWrapper::Read(make_pair(std::string("account"), vchFullObjectPath), entry);
+    return Read(make_pair(std::string("account"), vchFullObjectPath), entry);
 }
\ No newline at end of file
@@ -98,7 +98,7 @@ public:
 
 static CCriticalSection cs_ban_account;
 
-class CBanAccountDB : public CDBWrapper
+class CBanAccountDB : public CStagedDBWrapper
 {
 public:
     CBanAccountDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate);
@@ -92,7 +92,7 @@ void CFluidDynode::Serialize(std::vector<unsigned char>& vchData)
     vchData = std::vector<unsigned char>(dsFluidOp.begin(), dsFluidOp.end());
 }
 
-CFluidDynodeDB::CFluidDynodeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "fluid-dynode", nCacheSize, fMemory, fWipe, obfuscate)
+CFluidDynodeDB::CFluidDynodeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CStagedDBWrapper(GetDataDir() / "blocks" / "fluid-dynode", nCacheSize, fMemory, fWipe, obfuscate)
 {
 }
 
@@ -184,7 +184,7 @@ bool CFluidDynodeDB::RecordExists(const std::vector<unsigned char>& vchFluidScri
 {
     LOCK(cs_fluid_dynode);
     CFluidDynode fluidDynode;
-    return CDBWrapper::Read(make_pair(std::string("script"), vchFluidScript), fluidDynode);
+    return Read(make_pair(std::string("script"), vchFluidScript), fluidDynode);
 }
 
 bool CheckFluidDynodeDB()
@@ -109,7 +109,7 @@ public:
 
 static CCriticalSection cs_fluid_dynode;
 
-class CFluidDynodeDB : public CDBWrapper
+class CFluidDynodeDB : public CStagedDBWrapper
 {
 public:
     CFluidDynodeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate);
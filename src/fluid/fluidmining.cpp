@@ -92,7 +92,7 @@ void CFluidMining::Serialize(std::vector<unsigned char>& vchData)
     vchData = std::vector<unsigned char>(dsFluidOp.begin(), dsFluidOp.end());
 }
 
-CFluidMiningDB::CFluidMiningDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "fluid-mining", nCacheSize, fMemory, fWipe, obfuscate)
+CFluidMiningDB::CFluidMiningDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CStagedDBWrapper(GetDataDir() / "blocks" / "fluid-mining", nCacheSize, fMemory, fWipe, obfuscate)
 {
 }
 
@@ -184,7 +184,7 @@ bool CFluidMiningDB::RecordExists(const std::vector<unsigned char>& vchFluidScri
 {
     LOCK(cs_fluid_mining);
     CFluidMining fluidMining;
-    return CDBWrapper::Read(make_pair(std::string("script"), vchFluidScript), fluidMining);
+    return Read(make_pair(std::string("script"), vchFluidScript), fluidMining);
 }
 
 bool CheckFluidMiningDB()
@@ -109,7 +109,7 @@ public:
 
 static CCriticalSection cs_fluid_mining;
 
-class CFluidMiningDB : public CDBWrapper
+class CFluidMiningDB : public CStagedDBWrapper
 {
 public:
     CFluidMiningDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate);
@@ -101,7 +101,7 @@ CDynamicAddress CFluidMint::GetDestinationAddress() const
     return CDynamicAddress(StringFromCharVector(DestinationAddress));
 }
 
-CFluidMintDB::CFluidMintDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "fluid-mint", nCacheSize, fMemory, fWipe, obfuscate)
+CFluidMintDB::CFluidMintDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CStagedDBWrapper(GetDataDir() / "blocks" / "fluid-mint", nCacheSize, fMemory, fWipe, obfuscate)
 {
 }
 
@@ -190,7 +190,7 @@ bool CFluidMintDB::RecordExists(const std::vector<unsigned char>& vchFluidScript
 {
     LOCK(cs_fluid_mint);
     CFluidMint fluidMint;
-    return CDBWrapper::Read(make_pair(std::string("script"), vchFluidScript), fluidMint);
+    return Read(make_pair(std::string("script"), vchFluidScript), fluidMint);
 }
 
 bool CheckFluidMintDB()
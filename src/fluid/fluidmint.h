@@ -115,7 +115,7 @@ public:
 
 static CCriticalSection cs_fluid_mint;
 
-class CFluidMintDB : public CDBWrapper
+class CFluidMintDB : public CStagedDBWrapper
 {
 public:
     CFluidMintDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate);
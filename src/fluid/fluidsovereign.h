@@ -95,7 +95,7 @@ public:
 
 static CCriticalSection cs_fluid_sovereign;
 
-class CFluidSovereignDB : public CDBWrapper
+class CFluidSovereignDB : public CStagedDBWrapper
 {
 public:
     CFluidSovereignDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate);
@@ -28,6 +28,7 @@ class CGovernanceVote;
 static const int MAX_GOVERNANCE_OBJECT_DATA_SIZE = 16 * 1024;
 static const int MIN_GOVERNANCE_PEER_PROTO_VERSION = 70900;
 static const int GOVERNANCE_FILTER_PROTO_VERSION = 70500;
+static const int GOVERNANCE_RECON_PROTO_VERSION = 71200;
 
 static const double GOVERNANCE_FILTER_FP_RATE = 0.001;
 
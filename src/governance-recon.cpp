@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "governance-recon.h"
+
+#include "hash.h"
+#include "random.h"
+
+#include <algorithm>
+#include <limits>
+
+void CGovernanceReconRequest::InitKeys()
+{
+    nKey0 = GetRand(std::numeric_limits<uint64_t>::max());
+    nKey1 = GetRand(std::numeric_limits<uint64_t>::max());
+}
+
+size_t CGovernanceReconRequest::GetBucketCount(size_t nVoteCount)
+{
+    size_t nBuckets = (nVoteCount + GOVERNANCE_RECON_VOTES_PER_BUCKET - 1) / GOVERNANCE_RECON_VOTES_PER_BUCKET;
+    return std::min(std::max(nBuckets, size_t(1)), GOVERNANCE_RECON_MAX_BUCKETS);
+}
+
+uint64_t CGovernanceReconRequest::GetShortId(const uint256& nVoteHash) const
+{
+    return SipHashUint256(nKey0, nKey1, nVoteHash);
+}
+
+void CGovernanceReconRequest::AddObject(const uint256& nObjectHash, const std::vector<uint256>& vecVoteHashes)
+{
+    CGovernanceReconSketch sketch;
+    sketch.nObjectHash = nObjectHash;
+    sketch.vecBucketDigests.assign(GetBucketCount(vecVoteHashes.size()), 0);
+    for (const auto& nVoteHash : vecVoteHashes) {
+        uint64_t nShortId = GetShortId(nVoteHash);
+        sketch.vecBucketDigests[nShortId % sketch.vecBucketDigests.size()] ^= nShortId;
+    }
+    vecSketches.push_back(sketch);
+}
+
+std::vector<bool> CGovernanceReconRequest::GetDifferingBuckets(const CGovernanceReconSketch& sketch, const std::vector<uint256>& vecVoteHashes) const
+{
+    std::vector<uint64_t> vecOurDigests(sketch.vecBucketDigests.size(), 0);
+    for (const auto& nVoteHash : vecVoteHashes) {
+        uint64_t nShortId = GetShortId(nVoteHash);
+        vecOurDigests[nShortId % vecOurDigests.size()] ^= nShortId;
+    }
+
+    std::vector<bool> vecDiffer(vecOurDigests.size());
+    for (size_t i = 0; i < vecOurDigests.size(); ++i) {
+        vecDiffer[i] = vecOurDigests[i] != sketch.vecBucketDigests[i];
+    }
+    return vecDiffer;
+}
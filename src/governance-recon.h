@@ -0,0 +1,102 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GOVERNANCE_RECON_H
+#define GOVERNANCE_RECON_H
+
+#include "serialize.h"
+#include "uint256.h"
+
+#include <vector>
+
+/** Average number of votes summarized by one bucket digest */
+static const size_t GOVERNANCE_RECON_VOTES_PER_BUCKET = 16;
+/** Upper bound on the number of bucket digests for a single object */
+static const size_t GOVERNANCE_RECON_MAX_BUCKETS = 4096;
+
+/**
+ * Summary of the votes a node holds for one governance object.
+ * Votes are spread over buckets by their salted short id and every bucket
+ * carries the XOR of the short ids that fell into it, so two nodes holding
+ * the same votes produce the same digests.
+ */
+class CGovernanceReconSketch
+{
+public:
+    uint256 nObjectHash;
+    std::vector<uint64_t> vecBucketDigests;
+
+    CGovernanceReconSketch() : nObjectHash(), vecBucketDigests() {}
+
+    bool IsValid() const
+    {
+        return !vecBucketDigests.empty() && vecBucketDigests.size() <= GOVERNANCE_RECON_MAX_BUCKETS;
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(nObjectHash);
+        READWRITE(vecBucketDigests);
+    }
+};
+
+/**
+ * Governance set reconciliation request (NetMsgType::DNGOVERNANCERECON).
+ *
+ * The syncing node sends a sketch of every governance object it has. The
+ * peer answers with inventory for the objects missing from the request and,
+ * for the objects both sides have, only for the votes in buckets whose
+ * digests differ. This replaces pushing every object and then asking for
+ * the votes of each object one by one. When the peer stops early to keep
+ * the inventory in bounds, it lists the objects whose votes it didn't cover
+ * in a NetMsgType::DNGOVERNANCERECONREST message.
+ */
+class CGovernanceReconRequest
+{
+public:
+    // SipHash keys for the short vote ids, chosen by the requesting node
+    uint64_t nKey0;
+    uint64_t nKey1;
+    std::vector<CGovernanceReconSketch> vecSketches;
+
+    CGovernanceReconRequest() : nKey0(0), nKey1(0), vecSketches() {}
+
+    /** Pick fresh random keys, must be done before adding objects */
+    void InitKeys();
+
+    /** Number of buckets used to summarize nVoteCount votes */
+    static size_t GetBucketCount(size_t nVoteCount);
+
+    uint64_t GetShortId(const uint256& nVoteHash) const;
+
+    /** Append the sketch of an object holding the given votes */
+    void AddObject(const uint256& nObjectHash, const std::vector<uint256>& vecVoteHashes);
+
+    /**
+     * Compare our votes for an object against the peer's sketch of it.
+     * @return a flag per bucket of the sketch, set where the vote sets differ
+     */
+    std::vector<bool> GetDifferingBuckets(const CGovernanceReconSketch& sketch, const std::vector<uint256>& vecVoteHashes) const;
+
+    /** Bucket of the sketch the vote falls into */
+    size_t GetBucket(const CGovernanceReconSketch& sketch, const uint256& nVoteHash) const
+    {
+        return GetShortId(nVoteHash) % sketch.vecBucketDigests.size();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(nKey0);
+        READWRITE(nKey1);
+        READWRITE(vecSketches);
+    }
+};
+
+#endif // GOVERNANCE_RECON_H
@@ -55,6 +55,16 @@ std::vector<CGovernanceVote> CGovernanceObjectVoteFile::GetVotes() const
     return vecResult;
 }
 
+std::vector<uint256> CGovernanceObjectVoteFile::GetVoteHashes() const
+{
+    std::vector<uint256> vecResult;
+    vecResult.reserve(mapVoteIndex.size());
+    for (const auto& pair : mapVoteIndex) {
+        vecResult.push_back(pair.first);
+    }
+    return vecResult;
+}
+
 void CGovernanceObjectVoteFile::RemoveVotesFromDynode(const COutPoint& outpointDynode)
 {
     vote_l_it it = listVotes.begin();
@@ -73,6 +73,8 @@ public:
 
     std::vector<CGovernanceVote> GetVotes() const;
 
+    std::vector<uint256> GetVoteHashes() const;
+
     void RemoveVotesFromDynode(const COutPoint& outpointDynode);
 
     ADD_SERIALIZE_METHODS;
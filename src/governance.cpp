@@ -28,6 +28,9 @@ int nSubmittedFinalBudget;
 const std::string CGovernanceManager::SERIALIZATION_VERSION_STRING = "CGovernanceManager-Version-24";
 const int CGovernanceManager::MAX_TIME_FUTURE_DEVIATION = 60 * 60;
 const int CGovernanceManager::RELIABLE_PROPAGATION_TIME = 60;
+const int CGovernanceManager::VOTES_REQUEST_TIMEOUT = 60 * 60;
+// keep the answer to a single reconciliation well within the peer's setAskFor limit
+const size_t CGovernanceManager::MAX_RECON_VOTE_INVS = SETASKFOR_MAX_SZ / 2;
 
 CGovernanceManager::CGovernanceManager()
     : nTimeLastDiff(0),
@@ -41,6 +44,8 @@ CGovernanceManager::CGovernanceManager()
       mapLastDynodeObject(),
       setRequestedObjects(),
       fRateChecksEnabled(true),
+      mapAskedRecently(),
+      mapReconciledRecently(),
       cs()
 {
 }
@@ -129,6 +134,38 @@ void CGovernanceManager::ProcessMessage(CNode* pfrom, const std::string& strComm
         LogPrint("gobject", "DNGOVERNANCESYNC -- syncing governance objects to our peer at %s\n", pfrom->addr.ToString());
     }
 
+    // ANOTHER USER IS ASKING US FOR THE GOVERNANCE DATA IT IS MISSING
+    else if (strCommand == NetMsgType::DNGOVERNANCERECON) {
+        if (pfrom->nVersion < GOVERNANCE_RECON_PROTO_VERSION) {
+            LogPrint("gobject", "DNGOVERNANCERECON -- peer=%d using obsolete version %i\n", pfrom->id, pfrom->nVersion);
+            return;
+        }
+
+        // Same as DNGOVERNANCESYNC, ignore until we are fully synced
+        if (!dynodeSync.IsSynced())
+            return;
+
+        CGovernanceReconRequest request;
+        vRecv >> request;
+
+        SyncReconcile(pfrom, request, connman);
+        LogPrint("gobject", "DNGOVERNANCERECON -- reconciled governance objects with our peer at %s\n", pfrom->addr.ToString());
+    }
+
+    // THE PEER WE RECONCILED WITH DIDN'T SEND THE VOTES OF ALL OBJECTS
+    else if (strCommand == NetMsgType::DNGOVERNANCERECONREST) {
+        std::vector<uint256> vecObjectHashes;
+        vRecv >> vecObjectHashes;
+
+        // let RequestGovernanceObjectVotes ask for the votes of these objects again
+        LOCK(cs);
+        int nCount = 0;
+        for (const auto& nHash : vecObjectHashes) {
+            nCount += mapReconciledRecently.erase(nHash);
+        }
+        LogPrint("gobject", "DNGOVERNANCERECONREST -- votes of %d objects not reconciled, peer=%d\n", nCount, pfrom->id);
+    }
+
     // A NEW GOVERNANCE OBJECT HAS ARRIVED
     else if (strCommand == NetMsgType::DNGOVERNANCEOBJECT) {
         // MAKE SURE WE HAVE A VALID REFERENCE TO THE TIP BEFORE CONTINUING
@@ -742,6 +779,94 @@ void CGovernanceManager::SyncAll(CNode* pnode, CConnman& connman) const
     LogPrintf("CGovernanceManager::%s -- sent %d objects and %d votes to peer=%d\n", __func__, nObjCount, nVoteCount, pnode->id);
 }
 
+void CGovernanceManager::SyncReconcile(CNode* pnode, const CGovernanceReconRequest& request, CConnman& connman) const
+{
+    // do not provide any data until our node is synced
+    if (!dynodeSync.IsSynced())
+        return;
+
+    // this replaces the full sync, so it shares its rate limit
+    if (netfulfilledman.HasFulfilledRequest(pnode->addr, NetMsgType::DNGOVERNANCESYNC)) {
+        LOCK(cs_main);
+        LogPrint("gobject", "CGovernanceManager::%s -- peer already asked me for the list\n", __func__);
+        Misbehaving(pnode->GetId(), 20);
+        return;
+    }
+    netfulfilledman.AddFulfilledRequest(pnode->addr, NetMsgType::DNGOVERNANCESYNC);
+
+    std::map<uint256, const CGovernanceReconSketch*> mapSketches;
+    for (const auto& sketch : request.vecSketches) {
+        if (!sketch.IsValid()) {
+            LOCK(cs_main);
+            LogPrint("gobject", "CGovernanceManager::%s -- invalid sketch for object %s, peer=%d\n", __func__, sketch.nObjectHash.ToString(), pnode->id);
+            Misbehaving(pnode->GetId(), 20);
+            return;
+        }
+        mapSketches.emplace(sketch.nObjectHash, &sketch);
+    }
+
+    int nObjCount = 0;
+    int nVoteCount = 0;
+    // objects whose differing votes didn't all fit in MAX_RECON_VOTE_INVS
+    std::vector<uint256> vecUncovered;
+
+    LogPrint("gobject", "CGovernanceManager::%s -- reconciling %d objects with peer=%d\n", __func__, mapSketches.size(), pnode->id);
+
+    LOCK2(cs_main, cs);
+
+    for (const auto& objPair : mapObjects) {
+        const uint256& nHash = objPair.first;
+        const CGovernanceObject& govobj = objPair.second;
+
+        if (govobj.IsSetCachedDelete() || govobj.IsSetExpired()) {
+            continue;
+        }
+
+        auto itSketch = mapSketches.find(nHash);
+        if (itSketch == mapSketches.end()) {
+            // peer doesn't have the object, its votes are requested once the object is accepted
+            pnode->PushInventory(CInv(MSG_GOVERNANCE_OBJECT, nHash));
+            ++nObjCount;
+            continue;
+        }
+
+        if ((size_t)nVoteCount >= MAX_RECON_VOTE_INVS) {
+            // the peer asks for the rest with the regular per-object vote requests
+            vecUncovered.push_back(nHash);
+            continue;
+        }
+
+        const CGovernanceReconSketch& sketch = *itSketch->second;
+        const CGovernanceObjectVoteFile& fileVotes = govobj.GetVoteFile();
+        std::vector<bool> vecDiffer = request.GetDifferingBuckets(sketch, fileVotes.GetVoteHashes());
+        if (std::find(vecDiffer.begin(), vecDiffer.end(), true) == vecDiffer.end()) {
+            continue;
+        }
+
+        for (const auto& vote : fileVotes.GetVotes()) {
+            uint256 nVoteHash = vote.GetHash();
+            if (!vecDiffer[request.GetBucket(sketch, nVoteHash)] || !vote.IsValid(true)) {
+                continue;
+            }
+            if ((size_t)nVoteCount >= MAX_RECON_VOTE_INVS) {
+                vecUncovered.push_back(nHash);
+                break;
+            }
+            pnode->PushInventory(CInv(MSG_GOVERNANCE_OBJECT_VOTE, nVoteHash));
+            ++nVoteCount;
+        }
+    }
+
+    CNetMsgMaker msgMaker(pnode->GetSendVersion());
+    if (!vecUncovered.empty()) {
+        LogPrint("gobject", "CGovernanceManager::%s -- votes of %d objects left out, peer=%d\n", __func__, vecUncovered.size(), pnode->id);
+        connman.PushMessage(pnode, msgMaker.Make(NetMsgType::DNGOVERNANCERECONREST, vecUncovered));
+    }
+    connman.PushMessage(pnode, msgMaker.Make(NetMsgType::SYNCSTATUSCOUNT, DYNODE_SYNC_GOVOBJ, nObjCount));
+    connman.PushMessage(pnode, msgMaker.Make(NetMsgType::SYNCSTATUSCOUNT, DYNODE_SYNC_GOVOBJ_VOTE, nVoteCount));
+    LogPrintf("CGovernanceManager::%s -- sent %d objects and %d votes to peer=%d\n", __func__, nObjCount, nVoteCount, pnode->id);
+}
+
 void CGovernanceManager::DynodeRateUpdate(const CGovernanceObject& govobj)
 {
     if (govobj.GetObjectType() != GOVERNANCE_OBJECT_TRIGGER)
@@ -1051,13 +1176,11 @@ int CGovernanceManager::RequestGovernanceObjectVotes(CNode* pnode, CConnman& con
 
 int CGovernanceManager::RequestGovernanceObjectVotes(const std::vector<CNode*>& vNodesCopy, CConnman& connman)
 {
-    static std::map<uint256, std::map<CService, int64_t> > mapAskedRecently;
-
     if (vNodesCopy.empty())
         return -1;
 
     int64_t nNow = GetTime();
-    int nTimeout = 60 * 60;
+    int nTimeout = VOTES_REQUEST_TIMEOUT;
     size_t nPeersPerHashMax = 3;
 
     std::vector<uint256> vTriggerObjHashes;
@@ -1082,6 +1205,13 @@ int CGovernanceManager::RequestGovernanceObjectVotes(const std::vector<CNode*>&
 
         for (const auto& objPair : mapObjects) {
             uint256 nHash = objPair.first;
+            auto itReconciled = mapReconciledRecently.find(nHash);
+            if (itReconciled != mapReconciledRecently.end()) {
+                // the reconciled peer sends all votes we miss, don't ask anyone else until it expires
+                if (itReconciled->second >= nNow)
+                    continue;
+                mapReconciledRecently.erase(itReconciled);
+            }
             if (mapAskedRecently.count(nHash)) {
                 auto it = mapAskedRecently[nHash].begin();
                 while (it != mapAskedRecently[nHash].end()) {
@@ -1162,6 +1292,47 @@ int CGovernanceManager::RequestGovernanceObjectVotes(const std::vector<CNode*>&
     return int(vTriggerObjHashes.size() + vOtherObjHashes.size());
 }
 
+void CGovernanceManager::RequestGovernanceReconciliation(CNode* pnode, CConnman& connman)
+{
+    CGovernanceReconRequest request;
+    request.InitKeys();
+
+    {
+        LOCK(cs);
+        request.vecSketches.reserve(mapObjects.size());
+        for (const auto& objPair : mapObjects) {
+            if (objPair.second.IsSetCachedDelete() || objPair.second.IsSetExpired()) {
+                continue;
+            }
+            request.AddObject(objPair.first, objPair.second.GetVoteFile().GetVoteHashes());
+        }
+    }
+
+    // the peer sends the votes we miss for every object in the request, or tells which ones
+    // it left out, so no other peer is asked for them in RequestGovernanceObjectVotes
+    int64_t nNow = GetTime();
+    int64_t nExpires = nNow + VOTES_REQUEST_TIMEOUT;
+    {
+        LOCK(cs);
+        for (auto it = mapReconciledRecently.begin(); it != mapReconciledRecently.end();) {
+            if (it->second < nNow) {
+                mapReconciledRecently.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+        for (const auto& sketch : request.vecSketches) {
+            mapReconciledRecently[sketch.nObjectHash] = nExpires;
+        }
+    }
+    for (const auto& sketch : request.vecSketches) {
+        mapAskedRecently[sketch.nObjectHash][pnode->addr] = nExpires;
+    }
+
+    LogPrint("gobject", "CGovernanceManager::%s -- sending %d object sketches to peer=%d\n", __func__, request.vecSketches.size(), pnode->id);
+    connman.PushMessage(pnode, CNetMsgMaker(pnode->GetSendVersion()).Make(NetMsgType::DNGOVERNANCERECON, request));
+}
+
 bool CGovernanceManager::AcceptObjectMessage(const uint256& nHash)
 {
     LOCK(cs);
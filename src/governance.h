@@ -14,6 +14,7 @@
 #include "chain.h"
 #include "governance-exceptions.h"
 #include "governance-object.h"
+#include "governance-recon.h"
 #include "governance-vote.h"
 #include "net.h"
 #include "sync.h"
@@ -227,6 +228,8 @@ private:
 
     static const int MAX_TIME_FUTURE_DEVIATION;
     static const int RELIABLE_PROPAGATION_TIME;
+    static const int VOTES_REQUEST_TIMEOUT;
+    static const size_t MAX_RECON_VOTE_INVS;
 
     int64_t nTimeLastDiff;
 
@@ -261,6 +264,13 @@ private:
 
     bool fRateChecksEnabled;
 
+    // peers already asked for (or reconciled) the votes of each object, with the time the request expires,
+    // only used from the dynode sync thread
+    std::map<uint256, std::map<CService, int64_t> > mapAskedRecently;
+    // objects whose votes were reconciled with a peer, with the time the reconciliation expires,
+    // guarded by cs
+    std::map<uint256, int64_t> mapReconciledRecently;
+
     class ScopedLockBool
     {
         bool& ref;
@@ -297,6 +307,7 @@ public:
 
     void SyncSingleObjAndItsVotes(CNode* pnode, const uint256& nProp, const CBloomFilter& filter, CConnman& connman);
     void SyncAll(CNode* pnode, CConnman& connman) const;
+    void SyncReconcile(CNode* pnode, const CGovernanceReconRequest& request, CConnman& connman) const;
 
     void ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, CConnman& connman);
 
@@ -415,6 +426,9 @@ public:
     int RequestGovernanceObjectVotes(CNode* pnode, CConnman& connman);
     int RequestGovernanceObjectVotes(const std::vector<CNode*>& vNodesCopy, CConnman& connman);
 
+    /// Ask a peer for the objects and votes we are missing by sending it a sketch of all we have
+    void RequestGovernanceReconciliation(CNode* pnode, CConnman& connman);
+
 private:
     void RequestGovernanceObject(CNode* pfrom, const uint256& nHash, CConnman& connman, bool fUseFilter = false);
 
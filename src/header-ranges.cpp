@@ -0,0 +1,194 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "header-ranges.h"
+
+#include "pow.h"
+#include "util.h"
+#include "validation.h"
+
+#include <iterator>
+
+void CHeaderRangeSync::Init(const MapCheckpoints& mapCheckpoints, int nBestHeaderHeight)
+{
+    fInitialized = true;
+    vRanges.clear();
+
+    MapCheckpoints::const_iterator it = mapCheckpoints.upper_bound(nBestHeaderHeight);
+    if (it == mapCheckpoints.end())
+        return;
+
+    std::pair<int, uint256> start = *it;
+    for (++it; it != mapCheckpoints.end(); ++it) {
+        bool fLast = std::next(it) == mapCheckpoints.end();
+        if (it->first - start.first < MIN_HEADER_RANGE_SIZE && !fLast)
+            continue;
+        if (it->first - start.first < MIN_HEADER_RANGE_SIZE && !vRanges.empty()) {
+            // fold a short last stretch into the range before it
+            vRanges.back().nEndHeight = it->first;
+            vRanges.back().hashEnd = it->second;
+        } else {
+            vRanges.emplace_back(start.first, start.second, it->first, it->second);
+        }
+        start = *it;
+    }
+
+    for (const CHeaderRange& range : vRanges) {
+        LogPrint("net", "CHeaderRangeSync::%s -- header range %d-%d\n", __func__, range.nStartHeight, range.nEndHeight);
+    }
+}
+
+CHeaderRange* CHeaderRangeSync::FindRange(NodeId nodeid)
+{
+    for (CHeaderRange& range : vRanges) {
+        if (range.nodeid == nodeid)
+            return &range;
+    }
+    return NULL;
+}
+
+const CHeaderRange* CHeaderRangeSync::GetRange(NodeId nodeid) const
+{
+    return const_cast<CHeaderRangeSync*>(this)->FindRange(nodeid);
+}
+
+const CHeaderRange* CHeaderRangeSync::Assign(NodeId nodeid, int nPeerHeight, int64_t nNow)
+{
+    if (FindRange(nodeid))
+        return NULL;
+    for (CHeaderRange& range : vRanges) {
+        if (range.nodeid == -1 && !range.IsComplete() && range.nEndHeight <= nPeerHeight) {
+            range.nodeid = nodeid;
+            range.nRequestTime = nNow;
+            return &range;
+        }
+    }
+    return NULL;
+}
+
+void CHeaderRangeSync::ReleaseRange(CHeaderRange& range)
+{
+    range.nodeid = -1;
+    // headers ending in the checkpoint are the checkpointed chain, anything
+    // short of it may be a cheap chain of made up difficulty
+    if (!range.IsComplete()) {
+        range.vHeaders.clear();
+        range.vHashes.clear();
+        range.nodeidSource = -1;
+    }
+}
+
+void CHeaderRangeSync::Release(NodeId nodeid)
+{
+    CHeaderRange* range = FindRange(nodeid);
+    if (range)
+        ReleaseRange(*range);
+}
+
+void CHeaderRangeSync::MarkRequested(NodeId nodeid, int64_t nNow)
+{
+    CHeaderRange* range = FindRange(nodeid);
+    if (range)
+        range->nRequestTime = nNow;
+}
+
+bool CHeaderRangeSync::IsRangeReply(NodeId nodeid, const uint256& hashPrevBlock) const
+{
+    const CHeaderRange* range = GetRange(nodeid);
+    return range && range->GetTipHash() == hashPrevBlock;
+}
+
+bool CHeaderRangeSync::IsDownloadingAfter(const uint256& hash) const
+{
+    for (const CHeaderRange& range : vRanges) {
+        if (range.nodeid != -1 && range.hashStart == hash)
+            return true;
+    }
+    return false;
+}
+
+CHeaderRangeSync::Result CHeaderRangeSync::AddHeaders(NodeId nodeid, const std::vector<CBlockHeader>& headers, const std::vector<uint256>& vHashes, const Consensus::Params& consensusParams, int& nDoS, std::string& strError)
+{
+    nDoS = 0;
+    CHeaderRange* range = FindRange(nodeid);
+    assert(range);
+    assert(headers.size() == vHashes.size());
+
+    // check the whole message before adding any of it
+    size_t nAdd = 0;
+    uint256 hashPrev = range->GetTipHash();
+    for (; nAdd < headers.size() && range->GetTipHeight() + (int)nAdd < range->nEndHeight; nAdd++) {
+        if (headers[nAdd].hashPrevBlock != hashPrev) {
+            nDoS = 20;
+            strError = "non-continuous headers sequence";
+        } else if (!CheckProofOfWork(vHashes[nAdd], headers[nAdd].nBits, consensusParams)) {
+            nDoS = 50;
+            strError = "proof of work failed";
+        } else if (range->GetTipHeight() + (int)nAdd + 1 == range->nEndHeight && vHashes[nAdd] != range->hashEnd) {
+            nDoS = 100;
+            strError = strprintf("header at checkpoint %d does not match", range->nEndHeight);
+        }
+        if (nDoS > 0) {
+            ReleaseRange(*range);
+            return RANGE_FAILED;
+        }
+        hashPrev = vHashes[nAdd];
+    }
+
+    range->vHeaders.insert(range->vHeaders.end(), headers.begin(), headers.begin() + nAdd);
+    range->vHashes.insert(range->vHashes.end(), vHashes.begin(), vHashes.begin() + nAdd);
+    if (nAdd > 0)
+        range->nodeidSource = nodeid;
+
+    if (range->IsComplete())
+        return RANGE_DONE;
+    if (headers.size() < MAX_HEADERS_RESULTS) {
+        // the peer ran out of headers before the end of the range
+        strError = "headers ended before the checkpoint";
+        ReleaseRange(*range);
+        return RANGE_FAILED;
+    }
+    return RANGE_CONTINUE;
+}
+
+bool CHeaderRangeSync::PopConnectable(const std::function<bool(const uint256&)>& fnKnown, std::vector<CBlockHeader>& headers, std::vector<uint256>& vHashes, NodeId& nodeidSource)
+{
+    for (std::vector<CHeaderRange>::iterator it = vRanges.begin(); it != vRanges.end();) {
+        if (fnKnown(it->hashEnd) || (fnKnown(it->hashStart) && it->vHeaders.empty() && it->nodeid == -1)) {
+            // the regular headers sync got here first
+            it = vRanges.erase(it);
+            continue;
+        }
+        if (fnKnown(it->hashStart) && !it->vHeaders.empty()) {
+            headers.swap(it->vHeaders);
+            vHashes.swap(it->vHashes);
+            it->vHeaders.clear();
+            it->vHashes.clear();
+            nodeidSource = it->nodeidSource;
+            it->nStartHeight += headers.size();
+            it->hashStart = vHashes.back();
+            if (it->nStartHeight == it->nEndHeight)
+                vRanges.erase(it);
+            return true;
+        }
+        ++it;
+    }
+    return false;
+}
+
+void CHeaderRangeSync::Reset(const std::vector<CBlockHeader>& headers, const std::vector<uint256>& vHashes)
+{
+    assert(!headers.empty() && headers.size() == vHashes.size());
+    for (CHeaderRange& range : vRanges) {
+        if (range.hashStart == vHashes.back()) {
+            range.nStartHeight -= headers.size();
+            range.hashStart = headers.front().hashPrevBlock;
+            range.nodeid = -1;
+            range.nodeidSource = -1;
+            range.vHeaders.clear();
+            range.vHashes.clear();
+            return;
+        }
+    }
+}
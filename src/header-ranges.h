@@ -0,0 +1,120 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HEADER_RANGES_H
+#define HEADER_RANGES_H
+
+#include "chainparams.h"
+#include "primitives/block.h"
+#include "uint256.h"
+
+#include <functional>
+#include <vector>
+
+typedef int NodeId;
+
+namespace Consensus
+{
+struct Params;
+}
+
+/** Checkpoints closer than this are merged into one range, it's not worth a separate peer */
+static const int MIN_HEADER_RANGE_SIZE = 2000;
+/** Time in microseconds a peer gets to answer a header range request */
+static const int64_t HEADER_RANGE_TIMEOUT = 60 * 1000000;
+
+/**
+ * Headers between two checkpoints, downloaded from one peer.
+ * The range starts right after the block hashStart and ends in the block
+ * hashEnd. Headers are linked and have their proof of work checked as they
+ * arrive, then kept until the headers before them are known. Only the claimed
+ * difficulty is checked, so the headers are dropped if the peer goes away
+ * before they reach hashEnd.
+ */
+struct CHeaderRange {
+    int nStartHeight;
+    uint256 hashStart;
+    int nEndHeight;
+    uint256 hashEnd;
+    std::vector<CBlockHeader> vHeaders;
+    std::vector<uint256> vHashes; //!< hashes of vHeaders, the header hash is expensive
+    NodeId nodeid;                //!< peer downloading the range, -1 if none
+    NodeId nodeidSource;          //!< peer that sent vHeaders, -1 if none
+    int64_t nRequestTime;         //!< when the outstanding request was sent
+
+    CHeaderRange(int nStartHeightIn, const uint256& hashStartIn, int nEndHeightIn, const uint256& hashEndIn)
+        : nStartHeight(nStartHeightIn), hashStart(hashStartIn), nEndHeight(nEndHeightIn), hashEnd(hashEndIn), nodeid(-1), nodeidSource(-1), nRequestTime(0) {}
+
+    int GetTipHeight() const { return nStartHeight + vHeaders.size(); }
+    const uint256& GetTipHash() const { return vHashes.empty() ? hashStart : vHashes.back(); }
+    bool IsComplete() const { return GetTipHeight() == nEndHeight; }
+};
+
+/**
+ * Splits initial header sync along the checkpoints, so peers other than the
+ * headers sync peer can fetch the headers further ahead at the same time.
+ * Verified ranges are handed to ProcessNewBlockHeaders once the headers
+ * before them are known; chain selection is left to it. Requires cs_main.
+ */
+class CHeaderRangeSync
+{
+public:
+    enum Result {
+        RANGE_CONTINUE, //!< headers were added, request more
+        RANGE_DONE,     //!< the range reached its end checkpoint
+        RANGE_FAILED,   //!< the peer can't help with the range, it was released
+    };
+
+private:
+    std::vector<CHeaderRange> vRanges;
+    bool fInitialized;
+
+    CHeaderRange* FindRange(NodeId nodeid);
+    /** Free a range, its headers are dropped unless they reach the end checkpoint */
+    void ReleaseRange(CHeaderRange& range);
+
+public:
+    CHeaderRangeSync() : fInitialized(false) {}
+
+    /** Set up the ranges between the checkpoints above the best known header, only done once */
+    void Init(const MapCheckpoints& mapCheckpoints, int nBestHeaderHeight);
+    bool IsInitialized() const { return fInitialized; }
+    bool IsActive() const { return !vRanges.empty(); }
+
+    /** Give the first range nobody is downloading to a peer whose chain reaches its end */
+    const CHeaderRange* Assign(NodeId nodeid, int nPeerHeight, int64_t nNow);
+    const CHeaderRange* GetRange(NodeId nodeid) const;
+    /** Free the range of a peer, the next peer starts over from hashStart unless the range is complete */
+    void Release(NodeId nodeid);
+    void MarkRequested(NodeId nodeid, int64_t nNow);
+
+    /** Whether headers building on hashPrevBlock from this peer answer its range request */
+    bool IsRangeReply(NodeId nodeid, const uint256& hashPrevBlock) const;
+    /** Whether a peer is downloading the headers following this block */
+    bool IsDownloadingAfter(const uint256& hash) const;
+
+    /**
+     * Add headers received for a peer's range, vHashes are their hashes.
+     * On failure the range is released and rolled back to hashStart,
+     * nDoS is set if the peer sent invalid headers.
+     */
+    Result AddHeaders(NodeId nodeid, const std::vector<CBlockHeader>& headers, const std::vector<uint256>& vHashes, const Consensus::Params& consensusParams, int& nDoS, std::string& strError);
+
+    /**
+     * Take the verified headers of a range that builds on a known block, fnKnown tells whether a
+     * block header is known. Ranges the regular headers sync has caught up with are dropped.
+     * nodeidSource is set to the peer that sent the headers.
+     * @return false if there is nothing to connect
+     */
+    bool PopConnectable(const std::function<bool(const uint256&)>& fnKnown, std::vector<CBlockHeader>& headers, std::vector<uint256>& vHashes, NodeId& nodeidSource);
+
+    /**
+     * Put the range back to the start of headers from PopConnectable that failed to connect,
+     * dropping the headers downloaded after them. A range they completed is gone already,
+     * its headers end in the checkpoint.
+     */
+    void Reset(const std::vector<CBlockHeader>& headers, const std::vector<uint256>& vHashes);
+};
+
+#endif // HEADER_RANGES_H
@@ -43,6 +43,7 @@
 #include "messagesigner.h"
 #include "miner/internal/miners-controller.h"
 #include "miner/miner.h"
+#include "miner/stratum.h"
 #include "net.h"
 #include "net_processing.h"
 #include "netfulfilledman.h"
@@ -63,6 +64,7 @@
 #include "spork.h"
 #include "timedata.h"
 #include "torcontrol.h"
+#include "tx-recon.h"
 #include "txdb.h"
 #include "txmempool.h"
 #include "ui_interface.h"
@@ -233,6 +235,7 @@ void Interrupt(boost::thread_group& threadGroup)
     InterruptRPC();
     InterruptREST();
     InterruptTorControl();
+    InterruptStratumServer();
     if (g_connman)
         g_connman->Interrupt();
     threadGroup.interrupt_all();
@@ -286,6 +289,7 @@ void PrepareShutdown()
     RenameThread("dynamic-shutoff");
     mempool.AddTransactionsUpdated(1);
     StopTorrentDHTNetwork();
+    StopStratumServer();
     StopHTTPRPC();
     StopREST();
     StopRPC();
@@ -492,6 +496,10 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-alerts", strprintf(_("Receive and display P2P network alerts (default: %u)"), DEFAULT_ALERTS));
     strUsage += HelpMessageOpt("-alertnotify=<cmd>", _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)"));
     strUsage += HelpMessageOpt("-blocknotify=<cmd>", _("Execute command when the best block changes (%s in cmd is replaced by block hash)"));
+    if (showDebug) {
+        strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Keep at most <n> orphaned, conflicted and evicted transactions in memory for compact block reconstruction (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
+        strUsage += HelpMessageOpt("-blockreconstructionextratxnsize=<n>", strprintf(_("Keep those transactions below <n> megabytes of memory (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN_SIZE));
+    }
     if (showDebug)
         strUsage += HelpMessageOpt("-blocksonly", strprintf(_("Whether to operate in a blocks only mode (default: %u)"), DEFAULT_BLOCKSONLY));
     strUsage += HelpMessageOpt("-checkblocks=<n>", strprintf(_("How many blocks to check at startup (default: %u, 0 = all)"), DEFAULT_CHECKBLOCKS));
@@ -558,6 +566,8 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-timeout=<n>", strprintf(_("Specify connection timeout in milliseconds (minimum: 1, default: %d)"), DEFAULT_CONNECT_TIMEOUT));
     strUsage += HelpMessageOpt("-torcontrol=<ip>:<port>", strprintf(_("Tor control port to use if onion listening enabled (default: %s)"), DEFAULT_TOR_CONTROL));
     strUsage += HelpMessageOpt("-torpassword=<pass>", _("Tor control port password (default: empty)"));
+    strUsage += HelpMessageOpt("-txreconciliation", strprintf(_("Reconcile transactions with peers that support it instead of announcing each of them (default: %u)"), DEFAULT_TXRECONCILIATION));
+    strUsage += HelpMessageOpt("-txreconfloodpeers=<n>", strprintf(_("Keep announcing every transaction to <n> reconciling outbound peers (default: %u)"), DEFAULT_TXRECON_FLOOD_PEERS));
 #ifdef USE_UPNP
 #if USE_UPNP
     strUsage += HelpMessageOpt("-upnp", _("Use UPnP to map the listening port (default: 1 when listening and no -proxy)"));
@@ -590,6 +600,9 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtxlock=<address>", _("Enable publish raw transaction (locked via InstantSend) in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawinstantsenddoublespend=<address>", _("Enable publish raw transactions of attempted InstantSend double spend in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubbdaprecord=<address>", _("Enable publish JSON of added and modified BDAP accounts in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubbdaphistory=<address>", _("Enable publish JSON of BDAP accounts with the operation that changed them in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubrawbdaprecord=<address>", _("Enable publish binary serialized BDAP accounts in <address>"));
 #endif
 
     strUsage += HelpMessageGroup(_("Debugging/Testing options:"));
@@ -610,7 +623,7 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-limitdescendantcount=<n>", strprintf("Do not accept transactions if any ancestor would have <n> or more in-mempool descendants (default: %u)", DEFAULT_DESCENDANT_LIMIT));
         strUsage += HelpMessageOpt("-limitdescendantsize=<n>", strprintf("Do not accept transactions if any ancestor would have more than <n> kilobytes of in-mempool descendants (default: %u).", DEFAULT_DESCENDANT_SIZE_LIMIT));
     }
-    std::string debugCategories = "addrman, alert, bench, cmpctblock, coindb, db, http, leveldb, libevent, lock, mempool, mempoolrej, net, proxy, prune, rand, reindex, rpc, selectcoins, tor, zmq, "
+    std::string debugCategories = "addrman, alert, bench, cmpctblock, coindb, db, http, leveldb, libevent, lock, mempool, mempoolrej, net, proxy, prune, rand, reindex, rpc, selectcoins, stratum, tor, zmq, "
                                   "dynamic (or specifically: gobject, instantsend, keepass, dynode, dnpayments, dnsync, privatesend, spork)"; // Don't translate these and qt below
     if (mode == HMM_DYNAMIC_QT)
         debugCategories += ", qt";
@@ -685,6 +698,13 @@ std::string HelpMessage(HelpMessageMode mode)
     if (showDebug)
         strUsage += HelpMessageOpt("-blockversion=<n>", "Override block version to test forking scenarios");
 
+    strUsage += HelpMessageGroup(_("Stratum server options:"));
+    strUsage += HelpMessageOpt("-stratum", strprintf(_("Serve mining jobs to Stratum workers (default: %u)"), DEFAULT_STRATUM_ENABLE));
+    strUsage += HelpMessageOpt("-stratumbind=<addr>", _("Bind to given address to listen for Stratum workers (default: 127.0.0.1)"));
+    strUsage += HelpMessageOpt("-stratumport=<port>", strprintf(_("Listen for Stratum workers on <port> (default: %u)"), DEFAULT_STRATUM_PORT));
+    strUsage += HelpMessageOpt("-stratumaddress=<addr>", _("Pay blocks found by Stratum workers to <addr> (default: a new wallet key for every block)"));
+    strUsage += HelpMessageOpt("-stratumdifficulty=<n>", strprintf(_("Minimum share difficulty of Stratum workers, 1 being the proof-of-work limit (default: %s)"), DEFAULT_STRATUM_DIFFICULTY));
+
     strUsage += HelpMessageGroup(_("RPC server options:"));
     strUsage += HelpMessageOpt("-server", _("Accept command line and JSON-RPC commands"));
     strUsage += HelpMessageOpt("-rest", strprintf(_("Accept public REST requests (default: %u)"), DEFAULT_REST_ENABLE));
@@ -1440,6 +1460,8 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     if (nScriptCheckThreads) {
         for (int i = 0; i < nScriptCheckThreads - 1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        for (int i = 0; i < nScriptCheckThreads - 1; i++)
+            threadGroup.create_thread(&ThreadBDAPCheck);
     }
 
     std::vector<std::string> vSporkAddresses;
@@ -2065,6 +2087,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
 #endif // ENABLE_WALLET
     }
 
+#ifdef ENABLE_WALLET
+    // Drain the BDAP link queue in the background after the wallet unlocks
+    scheduler.scheduleEvery(std::bind(&DoLinkQueueMaintenance), 1);
+#endif // ENABLE_WALLET
+
     // ********************************************************* Step 12: start node
 
 
@@ -2109,6 +2136,9 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
         StartMiners();
     }
 
+    if (!InitStratumServer(chainparams))
+        return InitError(_("Unable to start the Stratum server. See debug log for details."));
+
     // Start the DHT Torrent networks in the background
     const bool fMultiSessions = GetArg("-multidhtsessions", true);
     StartTorrentDHTNetwork(fMultiSessions, chainparams, connman);
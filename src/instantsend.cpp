@@ -291,7 +291,7 @@ void CInstantSend::Vote(CTxLockCandidate& txLockCandidate, CConnman& connman)
         // we haven't voted for this outpoint yet, let's try to do this now
         CTxLockVote vote(txHash, outpointLockPair.first, activeDynode.outpoint);
 
-        if (!vote.Sign()) {
+        if (!vote.Sign(activeDynode.keyDynode, activeDynode.pubKeyDynode)) {
             LogPrintf("CInstantSend::Vote -- Failed to sign consensus vote\n");
             return;
         }
@@ -766,6 +766,15 @@ void CInstantSend::AcceptLockRequest(const CTxLockRequest& txLockRequest)
     mapLockRequestAccepted.insert(std::make_pair(txLockRequest.GetHash(), txLockRequest));
 }
 
+void CInstantSend::ForEachAcceptedLockRequest(const std::function<bool(const CTransactionRef&)>& fn) const
+{
+    LOCK(cs_instantsend);
+    for (const auto& pair : mapLockRequestAccepted) {
+        if (!fn(pair.second.tx))
+            return;
+    }
+}
+
 void CInstantSend::RejectLockRequest(const CTxLockRequest& txLockRequest)
 {
     LOCK(cs_instantsend);
@@ -1130,31 +1139,31 @@ bool CTxLockVote::CheckSignature() const
     return true;
 }
 
-bool CTxLockVote::Sign()
+bool CTxLockVote::Sign(const CKey& keyDynode, const CPubKey& pubKeyDynode)
 {
     std::string strError;
 
     if (sporkManager.IsSporkActive(SPORK_6_NEW_SIGS)) {
         uint256 hash = GetSignatureHash();
 
-        if (!CHashSigner::SignHash(hash, activeDynode.keyDynode, vchDynodeSignature)) {
+        if (!CHashSigner::SignHash(hash, keyDynode, vchDynodeSignature)) {
             LogPrintf("CTxLockVote::Sign -- SignHash() failed\n");
             return false;
         }
 
-        if (!CHashSigner::VerifyHash(hash, activeDynode.pubKeyDynode, vchDynodeSignature, strError)) {
+        if (!CHashSigner::VerifyHash(hash, pubKeyDynode, vchDynodeSignature, strError)) {
             LogPrintf("CTxLockVote::Sign -- VerifyHash() failed, error: %s\n", strError);
             return false;
         }
     } else {
         std::string strMessage = txHash.ToString() + outpoint.ToStringShort();
 
-        if (!CMessageSigner::SignMessage(strMessage, vchDynodeSignature, activeDynode.keyDynode)) {
+        if (!CMessageSigner::SignMessage(strMessage, vchDynodeSignature, keyDynode)) {
             LogPrintf("CTxLockVote::Sign -- SignMessage() failed\n");
             return false;
         }
 
-        if (!CMessageSigner::VerifyMessage(activeDynode.pubKeyDynode, vchDynodeSignature, strMessage, strError)) {
+        if (!CMessageSigner::VerifyMessage(pubKeyDynode, vchDynodeSignature, strMessage, strError)) {
             LogPrintf("CTxLockVote::Sign -- VerifyMessage() failed, error: %s\n", strError);
             return false;
         }
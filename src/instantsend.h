@@ -7,9 +7,12 @@
 #define INSTANTSEND_H
 
 #include "chain.h"
+#include "key.h"
 #include "net.h"
 #include "primitives/transaction.h"
 
+#include <functional>
+
 class CTxLockVote;
 class COutPointLock;
 class CTxLockRequest;
@@ -129,6 +132,9 @@ public:
     void RejectLockRequest(const CTxLockRequest& txLockRequest);
     bool HasTxLockRequest(const uint256& txHash);
     bool GetTxLockRequest(const uint256& txHash, CTxLockRequest& txLockRequestRet);
+    /// Call fn with the transaction of every accepted lock request until it returns false,
+    /// these stay known after the transaction left the mempool
+    void ForEachAcceptedLockRequest(const std::function<bool(const CTransactionRef&)>& fn) const;
 
     bool GetTxLockVote(const uint256& hash, CTxLockVote& txLockVoteRet);
 
@@ -285,7 +291,7 @@ public:
     bool IsTimedOut() const;
     bool IsFailed() const;
 
-    bool Sign();
+    bool Sign(const CKey& keyDynode, const CPubKey& pubKeyDynode);
     bool CheckSignature() const;
 
     void Relay(CConnman& connman) const;
@@ -21,7 +21,7 @@ int64_t CPUMiner::TryMineBlock(CBlock& block)
         }
         block.nNonce += 1;
         hashes_done += 1;
-        if ((block.nNonce & 0xFF) == 0)
+        if ((block.nNonce & 0xFF) == 0 || IsWorkStale())
             break;
     }
     return hashes_done;
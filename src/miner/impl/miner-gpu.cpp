@@ -32,6 +32,8 @@ int64_t GPUMiner::TryMineBlock(CBlock& block)
     //Increase nNonce for the next batch
     block.nNonce += _batch_size_target;
 
+    // A solution found after the template was recreated is still submitted,
+    // ProcessBlockFound only drops it if it doesn't build on the active tip
     std::uint32_t result_nonce = _processing_unit.scanNonces(input, start_nonce, device_target);
 
     if ( result_nonce < std::numeric_limits<uint32_t>::max()){
@@ -1,4 +1,3 @@
-
 // Copyright (c) 2019 Duality Blockchain Solutions Developers
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
@@ -6,33 +5,218 @@
 #include "miner/internal/hash-rate-counter.h"
 #include "utiltime.h"
 
+#include <algorithm>
 
-void HashRateCounter::Increment(int64_t amount)
+constexpr int64_t HashRateBuckets::BUCKET_MILLIS;
+constexpr size_t HashRateBuckets::BUCKETS;
+constexpr size_t HashRateBuckets::WINDOWS;
+constexpr int64_t HashRateBuckets::WINDOW_MILLIS[];
+
+using HashRateSample = std::pair<std::array<int64_t, HashRateBuckets::WINDOWS>, int64_t>;
+
+static void AddStart(int64_t& start, int64_t other)
 {
-    // Set start time if not set and return
-    if (_timer_start == 0) {
-        Reset();
-        return;
+    if (other != 0)
+        start = start == 0 ? other : std::min(start, other);
+}
+
+void HashRateBuckets::Add(int64_t now, int64_t amount)
+{
+    int64_t slot = now / BUCKET_MILLIS;
+    size_t index = slot % BUCKETS;
+    if (_slots[index].load(std::memory_order_relaxed) != slot) {
+        // bucket is out of the windows, start it over
+        _counts[index].store(0, std::memory_order_relaxed);
+        _slots[index].store(slot, std::memory_order_relaxed);
     }
-    // Increment hashes done
-    _count += amount;
+    _counts[index].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void HashRateBuckets::Merge(const HashRateBuckets& other)
+{
+    for (size_t index = 0; index < BUCKETS; index++) {
+        // buckets out of the windows are skipped when summed
+        int64_t slot = other._slots[index].load(std::memory_order_relaxed);
+        if (slot == 0)
+            continue;
+        int64_t ours = _slots[index].load(std::memory_order_relaxed);
+        if (ours > slot)
+            continue;
+        if (ours < slot) {
+            _counts[index].store(0, std::memory_order_relaxed);
+            _slots[index].store(slot, std::memory_order_relaxed);
+        }
+        _counts[index].fetch_add(other._counts[index].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void HashRateBuckets::Sum(int64_t now, std::array<int64_t, WINDOWS>& hashes) const
+{
+    int64_t current = now / BUCKET_MILLIS;
+    for (size_t index = 0; index < BUCKETS; index++) {
+        int64_t slot = _slots[index].load(std::memory_order_relaxed);
+        if (slot == 0 || slot > current)
+            continue;
+        int64_t count = _counts[index].load(std::memory_order_relaxed);
+        for (size_t window = 0; window < WINDOWS; window++) {
+            if ((current - slot) * BUCKET_MILLIS < WINDOW_MILLIS[window])
+                hashes[window] += count;
+        }
+    }
+}
+
+void HashRateBuckets::Clear()
+{
+    for (size_t index = 0; index < BUCKETS; index++) {
+        _slots[index].store(0, std::memory_order_relaxed);
+        _counts[index].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Converts hashes done in the windows to rates, a window is cut short if hashing started later
+static HashRates ToRates(const HashRateSample& sample, int64_t now)
+{
+    HashRates rates;
+    if (sample.second == 0)
+        return rates;
+    int64_t result[HashRateBuckets::WINDOWS];
+    for (size_t window = 0; window < HashRateBuckets::WINDOWS; window++) {
+        // the windows end with the current, partly filled, bucket
+        int64_t span = HashRateBuckets::WINDOW_MILLIS[window] - HashRateBuckets::BUCKET_MILLIS + now % HashRateBuckets::BUCKET_MILLIS;
+        span = std::max(std::min(span, now - sample.second), (int64_t)1000);
+        result[window] = 1000.0 * sample.first[window] / span;
+    }
+    rates.last_1m = result[0];
+    rates.last_5m = result[1];
+    rates.last_15m = result[2];
+    return rates;
+}
+
+HashRateCounter::~HashRateCounter()
+{
     if (_parent) {
-        _parent->Increment(amount);
+        _parent->Retire(*this);
+    }
+}
+
+HashRateCounterRef HashRateCounter::MakeChild()
+{
+    HashRateCounterRef child = std::make_shared<HashRateCounter>(shared_from_this());
+    boost::lock_guard<boost::mutex> guard(_mutex);
+    _children.erase(std::remove_if(_children.begin(), _children.end(), [](const std::weak_ptr<HashRateCounter>& ref) { return ref.expired(); }), _children.end());
+    _children.push_back(child);
+    return child;
+}
+
+void HashRateCounter::Retire(const HashRateCounter& child)
+{
+    boost::lock_guard<boost::mutex> guard(_mutex);
+    if (child._start != 0) {
+        _retired[child._device].Merge(child._buckets);
+        AddStart(_retired_start, child._start);
     }
-    // Ignore until at least 4 seconds passed
-    if (GetTimeMillis() - _timer_start < 4000) {
-        return;
+    boost::lock_guard<boost::mutex> child_guard(child._mutex);
+    for (const auto& retired : child._retired) {
+        _retired[retired.first].Merge(retired.second);
     }
-    // Set count per second
-    _count_per_sec = 1000.0 * _count / (GetTimeMillis() - _timer_start);
-    // Reset timer and count
-    _count = 0;
-    _timer_start = GetTimeMillis();
+    AddStart(_retired_start, child._retired_start);
+}
+
+void HashRateCounter::Collect(int64_t now, std::map<int, HashRateSample>& devices) const
+{
+    if (_start != 0) {
+        HashRateSample& sample = devices[_device];
+        _buckets.Sum(now, sample.first);
+        AddStart(sample.second, _start);
+    }
+
+    std::vector<HashRateCounterRef> children;
+    {
+        boost::lock_guard<boost::mutex> guard(_mutex);
+        for (const auto& retired : _retired) {
+            HashRateSample& sample = devices[retired.first];
+            retired.second.Sum(now, sample.first);
+            AddStart(sample.second, _retired_start);
+        }
+        for (const auto& ref : _children) {
+            if (HashRateCounterRef child = ref.lock())
+                children.push_back(child);
+        }
+    }
+    // children are summed without our lock, a child released here retires into us
+    for (const auto& child : children) {
+        child->Collect(now, devices);
+    }
+}
+
+void HashRateCounter::Increment(int64_t amount)
+{
+    Increment(amount, GetTimeMillis());
+}
+
+void HashRateCounter::Increment(int64_t amount, int64_t now)
+{
+    // Only this counter's own buckets are written, parents read them when asked
+    if (_start == 0) {
+        _start = now;
+    }
+    _buckets.Add(now, amount);
 }
 
 void HashRateCounter::Reset()
 {
-    _count = 0;
-    _count_per_sec = 0;
-    _timer_start = GetTimeMillis();
+    _start = 0;
+    _buckets.Clear();
+
+    std::vector<HashRateCounterRef> children;
+    {
+        boost::lock_guard<boost::mutex> guard(_mutex);
+        _retired.clear();
+        _retired_start = 0;
+        for (const auto& ref : _children) {
+            if (HashRateCounterRef child = ref.lock())
+                children.push_back(child);
+        }
+    }
+    for (const auto& child : children) {
+        child->Reset();
+    }
+}
+
+HashRates HashRateCounter::GetRates() const
+{
+    return GetRates(GetTimeMillis());
+}
+
+HashRates HashRateCounter::GetRates(int64_t now) const
+{
+    std::map<int, HashRateSample> devices;
+    Collect(now, devices);
+    // sum up all devices
+    HashRateSample total{};
+    for (const auto& device : devices) {
+        for (size_t window = 0; window < HashRateBuckets::WINDOWS; window++) {
+            total.first[window] += device.second.first[window];
+        }
+        AddStart(total.second, device.second.second);
+    }
+    return ToRates(total, now);
+}
+
+std::map<int, HashRates> HashRateCounter::GetDeviceRates() const
+{
+    return GetDeviceRates(GetTimeMillis());
+}
+
+std::map<int, HashRates> HashRateCounter::GetDeviceRates(int64_t now) const
+{
+    std::map<int, HashRateSample> devices;
+    Collect(now, devices);
+    std::map<int, HashRates> rates;
+    for (const auto& device : devices) {
+        if (device.first >= 0) {
+            rates[device.first] = ToRates(device.second, now);
+        }
+    }
+    return rates;
 }
@@ -5,42 +5,120 @@
 #ifndef DYNAMIC_INTERNAL_HASH_RATE_COUNTER_H
 #define DYNAMIC_INTERNAL_HASH_RATE_COUNTER_H
 
+#include <array>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <vector>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 
 
 struct HashRateCounter;
 using HashRateCounterRef = std::shared_ptr<HashRateCounter>;
 
+/**
+ * Hashes per second averaged over sliding windows.
+ */
+struct HashRates {
+    int64_t last_1m = 0;
+    int64_t last_5m = 0;
+    int64_t last_15m = 0;
+};
+
+/**
+ * Hashes done over the last 15 minutes, in buckets of a few seconds.
+ * Written by one thread at a time, read by any.
+ */
+class HashRateBuckets
+{
+public:
+    static constexpr int64_t BUCKET_MILLIS = 5000;
+    static constexpr size_t BUCKETS = 15 * 60 * 1000 / BUCKET_MILLIS;
+    static constexpr size_t WINDOWS = 3;
+    static constexpr int64_t WINDOW_MILLIS[WINDOWS] = {60 * 1000, 5 * 60 * 1000, 15 * 60 * 1000};
+
+    // Adds hashes done at time in milliseconds
+    void Add(int64_t now, int64_t amount);
+
+    // Adds hashes of other buckets, where they are not older than ours
+    void Merge(const HashRateBuckets& other);
+
+    // Adds hashes done in each window up to now
+    void Sum(int64_t now, std::array<int64_t, WINDOWS>& hashes) const;
+
+    // Forgets all hashes
+    void Clear();
+
+private:
+    // index of bucket since epoch, a bucket is reused once it's out of the windows
+    std::array<std::atomic<int64_t>, BUCKETS> _slots{};
+    std::array<std::atomic<int64_t>, BUCKETS> _counts{};
+};
+
 /**
  * Hash rate counter struct.
+ *
+ * Every miner thread increments a counter of its own, the counters of
+ * groups and the controller only sum their children when rates are read.
+ * When a thread stops its hashes are kept by the parent until they fall
+ * out of the windows.
  */
 struct HashRateCounter : public std::enable_shared_from_this<HashRateCounter> {
 private:
-    std::atomic<int64_t> _count{0};
-    std::atomic<int64_t> _timer_start{0};
-    std::atomic<int64_t> _count_per_sec{0};
+    // time in milliseconds of the first hashes since reset
+    std::atomic<int64_t> _start{0};
+    // device the hashes are done on, -1 for groups
+    std::atomic<int> _device{-1};
+    // hashes done by this counter
+    HashRateBuckets _buckets;
 
     HashRateCounterRef _parent;
+    std::vector<std::weak_ptr<HashRateCounter> > _children;
+    // hashes of stopped children by device, and when the first of them started
+    std::map<int, HashRateBuckets> _retired;
+    int64_t _retired_start{0};
+    // mutex protecting children and retired hashes
+    mutable boost::mutex _mutex;
+
+    // Hashes done in the windows and start time by device, of this counter and its children
+    void Collect(int64_t now, std::map<int, std::pair<std::array<int64_t, HashRateBuckets::WINDOWS>, int64_t> >& devices) const;
+
+    // Keeps hashes of a stopped child
+    void Retire(const HashRateCounter& child);
 
 public:
     explicit HashRateCounter() : _parent(nullptr){};
     explicit HashRateCounter(HashRateCounterRef parent) : _parent(parent){};
+    ~HashRateCounter();
 
-    // Returns hash rate per second
-    operator int64_t() { return _count_per_sec; };
+    // Returns hash rate per second over the last minute
+    operator int64_t() const { return GetRates().last_1m; };
 
     // Creates new child counter
-    HashRateCounterRef MakeChild() { return std::make_shared<HashRateCounter>(shared_from_this()); }
+    HashRateCounterRef MakeChild();
+
+    // Sets device the hashes are done on
+    void set_device(int device) { _device = device; }
 
-    // Increments counter
+    // Increments counter, only called by the thread owning it
     void Increment(int64_t amount);
+    void Increment(int64_t amount, int64_t now);
 
-    // Resets counter and timer
+    // Resets counter and its children
     void Reset();
 
+    // Returns hash rates of this counter and its children
+    HashRates GetRates() const;
+    HashRates GetRates(int64_t now) const;
+
+    // Returns hash rates by device
+    std::map<int, HashRates> GetDeviceRates() const;
+    std::map<int, HashRates> GetDeviceRates(int64_t now) const;
+
     // Returns start time
-    int64_t start() const { return _timer_start; };
+    int64_t start() const { return _start; };
 };
 
 #endif // DYNAMIC_INTERNAL_HASH_RATE_COUNTER_H
@@ -28,8 +28,15 @@ MinerBase::MinerBase(MinerContextRef ctx, std::size_t device_index)
     if (!_coinbase_script || _coinbase_script->reserveScript.empty()) {
         throw std::runtime_error("No coinbase script available (mining requires a wallet)");
     }
+    _extra_nonce_slot = _ctx->shared->AcquireExtraNonceSlot();
+    _ctx->counter->set_device(_device_index);
 };
 
+MinerBase::~MinerBase()
+{
+    _ctx->shared->ReleaseExtraNonceSlot(_extra_nonce_slot);
+}
+
 void MinerBase::Loop()
 {
     LogPrintf("DynamicMiner -- started on %s#%d\n", DeviceName(), _device_index);
@@ -38,31 +45,34 @@ void MinerBase::Loop()
 
     CBlock block;
     CBlockIndex* chain_tip = nullptr;
-    int64_t block_time = 0;
     std::shared_ptr<CBlockTemplate> block_template = {nullptr};
+    _work_generation = _ctx->shared->work_generation() - 1;
 
     try {
         while (true) {
             // Update block and tip if changed
-            if (block_time != _ctx->shared->block_time()) {
-                // set new block template
-                block_template = _ctx->shared->block_template();
+            if (IsWorkStale()) {
+                // set new block template and its generation
+                // waits for RecreateBlock
+                block_template = _ctx->shared->block_template(_work_generation);
                 block = block_template->block;
                 // set block reserve script
                 SetBlockPubkeyScript(block, _coinbase_script->reserveScript);
-                // set block flag only after template
-                // so we've waited for RecreateBlock
-                block_time = _ctx->shared->block_time();
                 // block template chain tip
                 chain_tip = _ctx->shared->tip();
+                // start over at the beginning of our extranonce range
+                _extra_nonce = _extra_nonce_slot * EXTRANONCE_RANGE;
+                LogPrintf("DynamicMiner -- Running miner on device %s#%d with %u transactions in block\n", DeviceName(), _device_index, block.vtx.size());
             }
             // Make sure we have a tip
             assert(chain_tip != nullptr);
             assert(block_template != nullptr);
-            // Increment nonce
-            IncrementExtraNonce(block, chain_tip, _extra_nonce);
-            LogPrintf("DynamicMiner -- Running miner on device %s#%d with %u transactions in block (%u bytes)\n", DeviceName(), _device_index, block.vtx.size(),
-                GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+            // Increment nonce, wrapping around within our range
+            if (_extra_nonce + 1 == (_extra_nonce_slot + 1) * EXTRANONCE_RANGE) {
+                _extra_nonce = _extra_nonce_slot * EXTRANONCE_RANGE;
+            }
+            IncrementExtraNonce(block, chain_tip, _extra_nonce, block_template->vCoinbaseMerkleBranch);
+            block.nNonce = 0;
             // set loop start for counter
             _hash_target = arith_uint256().SetCompact(block.nBits);
             // start mining the block
@@ -73,8 +83,9 @@ void MinerBase::Loop()
                 _ctx->counter->Increment(hashes);
                 // Check for stop or if block needs to be rebuilt
                 boost::this_thread::interruption_point();
-                // Check if block was recreated
-                if (block_time != _ctx->shared->block_time()) {
+                // Check if block was superseded
+                if (IsWorkStale()) {
+                    _ctx->shared->RecordStaleWork(GetTimeMicros() - _ctx->shared->work_superseded_time());
                     break;
                 }
                 // Recreate block if nonce too big
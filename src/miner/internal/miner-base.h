@@ -20,7 +20,7 @@ class MinerBase
 {
 public:
     MinerBase(MinerContextRef ctx, std::size_t device_index);
-    virtual ~MinerBase() = default;
+    virtual ~MinerBase();
 
     // Starts miner loop
     void Loop();
@@ -36,18 +36,29 @@ protected:
     void ProcessFoundSolution(const CBlock& block, const uint256& hash);
 
     // tries to mine a block
+    // returns early once the work is stale
     virtual int64_t TryMineBlock(CBlock& block) = 0;
 
+    // Returns true if the block being mined was superseded,
+    // cheap enough to be called between hashes
+    bool IsWorkStale() const { return _ctx->shared->work_generation() != _work_generation; }
+
     // Solution must be lower or equal to
     arith_uint256 _hash_target = 0;
 
     // Miner context
     MinerContextRef _ctx;
 
+    // Work generation of the block being mined
+    uint64_t _work_generation = 0;
+
 private:
     // Miner device index
     std::size_t _device_index;
 
+    // Extranonce range of this thread, disjoint from other threads
+    unsigned int _extra_nonce_slot;
+
     // Extra block nonce
     unsigned int _extra_nonce = 0;
 
@@ -4,7 +4,9 @@
 
 #include "miner/internal/miner-context.h"
 #include "miner/miner-util.h"
+#include "tinyformat.h"
 #include "txmempool.h"
+#include "utiltime.h"
 #include "validation.h"
 
 MinerContext::MinerContext(const CChainParams& chainparams_, CConnman& connman_)
@@ -14,6 +16,24 @@ MinerContext::MinerContext(const CChainParams& chainparams_, CConnman& connman_)
 MinerContext::MinerContext(MinerSharedContextRef shared_, HashRateCounterRef counter_)
     : counter(counter_), shared(shared_){};
 
+unsigned int MinerSharedContext::AcquireExtraNonceSlot()
+{
+    boost::lock_guard<boost::mutex> guard(_slots_mutex);
+    for (unsigned int slot = 0; slot < MAX_EXTRANONCE_SLOTS; slot++) {
+        if (!_extra_nonce_slots.test(slot)) {
+            _extra_nonce_slots.set(slot);
+            return slot;
+        }
+    }
+    throw std::runtime_error(tfm::format("No extranonce range left, at most %u miner threads can run", MAX_EXTRANONCE_SLOTS));
+}
+
+void MinerSharedContext::ReleaseExtraNonceSlot(unsigned int slot)
+{
+    boost::lock_guard<boost::mutex> guard(_slots_mutex);
+    _extra_nonce_slots.reset(slot);
+}
+
 void MinerSharedContext::RecreateBlock()
 {
     // Then we acquire unique lock so that miners wait
@@ -23,8 +43,32 @@ void MinerSharedContext::RecreateBlock()
     // pass if nothing changed
     if (_chain_tip == chainActive.Tip() && _last_txn == txn_time)
         return;
+    // Work on an old tip is worthless, stop hashing it right away
+    // and let miners wait for the new block template
+    bool fNewTip = _chain_tip != chainActive.Tip();
+    if (fNewTip)
+        InvalidateWork();
     _chain_tip = chainActive.Tip();
     _block_time = GetTime();
     _block_template = CreateNewBlock(chainparams);
     _last_txn = txn_time;
+    // otherwise miners pick up the new template within one hash
+    if (!fNewTip)
+        InvalidateWork();
+}
+
+void MinerSharedContext::InvalidateWork()
+{
+    _work_superseded_time = GetTimeMicros();
+    _work_generation++;
+}
+
+void MinerSharedContext::RecordStaleWork(int64_t micros)
+{
+    _stale_work_switches++;
+    _stale_work_last = micros;
+    _stale_work_total += micros;
+    int64_t max = _stale_work_max;
+    while (micros > max && !_stale_work_max.compare_exchange_weak(max, micros)) {
+    }
 }
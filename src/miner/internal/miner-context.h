@@ -8,9 +8,11 @@
 #include "miner/internal/hash-rate-counter.h"
 
 #include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 #include <atomic>
+#include <bitset>
 
 class CBlock;
 class CChainParams;
@@ -26,6 +28,13 @@ class MinersController;
 /** Miner context shared_ptr */
 using MinerContextRef = std::shared_ptr<MinerContext>;
 
+/** Extranonce bits that select the range of a miner thread */
+static const unsigned int EXTRANONCE_SLOT_BITS = 10;
+/** Maximum number of miner threads with a range of their own */
+static const unsigned int MAX_EXTRANONCE_SLOTS = 1 << EXTRANONCE_SLOT_BITS;
+/** Extranonces a miner thread may use on one block template */
+static const unsigned int EXTRANONCE_RANGE = 1 << (32 - EXTRANONCE_SLOT_BITS);
+
 struct MinerSharedContext {
 public:
     const CChainParams& chainparams;
@@ -43,6 +52,19 @@ public:
     // Returns time of last transaction in the block
     uint32_t last_txn() const { return _last_txn; }
 
+    // Returns generation of miner work, changed whenever the current work is superseded
+    uint64_t work_generation() const { return _work_generation.load(std::memory_order_relaxed); }
+
+    // Returns time in microseconds the current work generation started
+    int64_t work_superseded_time() const { return _work_superseded_time; }
+
+    // Returns stale work statistics: switches to new work and the time
+    // in microseconds miner threads kept hashing superseded work
+    uint64_t stale_work_switches() const { return _stale_work_switches; }
+    int64_t stale_work_last() const { return _stale_work_last; }
+    int64_t stale_work_total() const { return _stale_work_total; }
+    int64_t stale_work_max() const { return _stale_work_max; }
+
     // Returns miner block template
     std::shared_ptr<CBlockTemplate> block_template()
     {
@@ -50,6 +72,22 @@ public:
         return _block_template;
     }
 
+    // Returns miner block template and the work generation it belongs to,
+    // waits while the block template is being recreated
+    std::shared_ptr<CBlockTemplate> block_template(uint64_t& generation)
+    {
+        boost::shared_lock<boost::shared_mutex> guard(_mutex);
+        generation = _work_generation;
+        return _block_template;
+    }
+
+    // Reserves an extranonce range no other miner thread is using
+    // Throws if all of them are taken
+    unsigned int AcquireExtraNonceSlot();
+
+    // Returns the extranonce range of a stopped miner thread
+    void ReleaseExtraNonceSlot(unsigned int slot);
+
 protected:
     friend class MinerBase;
     friend class MinerSignals;
@@ -58,6 +96,13 @@ protected:
     // recreates miners block template
     void RecreateBlock();
 
+    // Tells miner threads to drop their current work,
+    // requires the unique lock on _mutex
+    void InvalidateWork();
+
+    // Records time a miner thread kept hashing superseded work
+    void RecordStaleWork(int64_t micros);
+
 private:
     // current block chain tip
     std::atomic<CBlockIndex*> _chain_tip{nullptr};
@@ -65,10 +110,23 @@ private:
     std::atomic<int64_t> _block_time{0};
     // last transaction update time
     std::atomic<uint32_t> _last_txn{0};
+    // incremented once per block template, under the unique lock on _mutex
+    std::atomic<uint64_t> _work_generation{0};
+    // time in microseconds of last work generation change
+    std::atomic<int64_t> _work_superseded_time{0};
+    // stale work statistics
+    std::atomic<uint64_t> _stale_work_switches{0};
+    std::atomic<int64_t> _stale_work_last{0};
+    std::atomic<int64_t> _stale_work_total{0};
+    std::atomic<int64_t> _stale_work_max{0};
     // shared block template for miners
     std::shared_ptr<CBlockTemplate> _block_template{nullptr};
     // mutex protecting multiple threads recreating block
     mutable boost::shared_mutex _mutex;
+    // extranonce ranges of running miner threads
+    std::bitset<MAX_EXTRANONCE_SLOTS> _extra_nonce_slots;
+    // mutex protecting extranonce ranges
+    boost::mutex _slots_mutex;
 };
 
 using MinerSharedContextRef = std::shared_ptr<MinerSharedContext>;
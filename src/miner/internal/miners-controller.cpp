@@ -81,7 +81,8 @@ void MinerSignals::NotifyBlock(const CBlockIndex* index_new, const CBlockIndex*
     // Compare with current tip (checks for unexpected behaviour or old block)
     if (index_new != chainActive.Tip())
         return;
-    // Create new block template for miners
+    // Create new block template for miners, this stops
+    // hashing on the old tip before CreateNewBlock runs
     _ctr->_ctx->shared->RecreateBlock();
     // start miners
     if (_ctr->can_start()) {
@@ -44,9 +44,15 @@ public:
     // Gets combined hash rate of GPU and CPU
     int64_t GetHashRate() const;
 
+    // Gets combined 1, 5 and 15 minute hash rates of GPU and CPU
+    HashRates GetHashRates() const { return _ctx->counter->GetRates(); }
+
     // Returns CPU miners thread group
     MinersThreadGroup<CPUMiner>& group_cpu() { return _group_cpu; }
 
+    // Returns shared miner context
+    MinerContextRef ctx() const { return _ctx; }
+
 #ifdef ENABLE_GPU
     // Returns GPU miners thread group
     MinersThreadGroup<GPUMiner>& group_gpu()
@@ -56,9 +62,6 @@ public:
 #endif // ENABLE_GPU
 
 protected:
-    // Returns shared miner context
-    MinerContextRef ctx() const { return _ctx; }
-
     // Starts miner only if can
     void StartIfEnabled();
 
@@ -43,6 +43,12 @@ public:
 
     // Gets hash rate of all threads in the group
     int64_t GetHashRate() const { return *this->_ctx->counter; };
+
+    // Gets 1, 5 and 15 minute hash rates of all threads in the group
+    HashRates GetHashRates() const { return this->_ctx->counter->GetRates(); };
+
+    // Gets hash rates of the group by device
+    std::map<int, HashRates> GetDeviceHashRates() const { return this->_ctx->counter->GetDeviceRates(); };
 };
 
 
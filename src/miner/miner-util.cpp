@@ -24,7 +24,7 @@
 #include "validation.h"
 #include "wallet/wallet.h"
 
-#include <queue>
+#include <algorithm>
 
 bool ProcessBlockFound(const CBlock& block, const CChainParams& chainparams)
 {
@@ -67,17 +67,6 @@ int64_t UpdateTime(CBlockHeader& block, const Consensus::Params& cparams, const
     return new_time - old_time;
 }
 
-class ScoreCompare
-{
-public:
-    ScoreCompare() {}
-
-    bool operator()(const CTxMemPool::txiter a, const CTxMemPool::txiter b)
-    {
-        return CompareTxMemPoolEntryByScore()(*b, *a); // Convert to less than
-    }
-};
-
 // Unconfirmed transactions in the memory pool often depend on other
 // transactions in the memory pool. When we select transactions from the
 // pool, we select by highest priority or fee rate, so we might consider
@@ -85,193 +74,372 @@ public:
 uint64_t nLastBlockTx = 0;
 uint64_t nLastBlockSize = 0;
 
-std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn)
-{
-    // Create new block
-    std::unique_ptr<CBlockTemplate> pblocktemplate(new CBlockTemplate());
-    CBlock& block = pblocktemplate->block; // pointer for convenience
-
-    // Create coinbase tx with fluid issuance
-    // TODO: Can this be made any more elegant?
-    CMutableTransaction txNew;
-    txNew.vin.resize(1);
-    txNew.vin[0].prevout.SetNull();
-    txNew.vout.resize(1);
+// Give up on filling the last bytes of a block after this many packages in a row didn't fit
+static const int MAX_CONSECUTIVE_FAILURES = 1000;
 
+BlockAssembler::BlockAssembler(CTxMemPool& mempoolIn, CBlockTemplate& blocktemplateIn, int nHeightIn, int64_t nLockTimeCutoffIn)
+    : mempool(mempoolIn), blocktemplate(blocktemplateIn), nHeight(nHeightIn), nLockTimeCutoff(nLockTimeCutoffIn)
+{
     // Largest block you're willing to create:
-    unsigned int nBlockMaxSize = GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
+    nBlockMaxSize = GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
     // Limit to between 1K and MAX_BLOCK_SIZE-1K for sanity:
     nBlockMaxSize = std::max((unsigned int)1000, std::min((unsigned int)(MAX_BLOCK_SIZE - 1000), nBlockMaxSize));
 
     // How much of the block should be dedicated to high-priority transactions,
     // included regardless of the fees they pay
-    unsigned int nBlockPrioritySize = GetArg("-blockprioritysize", DEFAULT_BLOCK_PRIORITY_SIZE);
+    nBlockPrioritySize = GetArg("-blockprioritysize", DEFAULT_BLOCK_PRIORITY_SIZE);
     nBlockPrioritySize = std::min(nBlockMaxSize, nBlockPrioritySize);
 
     // Minimum block size you want to create; block will be filled with free transactions
     // until there are no more or the block reaches this size:
-    unsigned int nBlockMinSize = GetArg("-blockminsize", DEFAULT_BLOCK_MIN_SIZE);
+    nBlockMinSize = GetArg("-blockminsize", DEFAULT_BLOCK_MIN_SIZE);
     nBlockMinSize = std::min(nBlockMaxSize, nBlockMinSize);
 
-    // Collect memory pool transactions into the block
-    CTxMemPool::setEntries inBlock;
-    CTxMemPool::setEntries waitSet;
+    fPrintPriority = GetBoolArg("-printpriority", DEFAULT_PRINTPRIORITY);
+
+    // Reserve space for coinbase tx
+    nBlockSize = 1000;
+    nBlockTx = 0;
+    nBlockSigOps = 100;
+    nFees = 0;
+    nPackagesSelected = 0;
+}
+
+void BlockAssembler::AddTransactions()
+{
+    AddPriorityTxs();
+    AddPackageTxs();
+}
+
+void BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
+{
+    blocktemplate.block.vtx.emplace_back(iter->GetSharedTx());
+    blocktemplate.vTxFees.push_back(iter->GetFee());
+    blocktemplate.vTxSigOps.push_back(iter->GetSigOpCount());
+    nBlockSize += iter->GetTxSize();
+    ++nBlockTx;
+    nBlockSigOps += iter->GetSigOpCount();
+    nFees += iter->GetFee();
+    inBlock.insert(iter);
+
+    if (fPrintPriority) {
+        double dPriority = iter->GetPriority(nHeight);
+        CAmount dummy;
+        mempool.ApplyDeltas(iter->GetTx().GetHash(), dPriority, dummy);
+        LogPrintf("priority %.1f fee %s txid %s\n", dPriority, CFeeRate(iter->GetModifiedFee(), iter->GetTxSize()).ToString(),
+            iter->GetTx().GetHash().ToString());
+    }
+}
+
+void BlockAssembler::AddPriorityTxs()
+{
+    // No transaction fits if the priority area is filled by the coinbase reservation
+    if (nBlockPrioritySize <= nBlockSize)
+        return;
 
-    // This vector will be sorted into a priority queue:
+    // This vector will be sorted into a priority queue. Transactions that don't
+    // qualify as free would end the priority area anyway, so they are left to
+    // the fee rate selection instead of being sorted here.
     std::vector<TxCoinAgePriority> vecPriority;
     TxCoinAgePriorityCompare pricomparer;
     std::map<CTxMemPool::txiter, double, CTxMemPool::CompareIteratorByHash> waitPriMap;
     typedef std::map<CTxMemPool::txiter, double, CTxMemPool::CompareIteratorByHash>::iterator waitPriIter;
-    double actualPriority = -1;
 
-    std::priority_queue<CTxMemPool::txiter, std::vector<CTxMemPool::txiter>, ScoreCompare> clearedTxs;
-    bool fPrintPriority = GetBoolArg("-printpriority", DEFAULT_PRINTPRIORITY);
-    uint64_t nBlockSize = 1000;
-    uint64_t nBlockTx = 0;
-    unsigned int nBlockSigOps = 100;
-    int lastFewTxs = 0;
-    CAmount nFees = 0;
+    // Only transactions whose priority has grown past the threshold by now are looked at
+    typedef CTxMemPool::indexed_transaction_set::index<free_height>::type::iterator freeiter;
+    for (freeiter mi = mempool.mapTx.get<free_height>().begin(); mi != mempool.mapTx.get<free_height>().end() && mi->GetFreeHeight() <= (unsigned int)nHeight; ++mi) {
+        double dPriority = mi->GetPriority(nHeight);
+        CAmount dummy;
+        mempool.ApplyDeltas(mi->GetTx().GetHash(), dPriority, dummy);
+        if (AllowFree(dPriority))
+            vecPriority.push_back(TxCoinAgePriority(dPriority, mempool.mapTx.project<0>(mi)));
+    }
+    // and those prioritised above it
+    for (const auto& delta : mempool.mapDeltas) {
+        if (delta.second.first <= 0)
+            continue;
+        CTxMemPool::txiter it = mempool.mapTx.find(delta.first);
+        if (it == mempool.mapTx.end() || it->GetFreeHeight() <= (unsigned int)nHeight)
+            continue;
+        double dPriority = it->GetPriority(nHeight) + delta.second.first;
+        if (AllowFree(dPriority))
+            vecPriority.push_back(TxCoinAgePriority(dPriority, it));
+    }
+    std::make_heap(vecPriority.begin(), vecPriority.end(), pricomparer);
+
+    while (!vecPriority.empty()) {
+        CTxMemPool::txiter iter = vecPriority.front().second;
+        double actualPriority = vecPriority.front().first;
+        std::pop_heap(vecPriority.begin(), vecPriority.end(), pricomparer);
+        vecPriority.pop_back();
+
+        // Wait for the parents, this transaction is queued again when the last one is added
+        bool fOrphan = false;
+        BOOST_FOREACH (CTxMemPool::txiter parent, mempool.GetMemPoolParents(iter)) {
+            if (!inBlock.count(parent)) {
+                fOrphan = true;
+                break;
+            }
+        }
+        if (fOrphan) {
+            waitPriMap.insert(std::make_pair(iter, actualPriority));
+            continue;
+        }
 
-    {
-        LOCK2(cs_main, governance.cs);
-        LOCK(mempool.cs);
-        CBlockIndex* indexPrev = chainActive.Tip();
-        const int nHeight = indexPrev->nHeight + 1;
-        block.nTime = GetAdjustedTime();
-        const int64_t nMedianTimePast = indexPrev->GetMedianTimePast();
+        if (nBlockSize + iter->GetTxSize() >= nBlockPrioritySize)
+            break;
+        if (!TestPackage(iter->GetTxSize(), iter->GetSigOpCount()) || !IsFinalTx(iter->GetTx(), nHeight, nLockTimeCutoff))
+            continue;
 
-        // Add our coinbase tx as first transaction
-        block.vtx.emplace_back();
-        pblocktemplate->vTxFees.push_back(-1);   // updated at end
-        pblocktemplate->vTxSigOps.push_back(-1); // updated at end
-        block.nVersion = ComputeBlockVersion(indexPrev, chainparams.GetConsensus());
-        // -regtest only: allow overriding block.nVersion with
-        // -blockversion=N to test forking scenarios
-        if (chainparams.MineBlocksOnDemand())
-            block.nVersion = GetArg("-blockversion", block.nVersion);
+        AddToBlock(iter);
 
-        int64_t nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST) ? nMedianTimePast : block.GetBlockTime();
+        // Add transactions that depend on this one to the priority queue
+        BOOST_FOREACH (CTxMemPool::txiter child, mempool.GetMemPoolChildren(iter)) {
+            waitPriIter wpiter = waitPriMap.find(child);
+            if (wpiter != waitPriMap.end()) {
+                vecPriority.push_back(TxCoinAgePriority(wpiter->second, child));
+                std::push_heap(vecPriority.begin(), vecPriority.end(), pricomparer);
+                waitPriMap.erase(wpiter);
+            }
+        }
+    }
+}
+
+void BlockAssembler::OnlyUnconfirmed(CTxMemPool::setEntries& testSet) const
+{
+    for (CTxMemPool::setEntries::iterator iit = testSet.begin(); iit != testSet.end();) {
+        // Only test txs not already in the block
+        if (inBlock.count(*iit)) {
+            testSet.erase(iit++);
+        } else {
+            iit++;
+        }
+    }
+}
 
+bool BlockAssembler::TestPackage(uint64_t nPackageSize, unsigned int nPackageSigOps) const
+{
+    if (nBlockSize + nPackageSize >= nBlockMaxSize)
+        return false;
+    if (nBlockSigOps + nPackageSigOps >= MAX_BLOCK_SIGOPS)
+        return false;
+    return true;
+}
+
+bool BlockAssembler::TestPackageTransactions(const CTxMemPool::setEntries& package) const
+{
+    BOOST_FOREACH (const CTxMemPool::txiter it, package) {
+        if (!IsFinalTx(it->GetTx(), nHeight, nLockTimeCutoff))
+            return false;
+    }
+    return true;
+}
+
+bool BlockAssembler::SkipMapTxEntry(CTxMemPool::txiter it, indexed_modified_transaction_set& mapModifiedTx, CTxMemPool::setEntries& failedTx) const
+{
+    assert(it != mempool.mapTx.end());
+    return mapModifiedTx.count(it) || inBlock.count(it) || failedTx.count(it);
+}
+
+void BlockAssembler::SortForBlock(const CTxMemPool::setEntries& package, std::vector<CTxMemPool::txiter>& sortedEntries) const
+{
+    // Sort package by ancestor count
+    // If a transaction A depends on transaction B, then A's ancestor count
+    // must be greater than B's.  So this is sufficient to validly order the
+    // transactions for block inclusion.
+    sortedEntries.clear();
+    sortedEntries.insert(sortedEntries.begin(), package.begin(), package.end());
+    std::sort(sortedEntries.begin(), sortedEntries.end(), CompareTxIterByAncestorCount());
+}
 
-        bool fPriorityBlock = nBlockPrioritySize > 0;
-        if (fPriorityBlock) {
-            vecPriority.reserve(mempool.mapTx.size());
-            for (CTxMemPool::indexed_transaction_set::iterator mi = mempool.mapTx.begin(); mi != mempool.mapTx.end(); ++mi) {
-                double dPriority = mi->GetPriority(nHeight);
-                CAmount dummy;
-                mempool.ApplyDeltas(mi->GetTx().GetHash(), dPriority, dummy);
-                vecPriority.push_back(TxCoinAgePriority(dPriority, mi));
+void BlockAssembler::UpdatePackagesForAdded(const CTxMemPool::setEntries& alreadyAdded, indexed_modified_transaction_set& mapModifiedTx) const
+{
+    BOOST_FOREACH (const CTxMemPool::txiter it, alreadyAdded) {
+        CTxMemPool::setEntries descendants;
+        mempool.CalculateDescendants(it, descendants);
+        // Insert all descendants (not yet in block) into the modified set
+        BOOST_FOREACH (CTxMemPool::txiter desc, descendants) {
+            if (alreadyAdded.count(desc))
+                continue;
+            modtxiter mit = mapModifiedTx.find(desc);
+            if (mit == mapModifiedTx.end()) {
+                CTxMemPoolModifiedEntry modEntry(desc);
+                modEntry.nSizeWithAncestors -= it->GetTxSize();
+                modEntry.nModFeesWithAncestors -= it->GetModifiedFee();
+                modEntry.nSigOpCountWithAncestors -= it->GetSigOpCount();
+                mapModifiedTx.insert(modEntry);
+            } else {
+                mapModifiedTx.modify(mit, update_for_parent_inclusion(it));
             }
-            std::make_heap(vecPriority.begin(), vecPriority.end(), pricomparer);
+        }
+    }
+}
+
+void BlockAssembler::AddPackageTxs()
+{
+    // mapModifiedTx will store sorted packages after they are modified
+    // because some of their txs are already in the block
+    indexed_modified_transaction_set mapModifiedTx;
+    // Keep track of entries that failed inclusion, to avoid duplicate work
+    CTxMemPool::setEntries failedTx;
+
+    // Start by adding all descendants of previously added txs to mapModifiedTx
+    // and modifying them for their already included ancestors
+    UpdatePackagesForAdded(inBlock, mapModifiedTx);
+
+    CTxMemPool::indexed_transaction_set::index<ancestor_score>::type::iterator mi = mempool.mapTx.get<ancestor_score>().begin();
+    CTxMemPool::txiter iter;
+
+    // Limit the number of attempts to add transactions to the block when it is
+    // close to full; this is just a simple heuristic to finish quickly if the
+    // mempool has a lot of entries.
+    int nConsecutiveFailed = 0;
+
+    while (mi != mempool.mapTx.get<ancestor_score>().end() || !mapModifiedTx.empty()) {
+        // First try to find a new transaction in mapTx to evaluate.
+        if (mi != mempool.mapTx.get<ancestor_score>().end() &&
+            SkipMapTxEntry(mempool.mapTx.project<0>(mi), mapModifiedTx, failedTx)) {
+            ++mi;
+            continue;
         }
 
-        CTxMemPool::indexed_transaction_set::index<mining_score>::type::iterator mi = mempool.mapTx.get<mining_score>().begin();
-        CTxMemPool::txiter iter;
-
-        while (mi != mempool.mapTx.get<mining_score>().end() || !clearedTxs.empty()) {
-            bool priorityTx = false;
-            if (fPriorityBlock && !vecPriority.empty()) { // add a tx from priority queue to fill the blockprioritysize
-                priorityTx = true;
-                iter = vecPriority.front().second;
-                actualPriority = vecPriority.front().first;
-                std::pop_heap(vecPriority.begin(), vecPriority.end(), pricomparer);
-                vecPriority.pop_back();
-            } else if (clearedTxs.empty()) { // add tx with next highest score
-                iter = mempool.mapTx.project<0>(mi);
-                mi++;
-            } else { // try to add a previously postponed child tx
-                iter = clearedTxs.top();
-                clearedTxs.pop();
+        // Now that mi is not stale, determine which transaction to evaluate:
+        // the next entry from mapTx, or the best from mapModifiedTx?
+        bool fUsingModified = false;
+
+        modtxscoreiter modit = mapModifiedTx.get<ancestor_score>().begin();
+        if (mi == mempool.mapTx.get<ancestor_score>().end()) {
+            // We're out of entries in mapTx; use the entry from mapModifiedTx
+            iter = modit->iter;
+            fUsingModified = true;
+        } else {
+            // Try to compare the mapTx entry to the mapModifiedTx entry
+            iter = mempool.mapTx.project<0>(mi);
+            if (modit != mapModifiedTx.get<ancestor_score>().end() &&
+                CompareModifiedEntry()(*modit, CTxMemPoolModifiedEntry(iter))) {
+                // The best entry in mapModifiedTx has higher score
+                // than the one from mapTx.
+                // Switch which transaction (package) to consider
+                iter = modit->iter;
+                fUsingModified = true;
+            } else {
+                // Either no entry in mapModifiedTx, or it's worse than mapTx.
+                // Increment mi for the next loop iteration.
+                ++mi;
             }
+        }
 
-            if (inBlock.count(iter))
-                continue; // could have been added to the priorityBlock
+        // We skip mapTx entries that are inBlock, and mapModifiedTx shouldn't
+        // contain anything that is inBlock.
+        assert(!inBlock.count(iter));
+
+        uint64_t nPackageSize = iter->GetSizeWithAncestors();
+        CAmount nPackageFees = iter->GetModFeesWithAncestors();
+        unsigned int nPackageSigOps = iter->GetSigOpCountWithAncestors();
+        if (fUsingModified) {
+            nPackageSize = modit->nSizeWithAncestors;
+            nPackageFees = modit->nModFeesWithAncestors;
+            nPackageSigOps = modit->nSigOpCountWithAncestors;
+        }
 
-            const CTransaction& tx = iter->GetTx();
+        if (nPackageFees < ::minRelayTxFee.GetFee(nPackageSize) && nBlockSize >= nBlockMinSize) {
+            // Everything else we might consider has a lower fee rate
+            return;
+        }
 
-            bool fOrphan = false;
-            BOOST_FOREACH (CTxMemPool::txiter parent, mempool.GetMemPoolParents(iter)) {
-                if (!inBlock.count(parent)) {
-                    fOrphan = true;
-                    break;
-                }
-            }
-            if (fOrphan) {
-                if (priorityTx)
-                    waitPriMap.insert(std::make_pair(iter, actualPriority));
-                else
-                    waitSet.insert(iter);
-                continue;
+        if (!TestPackage(nPackageSize, nPackageSigOps)) {
+            if (fUsingModified) {
+                // Since we always look at the best entry in mapModifiedTx,
+                // we must erase failed entries so that we can consider the
+                // next best entry on the next loop iteration
+                mapModifiedTx.get<ancestor_score>().erase(modit);
+                failedTx.insert(iter);
             }
 
-            unsigned int nTxSize = iter->GetTxSize();
-            if (fPriorityBlock && (nBlockSize + nTxSize >= nBlockPrioritySize || !AllowFree(actualPriority))) {
-                fPriorityBlock = false;
-                waitPriMap.clear();
-            }
-            if (!priorityTx && (iter->GetModifiedFee() < ::minRelayTxFee.GetFee(nTxSize) && nBlockSize >= nBlockMinSize)) {
+            ++nConsecutiveFailed;
+            if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockSize > nBlockMaxSize - 1000) {
+                // Give up if we're close to full and haven't succeeded in a while
                 break;
             }
-            if (nBlockSize + nTxSize >= nBlockMaxSize) {
-                if (nBlockSize > nBlockMaxSize - 100 || lastFewTxs > 50) {
-                    break;
-                }
-                // Once we're within 1000 bytes of a full block, only look at 50 more txs
-                // to try to fill the remaining space.
-                if (nBlockSize > nBlockMaxSize - 1000) {
-                    lastFewTxs++;
-                }
-                continue;
-            }
+            continue;
+        }
 
-            if (!IsFinalTx(tx, nHeight, nLockTimeCutoff))
-                continue;
+        CTxMemPool::setEntries ancestors;
+        uint64_t nNoLimit = std::numeric_limits<uint64_t>::max();
+        std::string dummy;
+        mempool.CalculateMemPoolAncestors(*iter, ancestors, nNoLimit, nNoLimit, nNoLimit, nNoLimit, dummy, false);
 
-            unsigned int nTxSigOps = iter->GetSigOpCount();
-            if (nBlockSigOps + nTxSigOps >= MAX_BLOCK_SIGOPS) {
-                if (nBlockSigOps > MAX_BLOCK_SIGOPS - 2) {
-                    break;
-                }
-                continue;
-            }
+        OnlyUnconfirmed(ancestors);
+        ancestors.insert(iter);
 
-            block.vtx.emplace_back(iter->GetSharedTx());
-
-            pblocktemplate->vTxFees.push_back(iter->GetFee());
-            pblocktemplate->vTxSigOps.push_back(iter->GetSigOpCount());
-            nBlockSize += iter->GetTxSize();
-            ++nBlockTx;
-            nBlockSigOps += iter->GetSigOpCount();
-            nFees += iter->GetFee();
-
-            if (fPrintPriority) {
-                double dPriority = iter->GetPriority(nHeight);
-                CAmount dummy;
-                mempool.ApplyDeltas(tx.GetHash(), dPriority, dummy);
-                LogPrintf("priority %.1f fee %s txid %s\n", dPriority, CFeeRate(iter->GetModifiedFee(), nTxSize).ToString(),
-                    tx.GetHash().ToString());
+        // Test if all tx's are Final
+        if (!TestPackageTransactions(ancestors)) {
+            if (fUsingModified) {
+                mapModifiedTx.get<ancestor_score>().erase(modit);
+                failedTx.insert(iter);
             }
+            continue;
+        }
 
-            inBlock.insert(iter);
-
-            // Add transactions that depend on this one to the priority queue
-            BOOST_FOREACH (CTxMemPool::txiter child, mempool.GetMemPoolChildren(iter)) {
-                if (fPriorityBlock) {
-                    waitPriIter wpiter = waitPriMap.find(child);
-                    if (wpiter != waitPriMap.end()) {
-                        vecPriority.push_back(TxCoinAgePriority(wpiter->second, child));
-                        std::push_heap(vecPriority.begin(), vecPriority.end(), pricomparer);
-                        waitPriMap.erase(wpiter);
-                    }
-                } else {
-                    if (waitSet.count(child)) {
-                        clearedTxs.push(child);
-                        waitSet.erase(child);
-                    }
-                }
-            }
+        // This transaction will make it in; reset the failed counter.
+        nConsecutiveFailed = 0;
+
+        // Package can be added. Sort the entries in a valid order.
+        std::vector<CTxMemPool::txiter> sortedEntries;
+        SortForBlock(ancestors, sortedEntries);
+
+        for (size_t i = 0; i < sortedEntries.size(); ++i) {
+            AddToBlock(sortedEntries[i]);
+            // Erase from the modified set, if present
+            mapModifiedTx.erase(sortedEntries[i]);
         }
 
+        ++nPackagesSelected;
+
+        // Update transactions that depend on each of these
+        UpdatePackagesForAdded(ancestors, mapModifiedTx);
+    }
+}
+
+std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn)
+{
+    // Create new block
+    std::unique_ptr<CBlockTemplate> pblocktemplate(new CBlockTemplate());
+    CBlock& block = pblocktemplate->block; // pointer for convenience
+
+    // Create coinbase tx with fluid issuance
+    // TODO: Can this be made any more elegant?
+    CMutableTransaction txNew;
+    txNew.vin.resize(1);
+    txNew.vin[0].prevout.SetNull();
+    txNew.vout.resize(1);
+
+    {
+        LOCK2(cs_main, governance.cs);
+        LOCK(mempool.cs);
+        CBlockIndex* indexPrev = chainActive.Tip();
+        const int nHeight = indexPrev->nHeight + 1;
+        block.nTime = GetAdjustedTime();
+        const int64_t nMedianTimePast = indexPrev->GetMedianTimePast();
+
+        // Add our coinbase tx as first transaction
+        block.vtx.emplace_back();
+        pblocktemplate->vTxFees.push_back(-1);   // updated at end
+        pblocktemplate->vTxSigOps.push_back(-1); // updated at end
+        block.nVersion = ComputeBlockVersion(indexPrev, chainparams.GetConsensus());
+        // -regtest only: allow overriding block.nVersion with
+        // -blockversion=N to test forking scenarios
+        if (chainparams.MineBlocksOnDemand())
+            block.nVersion = GetArg("-blockversion", block.nVersion);
+
+        int64_t nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST) ? nMedianTimePast : block.GetBlockTime();
+
+        int64_t nTimeStart = GetTimeMicros();
+        BlockAssembler assembler(mempool, *pblocktemplate, nHeight, nLockTimeCutoff);
+        assembler.AddTransactions();
+        int64_t nTimeSelected = GetTimeMicros();
+        LogPrint("bench", "CreateNewBlock(): %u packages selected from %u mempool txs in %.2fms\n", assembler.nPackagesSelected, mempool.mapTx.size(), 0.001 * (nTimeSelected - nTimeStart));
+
         CAmount blockReward = GetFluidMiningReward(nHeight);
         CDynamicAddress mintAddress;
         CAmount fluidIssuance = 0;
@@ -315,16 +483,16 @@ std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams,
         // LogPrintf("CreateNewBlock -- nBlockHeight %d blockReward %lld txoutDynode %s txNew %s",
         //             nHeight, blockReward, block.txoutDynode.ToString(), txNew.ToString());
 
-        nLastBlockTx = nBlockTx;
-        nLastBlockSize = nBlockSize;
-        LogPrintf("CreateNewBlock(): total size %u txs: %u fees: %ld sigops %d\n", nBlockSize, nBlockTx, nFees, nBlockSigOps);
+        nLastBlockTx = assembler.nBlockTx;
+        nLastBlockSize = assembler.nBlockSize;
+        LogPrintf("CreateNewBlock(): total size %u txs: %u fees: %ld sigops %d\n", assembler.nBlockSize, assembler.nBlockTx, assembler.nFees, assembler.nBlockSigOps);
 
         CAmount blockAmount = blockReward + fluidIssuance;
         LogPrintf("CreateNewBlock(): Computed Miner Block Reward is %ld DYN\n", FormatMoney(blockAmount));
 
         // Update block coinbase
         block.vtx[0] = MakeTransactionRef(std::move(txNew));
-        pblocktemplate->vTxFees[0] = -nFees;
+        pblocktemplate->vTxFees[0] = -assembler.nFees;
 
         // Fill in header
         block.hashPrevBlock = indexPrev->GetBlockHash();
@@ -332,6 +500,7 @@ std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams,
         block.nBits = GetNextWorkRequired(indexPrev, block, chainparams.GetConsensus());
         block.nNonce = 0;
         pblocktemplate->vTxSigOps[0] = GetLegacySigOpCount(*block.vtx[0]);
+        pblocktemplate->vCoinbaseMerkleBranch = BlockMerkleBranch(block, 0);
 
         CValidationState state;
         if (!TestBlockValidity(state, chainparams, block, indexPrev, false, false)) {
@@ -348,15 +517,9 @@ std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams,
     return CreateNewBlock(chainparams, &scriptPubKeyIn);
 }
 
-void IncrementExtraNonce(CBlock& block, const CBlockIndex* indexPrev, unsigned int& nExtraNonce)
+static void SetCoinbaseExtraNonce(CBlock& block, const CBlockIndex* indexPrev, unsigned int& nExtraNonce)
 {
-    // Update nExtraNonce
-    static uint256 hashPrevBlock;
-    if (hashPrevBlock != block.hashPrevBlock) {
-        nExtraNonce = 0;
-        hashPrevBlock = block.hashPrevBlock;
-    }
-    // Increment extra nonce
+    // Increment extra nonce, the caller keeps it unique for the height
     ++nExtraNonce;
     // Height first in coinbase required for block.version=2
     unsigned int nHeight = indexPrev->nHeight + 1;
@@ -369,10 +532,22 @@ void IncrementExtraNonce(CBlock& block, const CBlockIndex* indexPrev, unsigned i
     assert(txCoinbase.vin[0].scriptSig.size() <= 100);
     // Set new transaction in block
     block.vtx[0] = MakeTransactionRef(std::move(txCoinbase));
+}
+
+void IncrementExtraNonce(CBlock& block, const CBlockIndex* indexPrev, unsigned int& nExtraNonce)
+{
+    SetCoinbaseExtraNonce(block, indexPrev, nExtraNonce);
     // Generate merkle root hash
     block.hashMerkleRoot = BlockMerkleRoot(block);
 }
 
+void IncrementExtraNonce(CBlock& block, const CBlockIndex* indexPrev, unsigned int& nExtraNonce, const std::vector<uint256>& vCoinbaseMerkleBranch)
+{
+    SetCoinbaseExtraNonce(block, indexPrev, nExtraNonce);
+    // Only the coinbase changed, hash it up the branch instead of over all transactions
+    block.hashMerkleRoot = ComputeMerkleRootFromBranch(block.vtx[0]->GetHash(), vCoinbaseMerkleBranch, 0);
+}
+
 void SetBlockPubkeyScript(CBlock& block, const CScript& scriptPubKeyIn)
 {
     // Create copied transaction
@@ -381,6 +556,4 @@ void SetBlockPubkeyScript(CBlock& block, const CScript& scriptPubKeyIn)
     txCoinbase.vout[0].scriptPubKey = scriptPubKeyIn;
     //It should be added to the block
     block.vtx[0] = MakeTransactionRef(std::move(txCoinbase));
-    // Generate merkle root hash
-    block.hashMerkleRoot = BlockMerkleRoot(block);
 }
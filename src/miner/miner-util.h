@@ -13,6 +13,10 @@
 
 // #include "chain/chain.h"
 #include "primitives/block.h"
+#include "txmempool.h"
+
+#include "boost/multi_index/ordered_index.hpp"
+#include "boost/multi_index_container.hpp"
 
 class CBlockIndex;
 class CChainParams;
@@ -38,9 +42,165 @@ struct CBlockTemplate {
     std::vector<int64_t> vTxSigOps;
     CTxOut txoutDynode;                 // dynode payment
     std::vector<CTxOut> voutSuperblock; // dynode payment
+    std::vector<uint256> vCoinbaseMerkleBranch; // merkle branch of the coinbase, doesn't depend on the coinbase itself
+};
+
+// Container for tracking updates to ancestor feerate as we include (parent)
+// transactions in a block
+struct CTxMemPoolModifiedEntry {
+    CTxMemPoolModifiedEntry(CTxMemPool::txiter entry)
+    {
+        iter = entry;
+        nSizeWithAncestors = entry->GetSizeWithAncestors();
+        nModFeesWithAncestors = entry->GetModFeesWithAncestors();
+        nSigOpCountWithAncestors = entry->GetSigOpCountWithAncestors();
+    }
+
+    CTxMemPool::txiter iter;
+    uint64_t nSizeWithAncestors;
+    CAmount nModFeesWithAncestors;
+    unsigned int nSigOpCountWithAncestors;
+};
+
+/** Comparator for CTxMemPool::txiter objects.
+ *  It simply compares the internal memory address of the CTxMemPoolEntry object
+ *  pointed to. This means it has no meaning, and is only useful for using them
+ *  as key in other indexes.
+ */
+struct CompareCTxMemPoolIter {
+    bool operator()(const CTxMemPool::txiter& a, const CTxMemPool::txiter& b) const
+    {
+        return &(*a) < &(*b);
+    }
+};
+
+struct modifiedentry_iter {
+    typedef CTxMemPool::txiter result_type;
+    result_type operator()(const CTxMemPoolModifiedEntry& entry) const
+    {
+        return entry.iter;
+    }
+};
+
+// This matches the calculation in CompareTxMemPoolEntryByAncestorFee,
+// except operating on CTxMemPoolModifiedEntry.
+struct CompareModifiedEntry {
+    bool operator()(const CTxMemPoolModifiedEntry& a, const CTxMemPoolModifiedEntry& b) const
+    {
+        double f1 = (double)a.nModFeesWithAncestors * b.nSizeWithAncestors;
+        double f2 = (double)b.nModFeesWithAncestors * a.nSizeWithAncestors;
+        if (f1 == f2) {
+            return CTxMemPool::CompareIteratorByHash()(a.iter, b.iter);
+        }
+        return f1 > f2;
+    }
+};
+
+// A comparator that sorts transactions based on number of ancestors.
+// This is sufficient to sort an ancestor package in an order that is valid
+// to appear in a block.
+struct CompareTxIterByAncestorCount {
+    bool operator()(const CTxMemPool::txiter& a, const CTxMemPool::txiter& b) const
+    {
+        if (a->GetCountWithAncestors() != b->GetCountWithAncestors())
+            return a->GetCountWithAncestors() < b->GetCountWithAncestors();
+        return CTxMemPool::CompareIteratorByHash()(a, b);
+    }
+};
+
+typedef boost::multi_index_container<
+    CTxMemPoolModifiedEntry,
+    boost::multi_index::indexed_by<
+        boost::multi_index::ordered_unique<
+            modifiedentry_iter,
+            CompareCTxMemPoolIter>,
+        // sorted by modified ancestor fee rate
+        boost::multi_index::ordered_non_unique<
+            // Reuse same tag from CTxMemPool's similar index
+            boost::multi_index::tag<ancestor_score>,
+            boost::multi_index::identity<CTxMemPoolModifiedEntry>,
+            CompareModifiedEntry> > >
+    indexed_modified_transaction_set;
+
+typedef indexed_modified_transaction_set::nth_index<0>::type::iterator modtxiter;
+typedef indexed_modified_transaction_set::index<ancestor_score>::type::iterator modtxscoreiter;
+
+struct update_for_parent_inclusion {
+    update_for_parent_inclusion(CTxMemPool::txiter it) : iter(it) {}
+
+    void operator()(CTxMemPoolModifiedEntry& e)
+    {
+        e.nModFeesWithAncestors -= iter->GetModifiedFee();
+        e.nSizeWithAncestors -= iter->GetTxSize();
+        e.nSigOpCountWithAncestors -= iter->GetSigOpCount();
+    }
+
+    CTxMemPool::txiter iter;
+};
+
+/**
+ * Selects the mempool transactions of a new block template.
+ *
+ * After the optional priority area, transactions are added as packages: a
+ * transaction together with its ancestors that aren't in the block yet,
+ * highest ancestor fee rate first. The ancestor_score index of the mempool
+ * supplies the candidates; packages whose ancestors were partly included
+ * are tracked with their remaining size and fees in mapModifiedTx, so a
+ * transaction is looked at once instead of being re-checked whenever one
+ * of its parents is added.
+ */
+class BlockAssembler
+{
+private:
+    CTxMemPool& mempool;
+    CBlockTemplate& blocktemplate;
+    const int nHeight;
+    const int64_t nLockTimeCutoff;
+
+    // Configuration parameters for the block size
+    unsigned int nBlockMaxSize;
+    unsigned int nBlockPrioritySize;
+    unsigned int nBlockMinSize;
+    bool fPrintPriority;
+
+    CTxMemPool::setEntries inBlock;
+
+public:
+    // Information on the current status of the block
+    uint64_t nBlockSize;
+    uint64_t nBlockTx;
+    unsigned int nBlockSigOps;
+    CAmount nFees;
+    unsigned int nPackagesSelected;
+
+    BlockAssembler(CTxMemPool& mempoolIn, CBlockTemplate& blocktemplateIn, int nHeightIn, int64_t nLockTimeCutoffIn);
+
+    /** Add transactions after the coinbase of the template, requires mempool.cs */
+    void AddTransactions();
+
+private:
+    void AddToBlock(CTxMemPool::txiter iter);
+
+    /** Add transactions by coin age priority until the priority area is full */
+    void AddPriorityTxs();
+    /** Add transactions by ancestor fee rate, with their unconfirmed ancestors */
+    void AddPackageTxs();
+
+    /** Remove from the set the transactions already in the block */
+    void OnlyUnconfirmed(CTxMemPool::setEntries& testSet) const;
+    /** Test if a new package would fit in the block size and sigop limits */
+    bool TestPackage(uint64_t nPackageSize, unsigned int nPackageSigOps) const;
+    /** Test if all the transactions of a package are final */
+    bool TestPackageTransactions(const CTxMemPool::setEntries& package) const;
+    /** Whether mapTx entry it was already handled, through mapModifiedTx, the block or a failed package */
+    bool SkipMapTxEntry(CTxMemPool::txiter it, indexed_modified_transaction_set& mapModifiedTx, CTxMemPool::setEntries& failedTx) const;
+    /** Sort a package so that parents come before their children */
+    void SortForBlock(const CTxMemPool::setEntries& package, std::vector<CTxMemPool::txiter>& sortedEntries) const;
+    /** Account for the added transactions in the packages of their descendants */
+    void UpdatePackagesForAdded(const CTxMemPool::setEntries& alreadyAdded, indexed_modified_transaction_set& mapModifiedTx) const;
 };
 
-/** Set pubkey script in generated block */
+/** Set pubkey script in generated block, the merkle root is left for IncrementExtraNonce to update */
 void SetBlockPubkeyScript(CBlock& block, const CScript& scriptPubKeyIn);
 /** Generate a new block, without valid proof-of-work */
 std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn = nullptr);
@@ -50,6 +210,8 @@ bool ProcessBlockFound(const CBlock& block, const CChainParams& chainparams);
 
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock& pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
+/** Modify the extranonce in a block, with the merkle root following from the coinbase branch of its template */
+void IncrementExtraNonce(CBlock& pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce, const std::vector<uint256>& vCoinbaseMerkleBranch);
 int64_t UpdateTime(CBlockHeader& pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 
 #endif // DYNAMIC_MINER_UTIL_H
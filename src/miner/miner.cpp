@@ -71,6 +71,50 @@ int64_t GetGPUHashRate()
     return 0;
 };
 
+static MinerHashRates ToMinerHashRates(const HashRates& rates)
+{
+    MinerHashRates result;
+    result.n1m = rates.last_1m;
+    result.n5m = rates.last_5m;
+    result.n15m = rates.last_15m;
+    return result;
+}
+
+MinerHashRates GetHashRates()
+{
+    if (gMiners)
+        return ToMinerHashRates(gMiners->GetHashRates());
+    return MinerHashRates();
+};
+
+std::vector<MinerDeviceHashRates> GetDeviceHashRates()
+{
+    std::vector<MinerDeviceHashRates> devices;
+    if (!gMiners)
+        return devices;
+    for (const auto& device : gMiners->group_cpu().GetDeviceHashRates()) {
+        devices.push_back({"CPU", device.first, ToMinerHashRates(device.second)});
+    }
+#ifdef ENABLE_GPU
+    for (const auto& device : gMiners->group_gpu().GetDeviceHashRates()) {
+        devices.push_back({"GPU", device.first, ToMinerHashRates(device.second)});
+    }
+#endif // ENABLE_GPU
+    return devices;
+};
+
+MinerStaleWorkStats GetMinerStaleWork()
+{
+    MinerStaleWorkStats stats;
+    if (gMiners) {
+        stats.nSwitches = gMiners->ctx()->shared->stale_work_switches();
+        stats.nLastMicros = gMiners->ctx()->shared->stale_work_last();
+        stats.nTotalMicros = gMiners->ctx()->shared->stale_work_total();
+        stats.nMaxMicros = gMiners->ctx()->shared->stale_work_max();
+    }
+    return stats;
+};
+
 void SetCPUMinerThreads(uint8_t target)
 {
     assert(gMiners);
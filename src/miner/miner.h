@@ -33,6 +33,36 @@ int64_t GetCPUHashRate();
 /** Gets hash rate of GPU */
 int64_t GetGPUHashRate();
 
+/** Hashes per second averaged over the last 1, 5 and 15 minutes */
+struct MinerHashRates {
+    int64_t n1m = 0;
+    int64_t n5m = 0;
+    int64_t n15m = 0;
+};
+
+/** Hash rates of one CPU or GPU device */
+struct MinerDeviceHashRates {
+    std::string strType; //!< "CPU" or "GPU"
+    int nDevice;
+    MinerHashRates rates;
+};
+
+/** Gets 1, 5 and 15 minute hash rates of GPU and CPU */
+MinerHashRates GetHashRates();
+/** Gets 1, 5 and 15 minute hash rates of each CPU and GPU device */
+std::vector<MinerDeviceHashRates> GetDeviceHashRates();
+
+/** Time miner threads kept hashing superseded work */
+struct MinerStaleWorkStats {
+    uint64_t nSwitches = 0;    //!< switches of a miner thread to new work
+    int64_t nLastMicros = 0;   //!< stale time of the last switch
+    int64_t nTotalMicros = 0;  //!< stale time of all switches
+    int64_t nMaxMicros = 0;    //!< longest stale time of a switch
+};
+
+/** Gets stale work statistics of GPU and CPU miners */
+MinerStaleWorkStats GetMinerStaleWork();
+
 /** Sets amount of CPU miner threads */
 void SetCPUMinerThreads(uint8_t target);
 /** Sets amount of GPU miner threads */
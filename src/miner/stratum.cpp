@@ -0,0 +1,753 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "miner/stratum.h"
+
+#include "arith_uint256.h"
+#include "base58.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "consensus/merkle.h"
+#include "crypto/common.h"
+#include "miner/miner-util.h"
+#include "net.h"
+#include "netbase.h"
+#include "primitives/block.h"
+#include "random.h"
+#include "script/standard.h"
+#include "streams.h"
+#include "sync.h"
+#include "timedata.h"
+#include "txmempool.h"
+#include "util.h"
+#include "utilstrencodings.h"
+#include "utiltime.h"
+#include "validation.h"
+#include "validationinterface.h"
+#include "version.h"
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <set>
+#include <thread>
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+
+/** Stratum error codes */
+enum StratumError {
+    STRATUM_ERROR_OTHER = 20,
+    STRATUM_ERROR_JOB_NOT_FOUND = 21,
+    STRATUM_ERROR_DUPLICATE_SHARE = 22,
+    STRATUM_ERROR_LOW_DIFFICULTY = 23,
+    STRATUM_ERROR_UNAUTHORIZED = 24,
+    STRATUM_ERROR_NOT_SUBSCRIBED = 25,
+};
+
+/** Bytes of the coinbase scriptSig the two extranonces are written over */
+static const size_t STRATUM_EXTRANONCE_SIZE = STRATUM_EXTRANONCE1_SIZE + STRATUM_EXTRANONCE2_SIZE;
+/** Most a share's ntime may be ahead of our adjusted time */
+static const int64_t STRATUM_MAX_FUTURE_NTIME = 2 * 60 * 60;
+
+/**
+ * A block template as sent to the workers. The coinbase is split around
+ * the extranonces, workers hash it up the merkle branch themselves.
+ */
+struct CStratumJob {
+    std::string strId;
+    int nHeight;
+    CBlock block;
+    std::vector<uint256> vMerkleBranch;
+    std::vector<unsigned char> vchCoinbase1;
+    std::vector<unsigned char> vchCoinbase2;
+    arith_uint256 hashTarget;
+    //! extranonces, ntime and nonce of the shares submitted for this job
+    std::set<std::string> setShares;
+};
+
+struct CStratumClient {
+    int64_t nId;
+    struct bufferevent* bev;
+    std::string strAddress;
+    std::vector<unsigned char> vchExtraNonce1;
+    bool fSubscribed;
+    bool fAuthorized;
+    std::string strWorker;
+    int64_t nConnectedTime;
+    double dDifficulty;
+    arith_uint256 hashShareTarget;
+    uint64_t nAccepted;
+    uint64_t nRejected;
+    uint64_t nBlocks;
+    int64_t nLastShareTime;
+    std::map<std::string, uint64_t> mapRejectReasons;
+    //! time and expected hashes of the shares accepted in the hashrate window
+    std::deque<std::pair<int64_t, double> > dequeShares;
+};
+
+static const CChainParams* pchainparams = nullptr;
+static std::shared_ptr<CReserveScript> coinbaseScript;
+//! blocks are paid to wallet keys, a new one after every block found
+static bool fWalletScript = false;
+static double dMinDifficulty = DEFAULT_STRATUM_DIFFICULTY;
+
+static struct event_base* eventBaseStratum = nullptr;
+static struct evconnlistener* listenerStratum = nullptr;
+static struct event* eventUpdateJob = nullptr;
+static struct event* eventRefreshJob = nullptr;
+static std::thread threadStratum;
+
+static CCriticalSection cs_stratum;
+static std::map<int64_t, std::unique_ptr<CStratumClient> > mapClients;
+//! current jobs, oldest first
+static std::deque<std::shared_ptr<CStratumJob> > dequeJobs;
+static int64_t nLastClientId = 0;
+static uint32_t nLastExtraNonce1 = 0;
+static uint64_t nLastJobId = 0;
+static unsigned int nJobTransactionsUpdated = 0;
+static StratumStats stratumStats;
+
+class CStratumNotificationInterface : public CValidationInterface
+{
+public:
+    virtual ~CStratumNotificationInterface() = default;
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override
+    {
+        // The job is rebuilt on the event thread, the tip may have moved again by then
+        if (!fInitialDownload)
+            event_active(eventUpdateJob, 0, 0);
+    }
+};
+
+static CStratumNotificationInterface* pStratumNotificationInterface = nullptr;
+
+/** Share target for a difficulty, difficulty 1 being the proof-of-work limit */
+static arith_uint256 GetShareTarget(double dDifficulty)
+{
+    const arith_uint256 powLimit = UintToArith256(pchainparams->GetConsensus().powLimit);
+    // Work in 1/65536ths so that difficulties below 1 can be expressed
+    uint64_t nDifficulty = std::max((uint64_t)1, (uint64_t)(std::min(dDifficulty, 1e12) * 65536));
+    arith_uint256 hashTarget = powLimit / arith_uint256(nDifficulty);
+    if (hashTarget > (~arith_uint256(0) >> 16))
+        return ~arith_uint256(0);
+    return hashTarget << 16;
+}
+
+/** Hashes a worker needs on average to find a share below the target */
+static double GetHashesPerShare(const arith_uint256& hashTarget)
+{
+    return std::pow(2.0, 256) / (hashTarget.getdouble() + 1);
+}
+
+/** Stratum encodes the previous block hash as eight byte-swapped 32-bit words */
+static std::string EncodePrevHash(const uint256& hash)
+{
+    std::vector<unsigned char> vch(hash.begin(), hash.end());
+    for (size_t i = 0; i < vch.size(); i += 4)
+        std::reverse(vch.begin() + i, vch.begin() + i + 4);
+    return HexStr(vch);
+}
+
+static void SendMessage(CStratumClient& client, const UniValue& msg)
+{
+    std::string strMsg = msg.write() + "\n";
+    bufferevent_write(client.bev, strMsg.data(), strMsg.size());
+}
+
+static void SendResult(CStratumClient& client, const UniValue& id, const UniValue& result)
+{
+    UniValue reply(UniValue::VOBJ);
+    reply.push_back(Pair("id", id));
+    reply.push_back(Pair("result", result));
+    reply.push_back(Pair("error", NullUniValue));
+    SendMessage(client, reply);
+}
+
+static void SendError(CStratumClient& client, const UniValue& id, int nCode, const std::string& strMessage)
+{
+    UniValue error(UniValue::VARR);
+    error.push_back(nCode);
+    error.push_back(strMessage);
+    error.push_back(NullUniValue);
+    UniValue reply(UniValue::VOBJ);
+    reply.push_back(Pair("id", id));
+    reply.push_back(Pair("result", NullUniValue));
+    reply.push_back(Pair("error", error));
+    SendMessage(client, reply);
+}
+
+static void SendNotification(CStratumClient& client, const std::string& strMethod, const UniValue& params)
+{
+    UniValue msg(UniValue::VOBJ);
+    msg.push_back(Pair("id", NullUniValue));
+    msg.push_back(Pair("method", strMethod));
+    msg.push_back(Pair("params", params));
+    SendMessage(client, msg);
+}
+
+static void SendDifficulty(CStratumClient& client)
+{
+    UniValue params(UniValue::VARR);
+    params.push_back(client.dDifficulty);
+    SendNotification(client, "mining.set_difficulty", params);
+}
+
+static void SendJob(CStratumClient& client, const CStratumJob& job, bool fClean)
+{
+    UniValue branch(UniValue::VARR);
+    for (const uint256& hash : job.vMerkleBranch)
+        branch.push_back(HexStr(hash.begin(), hash.end()));
+
+    UniValue params(UniValue::VARR);
+    params.push_back(job.strId);
+    params.push_back(EncodePrevHash(job.block.hashPrevBlock));
+    params.push_back(HexStr(job.vchCoinbase1));
+    params.push_back(HexStr(job.vchCoinbase2));
+    params.push_back(branch);
+    params.push_back(strprintf("%08x", job.block.nVersion));
+    params.push_back(strprintf("%08x", job.block.nBits));
+    params.push_back(strprintf("%08x", job.block.nTime));
+    params.push_back(fClean);
+    SendNotification(client, "mining.notify", params);
+}
+
+/** Build a job from a new template and push it to the workers, unless nothing changed since the last one */
+static void UpdateJob(bool fForce)
+{
+    AssertLockNotHeld(cs_stratum);
+
+    {
+        LOCK(cs_main);
+        if (IsInitialBlockDownload())
+            return;
+        if (pchainparams->MiningRequiresPeers() && (!g_connman || g_connman->GetNodeCount(CConnman::CONNECTIONS_ALL) == 0))
+            return;
+
+        LOCK(cs_stratum);
+        bool fTipChanged = dequeJobs.empty() || dequeJobs.back()->block.hashPrevBlock != chainActive.Tip()->GetBlockHash();
+        if (!fForce && !fTipChanged && mempool.GetTransactionsUpdated() == nJobTransactionsUpdated)
+            return;
+    }
+
+    int64_t nTimeStart = GetTimeMicros();
+    unsigned int nTransactionsUpdated = mempool.GetTransactionsUpdated();
+    std::unique_ptr<CBlockTemplate> pblocktemplate;
+    try {
+        pblocktemplate = CreateNewBlock(*pchainparams, coinbaseScript->reserveScript);
+    } catch (const std::runtime_error& e) {
+        LogPrintf("%s: %s\n", __func__, e.what());
+        return;
+    }
+
+    std::shared_ptr<CStratumJob> job = std::make_shared<CStratumJob>();
+    job->block = pblocktemplate->block;
+    job->vMerkleBranch = pblocktemplate->vCoinbaseMerkleBranch;
+    job->hashTarget.SetCompact(job->block.nBits);
+    {
+        LOCK(cs_main);
+        BlockMap::const_iterator mi = mapBlockIndex.find(job->block.hashPrevBlock);
+        if (mi == mapBlockIndex.end())
+            return;
+        job->nHeight = mi->second->nHeight + 1;
+    }
+
+    // Leave room for the extranonces in the coinbase, the placeholder is
+    // random so that it can only be found where it was put
+    std::vector<unsigned char> vchPlaceholder(STRATUM_EXTRANONCE_SIZE);
+    GetRandBytes(vchPlaceholder.data(), vchPlaceholder.size());
+    CMutableTransaction txCoinbase(*job->block.vtx[0]);
+    txCoinbase.vin[0].scriptSig = (CScript() << job->nHeight << vchPlaceholder) + COINBASE_FLAGS;
+    assert(txCoinbase.vin[0].scriptSig.size() <= 100);
+
+    CDataStream ssCoinbase(SER_NETWORK, PROTOCOL_VERSION);
+    ssCoinbase << txCoinbase;
+    std::vector<unsigned char> vchCoinbase(ssCoinbase.begin(), ssCoinbase.end());
+    std::vector<unsigned char>::iterator it = std::search(vchCoinbase.begin(), vchCoinbase.end(), vchPlaceholder.begin(), vchPlaceholder.end());
+    assert(it != vchCoinbase.end());
+    job->vchCoinbase1.assign(vchCoinbase.begin(), it);
+    job->vchCoinbase2.assign(it + STRATUM_EXTRANONCE_SIZE, vchCoinbase.end());
+    job->block.vtx[0] = MakeTransactionRef(std::move(txCoinbase));
+
+    int64_t nTimeBuilt = GetTimeMicros();
+
+    LOCK(cs_stratum);
+    // A new tip invalidates all earlier jobs, workers drop their work at once
+    bool fClean = dequeJobs.empty() || dequeJobs.back()->block.hashPrevBlock != job->block.hashPrevBlock;
+    if (fClean)
+        dequeJobs.clear();
+    job->strId = strprintf("%x", ++nLastJobId);
+    dequeJobs.push_back(job);
+    while (dequeJobs.size() > STRATUM_MAX_JOBS)
+        dequeJobs.pop_front();
+    nJobTransactionsUpdated = nTransactionsUpdated;
+
+    stratumStats.nHeight = job->nHeight;
+    stratumStats.nJobs++;
+    stratumStats.dLastJobMillis = 0.001 * (nTimeBuilt - nTimeStart);
+
+    for (const auto& item : mapClients) {
+        if (item.second->fSubscribed)
+            SendJob(*item.second, *job, fClean);
+    }
+    LogPrint("stratum", "%s: job %s at height %d with %u txs in %.2fms, sent to %u workers\n", __func__,
+        job->strId, job->nHeight, job->block.vtx.size(), stratumStats.dLastJobMillis, mapClients.size());
+}
+
+static void RecordReject(CStratumClient& client, const std::string& strReason)
+{
+    AssertLockHeld(cs_stratum);
+    client.nRejected++;
+    client.mapRejectReasons[strReason]++;
+    stratumStats.nRejected++;
+    LogPrint("stratum", "%s: share from %s (%s) rejected: %s\n", __func__, client.strAddress, client.strWorker, strReason);
+}
+
+static void HandleSubscribe(CStratumClient& client, const UniValue& id)
+{
+    LOCK(cs_stratum);
+    client.fSubscribed = true;
+
+    UniValue subscription(UniValue::VARR);
+    UniValue difficulty(UniValue::VARR);
+    difficulty.push_back("mining.set_difficulty");
+    difficulty.push_back(strprintf("%x", client.nId));
+    subscription.push_back(difficulty);
+    UniValue notify(UniValue::VARR);
+    notify.push_back("mining.notify");
+    notify.push_back(strprintf("%x", client.nId));
+    subscription.push_back(notify);
+
+    UniValue result(UniValue::VARR);
+    result.push_back(subscription);
+    result.push_back(HexStr(client.vchExtraNonce1));
+    result.push_back((int)STRATUM_EXTRANONCE2_SIZE);
+    SendResult(client, id, result);
+
+    SendDifficulty(client);
+    if (!dequeJobs.empty())
+        SendJob(client, *dequeJobs.back(), true);
+}
+
+static void HandleAuthorize(CStratumClient& client, const UniValue& id, const UniValue& params)
+{
+    if (params.size() < 1 || !params[0].isStr()) {
+        SendError(client, id, STRATUM_ERROR_OTHER, "Missing worker name");
+        return;
+    }
+
+    LOCK(cs_stratum);
+    client.fAuthorized = true;
+    client.strWorker = params[0].get_str();
+    SendResult(client, id, true);
+}
+
+static void HandleSuggestDifficulty(CStratumClient& client, const UniValue& id, const UniValue& params)
+{
+    if (params.size() < 1 || !params[0].isNum()) {
+        SendError(client, id, STRATUM_ERROR_OTHER, "Missing difficulty");
+        return;
+    }
+
+    LOCK(cs_stratum);
+    client.dDifficulty = std::max(params[0].get_real(), dMinDifficulty);
+    client.hashShareTarget = GetShareTarget(client.dDifficulty);
+    SendResult(client, id, true);
+    SendDifficulty(client);
+}
+
+static void HandleSubmit(CStratumClient& client, const UniValue& id, const UniValue& params)
+{
+    std::shared_ptr<CStratumJob> job;
+    std::vector<unsigned char> vchCoinbase;
+    arith_uint256 hashShareTarget;
+    uint32_t nTime = 0;
+    uint32_t nNonce = 0;
+    {
+        LOCK(cs_stratum);
+        if (!client.fSubscribed) {
+            SendError(client, id, STRATUM_ERROR_NOT_SUBSCRIBED, "Not subscribed");
+            return;
+        }
+        if (!client.fAuthorized) {
+            RecordReject(client, "unauthorized");
+            SendError(client, id, STRATUM_ERROR_UNAUTHORIZED, "Unauthorized worker");
+            return;
+        }
+        if (params.size() < 5 || !params[1].isStr() || !params[2].isStr() || !params[3].isStr() || !params[4].isStr()) {
+            RecordReject(client, "invalid");
+            SendError(client, id, STRATUM_ERROR_OTHER, "Invalid parameters");
+            return;
+        }
+        const std::string& strJobId = params[1].get_str();
+        const std::string& strExtraNonce2 = params[2].get_str();
+        const std::string& strTime = params[3].get_str();
+        const std::string& strNonce = params[4].get_str();
+        if (strExtraNonce2.size() != 2 * STRATUM_EXTRANONCE2_SIZE || !IsHex(strExtraNonce2) || strTime.size() != 8 || !IsHex(strTime) || strNonce.size() != 8 || !IsHex(strNonce)) {
+            RecordReject(client, "invalid");
+            SendError(client, id, STRATUM_ERROR_OTHER, "Invalid extranonce2, ntime or nonce");
+            return;
+        }
+
+        for (const auto& item : dequeJobs) {
+            if (item->strId == strJobId)
+                job = item;
+        }
+        if (!job) {
+            RecordReject(client, "job-not-found");
+            SendError(client, id, STRATUM_ERROR_JOB_NOT_FOUND, "Job not found");
+            return;
+        }
+        std::string strShare = HexStr(client.vchExtraNonce1) + strExtraNonce2 + strTime + strNonce;
+        if (!job->setShares.insert(strShare).second) {
+            RecordReject(client, "duplicate");
+            SendError(client, id, STRATUM_ERROR_DUPLICATE_SHARE, "Duplicate share");
+            return;
+        }
+
+        std::vector<unsigned char> vchExtraNonce2 = ParseHex(strExtraNonce2);
+        vchCoinbase = job->vchCoinbase1;
+        vchCoinbase.insert(vchCoinbase.end(), client.vchExtraNonce1.begin(), client.vchExtraNonce1.end());
+        vchCoinbase.insert(vchCoinbase.end(), vchExtraNonce2.begin(), vchExtraNonce2.end());
+        vchCoinbase.insert(vchCoinbase.end(), job->vchCoinbase2.begin(), job->vchCoinbase2.end());
+        nTime = ReadBE32(ParseHex(strTime).data());
+        nNonce = ReadBE32(ParseHex(strNonce).data());
+        hashShareTarget = client.hashShareTarget;
+    }
+
+    // Hash without holding cs_stratum, a found block takes cs_main
+    std::string strReject;
+    CBlock block(job->block);
+    arith_uint256 hash;
+    if (nTime < job->block.nTime || nTime > GetAdjustedTime() + STRATUM_MAX_FUTURE_NTIME) {
+        strReject = "time-out-of-range";
+    } else {
+        CMutableTransaction txCoinbase;
+        CDataStream ssCoinbase(vchCoinbase, SER_NETWORK, PROTOCOL_VERSION);
+        ssCoinbase >> txCoinbase;
+        block.vtx[0] = MakeTransactionRef(std::move(txCoinbase));
+        block.hashMerkleRoot = ComputeMerkleRootFromBranch(block.vtx[0]->GetHash(), job->vMerkleBranch, 0);
+        block.nTime = nTime;
+        block.nNonce = nNonce;
+        hash = UintToArith256(block.GetHash());
+        if (hash > hashShareTarget)
+            strReject = "low-difficulty";
+    }
+
+    bool fBlock = false;
+    if (strReject.empty() && hash <= job->hashTarget) {
+        LogPrintf("%s: block %s found by %s (%s)\n", __func__, block.GetHash().ToString(), client.strAddress, client.strWorker);
+        fBlock = ProcessBlockFound(block, *pchainparams);
+        if (fBlock) {
+            coinbaseScript->KeepScript();
+            if (fWalletScript) {
+                std::shared_ptr<CReserveScript> script;
+                GetMainSignals().ScriptForMining(script);
+                if (script && !script->reserveScript.empty())
+                    coinbaseScript = script;
+            }
+        }
+    }
+
+    LOCK(cs_stratum);
+    if (!strReject.empty()) {
+        RecordReject(client, strReject);
+        if (strReject == "low-difficulty")
+            SendError(client, id, STRATUM_ERROR_LOW_DIFFICULTY, "Low difficulty share");
+        else
+            SendError(client, id, STRATUM_ERROR_OTHER, "Share ntime out of range");
+        return;
+    }
+
+    int64_t nNow = GetTime();
+    client.nAccepted++;
+    client.nLastShareTime = nNow;
+    client.dequeShares.push_back(std::make_pair(nNow, GetHashesPerShare(hashShareTarget)));
+    while (client.dequeShares.front().first < nNow - STRATUM_HASHRATE_WINDOW)
+        client.dequeShares.pop_front();
+    stratumStats.nAccepted++;
+    if (fBlock) {
+        client.nBlocks++;
+        stratumStats.nBlocks++;
+    }
+    SendResult(client, id, true);
+}
+
+/** Handle one request line, false if the connection is to be closed */
+static bool HandleRequest(CStratumClient& client, const std::string& strRequest)
+{
+    UniValue request;
+    if (!request.read(strRequest) || !request.isObject()) {
+        LogPrint("stratum", "%s: malformed request from %s\n", __func__, client.strAddress);
+        return false;
+    }
+
+    const UniValue& id = find_value(request, "id");
+    const UniValue& method = find_value(request, "method");
+    const UniValue& params = find_value(request, "params");
+    if (!method.isStr()) {
+        SendError(client, id, STRATUM_ERROR_OTHER, "Missing method");
+        return true;
+    }
+    const UniValue paramsArray = params.isArray() ? params : UniValue(UniValue::VARR);
+
+    const std::string& strMethod = method.get_str();
+    try {
+        if (strMethod == "mining.subscribe")
+            HandleSubscribe(client, id);
+        else if (strMethod == "mining.authorize")
+            HandleAuthorize(client, id, paramsArray);
+        else if (strMethod == "mining.suggest_difficulty")
+            HandleSuggestDifficulty(client, id, paramsArray);
+        else if (strMethod == "mining.submit")
+            HandleSubmit(client, id, paramsArray);
+        else
+            SendError(client, id, STRATUM_ERROR_OTHER, "Method not found");
+    } catch (const std::exception& e) {
+        LogPrint("stratum", "%s: %s from %s failed: %s\n", __func__, strMethod, client.strAddress, e.what());
+        SendError(client, id, STRATUM_ERROR_OTHER, e.what());
+    }
+    return true;
+}
+
+static void CloseClient(CStratumClient* pclient)
+{
+    LogPrint("stratum", "%s: worker %s (%s) disconnected\n", __func__, pclient->strAddress, pclient->strWorker);
+    bufferevent_free(pclient->bev);
+    LOCK(cs_stratum);
+    mapClients.erase(pclient->nId);
+}
+
+static void StratumReadCallback(struct bufferevent* bev, void* ctx)
+{
+    CStratumClient* pclient = static_cast<CStratumClient*>(ctx);
+    struct evbuffer* input = bufferevent_get_input(bev);
+
+    size_t nLength;
+    char* line;
+    while ((line = evbuffer_readln(input, &nLength, EVBUFFER_EOL_CRLF))) {
+        std::string strRequest(line, nLength);
+        free(line);
+        if (nLength > MAX_STRATUM_LINE_LENGTH || !HandleRequest(*pclient, strRequest)) {
+            CloseClient(pclient);
+            return;
+        }
+    }
+    if (evbuffer_get_length(input) > MAX_STRATUM_LINE_LENGTH) {
+        LogPrint("stratum", "%s: request from %s too long\n", __func__, pclient->strAddress);
+        CloseClient(pclient);
+    }
+}
+
+static void StratumEventCallback(struct bufferevent* bev, short events, void* ctx)
+{
+    if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR))
+        CloseClient(static_cast<CStratumClient*>(ctx));
+}
+
+static void StratumAcceptCallback(struct evconnlistener* listener, evutil_socket_t fd, struct sockaddr* address, int socklen, void* ctx)
+{
+    CService addr;
+    addr.SetSockAddr(address);
+
+    LOCK(cs_stratum);
+    if (mapClients.size() >= (size_t)MAX_STRATUM_CONNECTIONS) {
+        LogPrint("stratum", "%s: too many workers, refusing %s\n", __func__, addr.ToString());
+        evutil_closesocket(fd);
+        return;
+    }
+
+    struct bufferevent* bev = bufferevent_socket_new(eventBaseStratum, fd, BEV_OPT_CLOSE_ON_FREE);
+    if (!bev) {
+        evutil_closesocket(fd);
+        return;
+    }
+
+    std::unique_ptr<CStratumClient> client(new CStratumClient());
+    client->nId = ++nLastClientId;
+    client->bev = bev;
+    client->strAddress = addr.ToString();
+    // Workers roll the rest of the extranonce themselves, no two of them search the same coinbases
+    client->vchExtraNonce1.resize(STRATUM_EXTRANONCE1_SIZE);
+    WriteBE32(client->vchExtraNonce1.data(), ++nLastExtraNonce1);
+    client->fSubscribed = false;
+    client->fAuthorized = false;
+    client->nConnectedTime = GetTime();
+    client->dDifficulty = dMinDifficulty;
+    client->hashShareTarget = GetShareTarget(dMinDifficulty);
+    client->nAccepted = 0;
+    client->nRejected = 0;
+    client->nBlocks = 0;
+    client->nLastShareTime = 0;
+
+    bufferevent_setcb(bev, StratumReadCallback, nullptr, StratumEventCallback, client.get());
+    bufferevent_enable(bev, EV_READ | EV_WRITE);
+    LogPrint("stratum", "%s: worker %s connected\n", __func__, client->strAddress);
+    mapClients[client->nId] = std::move(client);
+}
+
+static void StratumUpdateJobCallback(evutil_socket_t, short, void*)
+{
+    UpdateJob(true);
+}
+
+static void StratumRefreshJobCallback(evutil_socket_t, short, void*)
+{
+    UpdateJob(false);
+}
+
+static void ThreadStratum()
+{
+    RenameThread("dynamic-stratum");
+    LogPrint("stratum", "%s: entering event loop\n", __func__);
+    event_base_dispatch(eventBaseStratum);
+    LogPrint("stratum", "%s: exited event loop\n", __func__);
+}
+
+bool InitStratumServer(const CChainParams& chainparams)
+{
+    if (!GetBoolArg("-stratum", DEFAULT_STRATUM_ENABLE))
+        return true;
+
+    pchainparams = &chainparams;
+    if (!ParseDouble(GetArg("-stratumdifficulty", std::to_string(DEFAULT_STRATUM_DIFFICULTY)), &dMinDifficulty) || !(dMinDifficulty > 0))
+        return error("%s: -stratumdifficulty must be a positive number", __func__);
+
+    std::string strAddress = GetArg("-stratumaddress", "");
+    if (!strAddress.empty()) {
+        CDynamicAddress address(strAddress);
+        if (!address.IsValid())
+            return error("%s: invalid -stratumaddress '%s'", __func__, strAddress);
+        coinbaseScript = std::make_shared<CReserveScript>();
+        coinbaseScript->reserveScript = GetScriptForDestination(address.Get());
+    } else {
+        GetMainSignals().ScriptForMining(coinbaseScript);
+        fWalletScript = true;
+        if (!coinbaseScript || coinbaseScript->reserveScript.empty())
+            return error("%s: -stratum requires -stratumaddress or a wallet to pay blocks to", __func__);
+    }
+
+    CService bind;
+    int nPort = GetArg("-stratumport", DEFAULT_STRATUM_PORT);
+    if (!Lookup(GetArg("-stratumbind", "127.0.0.1").c_str(), bind, nPort, false))
+        return error("%s: invalid -stratumbind", __func__);
+    struct sockaddr_storage sockaddr;
+    socklen_t len = sizeof(sockaddr);
+    if (!bind.GetSockAddr((struct sockaddr*)&sockaddr, &len))
+        return error("%s: unsupported -stratumbind address %s", __func__, bind.ToString());
+
+#ifdef WIN32
+    evthread_use_windows_threads();
+#else
+    evthread_use_pthreads();
+#endif
+    eventBaseStratum = event_base_new();
+    if (!eventBaseStratum)
+        return error("%s: couldn't create an event_base", __func__);
+
+    listenerStratum = evconnlistener_new_bind(eventBaseStratum, StratumAcceptCallback, nullptr,
+        LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE, -1, (struct sockaddr*)&sockaddr, len);
+    if (!listenerStratum) {
+        event_base_free(eventBaseStratum);
+        eventBaseStratum = nullptr;
+        return error("%s: unable to bind to %s", __func__, bind.ToString());
+    }
+
+    eventUpdateJob = event_new(eventBaseStratum, -1, 0, StratumUpdateJobCallback, nullptr);
+    eventRefreshJob = event_new(eventBaseStratum, -1, EV_PERSIST, StratumRefreshJobCallback, nullptr);
+    struct timeval tv = {STRATUM_JOB_REFRESH_INTERVAL, 0};
+    evtimer_add(eventRefreshJob, &tv);
+
+    nLastExtraNonce1 = GetRand(std::numeric_limits<uint32_t>::max());
+    stratumStats = StratumStats();
+    stratumStats.strBind = bind.ToString();
+
+    pStratumNotificationInterface = new CStratumNotificationInterface();
+    RegisterValidationInterface(pStratumNotificationInterface);
+
+    // The first job is built once the loop runs
+    event_active(eventUpdateJob, 0, 0);
+    threadStratum = std::thread(ThreadStratum);
+    LogPrintf("Stratum server listening on %s\n", stratumStats.strBind);
+    return true;
+}
+
+void InterruptStratumServer()
+{
+    if (eventBaseStratum)
+        event_base_loopbreak(eventBaseStratum);
+}
+
+void StopStratumServer()
+{
+    if (!eventBaseStratum)
+        return;
+
+    if (pStratumNotificationInterface) {
+        UnregisterValidationInterface(pStratumNotificationInterface);
+        delete pStratumNotificationInterface;
+        pStratumNotificationInterface = nullptr;
+    }
+
+    event_base_loopbreak(eventBaseStratum);
+    if (threadStratum.joinable())
+        threadStratum.join();
+
+    {
+        LOCK(cs_stratum);
+        for (const auto& item : mapClients)
+            bufferevent_free(item.second->bev);
+        mapClients.clear();
+        dequeJobs.clear();
+    }
+    evconnlistener_free(listenerStratum);
+    listenerStratum = nullptr;
+    event_free(eventUpdateJob);
+    eventUpdateJob = nullptr;
+    event_free(eventRefreshJob);
+    eventRefreshJob = nullptr;
+    event_base_free(eventBaseStratum);
+    eventBaseStratum = nullptr;
+    coinbaseScript.reset();
+}
+
+bool GetStratumStats(StratumStats& stats)
+{
+    LOCK(cs_stratum);
+    if (!eventBaseStratum)
+        return false;
+
+    stats = stratumStats;
+    int64_t nNow = GetTime();
+    for (const auto& item : mapClients) {
+        const CStratumClient& client = *item.second;
+        StratumWorkerStats worker;
+        worker.nId = client.nId;
+        worker.strAddress = client.strAddress;
+        worker.strWorker = client.strWorker;
+        worker.nConnectedTime = client.nConnectedTime;
+        worker.dDifficulty = client.dDifficulty;
+        double dHashes = 0;
+        for (const auto& share : client.dequeShares) {
+            if (share.first >= nNow - STRATUM_HASHRATE_WINDOW)
+                dHashes += share.second;
+        }
+        worker.dHashRate = dHashes / std::max((int64_t)1, std::min(STRATUM_HASHRATE_WINDOW, nNow - client.nConnectedTime));
+        worker.nAccepted = client.nAccepted;
+        worker.nRejected = client.nRejected;
+        worker.nBlocks = client.nBlocks;
+        worker.nLastShareTime = client.nLastShareTime;
+        worker.mapRejectReasons = client.mapRejectReasons;
+        stats.vWorkers.push_back(worker);
+    }
+    return true;
+}
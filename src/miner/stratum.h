@@ -0,0 +1,75 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_MINER_STRATUM_H
+#define DYNAMIC_MINER_STRATUM_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class CChainParams;
+
+/** Default for -stratum */
+static const bool DEFAULT_STRATUM_ENABLE = false;
+/** Default for -stratumport */
+static const unsigned short DEFAULT_STRATUM_PORT = 33380;
+/** Default for -stratumdifficulty, the share difficulty relative to the proof-of-work limit */
+static const double DEFAULT_STRATUM_DIFFICULTY = 1.0;
+/** Bytes of the extranonce the server assigns to a connection */
+static const unsigned int STRATUM_EXTRANONCE1_SIZE = 4;
+/** Bytes of the extranonce a worker rolls itself */
+static const unsigned int STRATUM_EXTRANONCE2_SIZE = 4;
+/** Jobs of the current tip kept for shares that arrive late */
+static const size_t STRATUM_MAX_JOBS = 16;
+/** Seconds between checks for new mempool transactions to put in a job */
+static const int STRATUM_JOB_REFRESH_INTERVAL = 5;
+/** Seconds of accepted shares a worker's hashrate is estimated from */
+static const int64_t STRATUM_HASHRATE_WINDOW = 600;
+/** Longest request line a worker may send */
+static const size_t MAX_STRATUM_LINE_LENGTH = 16 * 1024;
+/** Maximum number of workers connected at once */
+static const int MAX_STRATUM_CONNECTIONS = 256;
+
+/** Share statistics of one connected worker */
+struct StratumWorkerStats {
+    int64_t nId;
+    std::string strAddress;
+    std::string strWorker;           //!< name given in mining.authorize
+    int64_t nConnectedTime;
+    double dDifficulty;
+    double dHashRate;                //!< hashes per second expected for the shares accepted in the window
+    uint64_t nAccepted;
+    uint64_t nRejected;
+    uint64_t nBlocks;
+    int64_t nLastShareTime;
+    std::map<std::string, uint64_t> mapRejectReasons;
+};
+
+struct StratumStats {
+    std::string strBind;
+    int nHeight;                     //!< height of the current job, 0 if there is none yet
+    uint64_t nJobs;                  //!< jobs built since the server started
+    double dLastJobMillis;           //!< time taken to build the last job
+    uint64_t nAccepted;              //!< totals of all workers, including disconnected ones
+    uint64_t nRejected;
+    uint64_t nBlocks;
+    std::vector<StratumWorkerStats> vWorkers;
+};
+
+/**
+ * Start the Stratum server if -stratum is set.
+ * One block template is built for every new tip or set of mempool
+ * transactions and pushed to all workers as a mining.notify job.
+ */
+bool InitStratumServer(const CChainParams& chainparams);
+/** Stop accepting work, the event loop exits */
+void InterruptStratumServer();
+/** Disconnect all workers and free the server */
+void StopStratumServer();
+/** Get the server and worker statistics, false if the server is not running */
+bool GetStratumStats(StratumStats& stats);
+
+#endif // DYNAMIC_MINER_STRATUM_H
@@ -34,6 +34,7 @@
 #include <string.h>
 #else
 #include <fcntl.h>
+#include <sys/uio.h>
 #endif
 
 #ifdef USE_UPNP
@@ -88,6 +89,7 @@ std::string strSubVersion;
 boost::array<int, 10> vnThreadsRunning;
 
 limitedmap<uint256, int64_t> mapAlreadyAskedFor(MAX_INV_SZ);
+CNetMessageBufferPool netMessageBufferPool;
 
 // Signals for message handling
 static CNodeSignals g_signals;
@@ -417,14 +419,32 @@ void CConnman::DumpBanlist()
     int64_t nStart = GetTimeMillis();
 
     CBanDB bandb;
+    bool fCompact = bandb.NeedsCompaction();
     banmap_t banmap;
-    SetBannedSetDirty(false);
-    GetBanned(banmap);
-    if (!bandb.Write(banmap))
-        SetBannedSetDirty(true);
+    std::vector<CBanChange> vChanges;
+    {
+        LOCK(cs_setBanned);
+        setBannedIsDirty = false;
+        vChanges.swap(vBanChanges);
+        // dirty without changes means the whole set was replaced
+        fCompact |= vChanges.empty();
+        if (fCompact)
+            banmap = setBanned;
+    }
+
+    if (fCompact ? !bandb.Write(banmap) : !bandb.AppendChanges(vChanges)) {
+        LOCK(cs_setBanned);
+        setBannedIsDirty = true;
+        vBanChanges.insert(vBanChanges.begin(), vChanges.begin(), vChanges.end());
+        return;
+    }
 
-    LogPrint("net", "Flushed %d banned node ips/subnets to banlist.dat  %dms\n",
-        banmap.size(), GetTimeMillis() - nStart);
+    if (fCompact)
+        LogPrint("net", "Flushed %d banned node ips/subnets to banlist.dat  %dms\n",
+            banmap.size(), GetTimeMillis() - nStart);
+    else
+        LogPrint("net", "Journaled %d banlist changes to banlist.journal  %dms\n",
+            vChanges.size(), GetTimeMillis() - nStart);
 }
 
 void CNode::CloseSocketDisconnect()
@@ -443,6 +463,7 @@ void CConnman::ClearBanned()
         LOCK(cs_setBanned);
         setBanned.clear();
         setBannedIsDirty = true;
+        vBanChanges.emplace_back(CBanChange::CLEAR);
     }
     DumpBanlist(); //store banlist to disk
     if (clientInterface)
@@ -501,6 +522,7 @@ void CConnman::Ban(const CSubNet& subNet, const BanReason& banReason, int64_t ba
         if (setBanned[subNet].nBanUntil < banEntry.nBanUntil) {
             setBanned[subNet] = banEntry;
             setBannedIsDirty = true;
+            vBanChanges.emplace_back(CBanChange::SET, subNet, banEntry);
         } else
             return;
     }
@@ -530,6 +552,7 @@ bool CConnman::Unban(const CSubNet& subNet)
         if (!setBanned.erase(subNet))
             return false;
         setBannedIsDirty = true;
+        vBanChanges.emplace_back(CBanChange::ERASE, subNet);
     }
     if (clientInterface)
         clientInterface->BannedListChanged();
@@ -548,6 +571,8 @@ void CConnman::SetBanned(const banmap_t& banMap)
     LOCK(cs_setBanned);
     setBanned = banMap;
     setBannedIsDirty = true;
+    // the whole set is written by the next DumpBanlist
+    vBanChanges.clear();
 }
 
 void CConnman::SweepBanned()
@@ -562,6 +587,7 @@ void CConnman::SweepBanned()
         if (now > banEntry.nBanUntil) {
             setBanned.erase(it++);
             setBannedIsDirty = true;
+            vBanChanges.emplace_back(CBanChange::ERASE, subNet);
             LogPrint("net", "%s: Removed banned node ip/subnet from banlist.dat: %s\n", __func__, subNet.ToString());
         } else
             ++it;
@@ -578,6 +604,8 @@ void CConnman::SetBannedSetDirty(bool dirty)
 {
     LOCK(cs_setBanned); //reuse setBanned lock for the isDirty flag
     setBannedIsDirty = dirty;
+    if (!dirty)
+        vBanChanges.clear();
 }
 
 bool CConnman::IsWhitelistedRange(const CNetAddr& addr)
@@ -654,13 +682,19 @@ void CNode::copyStats(CNodeStats& stats)
     {
         LOCK(cs_vSend);
         X(mapSendBytesPerMsgCmd);
+        X(sendQueueStats);
         X(nSendBytes);
+        X(nSendSyscalls);
     }
     {
         LOCK(cs_vRecv);
         X(mapRecvBytesPerMsgCmd);
         X(nRecvBytes);
     }
+    {
+        LOCK(cs_processStats);
+        X(mapProcessStatsPerMsgCmd);
+    }
     X(fWhitelisted);
 
 
@@ -697,7 +731,7 @@ bool CNode::ReceiveMsgBytes(const char* pch, unsigned int nBytes, bool& complete
         // get current incomplete message, or create a new one
         if (vRecvMsg.empty() ||
             vRecvMsg.back().complete())
-            vRecvMsg.push_back(CNetMessage(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION));
+            vRecvMsg.emplace_back(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
 
         CNetMessage& msg = vRecvMsg.back();
 
@@ -790,6 +824,12 @@ int CNetMessage::readHeader(const char* pch, unsigned int nBytes)
     // switch state to reading message data
     in_data = true;
 
+    // the payload length is known now, take a buffer of the matching size class
+    CSerializeData vchBuffer;
+    nBufferClass = netMessageBufferPool.Acquire(vchBuffer, hdr.nMessageSize);
+    if (nBufferClass >= 0)
+        vRecv.SwapBuffer(vchBuffer);
+
     return nCopy;
 }
 
@@ -810,6 +850,15 @@ int CNetMessage::readData(const char* pch, unsigned int nBytes)
     return nCopy;
 }
 
+CNetMessage::~CNetMessage()
+{
+    if (nBufferClass >= 0) {
+        CSerializeData vchBuffer;
+        vRecv.SwapBuffer(vchBuffer);
+        netMessageBufferPool.Release(vchBuffer, nBufferClass);
+    }
+}
+
 const uint256& CNetMessage::GetMessageHash() const
 {
     assert(complete());
@@ -818,34 +867,223 @@ const uint256& CNetMessage::GetMessageHash() const
     return data_hash;
 }
 
+int CNetMessageBufferPool::GetSizeClass(size_t nSize)
+{
+    for (int nClass = 0; nClass < NUM_SIZE_CLASSES; nClass++) {
+        if (nSize <= GetClassSize(nClass))
+            return nClass;
+    }
+    return -1;
+}
+
+int CNetMessageBufferPool::Acquire(CSerializeData& vch, size_t nSize)
+{
+    // empty messages (verack, getaddr, ...) never touch their buffer
+    if (nSize == 0)
+        return -1;
+
+    int nClass = GetSizeClass(nSize);
+    {
+        LOCK(cs);
+        if (nClass < 0) {
+            nUnclassed++;
+            return -1;
+        }
+        if (!vFree[nClass].empty()) {
+            vch.swap(vFree[nClass].back());
+            vFree[nClass].pop_back();
+            nReused++;
+            return nClass;
+        }
+        nAllocated++;
+    }
+
+    CSerializeData vchNew;
+    vchNew.reserve(GetClassSize(nClass));
+    vch.swap(vchNew);
+    return nClass;
+}
+
+void CNetMessageBufferPool::Release(CSerializeData& vch, int nClass)
+{
+    assert(nClass >= 0 && nClass < NUM_SIZE_CLASSES);
+    size_t nClassSize = GetClassSize(nClass);
+    size_t nMaxBuffers = std::max(size_t(MIN_CACHED_BUFFERS_PER_CLASS), MAX_CACHED_BYTES_PER_CLASS / nClassSize);
+
+    LOCK(cs);
+    if (vch.capacity() < nClassSize || vFree[nClass].size() >= nMaxBuffers) {
+        nDiscarded++;
+        return;
+    }
+    vch.clear();
+    vFree[nClass].push_back(std::move(vch));
+    nReturned++;
+}
+
+CNetMessageBufferPool::Stats CNetMessageBufferPool::GetStats() const
+{
+    LOCK(cs);
+    Stats stats;
+    stats.nBuffersCached = 0;
+    stats.nBytesCached = 0;
+    for (int nClass = 0; nClass < NUM_SIZE_CLASSES; nClass++) {
+        stats.nBuffersCached += vFree[nClass].size();
+        for (const CSerializeData& vch : vFree[nClass])
+            stats.nBytesCached += vch.capacity();
+        stats.vClasses.emplace_back(GetClassSize(nClass), vFree[nClass].size());
+    }
+    stats.nReused = nReused;
+    stats.nAllocated = nAllocated;
+    stats.nReturned = nReturned;
+    stats.nDiscarded = nDiscarded;
+    stats.nUnclassed = nUnclassed;
+    return stats;
+}
+
+SendPriority GetSendPriority(const std::string& strCommand)
+{
+    // merkleblock stays with tx, the transactions that matched the filter must follow it
+    static const std::set<std::string> setHigh = {
+        NetMsgType::VERSION, NetMsgType::VERACK, NetMsgType::PING, NetMsgType::PONG,
+        NetMsgType::HEADERS, NetMsgType::CMPCTBLOCK, NetMsgType::GETBLOCKTXN, NetMsgType::BLOCKTXN,
+        NetMsgType::TXLOCKREQUEST, NetMsgType::TXLOCKVOTE, NetMsgType::DNPING};
+    static const std::set<std::string> setBulk = {
+        NetMsgType::BLOCK, NetMsgType::DNGOVERNANCEOBJECT, NetMsgType::DNGOVERNANCEOBJECTVOTE};
+
+    if (setHigh.count(strCommand))
+        return SEND_PRIORITY_HIGH;
+    if (setBulk.count(strCommand))
+        return SEND_PRIORITY_BULK;
+    return SEND_PRIORITY_NORMAL;
+}
+
+const char* SendPriorityName(int nPriority)
+{
+    switch (nPriority) {
+    case SEND_PRIORITY_HIGH:
+        return "high";
+    case SEND_PRIORITY_NORMAL:
+        return "normal";
+    case SEND_PRIORITY_BULK:
+        return "bulk";
+    }
+    return "unknown";
+}
+
+int64_t CSendQueueStats::GetBucketBound(int nBucket)
+{
+    if (nBucket >= NUM_BUCKETS - 1)
+        return -1;
+    int64_t nBound = 1000;
+    for (int i = 0; i < nBucket; i++)
+        nBound *= 10;
+    return nBound;
+}
+
+void CSendQueueStats::Add(int64_t nQueueTime, size_t nSize)
+{
+    nMessages++;
+    nBytes += nSize;
+    nQueueTimeTotal += nQueueTime;
+    nQueueTimeMax = std::max(nQueueTimeMax, nQueueTime);
+    int nBucket = 0;
+    while (nBucket < NUM_BUCKETS - 1 && nQueueTime >= GetBucketBound(nBucket))
+        nBucket++;
+    vBuckets[nBucket]++;
+}
+
+// requires LOCK(cs_vSend)
+bool CConnman::FillSendBuffer(CNode* pnode) const
+{
+    if (!pnode->vSendMsg.empty())
+        return false;
+
+    // Take the highest class first, several messages at once so they can share a sendmsg() call
+    int64_t nNow = GetTimeMicros();
+    size_t nFilled = 0;
+    for (int nPriority = 0; nPriority < NUM_SEND_PRIORITIES && nFilled < MAX_SEND_COALESCE_BYTES; nPriority++) {
+        std::deque<CNode::CQueuedNetMsg>& queue = pnode->vSendQueue[nPriority];
+        while (!queue.empty() && nFilled < MAX_SEND_COALESCE_BYTES) {
+            CNode::CQueuedNetMsg& msg = queue.front();
+            size_t nSize = msg.header.size() + msg.data.size();
+            pnode->sendQueueStats[nPriority].Add(nNow - msg.nTimeQueued, nSize);
+            pnode->vSendMsg.push_back(std::move(msg.header));
+            if (!msg.data.empty())
+                pnode->vSendMsg.push_back(std::move(msg.data));
+            pnode->nSendQueueSize -= nSize;
+            nFilled += nSize;
+            queue.pop_front();
+        }
+    }
+    return nFilled > 0;
+}
+
 // requires LOCK(cs_vSend)
 size_t CConnman::SocketSendData(CNode* pnode) const
 {
+    FillSendBuffer(pnode);
     auto it = pnode->vSendMsg.begin();
     size_t nSentSize = 0;
 
     while (it != pnode->vSendMsg.end()) {
-        const auto& data = *it;
-        assert(data.size() > pnode->nSendOffset);
+        assert(it->size() > pnode->nSendOffset);
         int nBytes = 0;
+        size_t nAttempted = 0;
         {
             LOCK(pnode->cs_hSocket);
             if (pnode->hSocket == INVALID_SOCKET)
                 break;
-            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(data.data()) + pnode->nSendOffset, data.size() - pnode->nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+#ifdef WIN32
+            nAttempted = it->size() - pnode->nSendOffset;
+            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(it->data()) + pnode->nSendOffset, nAttempted, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+            // Gather the unsent part of the first buffer and as many of the following
+            // ones as the limits allow, so header and payload of many small messages
+            // go out in one call.
+            struct iovec vIov[MAX_SEND_IOVECS];
+            size_t nIov = 0;
+            size_t nOffset = pnode->nSendOffset;
+            for (auto itIov = it; itIov != pnode->vSendMsg.end() && nIov < MAX_SEND_IOVECS && nAttempted < MAX_SEND_COALESCE_BYTES; ++itIov) {
+                vIov[nIov].iov_base = const_cast<unsigned char*>(itIov->data()) + nOffset;
+                vIov[nIov].iov_len = itIov->size() - nOffset;
+                nAttempted += vIov[nIov].iov_len;
+                nIov++;
+                nOffset = 0;
+            }
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = vIov;
+            msg.msg_iovlen = nIov;
+            nBytes = sendmsg(pnode->hSocket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+            pnode->nSendSyscalls++;
         }
         if (nBytes > 0) {
             pnode->nLastSend = GetSystemTimeInSeconds();
             pnode->nSendBytes += nBytes;
-            pnode->nSendOffset += nBytes;
             nSentSize += nBytes;
-            if (pnode->nSendOffset == data.size()) {
+            // Consume the buffers covered by the write, the last one may be partially sent
+            size_t nRemaining = nBytes;
+            while (nRemaining > 0) {
+                size_t nLeft = it->size() - pnode->nSendOffset;
+                if (nRemaining < nLeft) {
+                    pnode->nSendOffset += nRemaining;
+                    break;
+                }
+                nRemaining -= nLeft;
                 pnode->nSendOffset = 0;
-                pnode->nSendSize -= data.size();
-                pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
+                pnode->nSendSize -= it->size();
                 it++;
-            } else {
-                // could not send full message; stop sending more
+            }
+            pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
+            if (it == pnode->vSendMsg.end()) {
+                // everything handed to the socket went out, go on with the queued messages
+                pnode->vSendMsg.clear();
+                FillSendBuffer(pnode);
+                it = pnode->vSendMsg.begin();
+            }
+            if ((size_t)nBytes < nAttempted) {
+                // could not send everything we offered; stop sending more
                 break;
             }
         } else {
@@ -865,6 +1103,7 @@ size_t CConnman::SocketSendData(CNode* pnode) const
     if (it == pnode->vSendMsg.end()) {
         assert(pnode->nSendOffset == 0);
         assert(pnode->nSendSize == 0);
+        assert(pnode->nSendQueueSize == 0);
     }
     pnode->vSendMsg.erase(pnode->vSendMsg.begin(), it);
     return nSentSize;
@@ -1576,15 +1815,27 @@ void CConnman::ThreadDNSAddressSeed()
 }
 
 
-void CConnman::DumpAddresses()
+void CConnman::DumpAddresses(bool fCompact)
 {
     int64_t nStart = GetTimeMillis();
 
     CAddrDB adb;
-    adb.Write(addrman);
-
-    LogPrint("net", "Flushed %d addresses to peers.dat  %dms\n",
-        addrman.size(), GetTimeMillis() - nStart);
+    // changes made from here on are in the snapshot, the journal of the next one or both
+    std::vector<CAddrManChange> vChanges = addrman.TakeChanges();
+    if (fCompact || adb.NeedsCompaction()) {
+        if (adb.Write(addrman)) {
+            LogPrint("net", "Flushed %d addresses to peers.dat  %dms\n",
+                addrman.size(), GetTimeMillis() - nStart);
+            return;
+        }
+    }
+    if (!adb.AppendChanges(vChanges)) {
+        // keep them for the next dump
+        addrman.RequeueChanges(vChanges);
+        return;
+    }
+    LogPrint("net", "Journaled %d address changes to peers.journal  %dms\n",
+        vChanges.size(), GetTimeMillis() - nStart);
 }
 
 void CConnman::DumpData()
@@ -2187,13 +2438,8 @@ NodeId CConnman::GetNewNodeId()
     return nLastNodeId.fetch_add(1, std::memory_order_relaxed);
 }
 
-bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options connOptions)
+void CConnman::Init(const Options& connOptions)
 {
-    nTotalBytesRecv = 0;
-    nTotalBytesSent = 0;
-    nMaxOutboundTotalBytesSentInCycle = 0;
-    nMaxOutboundCycleStartTime = 0;
-
     nRelevantServices = connOptions.nRelevantServices;
     nLocalServices = connOptions.nLocalServices;
     nMaxConnections = connOptions.nMaxConnections;
@@ -2210,6 +2456,17 @@ bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options c
     SetBestHeight(connOptions.nBestHeight);
 
     clientInterface = connOptions.uiInterface;
+}
+
+bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options connOptions)
+{
+    nTotalBytesRecv = 0;
+    nTotalBytesSent = 0;
+    nMaxOutboundTotalBytesSentInCycle = 0;
+    nMaxOutboundCycleStartTime = 0;
+
+    Init(connOptions);
+
     if (clientInterface)
         clientInterface->InitMessage(_("Loading addresses..."));
     // Load addresses from peers.dat
@@ -2221,8 +2478,9 @@ bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options c
         else {
             addrman.Clear(); // Addrman can be in an inconsistent state after failure, reset it
             LogPrintf("Invalid or missing peers.dat; recreating\n");
-            DumpAddresses();
+            DumpAddresses(true);
         }
+        addrman.SetRecordChanges(true);
     }
     if (clientInterface)
         clientInterface->InitMessage(_("Loading banlist..."));
@@ -2666,6 +2924,62 @@ uint64_t CConnman::GetTotalBytesSent()
     return nTotalBytesSent;
 }
 
+void CMsgProcessStats::Add(const CMsgProcessStats& other)
+{
+    nCount += other.nCount;
+    nWallMicros += other.nWallMicros;
+    nCPUMicros += other.nCPUMicros;
+    nLockWaitMicros += other.nLockWaitMicros;
+    nMaxWallMicros = std::max(nMaxWallMicros, other.nMaxWallMicros);
+}
+
+CMsgProcessTimer::CMsgProcessTimer() : nWallStart(GetTimeMicros()), nCPUStart(GetThreadCPUTimeMicros()), nLockWaitStart(GetThreadLockWaitMicros())
+{
+}
+
+CMsgProcessStats CMsgProcessTimer::Elapsed(bool fCount) const
+{
+    CMsgProcessStats stats;
+    stats.nCount = fCount ? 1 : 0;
+    stats.nWallMicros = GetTimeMicros() - nWallStart;
+    stats.nCPUMicros = GetThreadCPUTimeMicros() - nCPUStart;
+    stats.nLockWaitMicros = GetThreadLockWaitMicros() - nLockWaitStart;
+    stats.nMaxWallMicros = stats.nWallMicros;
+    return stats;
+}
+
+void CConnman::RecordMessageProcessing(CNode* pnode, const std::string& strCommand, const CMsgProcessStats& stats)
+{
+    // same commands as mapRecvBytesPerMsgCmd, so a peer can't grow the maps with made up ones
+    static const std::set<std::string> setAllNetMessageTypes(getAllNetMessageTypes().begin(), getAllNetMessageTypes().end());
+    const std::string& strKey = setAllNetMessageTypes.count(strCommand) ? strCommand : NET_MESSAGE_COMMAND_OTHER;
+    {
+        LOCK(pnode->cs_processStats);
+        pnode->mapProcessStatsPerMsgCmd[strKey].Add(stats);
+    }
+    LOCK(cs_processStats);
+    mapProcessStatsPerMsgCmd[strKey].Add(stats);
+}
+
+mapMsgCmdProcessStats CConnman::GetMessageProcessingStats()
+{
+    LOCK(cs_processStats);
+    return mapProcessStatsPerMsgCmd;
+}
+
+void CConnman::ResetMessageProcessingStats()
+{
+    {
+        LOCK(cs_processStats);
+        mapProcessStatsPerMsgCmd.clear();
+    }
+    LOCK(cs_vNodes);
+    for (CNode* pnode : vNodes) {
+        LOCK(pnode->cs_processStats);
+        pnode->mapProcessStatsPerMsgCmd.clear();
+    }
+}
+
 ServiceFlags CConnman::GetLocalServices() const
 {
     return nLocalServices;
@@ -2703,6 +3017,7 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     nLastSend = 0;
     nLastRecv = 0;
     nSendBytes = 0;
+    nSendSyscalls = 0;
     nRecvBytes = 0;
     nTimeOffset = 0;
     addrName = addrNameIn == "" ? addr.ToStringIPPort() : addrNameIn;
@@ -2719,6 +3034,7 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     nRefCount = 0;
     nSendSize = 0;
     nSendOffset = 0;
+    nSendQueueSize = 0;
     hashContinue = uint256();
     nStartingHeight = -1;
     filterInventoryKnown.reset();
@@ -2825,6 +3141,9 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
 
+    SendPriority nPriority = GetSendPriority(msg.command);
+    int64_t nTimeQueued = GetTimeMicros();
+
     size_t nBytesSent = 0;
     {
         LOCK(pnode->cs_vSend);
@@ -2833,12 +3152,12 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         //log total amount of bytes per command
         pnode->mapSendBytesPerMsgCmd[msg.command] += nTotalSize;
         pnode->nSendSize += nTotalSize;
+        pnode->nSendQueueSize += nTotalSize;
 
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize)
-            pnode->vSendMsg.push_back(std::move(msg.data));
+        // Wait in the message's class until the messages being written and those of higher classes went out
+        pnode->vSendQueue[nPriority].push_back(CNode::CQueuedNetMsg{std::move(serializedHeader), std::move(msg.data), nTimeQueued});
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend == true)
@@ -24,6 +24,7 @@
 #include "uint256.h"
 #include "util.h"
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <deque>
@@ -95,6 +96,26 @@ static const bool DEFAULT_BLOCKSONLY = false;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER = 1 * 1000;
+/** Maximum number of queued buffers handed to a single sendmsg() call */
+static const size_t MAX_SEND_IOVECS = 64;
+/** Stop gathering more queued buffers for a single sendmsg() call past this many bytes */
+static const size_t MAX_SEND_COALESCE_BYTES = 256 * 1024;
+
+/**
+ * Classes of outgoing messages. Queued messages of a class are sent before
+ * any of a lower class, in the order they were pushed within a class. A
+ * message that started going out on the socket is always completed first.
+ */
+enum SendPriority {
+    SEND_PRIORITY_HIGH,   //!< handshake, pings, block headers and announcements, InstantSend and dynode pings
+    SEND_PRIORITY_NORMAL, //!< everything else
+    SEND_PRIORITY_BULK,   //!< full blocks and governance objects and votes
+    NUM_SEND_PRIORITIES
+};
+
+/** Class a message is sent in, by its command */
+SendPriority GetSendPriority(const std::string& strCommand);
+const char* SendPriorityName(int nPriority);
 
 static const ServiceFlags REQUIRED_SERVICES = NODE_NETWORK;
 
@@ -132,6 +153,35 @@ struct CSerializedNetMsg {
     std::string command;
 };
 
+/** Cost of processing the messages of one command, times in microseconds */
+struct CMsgProcessStats {
+    uint64_t nCount;
+    int64_t nWallMicros;
+    int64_t nCPUMicros;
+    int64_t nLockWaitMicros; //!< time spent waiting for contended locks, included in nWallMicros
+    int64_t nMaxWallMicros;
+
+    CMsgProcessStats() : nCount(0), nWallMicros(0), nCPUMicros(0), nLockWaitMicros(0), nMaxWallMicros(0) {}
+
+    void Add(const CMsgProcessStats& other);
+};
+typedef std::map<std::string, CMsgProcessStats> mapMsgCmdProcessStats; //command, processing cost
+
+/** Measures the cost of processing a message on the calling thread from construction */
+class CMsgProcessTimer
+{
+private:
+    int64_t nWallStart;
+    int64_t nCPUStart;
+    int64_t nLockWaitStart;
+
+public:
+    CMsgProcessTimer();
+
+    /** Cost since construction, counted as one message if fCount */
+    CMsgProcessStats Elapsed(bool fCount = true) const;
+};
+
 class CConnman
 {
 public:
@@ -158,6 +208,8 @@ public:
     };
     CConnman(uint64_t seed0, uint64_t seed1);
     ~CConnman();
+    /** Apply the options, Start does this before it loads addresses and opens connections */
+    void Init(const Options& connOptions);
     bool Start(CScheduler& scheduler, std::string& strNodeError, Options options);
     void Stop();
     void Interrupt();
@@ -396,6 +448,13 @@ public:
     uint64_t GetTotalBytesRecv();
     uint64_t GetTotalBytesSent();
 
+    //! add the cost of processing a message from pnode to its stats and the totals
+    void RecordMessageProcessing(CNode* pnode, const std::string& strCommand, const CMsgProcessStats& stats);
+    //! processing cost per command of all peers since startup or the last reset
+    mapMsgCmdProcessStats GetMessageProcessingStats();
+    //! clear the totals and the stats of every connected peer
+    void ResetMessageProcessingStats();
+
     void SetBestHeight(int height);
     int GetBestHeight() const;
 
@@ -439,13 +498,16 @@ private:
     NodeId GetNewNodeId();
 
     size_t SocketSendData(CNode* pnode) const;
+    //! hand queued messages to vSendMsg by class, once the messages before them were written
+    bool FillSendBuffer(CNode* pnode) const;
     //!check is the banlist has unwritten changes
     bool BannedSetIsDirty();
-    //!set the "dirty" flag for the banlist
+    //!set the "dirty" flag for the banlist, clearing it drops the changes to journal
     void SetBannedSetDirty(bool dirty = true);
     //!clean unused entries (if bantime has expired)
     void SweepBanned();
-    void DumpAddresses();
+    //!journal the changes to addrman, or write all of it when fCompact or the journal has grown large
+    void DumpAddresses(bool fCompact = false);
     void DumpData();
     void DumpBanlist();
 
@@ -462,6 +524,10 @@ private:
     uint64_t nTotalBytesRecv;
     uint64_t nTotalBytesSent;
 
+    // Message processing cost totals
+    CCriticalSection cs_processStats;
+    mapMsgCmdProcessStats mapProcessStatsPerMsgCmd;
+
     // outbound limit & stats
     uint64_t nMaxOutboundTotalBytesSentInCycle;
     uint64_t nMaxOutboundCycleStartTime;
@@ -481,6 +547,7 @@ private:
     banmap_t setBanned;
     CCriticalSection cs_setBanned;
     bool setBannedIsDirty;
+    std::vector<CBanChange> vBanChanges; //!< changes to setBanned not in banlist.dat/banlist.journal yet
     bool fAddressesInitialized;
     CAddrMan addrman;
     std::deque<std::string> vOneShots;
@@ -489,9 +556,14 @@ private:
     CCriticalSection cs_vAddedNodes;
     std::vector<CService> vPendingDynodes;
     CCriticalSection cs_vPendingDynodes;
+
+protected:
+    // Benchmarks connect nodes without sockets here
     std::vector<CNode*> vNodes;
     std::list<CNode*> vNodesDisconnected;
     mutable CCriticalSection cs_vNodes;
+
+private:
     std::atomic<NodeId> nLastNodeId;
 
     /** Connection signal */
@@ -610,6 +682,25 @@ extern CCriticalSection cs_mapLocalHost;
 extern std::map<CNetAddr, LocalServiceInfo> mapLocalHost;
 typedef std::map<std::string, uint64_t> mapMsgCmdSize; //command, total bytes
 
+/** Messages that went through a send queue class and how long they waited in it */
+struct CSendQueueStats {
+    /** Histogram buckets: below 1ms, 10ms, 100ms, 1s and longer */
+    static const int NUM_BUCKETS = 5;
+
+    uint64_t nMessages;
+    uint64_t nBytes;
+    int64_t nQueueTimeTotal; //!< in microseconds
+    int64_t nQueueTimeMax;   //!< in microseconds
+    uint64_t vBuckets[NUM_BUCKETS];
+
+    CSendQueueStats() : nMessages(0), nBytes(0), nQueueTimeTotal(0), nQueueTimeMax(0), vBuckets() {}
+
+    void Add(int64_t nQueueTime, size_t nSize);
+    /** Upper bound in microseconds of a histogram bucket, -1 for the last one */
+    static int64_t GetBucketBound(int nBucket);
+};
+typedef std::array<CSendQueueStats, NUM_SEND_PRIORITIES> SendQueueStatsArray;
+
 class CNodeStats
 {
 public:
@@ -627,9 +718,12 @@ public:
     bool fAddnode;
     int nStartingHeight;
     uint64_t nSendBytes;
+    uint64_t nSendSyscalls;
     mapMsgCmdSize mapSendBytesPerMsgCmd;
+    SendQueueStatsArray sendQueueStats;
     uint64_t nRecvBytes;
     mapMsgCmdSize mapRecvBytesPerMsgCmd;
+    mapMsgCmdProcessStats mapProcessStatsPerMsgCmd;
     bool fWhitelisted;
     double dPingTime;
     double dPingWait;
@@ -639,6 +733,60 @@ public:
 };
 
 
+/**
+ * Recycles the payload buffers of received messages. A buffer is picked by
+ * the payload length from the message header, from one of a few size classes,
+ * and handed back once the message has been processed. This keeps the steady
+ * stream of small messages from allocating a new vector for every message.
+ */
+class CNetMessageBufferPool
+{
+public:
+    static const int NUM_SIZE_CLASSES = 6;
+    /** Smallest size class, every following class is four times larger */
+    static const size_t MIN_CLASS_SIZE = 256;
+    /** Bytes of free buffers kept per size class */
+    static const size_t MAX_CACHED_BYTES_PER_CLASS = 1024 * 1024;
+    /** Free buffers kept per size class regardless of their size */
+    static const size_t MIN_CACHED_BUFFERS_PER_CLASS = 8;
+
+    struct Stats {
+        size_t nBuffersCached;
+        size_t nBytesCached;
+        uint64_t nReused;
+        uint64_t nAllocated;
+        uint64_t nReturned;
+        uint64_t nDiscarded;
+        uint64_t nUnclassed;
+        std::vector<std::pair<size_t, size_t> > vClasses; // size class, free buffers
+    };
+
+    /** Size class serving a payload of nSize bytes, -1 if it is too large to be pooled */
+    static int GetSizeClass(size_t nSize);
+    static size_t GetClassSize(int nClass) { return MIN_CLASS_SIZE << (2 * nClass); }
+
+    /**
+     * Replace vch with an empty buffer that can hold nSize bytes.
+     * @return the size class of the buffer, -1 if vch was left untouched
+     */
+    int Acquire(CSerializeData& vch, size_t nSize);
+    /** Hand back a buffer obtained from Acquire */
+    void Release(CSerializeData& vch, int nClass);
+
+    Stats GetStats() const;
+
+private:
+    mutable CCriticalSection cs;
+    std::vector<CSerializeData> vFree[NUM_SIZE_CLASSES];
+    uint64_t nReused = 0;
+    uint64_t nAllocated = 0;
+    uint64_t nReturned = 0;
+    uint64_t nDiscarded = 0;
+    uint64_t nUnclassed = 0;
+};
+
+extern CNetMessageBufferPool netMessageBufferPool;
+
 class CNetMessage
 {
 private:
@@ -657,6 +805,8 @@ public:
 
     int64_t nTime; // time (in microseconds) of message receipt.
 
+    int nBufferClass; // size class vRecv was taken from, -1 if not pooled
+
     CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, int nTypeIn, int nVersionIn) : hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn), vRecv(nTypeIn, nVersionIn)
     {
         hdrbuf.resize(24);
@@ -664,8 +814,15 @@ public:
         nHdrPos = 0;
         nDataPos = 0;
         nTime = 0;
+        nBufferClass = -1;
     }
 
+    // the payload buffer is handed back to netMessageBufferPool on destruction
+    CNetMessage(const CNetMessage&) = delete;
+    CNetMessage& operator=(const CNetMessage&) = delete;
+
+    ~CNetMessage();
+
     bool complete() const
     {
         if (!in_data)
@@ -696,10 +853,12 @@ public:
     std::atomic<ServiceFlags> nServices;
     ServiceFlags nServicesExpected;
     SOCKET hSocket;
-    size_t nSendSize;   // total size of all vSendMsg entries
+    size_t nSendSize;   // total size of all vSendMsg entries and queued messages
     size_t nSendOffset; // offset inside the first vSendMsg already sent
     uint64_t nSendBytes;
-    std::deque<std::vector<unsigned char> > vSendMsg;
+    uint64_t nSendSyscalls; // number of send calls made for this peer
+    std::deque<std::vector<unsigned char> > vSendMsg; // header and payload buffers being written to the socket
+    size_t nSendQueueSize; // total size of the messages waiting in vSendQueue
     CCriticalSection cs_vSend;
     CCriticalSection cs_hSocket;
     CCriticalSection cs_vRecv;
@@ -760,6 +919,18 @@ protected:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
     mapMsgCmdSize mapRecvBytesPerMsgCmd;
 
+    /** A message waiting in a send queue class */
+    struct CQueuedNetMsg {
+        std::vector<unsigned char> header;
+        std::vector<unsigned char> data;
+        int64_t nTimeQueued; //!< in microseconds
+    };
+    // Messages not yet handed to vSendMsg, per class, and how long they waited. Protected by cs_vSend.
+    std::array<std::deque<CQueuedNetMsg>, NUM_SEND_PRIORITIES> vSendQueue;
+    SendQueueStatsArray sendQueueStats;
+    CCriticalSection cs_processStats;
+    mapMsgCmdProcessStats mapProcessStatsPerMsgCmd;
+
 public:
     uint256 hashContinue;
     std::atomic<int> nStartingHeight;
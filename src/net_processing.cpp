@@ -14,7 +14,9 @@
 #include "blockencodings.h"
 #include "chainparams.h"
 #include "consensus/validation.h"
+#include "core_memusage.h"
 #include "hash.h"
+#include "header-ranges.h"
 #include "init.h"
 #include "merkleblock.h"
 #include "net.h"
@@ -26,6 +28,7 @@
 #include "primitives/transaction.h"
 #include "random.h"
 #include "tinyformat.h"
+#include "tx-recon.h"
 #include "txmempool.h"
 #include "ui_interface.h"
 #include "util.h"
@@ -39,6 +42,7 @@
 #include "dynodeman.h"
 #include "governance.h"
 #include "instantsend.h"
+#include "privatesend.h"
 #include "spork.h"
 #ifdef ENABLE_WALLET
 #include "privatesend-client.h"
@@ -74,6 +78,8 @@ void EraseOrphansFor(NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 static size_t vExtraTxnForCompactIt = 0;
 static std::vector<std::pair<uint256, CTransactionRef> > vExtraTxnForCompact GUARDED_BY(cs_main);
+static size_t nExtraTxnForCompactUsage GUARDED_BY(cs_main) = 0;
+static std::deque<CBlockReconstructionStats> dequeBlockReconstructionStats GUARDED_BY(cs_main);
 
 static const uint64_t RANDOMIZER_ID_ADDRESS_RELAY = 0x3cac0035b5866b90ULL; // SHA256("main address relay")[0:8]
 
@@ -119,9 +125,14 @@ struct QueuedBlock {
     const CBlockIndex* pindex;                              //!< Optional.
     bool fValidatedHeaders;                                 //!< Whether this block has validated headers at the time of request.
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock; //!< Optional, used for CMPCTBLOCK downloads
+    int64_t nTimeRequested;                                 //!< When the block was requested (in microseconds).
+    bool fReRequested;                                      //!< Whether it was taken over from a slower peer.
 };
 std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> > mapBlocksInFlight;
 
+/** Header ranges fetched ahead of the headers sync peer during initial sync. Protected by cs_main. */
+CHeaderRangeSync headerRanges;
+
 /** Stack of nodes which we have set to announce using compact blocks */
 std::list<NodeId> lNodesAnnouncingHeaderAndIDs;
 
@@ -131,6 +142,9 @@ int nPreferredDownload = 0;
 /** Number of peers from which we're downloading blocks. */
 int nPeersWithValidatedDownloads = 0;
 
+/** Number of outbound reconciling peers that are still sent every transaction inv. Protected by cs_main. */
+int nTxReconFloodPeers = 0;
+
 /** Relay map, protected by cs_main. */
 typedef std::map<uint256, CTransactionRef> MapRelay;
 MapRelay mapRelay;
@@ -184,6 +198,10 @@ struct CNodeState {
     bool fSyncStarted;
     //! When to potentially disconnect peer for stalling headers download
     int64_t nHeadersSyncTimeout;
+    //! Whether headers sync with this peer waits for a header range another peer is downloading.
+    bool fHeadersWaitingForRange;
+    //! Whether this peer failed a header range, it doesn't get another one.
+    bool fHeaderRangeFailed;
     //! Since when we're stalling block download progress (in microseconds), or 0.
     int64_t nStallingSince;
     std::list<QueuedBlock> vBlocksInFlight;
@@ -191,6 +209,18 @@ struct CNodeState {
     int64_t nDownloadingSince;
     int nBlocksInFlight;
     int nBlocksInFlightValidHeaders;
+    //! Number of blocks this peer may have in flight, derived from the rate it delivers them at.
+    int nBlocksInFlightTarget;
+    //! Moving average of the time between deliveries of requested blocks (in microseconds).
+    int64_t nBlockIntervalAvg;
+    //! Moving average of the time between requesting a block and receiving it (in microseconds).
+    int64_t nBlockLatencyAvg;
+    //! When the last requested block arrived (in microseconds).
+    int64_t nLastBlockReceived;
+    //! Number of requested blocks received, the averages are meaningless while this is 0.
+    int nBlocksReceived;
+    //! Number of blocks requested from this peer because a slower peer held back the download window.
+    int nBlocksReRequested;
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload;
     //! Whether this peer wants invs or headers (when possible) for block announcements.
@@ -204,6 +234,10 @@ struct CNodeState {
      * otherwise: whether this peer sends non-last version in cmpctblocks/blocktxns.
      */
     bool fSupportsDesiredCmpctVersion;
+    //! The salt we sent in sendtxrcncl, 0 if we didn't offer reconciliation.
+    uint64_t nTxReconSalt;
+    //! Transaction reconciliation with this peer, if both sides agreed to it.
+    std::unique_ptr<CTxReconState> txrecon;
 
     CNodeState(CAddress addrIn, std::string addrNameIn) : address(addrIn), name(addrNameIn)
     {
@@ -217,15 +251,24 @@ struct CNodeState {
         nUnconnectingHeaders = 0;
         fSyncStarted = false;
         nHeadersSyncTimeout = 0;
+        fHeadersWaitingForRange = false;
+        fHeaderRangeFailed = false;
         nStallingSince = 0;
         nDownloadingSince = 0;
         nBlocksInFlight = 0;
         nBlocksInFlightValidHeaders = 0;
+        nBlocksInFlightTarget = DEFAULT_BLOCKS_IN_TRANSIT_PER_PEER;
+        nBlockIntervalAvg = 0;
+        nBlockLatencyAvg = 0;
+        nLastBlockReceived = 0;
+        nBlocksReceived = 0;
+        nBlocksReRequested = 0;
         fPreferredDownload = false;
         fPreferHeaders = false;
         fPreferHeaderAndIDs = false;
         fProvidesHeaderAndIDs = false;
         fSupportsDesiredCmpctVersion = false;
+        nTxReconSalt = 0;
     }
 };
 
@@ -300,9 +343,12 @@ void FinalizeNode(NodeId nodeid, bool& fUpdateConnectionTime)
         mapBlocksInFlight.erase(entry.hash);
     }
     EraseOrphansFor(nodeid);
+    headerRanges.Release(nodeid);
     nPreferredDownload -= state->fPreferredDownload;
     nPeersWithValidatedDownloads -= (state->nBlocksInFlightValidHeaders != 0);
     assert(nPeersWithValidatedDownloads >= 0);
+    if (state->txrecon && state->txrecon->fInitiator && state->txrecon->fFlood)
+        nTxReconFloodPeers--;
 
     mapNodeState.erase(nodeid);
 
@@ -311,17 +357,46 @@ void FinalizeNode(NodeId nodeid, bool& fUpdateConnectionTime)
         assert(mapBlocksInFlight.empty());
         assert(nPreferredDownload == 0);
         assert(nPeersWithValidatedDownloads == 0);
+        assert(nTxReconFloodPeers == 0);
+    }
+}
+
+// Requires cs_main.
+// Update the delivery rate and latency estimates of a peer that sent us a block we asked it for,
+// and with them the number of blocks we keep in flight from it.
+void UpdateBlockDownloadEstimates(CNodeState* state, const QueuedBlock& queuedBlock)
+{
+    int64_t nNow = GetTimeMicros();
+    // the peer has been busy since the previous delivery, or since the queue was started
+    int64_t nInterval = std::max<int64_t>(nNow - std::max(state->nLastBlockReceived, state->nDownloadingSince), 0);
+    int64_t nLatency = std::max<int64_t>(nNow - queuedBlock.nTimeRequested, 0);
+    if (state->nBlocksReceived == 0) {
+        state->nBlockIntervalAvg = nInterval;
+        state->nBlockLatencyAvg = nLatency;
+    } else {
+        // new samples are weighted 1/8
+        state->nBlockIntervalAvg += (nInterval - state->nBlockIntervalAvg) / 8;
+        state->nBlockLatencyAvg += (nLatency - state->nBlockLatencyAvg) / 8;
     }
+    state->nLastBlockReceived = nNow;
+    state->nBlocksReceived++;
+
+    int64_t nTarget = BLOCK_DOWNLOAD_QUEUE_SECONDS * 1000000 / std::max<int64_t>(state->nBlockIntervalAvg, 1);
+    state->nBlocksInFlightTarget = std::min<int64_t>(std::max<int64_t>(nTarget, MIN_BLOCKS_IN_TRANSIT_PER_PEER), MAX_BLOCKS_IN_TRANSIT_PER_PEER);
 }
 
 // Requires cs_main.
 // Returns a bool indicating whether we requested this block.
 // Also used if a block was /not/ received and timed out or started with another peer
-bool MarkBlockAsReceived(const uint256& hash)
+// nodeFrom is the peer that delivered the block, if any.
+bool MarkBlockAsReceived(const uint256& hash, NodeId nodeFrom = -1)
 {
     std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(hash);
     if (itInFlight != mapBlocksInFlight.end()) {
         CNodeState* state = State(itInFlight->second.first);
+        if (itInFlight->second.first == nodeFrom) {
+            UpdateBlockDownloadEstimates(state, *itInFlight->second.second);
+        }
         state->nBlocksInFlightValidHeaders -= itInFlight->second.second->fValidatedHeaders;
         if (state->nBlocksInFlightValidHeaders == 0 && itInFlight->second.second->fValidatedHeaders) {
             // Last validated block on the queue was received.
@@ -359,7 +434,7 @@ bool MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const Consensus::Pa
     MarkBlockAsReceived(hash);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-        {hash, pindex, pindex != NULL, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : NULL)});
+        {hash, pindex, pindex != NULL, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : NULL), GetTimeMicros(), false});
     state->nBlocksInFlight++;
     state->nBlocksInFlightValidHeaders += it->fValidatedHeaders;
     if (state->nBlocksInFlight == 1) {
@@ -567,6 +642,99 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
     }
 }
 
+/** Find the block at the start of a peer's download window, if it is in flight from a slower peer that has
+ *  held it for longer than this peer would likely need to deliver it. Requires cs_main. */
+const CBlockIndex* FindBlockToReRequest(NodeId nodeid, int64_t nNow)
+{
+    CNodeState* state = State(nodeid);
+    assert(state != NULL);
+
+    if (state->nBlocksReceived == 0 || state->pindexLastCommonBlock == NULL || state->pindexBestKnownBlock == NULL ||
+        state->pindexLastCommonBlock->nHeight >= state->pindexBestKnownBlock->nHeight)
+        return NULL;
+
+    const CBlockIndex* pindex = state->pindexBestKnownBlock->GetAncestor(state->pindexLastCommonBlock->nHeight + 1);
+    std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(pindex->GetBlockHash());
+    if (itInFlight == mapBlocksInFlight.end() || itInFlight->second.first == nodeid)
+        return NULL;
+
+    // Take a block over only once, so two peers don't keep stealing it from each other
+    const QueuedBlock& queuedBlock = *itInFlight->second.second;
+    if (queuedBlock.fReRequested || nNow - queuedBlock.nTimeRequested < BLOCK_REREQUEST_LATENCY_FACTOR * state->nBlockLatencyAvg)
+        return NULL;
+
+    CNodeState* stateHolder = State(itInFlight->second.first);
+    if (stateHolder->nBlocksReceived > 0 && stateHolder->nBlockIntervalAvg <= state->nBlockIntervalAvg)
+        return NULL;
+
+    return pindex;
+}
+
+// Requires cs_main.
+void RequestHeaderRange(CNode* pnode, const CHeaderRange& range, CConnman& connman)
+{
+    LogPrint("net", "getheaders range %d-%d from %d to peer=%d\n", range.nStartHeight, range.nEndHeight, range.GetTipHeight(), pnode->id);
+    headerRanges.MarkRequested(pnode->GetId(), GetTimeMicros());
+    connman.PushMessage(pnode, CNetMsgMaker(pnode->GetSendVersion()).Make(NetMsgType::GETHEADERS, CBlockLocator(std::vector<uint256>(1, range.GetTipHash())), range.hashEnd));
+}
+
+// Requires cs_main.
+// Add the headers a peer sent for its header range and ask for the next batch, or for another range.
+void ProcessHeaderRange(CNode* pfrom, const std::vector<CBlockHeader>& headers, const std::vector<uint256>& vHashes, const Consensus::Params& consensusParams, CConnman& connman)
+{
+    CNodeState* nodestate = State(pfrom->GetId());
+    int nDoS = 0;
+    std::string strError;
+    CHeaderRangeSync::Result result = headerRanges.AddHeaders(pfrom->GetId(), headers, vHashes, consensusParams, nDoS, strError);
+    if (result == CHeaderRangeSync::RANGE_FAILED) {
+        LogPrint("net", "header range from peer=%d failed: %s\n", pfrom->id, strError);
+        nodestate->fHeaderRangeFailed = true;
+        if (nDoS > 0)
+            Misbehaving(pfrom->GetId(), nDoS);
+        return;
+    }
+
+    const CHeaderRange* range = headerRanges.GetRange(pfrom->GetId());
+    if (result == CHeaderRangeSync::RANGE_DONE) {
+        LogPrint("net", "header range %d-%d complete, peer=%d\n", range->nStartHeight, range->nEndHeight, pfrom->id);
+        headerRanges.Release(pfrom->GetId());
+        range = headerRanges.Assign(pfrom->GetId(), pfrom->nStartingHeight, GetTimeMicros());
+    }
+    if (range)
+        RequestHeaderRange(pfrom, *range, connman);
+}
+
+// Hand the verified header ranges that now connect to our headers to validation.
+void ConnectHeaderRanges(const CChainParams& chainparams)
+{
+    while (true) {
+        std::vector<CBlockHeader> headers;
+        std::vector<uint256> vHashes;
+        NodeId nodeidSource = -1;
+        {
+            LOCK(cs_main);
+            if (!headerRanges.PopConnectable([](const uint256& hash) { return mapBlockIndex.count(hash) > 0; }, headers, vHashes, nodeidSource))
+                return;
+        }
+        CValidationState state;
+        const CBlockIndex* pindexLast = NULL;
+        if (!ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast, &vHashes)) {
+            LogPrintf("%s: invalid header range from peer=%d: %s\n", __func__, nodeidSource, FormatStateMessage(state));
+            // Drop what the peer sent for the range, another peer or the headers sync fetches it again
+            LOCK(cs_main);
+            headerRanges.Reset(headers, vHashes);
+            CNodeState* nodestate = State(nodeidSource);
+            if (nodestate)
+                nodestate->fHeaderRangeFailed = true;
+            int nDoS = 0;
+            if (state.IsInvalid(nDoS))
+                Misbehaving(nodeidSource, nDoS);
+            return;
+        }
+        LogPrint("net", "connected %u headers from a header range, up to height %d\n", headers.size(), pindexLast->nHeight);
+    }
+}
+
 } // namespace
 
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats)
@@ -582,6 +750,23 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats)
         if (queue.pindex)
             stats.vHeightInFlight.push_back(queue.pindex->nHeight);
     }
+    stats.nBlocksInFlightTarget = state->nBlocksInFlightTarget;
+    stats.nBlockIntervalAvg = state->nBlockIntervalAvg;
+    stats.nBlockLatencyAvg = state->nBlockLatencyAvg;
+    stats.nBlocksReceived = state->nBlocksReceived;
+    stats.nBlocksReRequested = state->nBlocksReRequested;
+    stats.fTxRecon = (bool)state->txrecon;
+    if (state->txrecon) {
+        const CTxReconState& recon = *state->txrecon;
+        stats.fTxReconInitiator = recon.fInitiator;
+        stats.fTxReconFlood = recon.fFlood;
+        stats.nTxReconRounds = recon.nRounds;
+        stats.nTxReconPending = recon.setToReconcile.size() + recon.vecInFlight.size();
+        stats.nTxReconAnnounced = recon.nAnnounced;
+        stats.nTxReconSkipped = recon.nSkipped;
+        stats.nTxReconSketchBytes = recon.nSketchBytes;
+        stats.nTxReconBytesSaved = recon.GetBytesSaved();
+    }
     return true;
 }
 
@@ -611,12 +796,102 @@ void AddToCompactExtraTransactions(const CTransactionRef& tx)
     size_t max_extra_txn = GetArg("-blockreconstructionextratxn", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN);
     if (max_extra_txn <= 0)
         return;
+    size_t max_extra_txn_usage = GetArg("-blockreconstructionextratxnsize", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN_SIZE) * 1000000;
+    size_t usage = RecursiveDynamicUsage(*tx);
+    if (usage > max_extra_txn_usage)
+        return;
     if (!vExtraTxnForCompact.size())
         vExtraTxnForCompact.resize(max_extra_txn);
+    // Drop the oldest transactions, starting with the one overwritten, until the new one fits
+    for (size_t i = 0; i < max_extra_txn; i++) {
+        std::pair<uint256, CTransactionRef>& entry = vExtraTxnForCompact[(vExtraTxnForCompactIt + i) % max_extra_txn];
+        if (i > 0 && nExtraTxnForCompactUsage + usage <= max_extra_txn_usage)
+            break;
+        if (entry.second) {
+            nExtraTxnForCompactUsage -= RecursiveDynamicUsage(*entry.second);
+            entry = std::pair<uint256, CTransactionRef>();
+        }
+    }
+    nExtraTxnForCompactUsage += usage;
     vExtraTxnForCompact[vExtraTxnForCompactIt] = std::make_pair(tx->GetHash(), tx);
     vExtraTxnForCompactIt = (vExtraTxnForCompactIt + 1) % max_extra_txn;
 }
 
+void AddEvictedToCompactExtraTransactions(CTransactionRef tx, MemPoolRemovalReason reason)
+{
+    // Transactions trimmed from a full mempool or expired may still be mined by
+    // others. Both happen in LimitMempoolSize, which is called with cs_main held.
+    if (reason == MemPoolRemovalReason::EXPIRY || reason == MemPoolRemovalReason::SIZELIMIT)
+        AddToCompactExtraTransactions(tx);
+}
+
+namespace
+{
+/** Transactions of accepted InstantSend lock requests, known after they were mined or evicted */
+class CInstantSendTxSource : public CCompactBlockTxSource
+{
+public:
+    std::string GetName() const override { return "instantsend"; }
+    void ForEachTx(const std::function<bool(const CTransactionRef&)>& fn) const override { instantsend.ForEachAcceptedLockRequest(fn); }
+};
+
+/** Mixing transactions broadcast by dynodes, these are often mined without ever being relayed to us */
+class CPrivateSendTxSource : public CCompactBlockTxSource
+{
+public:
+    std::string GetName() const override { return "privatesend"; }
+    void ForEachTx(const std::function<bool(const CTransactionRef&)>& fn) const override { CPrivateSend::ForEachPSTX(fn); }
+};
+
+const CInstantSendTxSource instantSendTxSource;
+const CPrivateSendTxSource privateSendTxSource;
+const std::vector<const CCompactBlockTxSource*> vCompactBlockTxSources = {&instantSendTxSource, &privateSendTxSource};
+} // namespace
+
+void RecordBlockReconstruction(const uint256& hash, const CBlockHeaderAndShortTxIDs& cmpctblock, const PartiallyDownloadedBlock& partialBlock) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    CBlockReconstructionStats stats;
+    stats.hash = hash;
+    stats.nTime = GetTime();
+    stats.nTxCount = cmpctblock.BlockTxCount();
+    stats.nPrefilled = partialBlock.GetPrefilledCount();
+    stats.nMempool = partialBlock.GetFoundCount();
+    stats.nExtra = partialBlock.GetExtraCount();
+    for (size_t i = 0; i < vCompactBlockTxSources.size(); i++)
+        stats.vSources.emplace_back(vCompactBlockTxSources[i]->GetName(), partialBlock.GetSourceCounts()[i]);
+    stats.nRequested = stats.nTxCount - stats.nPrefilled - stats.nMempool;
+
+    dequeBlockReconstructionStats.push_back(stats);
+    if (dequeBlockReconstructionStats.size() > BLOCK_RECONSTRUCTION_STATS_HISTORY)
+        dequeBlockReconstructionStats.pop_front();
+}
+
+std::vector<CBlockReconstructionStats> GetBlockReconstructionStats()
+{
+    LOCK(cs_main);
+    return std::vector<CBlockReconstructionStats>(dequeBlockReconstructionStats.begin(), dequeBlockReconstructionStats.end());
+}
+
+/** Send an inv for the transactions a reconciliation round found the peer is missing */
+void AnnounceReconciledTxs(CNode* pto, const std::vector<uint256>& vecHashes, CConnman& connman)
+{
+    const CNetMsgMaker msgMaker(pto->GetSendVersion());
+    std::vector<CInv> vInv;
+    LOCK(pto->cs_inventory);
+    for (const uint256& hash : vecHashes) {
+        if (pto->filterInventoryKnown.contains(hash))
+            continue;
+        pto->filterInventoryKnown.insert(hash);
+        vInv.push_back(CInv(MSG_TX, hash));
+        if (vInv.size() == MAX_INV_SZ) {
+            connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
+            vInv.clear();
+        }
+    }
+    if (!vInv.empty())
+        connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
+}
+
 bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     const uint256& hash = tx->GetHash();
@@ -746,6 +1021,13 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn) :
 {
     // Initialize global variables that cannot be constructed at startup.
     recentRejects.reset(new CRollingBloomFilter(120000, 0.000001));
+
+    mempool.NotifyEntryRemoved.connect(&AddEvictedToCompactExtraTransactions);
+}
+
+PeerLogicValidation::~PeerLogicValidation()
+{
+    mempool.NotifyEntryRemoved.disconnect(&AddEvictedToCompactExtraTransactions);
 }
 
 void PeerLogicValidation::SyncTransaction(const CTransaction& tx, const CBlockIndex* pindex, int nPosInBlock)
@@ -1534,6 +1816,21 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::SENDCMPCT, fAnnounceUsingCMPCTBLOCK, nCMPCTBLOCKVersion));
         }
 
+        bool fPeerRelayTxes;
+        {
+            LOCK(pfrom->cs_filter);
+            fPeerRelayTxes = pfrom->fRelayTxes;
+        }
+        if (pfrom->nVersion >= TXRECON_PROTO_VERSION && fRelayTxes && fPeerRelayTxes && GetBoolArg("-txreconciliation", DEFAULT_TXRECONCILIATION)) {
+            // Offer to reconcile transactions instead of announcing each of them
+            uint64_t nSalt = GetRand(std::numeric_limits<uint64_t>::max());
+            {
+                LOCK(cs_main);
+                State(pfrom->GetId())->nTxReconSalt = nSalt;
+            }
+            connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::SENDTXRCNCL, TXRECON_VERSION, nSalt));
+        }
+
         pfrom->fSuccessfullyConnected = true;
     }
 
@@ -1603,6 +1900,81 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         }
     }
 
+    else if (strCommand == NetMsgType::SENDTXRCNCL) {
+        uint32_t nReconVersion = 0;
+        uint64_t nRemoteSalt = 0;
+        vRecv >> nReconVersion >> nRemoteSalt;
+        LOCK(cs_main);
+        CNodeState* state = State(pfrom->GetId());
+        if (state->txrecon) {
+            Misbehaving(pfrom->GetId(), 10);
+            return error("duplicate sendtxrcncl, peer=%d", pfrom->id);
+        }
+        // Only if we offered it as well
+        if (nReconVersion < TXRECON_VERSION || state->nTxReconSalt == 0)
+            return true;
+
+        // The outbound side sends the sketches. A few outbound peers still get every inv,
+        // so transactions spread quickly along a low fanout while the other links reconcile.
+        bool fInitiator = !pfrom->fInbound;
+        bool fFlood = fInitiator && nTxReconFloodPeers < GetArg("-txreconfloodpeers", DEFAULT_TXRECON_FLOOD_PEERS);
+        nTxReconFloodPeers += fFlood;
+        state->txrecon.reset(new CTxReconState(fInitiator, fFlood, state->nTxReconSalt, nRemoteSalt));
+        state->txrecon->nNextRound = PoissonNextSend(GetTimeMicros(), TXRECON_INTERVAL);
+        LogPrint("net", "reconciling transactions with peer=%d%s%s\n", pfrom->id, fInitiator ? " as initiator" : "", fFlood ? ", still flooding" : "");
+        // The responder can't tell on its own, it would wait for rounds that never come
+        if (fFlood)
+            connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::REQRECON, CTxReconSketch()));
+    }
+
+    else if (strCommand == NetMsgType::REQRECON) {
+        CTxReconSketch sketch;
+        vRecv >> sketch;
+        std::vector<uint256> vecAnnounce;
+        std::vector<uint32_t> vecDiffering;
+        bool fFloodNotice = sketch.IsFloodNotice();
+        {
+            LOCK(cs_main);
+            CNodeState* state = State(pfrom->GetId());
+            if (!state->txrecon || state->txrecon->fInitiator || state->txrecon->fFlood) {
+                Misbehaving(pfrom->GetId(), 10);
+                return error("unexpected reqrecon, peer=%d", pfrom->id);
+            }
+            if (fFloodNotice) {
+                // The set collected so far is announced, later transactions go out with inv right away
+                LogPrint("net", "peer=%d keeps flooding transactions\n", pfrom->id);
+                vecAnnounce = state->txrecon->StartFlooding();
+            } else if (!sketch.IsValid()) {
+                Misbehaving(pfrom->GetId(), 20);
+                return error("invalid reqrecon sketch, peer=%d", pfrom->id);
+            } else {
+                state->txrecon->Respond(sketch, vecAnnounce, vecDiffering);
+                state->txrecon->nSketchBytes += ::GetSerializeSize(sketch, SER_NETWORK, PROTOCOL_VERSION) + ::GetSerializeSize(vecDiffering, SER_NETWORK, PROTOCOL_VERSION);
+            }
+        }
+        // Our transactions go first, so the peer knows them by the time it announces its own
+        AnnounceReconciledTxs(pfrom, vecAnnounce, connman);
+        if (!fFloodNotice)
+            connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::RECONCILDIFF, vecDiffering));
+    }
+
+    else if (strCommand == NetMsgType::RECONCILDIFF) {
+        std::vector<uint32_t> vecDiffering;
+        vRecv >> vecDiffering;
+        std::vector<uint256> vecAnnounce;
+        {
+            LOCK(cs_main);
+            CNodeState* state = State(pfrom->GetId());
+            if (!state->txrecon || !state->txrecon->fInitiator || !state->txrecon->FinishRound(vecDiffering, vecAnnounce)) {
+                Misbehaving(pfrom->GetId(), 10);
+                return error("unexpected reconcildiff, peer=%d", pfrom->id);
+            }
+            state->txrecon->nSketchBytes += ::GetSerializeSize(vecDiffering, SER_NETWORK, PROTOCOL_VERSION);
+            state->txrecon->nNextRound = PoissonNextSend(GetTimeMicros(), TXRECON_INTERVAL);
+        }
+        AnnounceReconciledTxs(pfrom, vecAnnounce, connman);
+    }
+
     else if (strCommand == NetMsgType::INV) {
         vector<CInv> vInv;
         vRecv >> vInv;
@@ -2198,7 +2570,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     }
 
                     PartiallyDownloadedBlock& partialBlock = *(*queuedBlockIt)->partialBlock;
-                    ReadStatus status = partialBlock.InitData(cmpctblock, vExtraTxnForCompact);
+                    ReadStatus status = partialBlock.InitData(cmpctblock, vExtraTxnForCompact, vCompactBlockTxSources);
                     if (status == READ_STATUS_INVALID) {
                         MarkBlockAsReceived(pindex->GetBlockHash()); // Reset in-flight state in case of whitelist
                         Misbehaving(pfrom->GetId(), 100);
@@ -2211,6 +2583,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                         connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::GETDATA, vInv));
                         return true;
                     }
+                    RecordBlockReconstruction(pindex->GetBlockHash(), cmpctblock, partialBlock);
 
                     BlockTransactionsRequest req;
                     for (size_t i = 0; i < cmpctblock.BlockTxCount(); i++) {
@@ -2234,11 +2607,12 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     // Optimistically try to reconstruct anyway since we might be
                     // able to without any round trips.
                     PartiallyDownloadedBlock tempBlock(&mempool);
-                    ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact);
+                    ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact, vCompactBlockTxSources);
                     if (status != READ_STATUS_OK) {
                         // TODO: don't ignore failures
                         return true;
                     }
+                    RecordBlockReconstruction(pindex->GetBlockHash(), cmpctblock, tempBlock);
                     std::vector<CTransactionRef> dummy;
                     status = tempBlock.FillBlock(*pblock, dummy);
                     if (status == READ_STATUS_OK) {
@@ -2384,6 +2758,25 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             return true;
         }
 
+        // The header hash is expensive, compute it once and without holding cs_main
+        std::vector<uint256> vHashes;
+        vHashes.reserve(nCount);
+        for (const CBlockHeader& header : headers) {
+            vHashes.push_back(header.GetHash());
+        }
+
+        bool fRangeReply = false;
+        {
+            LOCK(cs_main);
+            fRangeReply = headerRanges.IsRangeReply(pfrom->GetId(), headers[0].hashPrevBlock);
+            if (fRangeReply)
+                ProcessHeaderRange(pfrom, headers, vHashes, chainparams.GetConsensus(), connman);
+        }
+        if (fRangeReply) {
+            ConnectHeaderRanges(chainparams);
+            return true;
+        }
+
         const CBlockIndex* pindexLast = NULL;
         {
             LOCK(cs_main);
@@ -2401,14 +2794,14 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 nodestate->nUnconnectingHeaders++;
                 connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexBestHeader), uint256()));
                 LogPrint("net", "received header %s: missing prev block %s, sending getheaders (%d) to end (peer=%d, nUnconnectingHeaders=%d)\n",
-                    headers[0].GetHash().ToString(),
+                    vHashes[0].ToString(),
                     headers[0].hashPrevBlock.ToString(),
                     pindexBestHeader->nHeight,
                     pfrom->id, nodestate->nUnconnectingHeaders);
                 // Set hashLastUnknownBlock for this peer, so that if we
                 // eventually get the headers - even from a different peer -
                 // we can use this peer to download.
-                UpdateBlockAvailability(pfrom->GetId(), headers.back().GetHash());
+                UpdateBlockAvailability(pfrom->GetId(), vHashes.back());
 
                 if (nodestate->nUnconnectingHeaders % MAX_UNCONNECTING_HEADERS == 0) {
                     Misbehaving(pfrom->GetId(), 20);
@@ -2416,18 +2809,16 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 return true;
             }
 
-            uint256 hashLastBlock;
-            for (const CBlockHeader& header : headers) {
-                if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
+            for (unsigned int n = 1; n < nCount; n++) {
+                if (headers[n].hashPrevBlock != vHashes[n - 1]) {
                     Misbehaving(pfrom->GetId(), 20);
                     return error("non-continuous headers sequence");
                 }
-                hashLastBlock = header.GetHash();
             }
         }
 
         CValidationState state;
-        if (!ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast)) {
+        if (!ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast, &vHashes)) {
             int nDoS;
             if (state.IsInvalid(nDoS)) {
                 if (nDoS > 0) {
@@ -2441,6 +2832,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             LogPrintf("*** ProcessMessage Error -- ProcessNewBlockHeaders returned an invalid pindexLast.  Avoid assert(pindexLast);\n");
             return error("ProcessNewBlockHeaders returned an invalid pindexLast.");
         }
+        // Header ranges downloaded from other peers may connect now
+        ConnectHeaderRanges(chainparams);
         {
             LOCK(cs_main);
             CNodeState* nodestate = State(pfrom->GetId());
@@ -2454,10 +2847,19 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
             if (nCount == MAX_HEADERS_RESULTS) {
                 // Headers message had its maximum size; the peer may have more headers.
-                // TODO: optimize: if pindexLast is an ancestor of chainActive.Tip or pindexBestHeader, continue
-                // from there instead.
-                LogPrint("net", "more getheaders (%d) to end to peer=%d (startheight:%d)\n", pindexLast->nHeight, pfrom->id, pfrom->nStartingHeight);
-                connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexLast), uint256()));
+                // If pindexLast is an ancestor of pindexBestHeader (header ranges may have been connected
+                // on top of it), continue from there instead.
+                const CBlockIndex* pindexNext = pindexLast;
+                if (pindexBestHeader->GetAncestor(pindexLast->nHeight) == pindexLast)
+                    pindexNext = pindexBestHeader;
+                if (headerRanges.IsDownloadingAfter(pindexNext->GetBlockHash())) {
+                    // Another peer is fetching the headers that follow, pick up after its range
+                    LogPrint("net", "getheaders (%d) waits for a header range, peer=%d\n", pindexNext->nHeight, pfrom->id);
+                    nodestate->fHeadersWaitingForRange = true;
+                } else {
+                    LogPrint("net", "more getheaders (%d) to end to peer=%d (startheight:%d)\n", pindexNext->nHeight, pfrom->id, pfrom->nStartingHeight);
+                    connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexNext), uint256()));
+                }
             }
 
             bool fCanDirectFetch = CanDirectFetch(chainparams.GetConsensus());
@@ -2529,7 +2931,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             LOCK(cs_main);
             // Also always process if we requested the block explicitly, as we may
             // need it even though it is not a candidate for a new best tip.
-            forceProcessing |= MarkBlockAsReceived(hash);
+            forceProcessing |= MarkBlockAsReceived(hash, pfrom->GetId());
             // mapBlockSource is only used for sending reject messages and DoS scores,
             // so the race between here and cs_main in ProcessNewBlock is fine.
             mapBlockSource.emplace(hash, std::make_pair(pfrom->GetId(), true));
@@ -2875,8 +3277,12 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
     //
     bool fMoreWork = false;
 
-    if (!pfrom->vRecvGetData.empty())
+    if (!pfrom->vRecvGetData.empty()) {
+        // serving the requests is part of the cost of the getdata messages, they were already counted
+        CMsgProcessTimer timer;
         ProcessGetData(pfrom, chainparams.GetConsensus(), connman, interruptMsgProc);
+        connman.RecordMessageProcessing(pfrom, NetMsgType::GETDATA, timer.Elapsed(false));
+    }
 
     if (pfrom->fDisconnect)
         return false;
@@ -2934,6 +3340,7 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
 
     // Process message
     bool fRet = false;
+    CMsgProcessTimer timer;
     try {
         fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc);
         if (interruptMsgProc)
@@ -2959,6 +3366,7 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
     } catch (...) {
         PrintExceptionContinue(NULL, "ProcessMessages()");
     }
+    connman.RecordMessageProcessing(pfrom, strCommand, timer.Elapsed());
 
     if (!fRet)
         LogPrintf("%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->id);
@@ -3093,6 +3501,24 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
             }
         }
 
+        // While the headers sync is far behind, fetch the headers between later checkpoints from other peers
+        if (!state.fSyncStarted && state.fPreferredDownload && !state.fHeaderRangeFailed && !pto->fClient && !pto->fDisconnect && !fImporting && !fReindex &&
+            fCheckpointsEnabled && pindexBestHeader->GetBlockTime() <= GetAdjustedTime() - nMaxTipAge) {
+            if (!headerRanges.IsInitialized())
+                headerRanges.Init(Params().Checkpoints().mapCheckpoints, pindexBestHeader->nHeight);
+            if (!headerRanges.GetRange(pto->GetId())) {
+                const CHeaderRange* range = headerRanges.Assign(pto->GetId(), pto->nStartingHeight, GetTimeMicros());
+                if (range)
+                    RequestHeaderRange(pto, *range, connman);
+            }
+        }
+        // The headers sync continues once nobody is fetching the headers after our best header anymore
+        if (state.fHeadersWaitingForRange && !headerRanges.IsDownloadingAfter(pindexBestHeader->GetBlockHash())) {
+            state.fHeadersWaitingForRange = false;
+            LogPrint("net", "more getheaders (%d) to end to peer=%d (startheight:%d)\n", pindexBestHeader->nHeight, pto->id, pto->nStartingHeight);
+            connman.PushMessage(pto, msgMaker.Make(NetMsgType::GETHEADERS, chainActive.GetLocator(pindexBestHeader), uint256()));
+        }
+
         // Resend wallet transactions that haven't gotten in a block yet
         // Except during reindex, importing and IBD, when old wallet
         // transactions become unconfirmed and spams other nodes.
@@ -3313,9 +3739,11 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                 std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                 // No reason to drain out at many times the network's capacity,
                 // especially since we have many peers and some will draw much shorter delays.
+                // Transactions for a reconciling peer wait for the next round instead.
+                CTxReconState* recon = state.txrecon && !state.txrecon->fFlood ? state.txrecon.get() : NULL;
                 unsigned int nRelayedTransactions = 0;
                 LOCK(pto->cs_filter);
-                while (!vInvTx.empty() && nRelayedTransactions < INVENTORY_BROADCAST_MAX) {
+                while (!vInvTx.empty() && (recon || nRelayedTransactions < INVENTORY_BROADCAST_MAX)) {
                     // Fetch the top element from the heap
                     std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                     std::set<uint256>::iterator it = vInvTx.back();
@@ -3334,9 +3762,14 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                     }
                     if (pto->pfilter && !pto->pfilter->IsRelevantAndUpdate(*txinfo.tx))
                         continue;
-                    // Send
-                    vInv.push_back(CInv(MSG_TX, hash));
-                    nRelayedTransactions++;
+                    // Send, or add it to the reconciliation set unless that is full
+                    bool fReconcile = recon && recon->setToReconcile.size() < TXRECON_MAX_SET_SIZE;
+                    if (fReconcile) {
+                        recon->setToReconcile.insert(hash);
+                    } else {
+                        vInv.push_back(CInv(MSG_TX, hash));
+                        nRelayedTransactions++;
+                    }
                     {
                         // Expire old relay messages
                         while (!vRelayExpiration.empty() && vRelayExpiration.front().first < nNow) {
@@ -3353,7 +3786,8 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                         connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
                         vInv.clear();
                     }
-                    pto->filterInventoryKnown.insert(hash);
+                    if (!fReconcile)
+                        pto->filterInventoryKnown.insert(hash);
                 }
             }
 
@@ -3370,6 +3804,24 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
         if (!vInv.empty())
             connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
 
+        //
+        // Message: transaction reconciliation
+        //
+        if (state.txrecon && state.txrecon->fInitiator && !state.txrecon->fFlood && state.txrecon->nNextRound < nNow) {
+            CTxReconState& recon = *state.txrecon;
+            if (recon.nInFlightBuckets > 0) {
+                // The peer didn't answer in time, announce the round's transactions the usual way
+                LogPrint("net", "reconciliation round timed out, peer=%d\n", pto->id);
+                AnnounceReconciledTxs(pto, recon.AbandonRound(), connman);
+                recon.nNextRound = PoissonNextSend(nNow, TXRECON_INTERVAL);
+            } else {
+                CTxReconSketch sketch = recon.StartRound();
+                recon.nSketchBytes += ::GetSerializeSize(sketch, SER_NETWORK, PROTOCOL_VERSION);
+                recon.nNextRound = nNow + TXRECON_ROUND_TIMEOUT * 1000000LL;
+                connman.PushMessage(pto, msgMaker.Make(NetMsgType::REQRECON, sketch));
+            }
+        }
+
         // Detect whether we're stalling
         nNow = GetTimeMicros();
         if (state.nStallingSince && state.nStallingSince < nNow - 1000000 * BLOCK_STALLING_TIMEOUT) {
@@ -3394,6 +3846,13 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                 return true;
             }
         }
+        // Give the header range of a peer that doesn't answer to another one
+        const CHeaderRange* pheaderRange = headerRanges.GetRange(pto->GetId());
+        if (pheaderRange && nNow > pheaderRange->nRequestTime + HEADER_RANGE_TIMEOUT) {
+            LogPrint("net", "Timeout downloading header range %d-%d from peer=%d\n", pheaderRange->nStartHeight, pheaderRange->nEndHeight, pto->id);
+            headerRanges.Release(pto->GetId());
+            state.fHeaderRangeFailed = true;
+        }
         // Check for headers sync timeouts
         if (state.fSyncStarted && state.nHeadersSyncTimeout < std::numeric_limits<int64_t>::max()) {
             // Detect whether this is a stalling initial-headers-sync peer
@@ -3432,16 +3891,31 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (!pto->fDisconnect && !pto->fClient && (fFetch || !IsInitialBlockDownload()) && state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        if (!pto->fDisconnect && !pto->fClient && (fFetch || !IsInitialBlockDownload()) && state.nBlocksInFlight < state.nBlocksInFlightTarget) {
             vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            FindNextBlocksToDownload(pto->GetId(), MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.nBlocksInFlight, vToDownload, staller, consensusParams);
+            unsigned int nWanted = state.nBlocksInFlightTarget - state.nBlocksInFlight;
+            FindNextBlocksToDownload(pto->GetId(), nWanted, vToDownload, staller, consensusParams);
             BOOST_FOREACH (const CBlockIndex* pindex, vToDownload) {
                 vGetData.push_back(CInv(MSG_BLOCK, pindex->GetBlockHash()));
                 MarkBlockAsInFlight(pto->GetId(), pindex->GetBlockHash(), consensusParams, pindex);
                 LogPrint("net", "Requesting block %s (%d) peer=%d\n", pindex->GetBlockHash().ToString(),
                     pindex->nHeight, pto->id);
             }
+            // We have spare capacity but are running out of blocks to ask for, so the window is closing in.
+            // Take over the block holding it back if a slower peer is late with it, before the window stalls.
+            if (vToDownload.size() < nWanted && IsInitialBlockDownload()) {
+                const CBlockIndex* pindex = FindBlockToReRequest(pto->GetId(), nNow);
+                if (pindex) {
+                    NodeId nodeSlow = mapBlocksInFlight[pindex->GetBlockHash()].first;
+                    vGetData.push_back(CInv(MSG_BLOCK, pindex->GetBlockHash()));
+                    MarkBlockAsInFlight(pto->GetId(), pindex->GetBlockHash(), consensusParams, pindex);
+                    mapBlocksInFlight[pindex->GetBlockHash()].second->fReRequested = true;
+                    state.nBlocksReRequested++;
+                    LogPrint("net", "Re-requesting block %s (%d) from peer=%d, peer=%d is late with it\n", pindex->GetBlockHash().ToString(),
+                        pindex->nHeight, pto->id, nodeSlow);
+                }
+            }
             if (state.nBlocksInFlight == 0 && staller != -1) {
                 if (State(staller)->nStallingSince == 0) {
                     State(staller)->nStallingSince = nNow;
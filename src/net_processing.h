@@ -23,8 +23,12 @@ static const int64_t ORPHAN_TX_EXPIRE_INTERVAL = 5 * 60;
 static constexpr int64_t HEADERS_DOWNLOAD_TIMEOUT_BASE = 15 * 60 * 1000000; // 15 minutes
 static constexpr int64_t HEADERS_DOWNLOAD_TIMEOUT_PER_HEADER = 1000;        // 1ms/header
 
-/** Default number of orphan+recently-replaced txn to keep around for block reconstruction */
-static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
+/** Default number of orphan, recently-replaced and evicted txn to keep around for block reconstruction */
+static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 1000;
+/** Default for -blockreconstructionextratxnsize, maximum megabytes of memory used by those txn */
+static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN_SIZE = 5;
+/** Number of recent compact block reconstructions kept for getblockreconstructionstats */
+static const size_t BLOCK_RECONSTRUCTION_STATS_HISTORY = 50;
 
 /** Register with a network node to receive its signals */
 void RegisterNodeSignals(CNodeSignals& nodeSignals);
@@ -38,6 +42,7 @@ private:
 
 public:
     PeerLogicValidation(CConnman* connmanIn);
+    ~PeerLogicValidation();
 
     virtual void SyncTransaction(const CTransaction& tx, const CBlockIndex* pindex, int nPosInBlock) override;
     virtual void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
@@ -50,8 +55,37 @@ struct CNodeStateStats {
     int nSyncHeight;
     int nCommonHeight;
     std::vector<int> vHeightInFlight;
+    int nBlocksInFlightTarget;
+    int64_t nBlockIntervalAvg;
+    int64_t nBlockLatencyAvg;
+    int nBlocksReceived;
+    int nBlocksReRequested;
+    bool fTxRecon;
+    bool fTxReconInitiator;
+    bool fTxReconFlood;
+    uint64_t nTxReconRounds;
+    uint64_t nTxReconPending;
+    uint64_t nTxReconAnnounced;
+    uint64_t nTxReconSkipped;
+    uint64_t nTxReconSketchBytes;
+    int64_t nTxReconBytesSaved;
 };
 
+/** Where the transactions of a compact block we reconstructed came from */
+struct CBlockReconstructionStats {
+    uint256 hash;
+    int64_t nTime;
+    size_t nTxCount;
+    size_t nPrefilled;
+    size_t nMempool; //!< found locally, includes nExtra and vSources
+    size_t nExtra;
+    std::vector<std::pair<std::string, size_t> > vSources;
+    size_t nRequested;
+};
+
+/** Get the most recent compact block reconstructions, oldest first */
+std::vector<CBlockReconstructionStats> GetBlockReconstructionStats();
+
 /** Get statistics from node state */
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats);
 /** Increase a node's misbehavior score. */
@@ -8,37 +8,75 @@
 #include "netfulfilledman.h"
 
 #include "chainparams.h"
+#include "hash.h"
 #include "init.h"
+#include "random.h"
 #include "util.h"
 
+#include <algorithm>
+#include <limits>
+
 CNetFulfilledRequestManager netfulfilledman;
 
+CNetFulfilledRequestManager::SaltedFulfilledRequestHasher::SaltedFulfilledRequestHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+size_t CNetFulfilledRequestManager::SaltedFulfilledRequestHasher::operator()(const CFulfilledRequestKey& key) const
+{
+    std::vector<unsigned char> vchAddr = key.addr.GetKey();
+    return CSipHasher(k0, k1).Write(vchAddr.data(), vchAddr.size()).Write(key.nRequestId).Finalize();
+}
+
+CService CNetFulfilledRequestManager::GetSquashedAddr(const CService& addr) const
+{
+    return Params().AllowMultiplePorts() ? addr : CService(addr, 0);
+}
+
+uint32_t CNetFulfilledRequestManager::GetRequestId(const std::string& strRequest)
+{
+    AssertLockHeld(cs_mapFulfilledRequests);
+    auto it = mapRequestIds.find(strRequest);
+    if (it != mapRequestIds.end()) {
+        return it->second;
+    }
+    uint32_t nRequestId = vecRequestNames.size();
+    vecRequestNames.push_back(strRequest);
+    mapRequestIds.emplace(strRequest, nRequestId);
+    return nRequestId;
+}
+
+void CNetFulfilledRequestManager::SetFulfilledRequest(const CFulfilledRequestKey& key, int64_t nExpireTime)
+{
+    AssertLockHeld(cs_mapFulfilledRequests);
+    mapFulfilledRequests[key] = nExpireTime;
+    dequeExpiry.emplace_back(nExpireTime, key);
+}
+
 void CNetFulfilledRequestManager::AddFulfilledRequest(const CService& addr, const std::string& strRequest)
 {
     LOCK(cs_mapFulfilledRequests);
-    CService addrSquashed = Params().AllowMultiplePorts() ? addr : CService(addr, 0);
-    mapFulfilledRequests[addrSquashed][strRequest] = GetTime() + Params().FulfilledRequestExpireTime();
+    SetFulfilledRequest(CFulfilledRequestKey(GetSquashedAddr(addr), GetRequestId(strRequest)), GetTime() + Params().FulfilledRequestExpireTime());
 }
 
 bool CNetFulfilledRequestManager::HasFulfilledRequest(const CService& addr, const std::string& strRequest)
 {
     LOCK(cs_mapFulfilledRequests);
-    CService addrSquashed = Params().AllowMultiplePorts() ? addr : CService(addr, 0);
-    fulfilledreqmap_t::iterator it = mapFulfilledRequests.find(addrSquashed);
+    auto itId = mapRequestIds.find(strRequest);
+    if (itId == mapRequestIds.end()) {
+        // never fulfilled for anyone
+        return false;
+    }
+    fulfilledreqhashmap_t::iterator it = mapFulfilledRequests.find(CFulfilledRequestKey(GetSquashedAddr(addr), itId->second));
 
-    return it != mapFulfilledRequests.end() &&
-           it->second.find(strRequest) != it->second.end() &&
-           it->second[strRequest] > GetTime();
+    return it != mapFulfilledRequests.end() && it->second > GetTime();
 }
 
 void CNetFulfilledRequestManager::RemoveFulfilledRequest(const CService& addr, const std::string& strRequest)
 {
     LOCK(cs_mapFulfilledRequests);
-    CService addrSquashed = Params().AllowMultiplePorts() ? addr : CService(addr, 0);
-    fulfilledreqmap_t::iterator it = mapFulfilledRequests.find(addrSquashed);
-
-    if (it != mapFulfilledRequests.end()) {
-        it->second.erase(strRequest);
+    auto itId = mapRequestIds.find(strRequest);
+    if (itId != mapRequestIds.end()) {
+        // the expiry queue entry goes stale and is dropped by CheckAndRemove
+        mapFulfilledRequests.erase(CFulfilledRequestKey(GetSquashedAddr(addr), itId->second));
     }
 }
 
@@ -47,35 +85,58 @@ void CNetFulfilledRequestManager::CheckAndRemove()
     LOCK(cs_mapFulfilledRequests);
 
     int64_t now = GetTime();
-    fulfilledreqmap_t::iterator it = mapFulfilledRequests.begin();
-
-    while (it != mapFulfilledRequests.end()) {
-        fulfilledreqmapentry_t::iterator it_entry = it->second.begin();
-        while (it_entry != it->second.end()) {
-            if (now > it_entry->second) {
-                it->second.erase(it_entry++);
-            } else {
-                ++it_entry;
-            }
+    while (!dequeExpiry.empty() && now > dequeExpiry.front().first) {
+        fulfilledreqhashmap_t::iterator it = mapFulfilledRequests.find(dequeExpiry.front().second);
+        // skip entries superseded by a later AddFulfilledRequest
+        if (it != mapFulfilledRequests.end() && it->second == dequeExpiry.front().first) {
+            mapFulfilledRequests.erase(it);
         }
-        if (it->second.size() == 0) {
-            mapFulfilledRequests.erase(it++);
-        } else {
-            ++it;
+        dequeExpiry.pop_front();
+    }
+}
+
+CNetFulfilledRequestManager::fulfilledreqmap_t CNetFulfilledRequestManager::GetRequestMap()
+{
+    AssertLockHeld(cs_mapFulfilledRequests);
+    fulfilledreqmap_t mapRequests;
+    for (const auto& pair : mapFulfilledRequests) {
+        mapRequests[pair.first.addr][vecRequestNames[pair.first.nRequestId]] = pair.second;
+    }
+    return mapRequests;
+}
+
+void CNetFulfilledRequestManager::LoadRequestMap(const fulfilledreqmap_t& mapRequests)
+{
+    AssertLockHeld(cs_mapFulfilledRequests);
+    mapFulfilledRequests.clear();
+    dequeExpiry.clear();
+
+    // the expiry queue must stay sorted, cached entries are not
+    std::vector<std::pair<int64_t, CFulfilledRequestKey> > vecExpiry;
+    for (const auto& addrPair : mapRequests) {
+        for (const auto& requestPair : addrPair.second) {
+            vecExpiry.emplace_back(requestPair.second, CFulfilledRequestKey(addrPair.first, GetRequestId(requestPair.first)));
         }
     }
+    std::sort(vecExpiry.begin(), vecExpiry.end(), [](const std::pair<int64_t, CFulfilledRequestKey>& a, const std::pair<int64_t, CFulfilledRequestKey>& b) {
+        return a.first < b.first;
+    });
+    for (const auto& pair : vecExpiry) {
+        SetFulfilledRequest(pair.second, pair.first);
+    }
 }
 
 void CNetFulfilledRequestManager::Clear()
 {
     LOCK(cs_mapFulfilledRequests);
     mapFulfilledRequests.clear();
+    dequeExpiry.clear();
 }
 
 std::string CNetFulfilledRequestManager::ToString() const
 {
     std::ostringstream info;
-    info << "Nodes with fulfilled requests: " << (int)mapFulfilledRequests.size();
+    info << "Fulfilled requests: " << (int)mapFulfilledRequests.size() << ", request types: " << (int)vecRequestNames.size();
     return info.str();
 }
 
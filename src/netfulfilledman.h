@@ -12,6 +12,9 @@
 #include "serialize.h"
 #include "sync.h"
 
+#include <deque>
+#include <unordered_map>
+
 class CNetFulfilledRequestManager;
 extern CNetFulfilledRequestManager netfulfilledman;
 
@@ -20,15 +23,54 @@ extern CNetFulfilledRequestManager netfulfilledman;
 class CNetFulfilledRequestManager
 {
 private:
+    // netfulfilled.dat format
     typedef std::map<std::string, int64_t> fulfilledreqmapentry_t;
     typedef std::map<CService, fulfilledreqmapentry_t> fulfilledreqmap_t;
 
-    //keep track of what node has/was asked for and when
-    fulfilledreqmap_t mapFulfilledRequests;
+    struct CFulfilledRequestKey {
+        CService addr;
+        uint32_t nRequestId;
+
+        CFulfilledRequestKey(const CService& addrIn, uint32_t nRequestIdIn) : addr(addrIn), nRequestId(nRequestIdIn) {}
+
+        friend bool operator==(const CFulfilledRequestKey& a, const CFulfilledRequestKey& b)
+        {
+            return a.nRequestId == b.nRequestId && a.addr == b.addr;
+        }
+    };
+
+    class SaltedFulfilledRequestHasher
+    {
+    private:
+        /** Salt */
+        const uint64_t k0, k1;
+
+    public:
+        SaltedFulfilledRequestHasher();
+
+        size_t operator()(const CFulfilledRequestKey& key) const;
+    };
+
+    typedef std::unordered_map<CFulfilledRequestKey, int64_t, SaltedFulfilledRequestHasher> fulfilledreqhashmap_t;
+
+    // request names are interned, the table only stores their index
+    std::vector<std::string> vecRequestNames;
+    std::unordered_map<std::string, uint32_t> mapRequestIds;
+
+    //keep track of what node has/was asked for and until when
+    fulfilledreqhashmap_t mapFulfilledRequests;
+    // expiry times in the order they were added, re-added requests leave a stale entry behind
+    std::deque<std::pair<int64_t, CFulfilledRequestKey> > dequeExpiry;
     CCriticalSection cs_mapFulfilledRequests;
 
+    CService GetSquashedAddr(const CService& addr) const;
+    uint32_t GetRequestId(const std::string& strRequest);
+    void SetFulfilledRequest(const CFulfilledRequestKey& key, int64_t nExpireTime);
     void RemoveFulfilledRequest(const CService& addr, const std::string& strRequest);
 
+    fulfilledreqmap_t GetRequestMap();
+    void LoadRequestMap(const fulfilledreqmap_t& mapRequests);
+
 public:
     CNetFulfilledRequestManager() {}
 
@@ -38,7 +80,14 @@ public:
     inline void SerializationOp(Stream& s, Operation ser_action)
     {
         LOCK(cs_mapFulfilledRequests);
-        READWRITE(mapFulfilledRequests);
+        fulfilledreqmap_t mapRequests;
+        if (!ser_action.ForRead()) {
+            mapRequests = GetRequestMap();
+        }
+        READWRITE(mapRequests);
+        if (ser_action.ForRead()) {
+            LoadRequestMap(mapRequests);
+        }
     }
 
     void AddFulfilledRequest(const CService& addr, const std::string& strRequest);
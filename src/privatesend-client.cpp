@@ -53,11 +53,9 @@ void CPrivateSendClientManager::ProcessMessage(CNode* pfrom, const std::string&
             if (!lockRecv)
                 return;
             // process every psq only once
-            for (const auto& q : vecPrivateSendQueue) {
-                if (q == psq) {
-                    // LogPrint("privatesend", "PSQUEUE -- %s seen\n", psq.ToString());
-                    return;
-                }
+            if (HasQueue(psq)) {
+                // LogPrint("privatesend", "PSQUEUE -- %s seen\n", psq.ToString());
+                return;
             }
         } // cs_vecqueue
 
@@ -93,12 +91,10 @@ void CPrivateSendClientManager::ProcessMessage(CNode* pfrom, const std::string&
             if (!lockRecv)
                 return;
 
-            for (const auto& q : vecPrivateSendQueue) {
-                if (q.dynodeOutpoint == psq.dynodeOutpoint) {
-                    // no way same dn can send another "not yet ready" psq this soon
-                    LogPrint("privatesend", "PSQUEUE -- Dynode %s is sending WAY too many psq messages\n", infoDn.addr.ToString());
-                    return;
-                }
+            if (HasQueueFromDynode(psq.dynodeOutpoint)) {
+                // no way same dn can send another "not yet ready" psq this soon
+                LogPrint("privatesend", "PSQUEUE -- Dynode %s is sending WAY too many psq messages\n", infoDn.addr.ToString());
+                return;
             }
 
             int nThreshold = infoDn.nLastPsq + dnodeman.CountDynodes() / 5;
@@ -119,7 +115,7 @@ void CPrivateSendClientManager::ProcessMessage(CNode* pfrom, const std::string&
                     psq.fTried = true;
                 }
             }
-            vecPrivateSendQueue.push_back(psq);
+            AddQueue(psq);
             psq.Relay(connman);
         }
 
@@ -259,7 +255,7 @@ void CPrivateSendClientManager::ResetPool()
 {
     LOCK(cs_peqsessions);
     nCachedLastSuccessBlock = 0;
-    vecDynodesUsed.clear();
+    mapDynodesUsed.clear();
     for (auto& session : peqSessions) {
         session.ResetPool();
     }
@@ -971,17 +967,7 @@ bool CPrivateSendClientManager::DoAutomaticDenominating(CConnman& connman, bool
         return false;
     }
 
-    int nDnCountEnabled = dnodeman.CountEnabled(MIN_PRIVATESEND_PEER_PROTO_VERSION);
-
-    // If we've used 90% of the Dynode list then drop the oldest first ~30%
-    int nThreshold_high = nDnCountEnabled * 0.9;
-    int nThreshold_low = nThreshold_high * 0.7;
-    LogPrint("privatesend", "Checking vecDynodesUsed: size: %d, threshold: %d\n", (int)vecDynodesUsed.size(), nThreshold_high);
-
-    if ((int)vecDynodesUsed.size() > nThreshold_high) {
-        vecDynodesUsed.erase(vecDynodesUsed.begin(), vecDynodesUsed.begin() + vecDynodesUsed.size() - nThreshold_low);
-        LogPrint("privatesend", "  vecDynodesUsed: new size: %d, threshold: %d\n", (int)vecDynodesUsed.size(), nThreshold_high);
-    }
+    CheckUsedDynodes(dnodeman.CountEnabled(MIN_PRIVATESEND_PEER_PROTO_VERSION));
 
     LOCK(cs_peqsessions);
     bool fResult = true;
@@ -1006,10 +992,47 @@ bool CPrivateSendClientManager::DoAutomaticDenominating(CConnman& connman, bool
 
 void CPrivateSendClientManager::AddUsedDynode(const COutPoint& outpointDn)
 {
-    vecDynodesUsed.push_back(outpointDn);
+    mapDynodesUsed[outpointDn] = GetTime();
+}
+
+void CPrivateSendClientManager::CheckUsedDynodes(int nDnCountEnabled)
+{
+    int64_t nNow = GetTime();
+    for (auto it = mapDynodesUsed.begin(); it != mapDynodesUsed.end();) {
+        if (nNow - it->second > PRIVATESEND_USED_DYNODE_EXPIRY) {
+            it = mapDynodesUsed.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // If we've used 90% of the Dynode list then drop the oldest first ~30%
+    int nThreshold_high = nDnCountEnabled * 0.9;
+    int nThreshold_low = nThreshold_high * 0.7;
+    LogPrint("privatesend", "Checking mapDynodesUsed: size: %d, threshold: %d\n", (int)mapDynodesUsed.size(), nThreshold_high);
+
+    if ((int)mapDynodesUsed.size() > nThreshold_high) {
+        std::vector<std::pair<int64_t, COutPoint> > vecUsedByTime;
+        vecUsedByTime.reserve(mapDynodesUsed.size());
+        for (const auto& pair : mapDynodesUsed) {
+            vecUsedByTime.emplace_back(pair.second, pair.first);
+        }
+        size_t nToErase = vecUsedByTime.size() - std::max(nThreshold_low, 0);
+        std::nth_element(vecUsedByTime.begin(), vecUsedByTime.begin() + nToErase, vecUsedByTime.end());
+        for (size_t i = 0; i < nToErase; ++i) {
+            mapDynodesUsed.erase(vecUsedByTime[i].second);
+        }
+        LogPrint("privatesend", "  mapDynodesUsed: new size: %d, threshold: %d\n", (int)mapDynodesUsed.size(), nThreshold_high);
+    }
 }
+
 dynode_info_t CPrivateSendClientManager::GetNotUsedDynode()
 {
+    std::vector<COutPoint> vecDynodesUsed;
+    vecDynodesUsed.reserve(mapDynodesUsed.size());
+    for (const auto& pair : mapDynodesUsed) {
+        vecDynodesUsed.push_back(pair.first);
+    }
     return dnodeman.FindRandomNotInVec(vecDynodesUsed, MIN_PRIVATESEND_PEER_PROTO_VERSION);
 }
 
@@ -1019,9 +1042,11 @@ bool CPrivateSendClientSession::JoinExistingQueue(CAmount nBalanceNeedsAnonymize
         return false;
 
     std::vector<CAmount> vecStandardDenoms = CPrivateSend::GetStandardDenominations();
+    // Denominations our wallet can't match, any other queue for them is skipped
+    std::set<int> setDenomsUnmatched;
     // Look through the queues and see if anything matches
     CPrivateSendQueue psq;
-    while (privateSendClient.GetQueueItemAndTry(psq)) {
+    while (privateSendClient.GetQueueItemAndTry(psq, setDenomsUnmatched)) {
         dynode_info_t infoDn;
 
         if (!dnodeman.GetDynodeInfo(psq.dynodeOutpoint, infoDn)) {
@@ -1041,11 +1066,12 @@ bool CPrivateSendClientSession::JoinExistingQueue(CAmount nBalanceNeedsAnonymize
         std::vector<int> vecBits;
         if (!CPrivateSend::GetDenominationsBits(psq.nDenom, vecBits)) {
             // incompatible denom
+            setDenomsUnmatched.insert(psq.nDenom);
             continue;
         }
 
         // mixing rate limit i.e. nLastPsq check should already pass in PSQUEUE ProcessMessage
-        // in order for psq to get into vecPrivateSendQueue, so we should be safe to mix already,
+        // in order for psq to get into listPrivateSendQueue, so we should be safe to mix already,
         // no need for additional verification here
 
         LogPrint("privatesend", "CPrivateSendClientSession::JoinExistingQueue -- found valid queue: %s\n", psq.ToString());
@@ -1057,6 +1083,7 @@ bool CPrivateSendClientSession::JoinExistingQueue(CAmount nBalanceNeedsAnonymize
         // Try to match their denominations if possible, select exact number of denominations
         if (!pwalletMain->SelectPSInOutPairsByDenominations(psq.nDenom, nMinAmount, nMaxAmount, vecPSInOutPairsTmp)) {
             LogPrintf("CPrivateSendClientSession::JoinExistingQueue -- Couldn't match %d denominations %d (%s)\n", vecBits.front(), psq.nDenom, CPrivateSend::GetDenominationsToString(psq.nDenom));
+            setDenomsUnmatched.insert(psq.nDenom);
             continue;
         }
 
@@ -31,6 +31,9 @@ static const int DEFAULT_PRIVATESEND_LIQUIDITY = 0;
 
 static const bool DEFAULT_PRIVATESEND_MULTISESSION = false;
 
+// Forget that we mixed on a Dynode after this many seconds
+static const int PRIVATESEND_USED_DYNODE_EXPIRY = 60 * 60;
+
 // Warn user if mixing in gui or try to create backup if mixing in daemon mode
 // when we have only this many keys left
 static const int PRIVATESEND_KEYS_THRESHOLD_WARNING = 50;
@@ -170,8 +173,8 @@ public:
 class CPrivateSendClientManager : public CPrivateSendBaseManager
 {
 private:
-    // Keep track of the used Dynodes
-    std::vector<COutPoint> vecDynodesUsed;
+    // Keep track of the used Dynodes and when they were used
+    std::unordered_map<COutPoint, int64_t, SaltedOutpointHasher> mapDynodesUsed;
 
     std::vector<CAmount> vecDenominationsSkipped;
 
@@ -202,7 +205,7 @@ public:
     int nCachedNumBlocks;    //used for the overview screen
     bool fCreateAutoBackups; //builtin support for automatic backups
 
-    CPrivateSendClientManager() : vecDynodesUsed(),
+    CPrivateSendClientManager() : mapDynodesUsed(),
                                   vecDenominationsSkipped(),
                                   peqSessions(),
                                   nCachedLastSuccessBlock(0),
@@ -242,6 +245,7 @@ public:
     void ProcessPendingPsaRequest(CConnman& connman);
 
     void AddUsedDynode(const COutPoint& outpointDn);
+    void CheckUsedDynodes(int nDnCountEnabled);
     dynode_info_t GetNotUsedDynode();
 
     void UpdatedSuccessBlock();
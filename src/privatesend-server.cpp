@@ -59,13 +59,11 @@ void CPrivateSendServer::ProcessMessage(CNode* pfrom, const std::string& strComm
                 TRY_LOCK(cs_vecqueue, lockRecv);
                 if (!lockRecv) return;
 
-                for (const auto& q : vecPrivateSendQueue) {
-                    if (q.dynodeOutpoint == activeDynode.outpoint) {
-                        // refuse to create another queue this often
-                        LogPrint("privatesend", "PSACCEPT -- last psq is still in queue, refuse to mix\n");
-                        PushStatus(pfrom, STATUS_REJECTED, ERR_RECENT, connman);
-                        return;
-                    }
+                if (HasQueueFromDynode(activeDynode.outpoint)) {
+                    // refuse to create another queue this often
+                    LogPrint("privatesend", "PSACCEPT -- last psq is still in queue, refuse to mix\n");
+                    PushStatus(pfrom, STATUS_REJECTED, ERR_RECENT, connman);
+                    return;
                 }
             }
 
@@ -104,11 +102,9 @@ void CPrivateSendServer::ProcessMessage(CNode* pfrom, const std::string& strComm
         vRecv >> psq;
 
         // process every psq only once
-        for (const auto& q : vecPrivateSendQueue) {
-            if (q == psq) {
-                // LogPrint("privatesend", "PSQUEUE -- %s seen\n", psq.ToString());
-                return;
-            }
+        if (HasQueue(psq)) {
+            // LogPrint("privatesend", "PSQUEUE -- %s seen\n", psq.ToString());
+            return;
         }
 
         LogPrint("privatesend", "PSQUEUE -- %s new\n", psq.ToString());
@@ -127,12 +123,10 @@ void CPrivateSendServer::ProcessMessage(CNode* pfrom, const std::string& strComm
         }
 
         if (!psq.fReady) {
-            for (const auto& q : vecPrivateSendQueue) {
-                if (q.dynodeOutpoint == psq.dynodeOutpoint) {
-                    // no way same dn can send another "not yet ready" psq this soon
-                    LogPrint("privatesend", "PSQUEUE -- Dynode %s is sending WAY too many psq messages\n", dnInfo.addr.ToString());
-                    return;
-                }
+            if (HasQueueFromDynode(psq.dynodeOutpoint)) {
+                // no way same dn can send another "not yet ready" psq this soon
+                LogPrint("privatesend", "PSQUEUE -- Dynode %s is sending WAY too many psq messages\n", dnInfo.addr.ToString());
+                return;
             }
 
             int nThreshold = dnInfo.nLastPsq + dnodeman.CountDynodes() / 5;
@@ -145,7 +139,7 @@ void CPrivateSendServer::ProcessMessage(CNode* pfrom, const std::string& strComm
             dnodeman.AllowMixing(psq.dynodeOutpoint);
 
             LogPrint("privatesend", "PSQUEUE -- new PrivateSend queue (%s) from dynode %s\n", psq.ToString(), dnInfo.addr.ToString());
-            vecPrivateSendQueue.push_back(psq);
+            AddQueue(psq);
             psq.Relay(connman);
         }
 
@@ -749,7 +743,8 @@ bool CPrivateSendServer::CreateNewSession(const CPrivateSendAccept& psa, PoolMes
         LogPrint("privatesend", "CPrivateSendServer::CreateNewSession -- signing and relaying new queue: %s\n", psq.ToString());
         psq.Sign();
         psq.Relay(connman);
-        vecPrivateSendQueue.push_back(psq);
+        LOCK(cs_vecqueue);
+        AddQueue(psq);
     }
 
     vecSessionCollaterals.push_back(MakeTransactionRef(psa.txCollateral));
@@ -207,7 +207,9 @@ void CPrivateSendBaseSession::SetNull()
 void CPrivateSendBaseManager::SetNull()
 {
     LOCK(cs_vecqueue);
-    vecPrivateSendQueue.clear();
+    listPrivateSendQueue.clear();
+    mapQueueByDynode.clear();
+    mapQueueByDenom.clear();
 }
 
 void CPrivateSendBaseManager::CheckQueue()
@@ -217,25 +219,77 @@ void CPrivateSendBaseManager::CheckQueue()
         return; // it's ok to fail here, we run this quite frequently
 
     // check mixing queue objects for timeouts
-    std::vector<CPrivateSendQueue>::iterator it = vecPrivateSendQueue.begin();
-    while (it != vecPrivateSendQueue.end()) {
+    queue_l_it it = listPrivateSendQueue.begin();
+    while (it != listPrivateSendQueue.end()) {
         if ((*it).IsExpired()) {
             LogPrint("privatesend", "CPrivateSendBaseManager::%s -- Removing expired queue (%s)\n", __func__, (*it).ToString());
-            it = vecPrivateSendQueue.erase(it);
+            EraseQueue(it++);
         } else
             ++it;
     }
 }
 
-bool CPrivateSendBaseManager::GetQueueItemAndTry(CPrivateSendQueue& psqRet)
+bool CPrivateSendBaseManager::HasQueue(const CPrivateSendQueue& psq) const
+{
+    AssertLockHeld(cs_vecqueue);
+    auto range = mapQueueByDynode.equal_range(psq.dynodeOutpoint);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (*it->second == psq)
+            return true;
+    }
+    return false;
+}
+
+bool CPrivateSendBaseManager::HasQueueFromDynode(const COutPoint& outpointDn) const
+{
+    AssertLockHeld(cs_vecqueue);
+    return mapQueueByDynode.count(outpointDn) > 0;
+}
+
+void CPrivateSendBaseManager::AddQueue(const CPrivateSendQueue& psq)
+{
+    AssertLockHeld(cs_vecqueue);
+    queue_l_it it = listPrivateSendQueue.insert(listPrivateSendQueue.end(), psq);
+    mapQueueByDynode.emplace(psq.dynodeOutpoint, it);
+    mapQueueByDenom[psq.nDenom].push_back(it);
+}
+
+void CPrivateSendBaseManager::EraseQueue(queue_l_it it)
+{
+    AssertLockHeld(cs_vecqueue);
+    auto range = mapQueueByDynode.equal_range(it->dynodeOutpoint);
+    for (auto itDn = range.first; itDn != range.second; ++itDn) {
+        if (itDn->second == it) {
+            mapQueueByDynode.erase(itDn);
+            break;
+        }
+    }
+    auto itDenom = mapQueueByDenom.find(it->nDenom);
+    if (itDenom != mapQueueByDenom.end()) {
+        std::vector<queue_l_it>& vecQueues = itDenom->second;
+        vecQueues.erase(std::find(vecQueues.begin(), vecQueues.end(), it));
+        if (vecQueues.empty())
+            mapQueueByDenom.erase(itDenom);
+    }
+    listPrivateSendQueue.erase(it);
+}
+
+bool CPrivateSendBaseManager::GetQueueItemAndTry(CPrivateSendQueue& psqRet, const std::set<int>& setDenomsSkipped)
 {
     TRY_LOCK(cs_vecqueue, lockPS);
     if (!lockPS)
         return false; // it's ok to fail here, we run this quite frequently
-    for (auto& psq : vecPrivateSendQueue) {
+    // walk the queues in the order they were received, the oldest is tried first
+    for (auto& psq : listPrivateSendQueue) {
         // only try each queue once
         if (psq.fTried || psq.IsExpired())
             continue;
+        if (setDenomsSkipped.count(psq.nDenom)) {
+            // mark all queues of this denomination at once so they are not looked at again
+            for (auto& it : mapQueueByDenom[psq.nDenom])
+                it->fTried = true;
+            continue;
+        }
         psq.fTried = true;
         psqRet = psq;
         return true;
@@ -537,6 +591,15 @@ CPrivateSendBroadcastTx CPrivateSend::GetPSTX(const uint256& hash)
     return (it == mapPSTX.end()) ? CPrivateSendBroadcastTx() : it->second;
 }
 
+void CPrivateSend::ForEachPSTX(const std::function<bool(const CTransactionRef&)>& fn)
+{
+    LOCK(cs_mappstx);
+    for (const auto& pair : mapPSTX) {
+        if (!fn(pair.second.tx))
+            return;
+    }
+}
+
 void CPrivateSend::CheckPSTXes(int nHeight)
 {
     LOCK(cs_mappstx);
@@ -8,12 +8,17 @@
 
 #include "chain.h"
 #include "chainparams.h"
+#include "coins.h"
 #include "primitives/transaction.h"
 #include "pubkey.h"
 #include "sync.h"
 #include "timedata.h"
 #include "tinyformat.h"
 
+#include <functional>
+#include <list>
+#include <unordered_map>
+
 class CPrivateSend;
 class CConnman;
 
@@ -369,16 +374,34 @@ public:
 class CPrivateSendBaseManager
 {
 protected:
+    typedef std::list<CPrivateSendQueue> queue_l_t;
+    typedef queue_l_t::iterator queue_l_it;
+
     mutable CCriticalSection cs_vecqueue;
-    // The current mixing sessions in progress on the network
-    std::vector<CPrivateSendQueue> vecPrivateSendQueue;
+    // The current mixing sessions in progress on the network, in the order they were received
+    queue_l_t listPrivateSendQueue;
+    // Indexes into listPrivateSendQueue
+    std::unordered_multimap<COutPoint, queue_l_it, SaltedOutpointHasher> mapQueueByDynode;
+    std::map<int, std::vector<queue_l_it> > mapQueueByDenom;
+
     void SetNull();
     void CheckQueue();
 
+    // The following require cs_vecqueue
+    bool HasQueue(const CPrivateSendQueue& psq) const;
+    bool HasQueueFromDynode(const COutPoint& outpointDn) const;
+    void AddQueue(const CPrivateSendQueue& psq);
+    void EraseQueue(queue_l_it it);
+
 public:
-    CPrivateSendBaseManager() : vecPrivateSendQueue() {}
-    int GetQueueSize() const { return vecPrivateSendQueue.size(); }
-    bool GetQueueItemAndTry(CPrivateSendQueue& psqRet);
+    CPrivateSendBaseManager() : listPrivateSendQueue(), mapQueueByDynode(), mapQueueByDenom() {}
+    int GetQueueSize() const
+    {
+        LOCK(cs_vecqueue);
+        return listPrivateSendQueue.size();
+    }
+    /// Get a queue we haven't tried yet, queues for the denominations in setDenomsSkipped are only marked as tried
+    bool GetQueueItemAndTry(CPrivateSendQueue& psqRet, const std::set<int>& setDenomsSkipped = std::set<int>());
 };
 
 // helper class
@@ -430,6 +453,8 @@ public:
 
     static void AddPSTX(const CPrivateSendBroadcastTx& pstx);
     static CPrivateSendBroadcastTx GetPSTX(const uint256& hash);
+    /// Call fn with every known mixing transaction until it returns false
+    static void ForEachPSTX(const std::function<bool(const CTransactionRef&)>& fn);
 
     static void UpdatedBlockTip(const CBlockIndex* pindex);
     static void SyncTransaction(const CTransaction& tx, const CBlockIndex* pindex, int posInBlock);
@@ -42,6 +42,9 @@ const char* SENDCMPCT = "sendcmpct";
 const char* CMPCTBLOCK = "cmpctblock";
 const char* GETBLOCKTXN = "getblocktxn";
 const char* BLOCKTXN = "blocktxn";
+const char* SENDTXRCNCL = "sendtxrcncl";
+const char* REQRECON = "reqrecon";
+const char* RECONCILDIFF = "reconcildiff";
 // Dynamic message types
 const char* TXLOCKREQUEST = "is";
 const char* TXLOCKVOTE = "txlvote";
@@ -64,6 +67,8 @@ const char* PSQUEUE = "psq";
 const char* PSEG = "pseg";
 const char* SYNCSTATUSCOUNT = "ssc";
 const char* DNGOVERNANCESYNC = "govsync";
+const char* DNGOVERNANCERECON = "govrecon";
+const char* DNGOVERNANCERECONREST = "govreconrest";
 const char* DNGOVERNANCEOBJECT = "govobj";
 const char* DNGOVERNANCEOBJECTVOTE = "govobjvote";
 const char* DNVERIFY = "dnv";
@@ -123,6 +128,9 @@ const static std::string allNetMessageTypes[] = {
     NetMsgType::CMPCTBLOCK,
     NetMsgType::GETBLOCKTXN,
     NetMsgType::BLOCKTXN,
+    NetMsgType::SENDTXRCNCL,
+    NetMsgType::REQRECON,
+    NetMsgType::RECONCILDIFF,
     // Dynamic message types
     // NOTE: do NOT include non-implmented here, we want them to be "Unknown command" in ProcessMessage()
     NetMsgType::TXLOCKREQUEST,
@@ -145,6 +153,8 @@ const static std::string allNetMessageTypes[] = {
     NetMsgType::PSEG,
     NetMsgType::SYNCSTATUSCOUNT,
     NetMsgType::DNGOVERNANCESYNC,
+    NetMsgType::DNGOVERNANCERECON,
+    NetMsgType::DNGOVERNANCERECONREST,
     NetMsgType::DNGOVERNANCEOBJECT,
     NetMsgType::DNGOVERNANCEOBJECTVOTE,
     NetMsgType::DNVERIFY,
@@ -243,6 +243,24 @@ extern const char* GETBLOCKTXN;
  * @since protocol version 71000 as described by BIP 152
  */
 extern const char* BLOCKTXN;
+/**
+ * Contains a 4-byte reconciliation version and an 8-byte salt.
+ * Indicates that a node is willing to reconcile transactions instead of
+ * announcing each of them with an inv.
+ * @since protocol version 71300
+ */
+extern const char* SENDTXRCNCL;
+/**
+ * Contains a CTxReconSketch of the transactions the sender would announce.
+ * An empty sketch tells the peer the link keeps flooding, see CTxReconState.
+ * @since protocol version 71300
+ */
+extern const char* REQRECON;
+/**
+ * Contains the indexes of the sketch buckets that differ, as a vector of uint32_t.
+ * @since protocol version 71300
+ */
+extern const char* RECONCILDIFF;
 // Dynamic message types
 // NOTE: do NOT declare non-implmented here, we don't want them to be exposed to the outside
 // TODO: add description
@@ -265,6 +283,8 @@ extern const char* PSQUEUE;
 extern const char* PSEG;
 extern const char* SYNCSTATUSCOUNT;
 extern const char* DNGOVERNANCESYNC;
+extern const char* DNGOVERNANCERECON;
+extern const char* DNGOVERNANCERECONREST;
 extern const char* DNGOVERNANCEOBJECT;
 extern const char* DNGOVERNANCEOBJECTVOTE;
 extern const char* DNVERIFY;
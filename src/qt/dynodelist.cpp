@@ -9,6 +9,7 @@
 #include "ui_dynodelist.h"
 
 #include "clientmodel.h"
+#include "dynodetablemodel.h"
 #include "guiutil.h"
 #include "walletmodel.h"
 
@@ -21,19 +22,9 @@
 #include "wallet/wallet.h"
 
 #include <QMessageBox>
+#include <QSortFilterProxyModel>
 #include <QTimer>
 
-int GetOffsetFromUtc()
-{
-#if QT_VERSION < 0x050200
-    const QDateTime dateTime1 = QDateTime::currentDateTime();
-    const QDateTime dateTime2 = QDateTime(dateTime1.date(), dateTime1.time(), Qt::UTC);
-    return dateTime1.secsTo(dateTime2);
-#else
-    return QDateTime::currentDateTime().offsetFromUtc();
-#endif
-}
-
 DynodeList::DynodeList(const PlatformStyle* platformStyle, QWidget* parent) : QWidget(parent),
                                                                               ui(new Ui::DynodeList),
                                                                               clientModel(0),
@@ -57,11 +48,20 @@ DynodeList::DynodeList(const PlatformStyle* platformStyle, QWidget* parent) : QW
     ui->tableWidgetMyDynodes->setColumnWidth(4, columnActiveWidth);
     ui->tableWidgetMyDynodes->setColumnWidth(5, columnLastSeenWidth);
 
-    ui->tableWidgetDynodes->setColumnWidth(0, columnAddressWidth);
-    ui->tableWidgetDynodes->setColumnWidth(1, columnProtocolWidth);
-    ui->tableWidgetDynodes->setColumnWidth(2, columnStatusWidth);
-    ui->tableWidgetDynodes->setColumnWidth(3, columnActiveWidth);
-    ui->tableWidgetDynodes->setColumnWidth(4, columnLastSeenWidth);
+    dynodeTableModel = new DynodeTableModel(this);
+    dynodeProxyModel = new QSortFilterProxyModel(this);
+    dynodeProxyModel->setSourceModel(dynodeTableModel);
+    dynodeProxyModel->setSortRole(DynodeTableModel::SortRole);
+    dynodeProxyModel->setFilterKeyColumn(-1); // match the filter against every column
+    dynodeProxyModel->setDynamicSortFilter(true);
+    ui->tableViewDynodes->setModel(dynodeProxyModel);
+    ui->tableViewDynodes->sortByColumn(DynodeTableModel::Address, Qt::AscendingOrder);
+
+    ui->tableViewDynodes->setColumnWidth(DynodeTableModel::Address, columnAddressWidth);
+    ui->tableViewDynodes->setColumnWidth(DynodeTableModel::Protocol, columnProtocolWidth);
+    ui->tableViewDynodes->setColumnWidth(DynodeTableModel::Status, columnStatusWidth);
+    ui->tableViewDynodes->setColumnWidth(DynodeTableModel::Active, columnActiveWidth);
+    ui->tableViewDynodes->setColumnWidth(DynodeTableModel::LastSeen, columnLastSeenWidth);
 
     ui->tableWidgetMyDynodes->setContextMenuPolicy(Qt::CustomContextMenu);
 
@@ -76,8 +76,6 @@ DynodeList::DynodeList(const PlatformStyle* platformStyle, QWidget* parent) : QW
     connect(timer, SIGNAL(timeout()), this, SLOT(updateMyNodeList()));
     timer->start(1000);
 
-    fFilterUpdated = false;
-    nTimeFilterUpdated = GetTime();
     updateNodeList();
 }
 
@@ -254,7 +252,6 @@ void DynodeList::updateMyNodeList(bool fForce)
     QModelIndexList selected = selectionModel->selectedRows();
     int nSelectedRow = selected.count() ? selected.at(0).row() : 0;
 
-    ui->tableWidgetDynodes->setSortingEnabled(false);
     for (const auto& dne : dynodeConfig.getEntries()) {
         int32_t nOutputIndex = 0;
         if (!ParseInt32(dne.getOutputIndex(), &nOutputIndex)) {
@@ -264,7 +261,6 @@ void DynodeList::updateMyNodeList(bool fForce)
         updateMyDynodeInfo(QString::fromStdString(dne.getAlias()), QString::fromStdString(dne.getIp()), COutPoint(uint256S(dne.getTxHash()), nOutputIndex));
     }
     ui->tableWidgetMyDynodes->selectRow(nSelectedRow);
-    ui->tableWidgetDynodes->setSortingEnabled(true);
 
     // reset "timer"
     ui->secondsLabel->setText("0");
@@ -272,74 +268,15 @@ void DynodeList::updateMyNodeList(bool fForce)
 
 void DynodeList::updateNodeList()
 {
-    TRY_LOCK(cs_dnlist, fLockAcquired);
-    if (!fLockAcquired) {
-        return;
-    }
-
-    static int64_t nTimeListUpdated = GetTime();
-
-    // to prevent high cpu usage update only once in DYNODELIST_UPDATE_SECONDS seconds
-    // or DYNODELIST_FILTER_COOLDOWN_SECONDS seconds after filter was last changed
-    int64_t nSecondsToWait = fFilterUpdated ? nTimeFilterUpdated - GetTime() + DYNODELIST_FILTER_COOLDOWN_SECONDS : nTimeListUpdated - GetTime() + DYNODELIST_UPDATE_SECONDS;
-
-    if (fFilterUpdated)
-        ui->countLabel->setText(QString::fromStdString(strprintf("Please wait... %d", nSecondsToWait)));
-    if (nSecondsToWait > 0)
-        return;
-
-    nTimeListUpdated = GetTime();
-    fFilterUpdated = false;
-
-    QString strToFilter;
-    ui->countLabel->setText("Updating...");
-    ui->tableWidgetDynodes->setSortingEnabled(false);
-    ui->tableWidgetDynodes->clearContents();
-    ui->tableWidgetDynodes->setRowCount(0);
-    std::map<COutPoint, CDynode> mapDynodes = dnodeman.GetFullDynodeMap();
-    int offsetFromUtc = GetOffsetFromUtc();
-
-    for (const auto& dnpair : mapDynodes) {
-        CDynode dn = dnpair.second;
-        // populate list
-        // Address, Protocol, Status, Active Seconds, Last Seen, Pub Key
-        QTableWidgetItem* addressItem = new QTableWidgetItem(QString::fromStdString(dn.addr.ToString()));
-        QTableWidgetItem* protocolItem = new QTableWidgetItem(QString::number(dn.nProtocolVersion));
-        QTableWidgetItem* statusItem = new QTableWidgetItem(QString::fromStdString(dn.GetStatus()));
-        QTableWidgetItem* activeSecondsItem = new QTableWidgetItem(QString::fromStdString(DurationToDHMS(dn.lastPing.sigTime - dn.sigTime)));
-        QTableWidgetItem* lastSeenItem = new QTableWidgetItem(QString::fromStdString(DateTimeStrFormat("%Y-%m-%d %H:%M", dn.lastPing.sigTime + offsetFromUtc)));
-        QTableWidgetItem* pubkeyItem = new QTableWidgetItem(QString::fromStdString(CDynamicAddress(dn.pubKeyCollateralAddress.GetID()).ToString()));
-
-        if (strCurrentFilter != "") {
-            strToFilter = addressItem->text() + " " +
-                          protocolItem->text() + " " +
-                          statusItem->text() + " " +
-                          activeSecondsItem->text() + " " +
-                          lastSeenItem->text() + " " +
-                          pubkeyItem->text();
-            if (!strToFilter.contains(strCurrentFilter))
-                continue;
-        }
-
-        ui->tableWidgetDynodes->insertRow(0);
-        ui->tableWidgetDynodes->setItem(0, 0, addressItem);
-        ui->tableWidgetDynodes->setItem(0, 1, protocolItem);
-        ui->tableWidgetDynodes->setItem(0, 2, statusItem);
-        ui->tableWidgetDynodes->setItem(0, 3, activeSecondsItem);
-        ui->tableWidgetDynodes->setItem(0, 4, lastSeenItem);
-        ui->tableWidgetDynodes->setItem(0, 5, pubkeyItem);
-    }
-
-    ui->countLabel->setText(QString::number(ui->tableWidgetDynodes->rowCount()));
-    ui->tableWidgetDynodes->setSortingEnabled(true);
+    // only the Dynodes reported as added, removed or changed since the last call are touched
+    dynodeTableModel->processQueuedUpdates();
+    ui->countLabel->setText(QString::number(dynodeProxyModel->rowCount()));
 }
 
 void DynodeList::on_filterLineEdit_textChanged(const QString& strFilterIn)
 {
-    strCurrentFilter = strFilterIn;
-    nTimeFilterUpdated = GetTime();
-    fFilterUpdated = true;
-    ui->countLabel->setText(QString::fromStdString(strprintf("Please wait... %d", DYNODELIST_FILTER_COOLDOWN_SECONDS)));
+    dynodeProxyModel->setFilterFixedString(strFilterIn);
+    ui->countLabel->setText(QString::number(dynodeProxyModel->rowCount()));
 }
 
 void DynodeList::on_startButton_clicked()
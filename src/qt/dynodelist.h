@@ -19,8 +19,6 @@
 #include <QWidget>
 
 #define MY_DYNODELIST_UPDATE_SECONDS 60
-#define DYNODELIST_UPDATE_SECONDS 15
-#define DYNODELIST_FILTER_COOLDOWN_SECONDS 3
 
 namespace Ui
 {
@@ -28,10 +26,12 @@ class DynodeList;
 }
 
 class ClientModel;
+class DynodeTableModel;
 class WalletModel;
 
 QT_BEGIN_NAMESPACE
 class QModelIndex;
+class QSortFilterProxyModel;
 QT_END_NAMESPACE
 
 /** Dynode Manager page widget */
@@ -50,8 +50,6 @@ public:
 
 private:
     QMenu* contextMenu;
-    int64_t nTimeFilterUpdated;
-    bool fFilterUpdated;
 
 public Q_SLOTS:
     void updateMyDynodeInfo(QString strAlias, QString strAddr, const COutPoint& outpoint);
@@ -65,12 +63,11 @@ private:
     Ui::DynodeList* ui;
     ClientModel* clientModel;
     WalletModel* walletModel;
-    // Protects tableWidgetDynodes
-    CCriticalSection cs_dnlist;
+    DynodeTableModel* dynodeTableModel;
+    QSortFilterProxyModel* dynodeProxyModel;
 
     // Protects tableWidgetMyDynodes
     CCriticalSection cs_mydnlist;
-    QString strCurrentFilter;
 
 private Q_SLOTS:
     void showContextMenu(const QPoint&);
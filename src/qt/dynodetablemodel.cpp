@@ -0,0 +1,224 @@
+// Copyright (c) 2016-2019 Duality Blockchain Solutions Developers
+// Copyright (c) 2014-2019 The Dash Core Developers
+// Copyright (c) 2009-2019 The Bitcoin Developers
+// Copyright (c) 2009-2019 Satoshi Nakamoto
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "dynodetablemodel.h"
+
+#include "base58.h"
+#include "dynode.h"
+#include "dynodeman.h"
+#include "ui_interface.h"
+#include "util.h"
+#include "utiltime.h"
+
+#include <QDateTime>
+
+int GetOffsetFromUtc()
+{
+#if QT_VERSION < 0x050200
+    const QDateTime dateTime1 = QDateTime::currentDateTime();
+    const QDateTime dateTime2 = QDateTime(dateTime1.date(), dateTime1.time(), Qt::UTC);
+    return dateTime1.secsTo(dateTime2);
+#else
+    return QDateTime::currentDateTime().offsetFromUtc();
+#endif
+}
+
+static DynodeTableEntry MakeEntry(const dynode_info_t& infoDn)
+{
+    DynodeTableEntry entry;
+    entry.outpoint = infoDn.outpoint;
+    entry.address = QString::fromStdString(infoDn.addr.ToString());
+    entry.nProtocolVersion = infoDn.nProtocolVersion;
+    entry.status = QString::fromStdString(CDynode::StateToString(infoDn.nActiveState));
+    entry.nActiveSeconds = infoDn.nTimeLastPing - infoDn.sigTime;
+    entry.nLastSeen = infoDn.nTimeLastPing;
+    entry.payee = QString::fromStdString(CDynamicAddress(infoDn.pubKeyCollateralAddress.GetID()).ToString());
+    return entry;
+}
+
+DynodeTableModel::DynodeTableModel(QObject* parent) : QAbstractTableModel(parent)
+{
+    columns << tr("Address") << tr("Protocol") << tr("Status") << tr("Active") << tr("Last Seen") << tr("Payee");
+
+    // subscribe before the initial load so no change in between is missed
+    subscribeToCoreSignals();
+    refresh();
+}
+
+DynodeTableModel::~DynodeTableModel()
+{
+    unsubscribeFromCoreSignals();
+}
+
+int DynodeTableModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return cachedDynodes.size();
+}
+
+int DynodeTableModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return columns.length();
+}
+
+QVariant DynodeTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= (int)cachedDynodes.size())
+        return QVariant();
+
+    const DynodeTableEntry& entry = cachedDynodes[index.row()];
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case Address:
+            return entry.address;
+        case Protocol:
+            return QString::number(entry.nProtocolVersion);
+        case Status:
+            return entry.status;
+        case Active:
+            return QString::fromStdString(DurationToDHMS(entry.nActiveSeconds));
+        case LastSeen:
+            return QString::fromStdString(DateTimeStrFormat("%Y-%m-%d %H:%M", entry.nLastSeen + GetOffsetFromUtc()));
+        case Payee:
+            return entry.payee;
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case Address:
+            return entry.address;
+        case Protocol:
+            return entry.nProtocolVersion;
+        case Status:
+            return entry.status;
+        case Active:
+            return (qint64)entry.nActiveSeconds;
+        case LastSeen:
+            return (qint64)entry.nLastSeen;
+        case Payee:
+            return entry.payee;
+        }
+    }
+    return QVariant();
+}
+
+QVariant DynodeTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal) {
+        if (role == Qt::DisplayRole && section < columns.size()) {
+            return columns[section];
+        }
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags DynodeTableModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return 0;
+
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+}
+
+void DynodeTableModel::refresh()
+{
+    {
+        // everything queued so far is covered by the full reload
+        LOCK(cs_queue);
+        setQueuedUpdates.clear();
+    }
+
+    std::map<COutPoint, CDynode> mapDynodes = dnodeman.GetFullDynodeMap();
+
+    beginResetModel();
+    cachedDynodes.clear();
+    mapDynodeRows.clear();
+    cachedDynodes.reserve(mapDynodes.size());
+    for (const auto& dnpair : mapDynodes) {
+        mapDynodeRows.emplace(dnpair.first, cachedDynodes.size());
+        cachedDynodes.push_back(MakeEntry(dnpair.second.GetInfo()));
+    }
+    endResetModel();
+}
+
+void DynodeTableModel::queueUpdate(const COutPoint& outpoint)
+{
+    LOCK(cs_queue);
+    setQueuedUpdates.insert(outpoint);
+}
+
+void DynodeTableModel::processQueuedUpdates()
+{
+    std::set<COutPoint> setUpdates;
+    {
+        LOCK(cs_queue);
+        setUpdates.swap(setQueuedUpdates);
+    }
+
+    for (const COutPoint& outpoint : setUpdates) {
+        updateEntry(outpoint);
+    }
+}
+
+void DynodeTableModel::updateEntry(const COutPoint& outpoint)
+{
+    // the notification only names the Dynode, its current state comes from CDynodeMan
+    dynode_info_t infoDn;
+    bool fFound = dnodeman.GetDynodeInfo(outpoint, infoDn);
+
+    auto it = mapDynodeRows.find(outpoint);
+    if (!fFound) {
+        if (it != mapDynodeRows.end()) {
+            removeEntry(it->second);
+        }
+        return;
+    }
+
+    if (it == mapDynodeRows.end()) {
+        int nRow = cachedDynodes.size();
+        beginInsertRows(QModelIndex(), nRow, nRow);
+        mapDynodeRows.emplace(outpoint, nRow);
+        cachedDynodes.push_back(MakeEntry(infoDn));
+        endInsertRows();
+        return;
+    }
+
+    int nRow = it->second;
+    cachedDynodes[nRow] = MakeEntry(infoDn);
+    Q_EMIT dataChanged(index(nRow, 0), index(nRow, columns.length() - 1));
+}
+
+void DynodeTableModel::removeEntry(int nRow)
+{
+    beginRemoveRows(QModelIndex(), nRow, nRow);
+    mapDynodeRows.erase(cachedDynodes[nRow].outpoint);
+    cachedDynodes.erase(cachedDynodes.begin() + nRow);
+    // shift the row index of every Dynode after the removed one
+    for (size_t i = nRow; i < cachedDynodes.size(); i++) {
+        mapDynodeRows[cachedDynodes[i].outpoint] = i;
+    }
+    endRemoveRows();
+}
+
+// Handlers for core signals
+static void NotifyDynodeChanged(DynodeTableModel* dynodeTableModel, const COutPoint& outpoint, ChangeType status)
+{
+    Q_UNUSED(status);
+    // called with CDynodeMan::cs held, just queue the outpoint and let the GUI thread pick it up
+    dynodeTableModel->queueUpdate(outpoint);
+}
+
+void DynodeTableModel::subscribeToCoreSignals()
+{
+    uiInterface.NotifyDynodeChanged.connect(boost::bind(NotifyDynodeChanged, this, _1, _2));
+}
+
+void DynodeTableModel::unsubscribeFromCoreSignals()
+{
+    uiInterface.NotifyDynodeChanged.disconnect(boost::bind(NotifyDynodeChanged, this, _1, _2));
+}
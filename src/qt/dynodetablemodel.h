@@ -0,0 +1,95 @@
+// Copyright (c) 2016-2019 Duality Blockchain Solutions Developers
+// Copyright (c) 2014-2019 The Dash Core Developers
+// Copyright (c) 2009-2019 The Bitcoin Developers
+// Copyright (c) 2009-2019 Satoshi Nakamoto
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_QT_DYNODETABLEMODEL_H
+#define DYNAMIC_QT_DYNODETABLEMODEL_H
+
+#include "primitives/transaction.h"
+#include "sync.h"
+
+#include <QAbstractTableModel>
+#include <QStringList>
+
+#include <map>
+#include <set>
+#include <vector>
+
+/** Offset of the local time zone from UTC, in seconds */
+int GetOffsetFromUtc();
+
+struct DynodeTableEntry {
+    COutPoint outpoint;
+    QString address;
+    int nProtocolVersion;
+    QString status;
+    int64_t nActiveSeconds;
+    int64_t nLastSeen;
+    QString payee;
+};
+
+/**
+   Qt model of the network Dynode list. Filled once from CDynodeMan and then
+   kept up to date from NotifyDynodeChanged, so that only the rows of Dynodes
+   that were added, removed or changed state are touched.
+ */
+class DynodeTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit DynodeTableModel(QObject* parent = 0);
+    ~DynodeTableModel();
+
+    enum ColumnIndex {
+        Address = 0,
+        Protocol = 1,
+        Status = 2,
+        Active = 3,
+        LastSeen = 4,
+        Payee = 5
+    };
+
+    enum RoleIndex {
+        /** Unformatted column value, used by the proxy model for sorting */
+        SortRole = Qt::UserRole
+    };
+
+    /** @name Methods overridden from QAbstractTableModel
+        @{*/
+    int rowCount(const QModelIndex& parent) const;
+    int columnCount(const QModelIndex& parent) const;
+    QVariant data(const QModelIndex& index, int role) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+    Qt::ItemFlags flags(const QModelIndex& index) const;
+    /*@}*/
+
+    /** Queue a Dynode for refresh, may be called from any thread */
+    void queueUpdate(const COutPoint& outpoint);
+
+public Q_SLOTS:
+    /** Reload the whole list from CDynodeMan */
+    void refresh();
+    /** Apply the changes queued since the last call, must be called from the GUI thread */
+    void processQueuedUpdates();
+
+private:
+    QStringList columns;
+    std::vector<DynodeTableEntry> cachedDynodes;
+    std::map<COutPoint, int> mapDynodeRows;
+
+    // Protects setQueuedUpdates
+    CCriticalSection cs_queue;
+    std::set<COutPoint> setQueuedUpdates;
+
+    void updateEntry(const COutPoint& outpoint);
+    void removeEntry(int nRow);
+
+    void subscribeToCoreSignals();
+    void unsubscribeFromCoreSignals();
+};
+
+#endif // DYNAMIC_QT_DYNODETABLEMODEL_H
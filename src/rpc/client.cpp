@@ -30,6 +30,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
         {"setgenerate", 0, "generate"},
         {"setgenerate", 1, "genproclimit-cpu"},
         {"setgenerate", 2, "genproclimit-gpu"},
+        {"gethashespersec", 0, "verbose"},
         {"generate", 0, "nblocks"},
         {"generate", 1, "maxtries"},
         {"generatetoaddress", 0, "nblocks"},
@@ -138,6 +139,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
         {"getmempoolancestors", 1, "verbose"},
         {"getmempooldescendants", 1, "verbose"},
         {"setnetworkactive", 0, "state"},
+        {"getmsgstats", 0, "reset"},
         {"spork", 1, "value"},
         {"voteraw", 1, "tx_index"},
         {"voteraw", 5, "time"},
@@ -25,6 +25,7 @@
 #include "wallet/wallet.h"
 #include "uint256.h"
 #include "utilmoneystr.h"
+#include "utilstrencodings.h"
 #include "utiltime.h"
 #include "validation.h"
 
@@ -467,85 +468,118 @@ static UniValue SendLinkAccept(const JSONRPCRequest& request)
     return oLink;
 }
 
-static bool BuildJsonMyLists(const std::vector<CLink>& vchLinkRequests, const std::string& strFromAccount, const std::string& strToAccount, UniValue& oLinkRequests)
+static bool BuildJsonMyLists(const std::vector<CLink>& vchLinkRequests, UniValue& oLinkRequests, const int nFirst)
 {
-    int nCount = 1;
+    int nCount = nFirst;
     for (const CLink& link : vchLinkRequests) {
         UniValue oLink(UniValue::VOBJ);
         bool expired = false;
         int64_t expired_time = 0;
         int64_t nTime = 0;
-        if (strFromAccount.empty() || strFromAccount == stringFromVch(link.RequestorFullObjectPath)) {
-            if (strToAccount.empty() || strToAccount == stringFromVch(link.RecipientFullObjectPath)) {
-                oLink.push_back(Pair("requestor_fqdn", stringFromVch(link.RequestorFullObjectPath)));
-                oLink.push_back(Pair("recipient_fqdn", stringFromVch(link.RecipientFullObjectPath)));
-
-                if (stringFromVch(link.SharedRequestPubKey).length() > 0) oLink.push_back(Pair("shared_request_pubkey", stringFromVch(link.SharedRequestPubKey)));
-                if (stringFromVch(link.SharedAcceptPubKey).length() > 0) oLink.push_back(Pair("shared_accept_pubkey", stringFromVch(link.SharedAcceptPubKey)));
-
-                if (stringFromVch(link.RequestorWalletAddress).length() > 0) oLink.push_back(Pair("requestor_wallet_address", stringFromVch(link.RequestorWalletAddress)));
-                if (stringFromVch(link.RecipientWalletAddress).length() > 0) oLink.push_back(Pair("recipient_wallet_address", stringFromVch(link.RecipientWalletAddress)));
-
-                oLink.push_back(Pair("requestor_link_pubkey", stringFromVch(link.RequestorPubKey)));
-                oLink.push_back(Pair("txid", link.txHashRequest.GetHex())); // TODO: rename to request_txid
-                if ((unsigned int)chainActive.Height() >= link.nHeightRequest-1) {
-                    CBlockIndex *pindex = chainActive[link.nHeightRequest-1];
-                    if (pindex) {
-                        nTime = pindex->GetMedianTimePast();
-                    }
+        oLink.push_back(Pair("requestor_fqdn", stringFromVch(link.RequestorFullObjectPath)));
+        oLink.push_back(Pair("recipient_fqdn", stringFromVch(link.RecipientFullObjectPath)));
+
+        if (stringFromVch(link.SharedRequestPubKey).length() > 0) oLink.push_back(Pair("shared_request_pubkey", stringFromVch(link.SharedRequestPubKey)));
+        if (stringFromVch(link.SharedAcceptPubKey).length() > 0) oLink.push_back(Pair("shared_accept_pubkey", stringFromVch(link.SharedAcceptPubKey)));
+
+        if (stringFromVch(link.RequestorWalletAddress).length() > 0) oLink.push_back(Pair("requestor_wallet_address", stringFromVch(link.RequestorWalletAddress)));
+        if (stringFromVch(link.RecipientWalletAddress).length() > 0) oLink.push_back(Pair("recipient_wallet_address", stringFromVch(link.RecipientWalletAddress)));
+
+        oLink.push_back(Pair("requestor_link_pubkey", stringFromVch(link.RequestorPubKey)));
+        oLink.push_back(Pair("txid", link.txHashRequest.GetHex())); // TODO: rename to request_txid
+        if ((unsigned int)chainActive.Height() >= link.nHeightRequest-1) {
+            CBlockIndex *pindex = chainActive[link.nHeightRequest-1];
+            if (pindex) {
+                nTime = pindex->GetMedianTimePast();
+            }
+        }
+        oLink.push_back(Pair("time", nTime)); // TODO: rename to request_time
+        expired_time = link.nExpireTimeRequest;
+        if (expired_time != 0)
+        {
+            if (expired_time <= (int64_t)chainActive.Tip()->GetMedianTimePast())
+            {
+                expired = true;
+            }
+        }
+        oLink.push_back(Pair("expires_on", expired_time)); // TODO: rename to request_expires_on
+        oLink.push_back(Pair("expired", expired)); // TODO: rename to request_expired
+        if (!link.txHashAccept.IsNull()) {
+            oLink.push_back(Pair("recipient_link_pubkey", stringFromVch(link.RecipientPubKey)));
+            oLink.push_back(Pair("accept_txid", link.txHashAccept.GetHex()));
+            if ((unsigned int)chainActive.Height() >= link.nHeightAccept-1) {
+                CBlockIndex *pindex = chainActive[link.nHeightAccept-1]; //changed from Request to Accept
+                if (pindex) {
+                    nTime = pindex->GetMedianTimePast();
                 }
-                oLink.push_back(Pair("time", nTime)); // TODO: rename to request_time
-                expired_time = link.nExpireTimeRequest;
-                if (expired_time != 0)
+            }
+            oLink.push_back(Pair("accept_time", nTime));
+            expired_time = link.nExpireTimeAccept; //changed from Request to Accept
+            expired = false;
+            if (expired_time != 0)
+            {
+                if (expired_time <= (int64_t)chainActive.Tip()->GetMedianTimePast())
                 {
-                    if (expired_time <= (int64_t)chainActive.Tip()->GetMedianTimePast())
-                    {
-                        expired = true;
-                    }
+                    expired = true;
                 }
-                oLink.push_back(Pair("expires_on", expired_time)); // TODO: rename to request_expires_on
-                oLink.push_back(Pair("expired", expired)); // TODO: rename to request_expired
-                if (!link.txHashAccept.IsNull()) {
-                    oLink.push_back(Pair("recipient_link_pubkey", stringFromVch(link.RecipientPubKey)));
-                    oLink.push_back(Pair("accept_txid", link.txHashAccept.GetHex()));
-                    if ((unsigned int)chainActive.Height() >= link.nHeightAccept-1) {
-                        CBlockIndex *pindex = chainActive[link.nHeightAccept-1]; //changed from Request to Accept
-                        if (pindex) {
-                            nTime = pindex->GetMedianTimePast();
-                        }
-                    }
-                    oLink.push_back(Pair("accept_time", nTime));
-                    expired_time = link.nExpireTimeAccept; //changed from Request to Accept
-                    expired = false;
-                    if (expired_time != 0)
-                    {
-                        if (expired_time <= (int64_t)chainActive.Tip()->GetMedianTimePast())
-                        {
-                            expired = true;
-                        }
-                    }
-                    oLink.push_back(Pair("accept_expires_on", expired_time));
-                    oLink.push_back(Pair("accept_expired", expired));
-                }
-                oLink.push_back(Pair("link_message", stringFromVch(link.LinkMessage)));
-                oLinkRequests.push_back(Pair("link-" + std::to_string(nCount) , oLink));
-                nCount ++;
             }
+            oLink.push_back(Pair("accept_expires_on", expired_time));
+            oLink.push_back(Pair("accept_expired", expired));
         }
+        oLink.push_back(Pair("link_message", stringFromVch(link.LinkMessage)));
+        oLinkRequests.push_back(Pair("link-" + std::to_string(nCount) , oLink));
+        nCount ++;
     }
 
     return true;
 }
 
+// Optional from/to accounts and page window of the link list commands, starting at nFirstParam
+static CLinkFilter ParseLinkListFilter(const JSONRPCRequest& request, const size_t nFirstParam, const std::string& strErrorPrefix)
+{
+    CLinkFilter filter;
+    if (request.params.size() > nFirstParam && !request.params[nFirstParam].get_str().empty()) {
+        std::string strFromAccountFQDN = request.params[nFirstParam].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
+        ToLowerCase(strFromAccountFQDN);
+        filter.vchRequestor = vchFromString(strFromAccountFQDN);
+    }
+    if (request.params.size() > nFirstParam + 1 && !request.params[nFirstParam + 1].get_str().empty()) {
+        std::string strToAccountFQDN = request.params[nFirstParam + 1].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
+        ToLowerCase(strToAccountFQDN);
+        filter.vchRecipient = vchFromString(strToAccountFQDN);
+    }
+    int nSkip = 0, nCount = 0;
+    if (request.params.size() > nFirstParam + 2) {
+        if (!ParseInt32(request.params[nFirstParam + 2].get_str(), &nSkip) || nSkip < 0)
+            throw std::runtime_error(strErrorPrefix + ": ERRCODE: 4204 - Invalid skip parameter.");
+    }
+    if (request.params.size() > nFirstParam + 3) {
+        if (!ParseInt32(request.params[nFirstParam + 3].get_str(), &nCount) || nCount < 0)
+            throw std::runtime_error(strErrorPrefix + ": ERRCODE: 4205 - Invalid count parameter.");
+    }
+    filter.nSkip = nSkip;
+    filter.nCount = nCount;
+    return filter;
+}
+
+static void PushLinkListTotals(UniValue& oLinks, const size_t nTotal)
+{
+    oLinks.push_back(Pair("total_links", (int)nTotal));
+    int nInQueue = (int)pLinkManager->QueueSize();
+    oLinks.push_back(Pair("locked_links", nInQueue));
+}
+
 static UniValue ListPendingLinks(const JSONRPCRequest& request)
 {
-     if (request.fHelp || request.params.size() > 4)
+     if (request.fHelp || request.params.size() > 5)
         throw std::runtime_error(
-            "lists pending link requests\n"
+            "lists pending links of your accounts, link pending request or link pending accept narrow them to one side\n"
             + HelpRequiringPassphrase() +
-            "\nLink Send Arguments:\n"
-            "1. from account                  (string, optional)    BDAP from account sending the link request\n"
-            "2. to account                    (string, optional)    BDAP to account receiving the link request\n"
+            "\nLink Pending Arguments:\n"
+            "1. from account                  (string, optional)    BDAP from account sending the link request, \"\" for any\n"
+            "2. to account                    (string, optional)    BDAP to account receiving the link request, \"\" for any\n"
+            "3. skip                          (int, optional)       Number of matching links to skip, default 0\n"
+            "4. count                         (int, optional)       Maximum number of links to return, default 0 (all)\n"
             "\nResult:\n"
             "{(json objects)\n"
             "  \"From Account\"               (string)  Requestor's BDAP full path\n"
@@ -556,50 +590,43 @@ static UniValue ListPendingLinks(const JSONRPCRequest& request)
             "  \"Expires On\"                 (int)     Link request expiration\n"
             "  \"Expired\"                    (boolean) Is link request expired\n"
             "  },...n \n"
+            "  \"total_links\"                (int)     Number of matching links before paging\n"
+            "  \"locked_links\"               (int)     Links waiting in the queue for the wallet to unlock\n"
             "\nExamples:\n"
-            + HelpExampleCli("link pending request", "superman batman") +
+            + HelpExampleCli("link pending", "superman batman 0 10") +
             "\nAs a JSON-RPC call\n"
-            + HelpExampleRpc("link pending request", "superman batman"));
+            + HelpExampleRpc("link pending", "superman batman 0 10"));
 
-    std::string strFromAccountFQDN, strToAccountFQDN;
-    if (request.params.size() > 2) {
-        strFromAccountFQDN = request.params[2].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strFromAccountFQDN);
-    }
-    if (request.params.size() > 3) {
-        strToAccountFQDN = request.params[3].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strToAccountFQDN);
-    }
+    CLinkFilter filter = ParseLinkListFilter(request, 1, "BDAP_LINK_LIST_PENDING_RPC_ERROR");
 
     if (!pLinkManager)
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_RPC_ERROR: ERRCODE: 4200 - Link manager map is null.");
 
     std::vector<CLink> vchPendingLinks;
-    if (!pLinkManager->ListMyPendingRequests(vchPendingLinks))
-        throw std::runtime_error("BDAP_LINK_LIST_PENDING_RPC_ERROR: ERRCODE: 4201 - Error listing link requests from memory map");
-
-    if (!pLinkManager->ListMyPendingAccepts(vchPendingLinks))
-        throw std::runtime_error("BDAP_LINK_LIST_PENDING_RPC_ERROR: ERRCODE: 4202 - Error listing link accepts from memory map");
+    size_t nTotal = 0;
+    if (!pLinkManager->ListMyPending(vchPendingLinks, filter, &nTotal))
+        throw std::runtime_error("BDAP_LINK_LIST_PENDING_RPC_ERROR: ERRCODE: 4201 - Error listing pending links from memory map");
 
     UniValue oLinks(UniValue::VOBJ);
-    if (!BuildJsonMyLists(vchPendingLinks, strFromAccountFQDN, strToAccountFQDN, oLinks))
+    if (!BuildJsonMyLists(vchPendingLinks, oLinks, filter.nSkip + 1))
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_RPC_ERROR: ERRCODE: 4203 - Error creating JSON link requests.");
 
-    int nInQueue = (int)pLinkManager->QueueSize();
-    oLinks.push_back(Pair("locked_links", nInQueue));
+    PushLinkListTotals(oLinks, nTotal);
 
     return oLinks;
 }
 
 static UniValue ListPendingLinkRequests(const JSONRPCRequest& request)
 {
-     if (request.fHelp || request.params.size() > 4)
+     if (request.fHelp || request.params.size() > 6)
         throw std::runtime_error(
             "lists pending link requests sent by your account\n"
             + HelpRequiringPassphrase() +
             "\nLink Send Arguments:\n"
             "1. from account                  (string, optional)    BDAP from account sending the link request\n"
             "2. to account                    (string, optional)    BDAP to account receiving the link request\n"
+            "3. skip                          (int, optional)       Number of matching links to skip, default 0\n"
+            "4. count                         (int, optional)       Maximum number of links to return, default 0 (all)\n"
             "\nResult:\n"
             "{(json objects)\n"
             "  \"From Account\"               (string)  Requestor's BDAP full path\n"
@@ -610,47 +637,43 @@ static UniValue ListPendingLinkRequests(const JSONRPCRequest& request)
             "  \"Expires On\"                 (int)     Link request expiration\n"
             "  \"Expired\"                    (boolean) Is link request expired\n"
             "  },...n \n"
+            "  \"total_links\"                (int)     Number of matching links before paging\n"
+            "  \"locked_links\"               (int)     Links waiting in the queue for the wallet to unlock\n"
             "\nExamples:\n"
             + HelpExampleCli("link pending request", "superman batman") +
             "\nAs a JSON-RPC call\n"
             + HelpExampleRpc("link pending request", "superman batman"));
 
-    std::string strFromAccountFQDN, strToAccountFQDN;
-    if (request.params.size() > 2) {
-        strFromAccountFQDN = request.params[2].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strFromAccountFQDN);
-    }
-    if (request.params.size() > 3) {
-        strToAccountFQDN = request.params[3].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strToAccountFQDN);
-    }
+    CLinkFilter filter = ParseLinkListFilter(request, 2, "BDAP_LINK_LIST_PENDING_REQ_RPC_ERROR");
 
     if (!pLinkManager)
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_REQ_RPC_ERROR: ERRCODE: 4200 - Link manager map is null.");
 
     std::vector<CLink> vchPendingLinks;
-    if (!pLinkManager->ListMyPendingRequests(vchPendingLinks))
+    size_t nTotal = 0;
+    if (!pLinkManager->ListMyPendingRequests(vchPendingLinks, filter, &nTotal))
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_REQ_RPC_ERROR: ERRCODE: 4201 - Error listing link requests from memory map");
 
     UniValue oLinks(UniValue::VOBJ);
-    if (!BuildJsonMyLists(vchPendingLinks, strFromAccountFQDN, strToAccountFQDN, oLinks))
+    if (!BuildJsonMyLists(vchPendingLinks, oLinks, filter.nSkip + 1))
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_REQ_RPC_ERROR: ERRCODE: 4203 - Error creating JSON link requests.");
 
-    int nInQueue = (int)pLinkManager->QueueSize();
-    oLinks.push_back(Pair("locked_links", nInQueue));
+    PushLinkListTotals(oLinks, nTotal);
 
     return oLinks;
 }
 
 static UniValue ListPendingLinkAccepts(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() > 4)
+    if (request.fHelp || request.params.size() > 6)
         throw std::runtime_error(
             "lists pending link accepts sent to your account\n"
             + HelpRequiringPassphrase() +
             "\nLink Send Arguments:\n"
             "1. from account                  (string, optional)    BDAP from account sending the link request\n"
             "2. to account                    (string, optional)    BDAP to account receiving the link request\n"
+            "3. skip                          (int, optional)       Number of matching links to skip, default 0\n"
+            "4. count                         (int, optional)       Maximum number of links to return, default 0 (all)\n"
             "\nResult:\n"
             "{(json objects)\n"
             "  \"From Account\"               (string)  Requestor's BDAP full path\n"
@@ -661,46 +684,42 @@ static UniValue ListPendingLinkAccepts(const JSONRPCRequest& request)
             "  \"Expires On\"                 (int)     Link request expiration\n"
             "  \"Expired\"                    (boolean) Is link request expired\n"
             "  },...n \n"
+            "  \"total_links\"                (int)     Number of matching links before paging\n"
+            "  \"locked_links\"               (int)     Links waiting in the queue for the wallet to unlock\n"
             "\nExamples:\n"
             + HelpExampleCli("link pending accept", "superman batman") +
             "\nAs a JSON-RPC call\n"
             + HelpExampleRpc("link pending accept", "superman batman"));
 
-    std::string strFromAccountFQDN, strToAccountFQDN;
-    if (request.params.size() > 2) {
-        strFromAccountFQDN = request.params[2].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strFromAccountFQDN);
-    }
-    if (request.params.size() > 3) {
-        strToAccountFQDN = request.params[3].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strToAccountFQDN);
-    }
-    
+    CLinkFilter filter = ParseLinkListFilter(request, 2, "BDAP_LINK_LIST_PENDING_ACCEPT_RPC_ERROR");
+
     if (!pLinkManager)
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_ACCEPT_RPC_ERROR: ERRCODE: 4200 - Link manager map is null.");
 
     std::vector<CLink> vchPendingLinks;
-    if (!pLinkManager->ListMyPendingAccepts(vchPendingLinks))
+    size_t nTotal = 0;
+    if (!pLinkManager->ListMyPendingAccepts(vchPendingLinks, filter, &nTotal))
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_ACCEPT_RPC_ERROR: ERRCODE: 4211 - Error listing link requests from memory map");
 
     UniValue oLinks(UniValue::VOBJ);
-    if (!BuildJsonMyLists(vchPendingLinks, strFromAccountFQDN, strToAccountFQDN, oLinks))
+    if (!BuildJsonMyLists(vchPendingLinks, oLinks, filter.nSkip + 1))
         throw std::runtime_error("BDAP_LINK_LIST_PENDING_ACCEPT_RPC_ERROR: ERRCODE: 4213 - Error creating JSON link requests.");
 
-    int nInQueue = (int)pLinkManager->QueueSize();
-    oLinks.push_back(Pair("locked_links", nInQueue));
+    PushLinkListTotals(oLinks, nTotal);
 
     return oLinks;
 }
 
 static UniValue ListCompletedLinks(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() > 3)
+    if (request.fHelp || request.params.size() > 5)
         throw std::runtime_error(
             "lists completed links\n"
             "\nLink Completed Arguments:\n"
             "1. from account                  (string, optional)    BDAP from account sending the link request\n"
             "2. to account                    (string, optional)    BDAP to account receiving the link request\n"
+            "3. skip                          (int, optional)       Number of matching links to skip, default 0\n"
+            "4. count                         (int, optional)       Maximum number of links to return, default 0 (all)\n"
             + HelpRequiringPassphrase() +
             "\nResult:\n"
             "{(json objects)\n"
@@ -717,37 +736,65 @@ static UniValue ListCompletedLinks(const JSONRPCRequest& request)
             "  \"Accept Expired\"             (boolean) Is link request expired\n"
             "  \"Link Message\"               (string) Message from requestor to recipient\n"
             "  },...n \n"
+            "  \"total_links\"                (int)     Number of matching links before paging\n"
+            "  \"locked_links\"               (int)     Links waiting in the queue for the wallet to unlock\n"
             "\nExamples:\n"
             + HelpExampleCli("link complete", "") +
             "\nAs a JSON-RPC call\n"
             + HelpExampleRpc("link complete", ""));
 
-    std::string strFromAccountFQDN, strToAccountFQDN;
-    if (request.params.size() > 1) {
-        strFromAccountFQDN = request.params[1].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strFromAccountFQDN);
-    }
-    if (request.params.size() > 2) {
-        strToAccountFQDN = request.params[2].get_str() + "@" + DEFAULT_PUBLIC_OU + "." + DEFAULT_PUBLIC_DOMAIN;
-        ToLowerCase(strToAccountFQDN);
-    }
+    CLinkFilter filter = ParseLinkListFilter(request, 1, "BDAP_LINK_COMPLETED_RPC_ERROR");
 
     if (!pLinkManager)
-        throw std::runtime_error("BDAP_LINK_LIST_PENDING_ACCEPT_RPC_ERROR: ERRCODE: 4200 - Link manager map is null.");
+        throw std::runtime_error("BDAP_LINK_COMPLETED_RPC_ERROR: ERRCODE: 4200 - Link manager map is null.");
 
     std::vector<CLink> vchLinkCompleted;
-    if (!pLinkManager->ListMyCompleted(vchLinkCompleted))
+    size_t nTotal = 0;
+    if (!pLinkManager->ListMyCompleted(vchLinkCompleted, filter, &nTotal))
         throw std::runtime_error("BDAP_LINK_COMPLETED_RPC_ERROR: ERRCODE: 4221 - Error listing link requests from memory map");
 
     UniValue oLinks(UniValue::VOBJ);
-    if (!BuildJsonMyLists(vchLinkCompleted, strFromAccountFQDN, strToAccountFQDN, oLinks))
+    if (!BuildJsonMyLists(vchLinkCompleted, oLinks, filter.nSkip + 1))
         throw std::runtime_error("BDAP_LINK_COMPLETED_RPC_ERROR: ERRCODE: 4222 - Error creating JSON link requests.");
 
-    int nInQueue = (int)pLinkManager->QueueSize();
-    oLinks.push_back(Pair("locked_links", nInQueue));
+    PushLinkListTotals(oLinks, nTotal);
 
     return oLinks;
 }
+static UniValue GetLinkQueueInfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "link queue\n"
+            "Shows the progress of processing the link queue after the wallet is unlocked.\n"
+            "\nResult:\n"
+            "{(json object)\n"
+            "  \"queued_links\"               (int)     Links waiting in the queue\n"
+            "  \"processing\"                 (boolean) The queue is being processed in the background\n"
+            "  \"processed\"                  (int)     Links processed by the current or last run\n"
+            "  \"total\"                      (int)     Links scheduled in the current or last run\n"
+            "  \"link_count\"                 (int)     Links held in memory\n"
+            "  }\n"
+            "\nExamples:\n"
+            + HelpExampleCli("link queue", "") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("link queue", ""));
+
+    if (!pLinkManager)
+        throw std::runtime_error("BDAP_LINK_QUEUE_RPC_ERROR: ERRCODE: 4200 - Link manager map is null.");
+
+    size_t nProcessed = 0, nTotal = 0;
+    bool fProcessing = pLinkManager->GetQueueProgress(nProcessed, nTotal);
+
+    UniValue oQueue(UniValue::VOBJ);
+    oQueue.push_back(Pair("queued_links", (int)pLinkManager->QueueSize()));
+    oQueue.push_back(Pair("processing", fProcessing));
+    oQueue.push_back(Pair("processed", (int)nProcessed));
+    oQueue.push_back(Pair("total", (int)nTotal));
+    oQueue.push_back(Pair("link_count", (int)pLinkManager->LinkCount()));
+
+    return oQueue;
+}
 /*
 static UniValue DeleteLink(const JSONRPCRequest& request)
 {
@@ -1275,7 +1322,7 @@ UniValue link(const JSONRPCRequest& request)
         throw std::runtime_error(
             "link \"command\"...\n"
             + HelpRequiringPassphrase() +
-            "\nLink commands are request, accept, pending, complete, deny, denied, getaccountmessages, getmessages, and sendmessage\n"
+            "\nLink commands are request, accept, pending, complete, deny, denied, getaccountmessages, getmessages, queue, and sendmessage\n"
             "\nExamples:\n"
             + HelpExampleCli("link accept", "superman batman") +
             "\nAs a JSON-RPC call\n"
@@ -1312,40 +1359,25 @@ UniValue link(const JSONRPCRequest& request)
         return GetMessages(request);
     }
     else if (strCommand == "pending") {
-        if (request.params.size() == 1) {
-            return ListPendingLinks(request);
-        }
-        else if (request.params.size() >= 2) {
-            std::string strSubCommand = request.params[1].get_str();
+        // link pending [request|accept] [from] [to] [skip] [count]
+        std::string strSubCommand;
+        if (request.params.size() >= 2) {
+            strSubCommand = request.params[1].get_str();
             ToLowerCase(strSubCommand);
-            if (strSubCommand == "request") {
-                return ListPendingLinkRequests(request);
-            }
-            else if (strSubCommand == "accept") {
-                return ListPendingLinkAccepts(request);
-            }
-            else {
-                throw std::runtime_error(
-                "link pending\n"
-                + HelpRequiringPassphrase() +
-                "\nLink Pending sub-commands are request or accept.\n"
-                "\nExamples:\n"
-                + HelpExampleCli("link pending request", "") +
-                "\nAs a JSON-RPC call\n"
-                + HelpExampleRpc("link pending request", ""));
-            }
+        }
+        if (strSubCommand == "request") {
+            return ListPendingLinkRequests(request);
+        }
+        else if (strSubCommand == "accept") {
+            return ListPendingLinkAccepts(request);
         }
         else {
-            throw std::runtime_error(
-            "link pending\n"
-            + HelpRequiringPassphrase() +
-            "\nLink Pending sub-commands are request or accept.\n"
-            "\nExamples:\n"
-            + HelpExampleCli("link pending request", "") +
-            "\nAs a JSON-RPC call\n"
-            + HelpExampleRpc("link pending request", ""));
+            return ListPendingLinks(request);
         }
     }
+    else if (strCommand == "queue") {
+        return GetLinkQueueInfo(request);
+    }
     else if (strCommand == "sendmessage") {
         return SendMessage(request);
     }
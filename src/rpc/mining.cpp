@@ -19,6 +19,7 @@
 #include "fluid/fluidmint.h"
 #include "init.h"
 #include "miner/miner.h"
+#include "miner/stratum.h"
 #include "net.h"
 #include "pow.h"
 #include "rpc/server.h"
@@ -353,19 +354,63 @@ UniValue setgenerate(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
+static UniValue HashRatesToJSON(const MinerHashRates& rates)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("1m", rates.n1m));
+    obj.push_back(Pair("5m", rates.n5m));
+    obj.push_back(Pair("15m", rates.n15m));
+    return obj;
+}
+
+static UniValue DeviceHashRatesToJSON()
+{
+    UniValue devices(UniValue::VARR);
+    for (const MinerDeviceHashRates& device : GetDeviceHashRates()) {
+        UniValue obj = HashRatesToJSON(device.rates);
+        obj.push_back(Pair("type", device.strType));
+        obj.push_back(Pair("device", device.nDevice));
+        devices.push_back(obj);
+    }
+    return devices;
+}
+
 UniValue gethashespersec(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 1)
         throw std::runtime_error(
-            "gethashespersec\n"
+            "gethashespersec ( verbose )\n"
             "\nReturns a recent hashes per second performance measurement while generating.\n"
             "See the getgenerate and setgenerate calls to turn generation on and off.\n"
-            "\nResult:\n"
-            "n            (numeric) The recent hashes per second when generation is on (will return 0 if generation is off)\n"
+            "\nArguments:\n"
+            "1. verbose   (boolean, optional, default=false) Return the 1, 5 and 15 minute rates of every device\n"
+            "\nResult (for verbose = false):\n"
+            "n            (numeric) The hashes per second over the last minute when generation is on (will return 0 if generation is off)\n"
+            "\nResult (for verbose = true):\n"
+            "{\n"
+            "  \"1m\": n,            (numeric) The hashes per second over the last minute\n"
+            "  \"5m\": n,            (numeric) The hashes per second over the last 5 minutes\n"
+            "  \"15m\": n,           (numeric) The hashes per second over the last 15 minutes\n"
+            "  \"devices\": [        (array) Rates of each device miner threads ran on\n"
+            "    {\n"
+            "      \"1m\": n,        (numeric) The hashes per second of the device over the last minute\n"
+            "      \"5m\": n,        (numeric) The hashes per second of the device over the last 5 minutes\n"
+            "      \"15m\": n,       (numeric) The hashes per second of the device over the last 15 minutes\n"
+            "      \"type\": \"xxx\",  (string) CPU or GPU\n"
+            "      \"device\": n     (numeric) Index of the device\n"
+            "    }\n"
+            "    ,...\n"
+            "  ]\n"
+            "}\n"
             "\nExamples:\n" +
-            HelpExampleCli("gethashespersec", "") + HelpExampleRpc("gethashespersec", ""));
+            HelpExampleCli("gethashespersec", "") + HelpExampleCli("gethashespersec", "true") + HelpExampleRpc("gethashespersec", ""));
 
-    return GetHashRate();
+    if (request.params.size() == 0 || !request.params[0].get_bool())
+        return GetHashRate();
+
+    UniValue obj = HashRatesToJSON(GetHashRates());
+    obj.push_back(Pair("devices", DeviceHashRatesToJSON()));
+    return obj;
 }
 
 
@@ -420,6 +465,19 @@ UniValue getmininginfo(const JSONRPCRequest& request)
             "  \"hashespersec\": n          (numeric) The recent hashes per second when generation is on (will return 0 if generation is off)\n"
             "  \"cpuhashespersec\": n       (numeric) The recent CPU hashes per second when generation is on (will return 0 if generation is off)\n"
             "  \"gpuhashespersec\": n       (numeric) The recent GPU hashes per second when generation is on (will return 0 if generation is off)\n"
+            "  \"hashrates\": {             (json object) Hashes per second of CPU and GPU over the last 1, 5 and 15 minutes\n"
+            "    \"1m\": n, \"5m\": n, \"15m\": n\n"
+            "  }\n"
+            "  \"devices\": [               (array) The same rates for each device, see gethashespersec true\n"
+            "    { \"1m\": n, \"5m\": n, \"15m\": n, \"type\": \"xxx\", \"device\": n }\n"
+            "    ,...\n"
+            "  ]\n"
+            "  \"stalework\": {             (json object) Time miner threads kept hashing a block after it was superseded by a new tip or template\n"
+            "    \"switches\": n            (numeric) The number of times a miner thread switched to new work\n"
+            "    \"last\": n                (numeric) Stale time of the last switch in milliseconds\n"
+            "    \"avg\": n                 (numeric) Average stale time in milliseconds\n"
+            "    \"max\": n                 (numeric) Longest stale time in milliseconds\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("getmininginfo", "") + HelpExampleRpc("getmininginfo", ""));
@@ -442,6 +500,94 @@ UniValue getmininginfo(const JSONRPCRequest& request)
     obj.push_back(Pair("hashespersec", gethashespersec(request)));
     obj.push_back(Pair("cpuhashespersec", getcpuhashespersec(request)));
     obj.push_back(Pair("gpuhashespersec", getgpuhashespersec(request)));
+    obj.push_back(Pair("hashrates", HashRatesToJSON(GetHashRates())));
+    obj.push_back(Pair("devices", DeviceHashRatesToJSON()));
+
+    MinerStaleWorkStats staleWork = GetMinerStaleWork();
+    UniValue staleObj(UniValue::VOBJ);
+    staleObj.push_back(Pair("switches", staleWork.nSwitches));
+    staleObj.push_back(Pair("last", staleWork.nLastMicros / 1000.0));
+    staleObj.push_back(Pair("avg", staleWork.nSwitches ? staleWork.nTotalMicros / 1000.0 / staleWork.nSwitches : 0.0));
+    staleObj.push_back(Pair("max", staleWork.nMaxMicros / 1000.0));
+    obj.push_back(Pair("stalework", staleObj));
+    return obj;
+}
+
+UniValue getstratuminfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getstratuminfo\n"
+            "\nReturns the state of the Stratum server and share statistics of its workers.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"enabled\": true|false,     (boolean) If the Stratum server is running (-stratum)\n"
+            "  \"bind\": \"addr:port\",       (string) The address workers connect to\n"
+            "  \"height\": n,               (numeric) The height of the current job\n"
+            "  \"jobs\": n,                 (numeric) The number of jobs built since the server started\n"
+            "  \"lastjobtime\": n,          (numeric) Time taken to build the last job in milliseconds\n"
+            "  \"accepted\": n,             (numeric) Shares accepted from all workers\n"
+            "  \"rejected\": n,             (numeric) Shares rejected from all workers\n"
+            "  \"blocks\": n,               (numeric) Blocks found by all workers\n"
+            "  \"workers\": [               (array) Connected workers\n"
+            "    {\n"
+            "      \"id\": n,               (numeric) Connection id\n"
+            "      \"address\": \"addr\",     (string) The worker's IP address and port\n"
+            "      \"worker\": \"name\",      (string) The name the worker authorized as\n"
+            "      \"conntime\": ttt,       (numeric) The connection time in seconds since epoch (Jan 1 1970 GMT)\n"
+            "      \"difficulty\": n.nnn,   (numeric) The share difficulty of the worker\n"
+            "      \"hashespersec\": n,     (numeric) Hashes per second estimated from the shares of the last " + std::to_string(STRATUM_HASHRATE_WINDOW / 60) + " minutes\n"
+            "      \"accepted\": n,         (numeric) Shares accepted\n"
+            "      \"rejected\": n,         (numeric) Shares rejected\n"
+            "      \"blocks\": n,           (numeric) Blocks found\n"
+            "      \"lastshare\": ttt,      (numeric) The time of the last accepted share in seconds since epoch (Jan 1 1970 GMT)\n"
+            "      \"rejectreasons\": {     (json object) Rejected shares by reason\n"
+            "        \"reason\": n          (numeric) Number of shares rejected for this reason\n"
+            "        ,...\n"
+            "      }\n"
+            "    }\n"
+            "    ,...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getstratuminfo", "") + HelpExampleRpc("getstratuminfo", ""));
+
+    StratumStats stats;
+    UniValue obj(UniValue::VOBJ);
+    if (!GetStratumStats(stats)) {
+        obj.push_back(Pair("enabled", false));
+        return obj;
+    }
+
+    obj.push_back(Pair("enabled", true));
+    obj.push_back(Pair("bind", stats.strBind));
+    obj.push_back(Pair("height", stats.nHeight));
+    obj.push_back(Pair("jobs", stats.nJobs));
+    obj.push_back(Pair("lastjobtime", stats.dLastJobMillis));
+    obj.push_back(Pair("accepted", stats.nAccepted));
+    obj.push_back(Pair("rejected", stats.nRejected));
+    obj.push_back(Pair("blocks", stats.nBlocks));
+
+    UniValue workers(UniValue::VARR);
+    for (const StratumWorkerStats& worker : stats.vWorkers) {
+        UniValue workerObj(UniValue::VOBJ);
+        workerObj.push_back(Pair("id", worker.nId));
+        workerObj.push_back(Pair("address", worker.strAddress));
+        workerObj.push_back(Pair("worker", worker.strWorker));
+        workerObj.push_back(Pair("conntime", worker.nConnectedTime));
+        workerObj.push_back(Pair("difficulty", worker.dDifficulty));
+        workerObj.push_back(Pair("hashespersec", worker.dHashRate));
+        workerObj.push_back(Pair("accepted", worker.nAccepted));
+        workerObj.push_back(Pair("rejected", worker.nRejected));
+        workerObj.push_back(Pair("blocks", worker.nBlocks));
+        workerObj.push_back(Pair("lastshare", worker.nLastShareTime));
+        UniValue reasons(UniValue::VOBJ);
+        for (const auto& item : worker.mapRejectReasons)
+            reasons.push_back(Pair(item.first, item.second));
+        workerObj.push_back(Pair("rejectreasons", reasons));
+        workers.push_back(workerObj);
+    }
+    obj.push_back(Pair("workers", workers));
     return obj;
 }
 
@@ -1136,6 +1282,7 @@ static const CRPCCommand commands[] =
         //  --------------------- ------------------------  -----------------------  ------ ---
         {"mining", "getnetworkhashps", &getnetworkhashps, true, {"nblocks", "height"}},
         {"mining", "getmininginfo", &getmininginfo, true, {}},
+        {"mining", "getstratuminfo", &getstratuminfo, true, {}},
         {"mining", "prioritisetransaction", &prioritisetransaction, true, {"txid", "priority_delta", "fee_delta"}},
         {"mining", "getblocktemplate", &getblocktemplate, true, {"template_request"}},
         {"mining", "submitblock", &submitblock, true, {"hexdata", "parameters"}},
@@ -1144,7 +1291,7 @@ static const CRPCCommand commands[] =
         {"generating", "setgenerate", &setgenerate, true, {"generate", "genproclimit-cpu", "genproclimit-gpu"}},
         {"generating", "generate", &generate, true, {"nblocks", "maxtries"}},
         {"generating", "generatetoaddress", &generatetoaddress, true, {"nblocks", "address", "maxtries"}},
-        {"generating", "gethashespersec", &gethashespersec, true, {}},
+        {"generating", "gethashespersec", &gethashespersec, true, {"verbose"}},
         {"generating", "getcpuhashespersec", &getcpuhashespersec, true, {}},
         {"generating", "getgpuhashespersec", &getgpuhashespersec, true, {}},
 
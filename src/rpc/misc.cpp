@@ -1062,6 +1062,25 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCReceiveBufferInfo()
+{
+    CNetMessageBufferPool::Stats stats = netMessageBufferPool.GetStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("cached", uint64_t(stats.nBuffersCached)));
+    obj.push_back(Pair("cached_bytes", uint64_t(stats.nBytesCached)));
+    obj.push_back(Pair("reused", stats.nReused));
+    obj.push_back(Pair("allocated", stats.nAllocated));
+    obj.push_back(Pair("returned", stats.nReturned));
+    obj.push_back(Pair("discarded", stats.nDiscarded));
+    obj.push_back(Pair("unclassed", stats.nUnclassed));
+    UniValue classes(UniValue::VOBJ);
+    for (const auto& classPair : stats.vClasses) {
+        classes.push_back(Pair(std::to_string(classPair.first), uint64_t(classPair.second)));
+    }
+    obj.push_back(Pair("classes", classes));
+    return obj;
+}
+
 UniValue getmemoryinfo(const JSONRPCRequest& request)
 {
     /* Please, avoid using the word "pool" here in the RPC interface or help,
@@ -1080,12 +1099,26 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"recvbuffers\": {          (object) Information about recycled network receive buffers\n"
+            "    \"cached\": xxxxx,        (numeric) Number of free buffers kept for reuse\n"
+            "    \"cached_bytes\": xxxxx,  (numeric) Capacity in bytes of the free buffers\n"
+            "    \"reused\": xxxxx,        (numeric) Messages that received a recycled buffer\n"
+            "    \"allocated\": xxxxx,     (numeric) Messages that needed a newly allocated buffer\n"
+            "    \"returned\": xxxxx,      (numeric) Buffers kept for reuse after their message was processed\n"
+            "    \"discarded\": xxxxx,     (numeric) Buffers freed after processing because enough were kept already\n"
+            "    \"unclassed\": xxxxx,     (numeric) Messages too large for any size class\n"
+            "    \"classes\": {            (object) Free buffers by size class\n"
+            "      \"size\": n,            (numeric) Number of free buffers of this size in bytes\n"
+            "      ...\n"
+            "    }\n"
             "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("getmemoryinfo", "") + HelpExampleRpc("getmemoryinfo", ""));
     UniValue obj(UniValue::VOBJ);
     obj.push_back(Pair("locked", RPCLockedMemoryInfo()));
+    obj.push_back(Pair("recvbuffers", RPCReceiveBufferInfo()));
     return obj;
 }
 
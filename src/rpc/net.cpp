@@ -80,6 +80,7 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
             "    \"lastrecv\": ttt,           (numeric) The time in seconds since epoch (Jan 1 1970 GMT) of the last receive\n"
             "    \"bytessent\": n,            (numeric) The total bytes sent\n"
             "    \"bytesrecv\": n,            (numeric) The total bytes received\n"
+            "    \"sendsyscalls\": n,         (numeric) The number of socket send calls made\n"
             "    \"conntime\": ttt,           (numeric) The connection time in seconds since epoch (Jan 1 1970 GMT)\n"
             "    \"timeoffset\": ttt,         (numeric) The time offset in seconds\n"
             "    \"pingtime\": n,             (numeric) ping time\n"
@@ -95,7 +96,34 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
             "    \"inflight\": [\n"
             "       n,                        (numeric) The heights of blocks we're currently asking from this peer\n"
             "       ...\n"
-            "    ]\n"
+            "    ],\n"
+            "    \"inflight_target\": n,      (numeric) The number of blocks we keep in flight from this peer, adapted to its delivery rate\n"
+            "    \"block_interval\": n,       (numeric) Average time in milliseconds between blocks delivered by this peer\n"
+            "    \"block_latency\": n,        (numeric) Average time in milliseconds from requesting a block to receiving it\n"
+            "    \"blocks_received\": n,      (numeric) The number of requested blocks received from this peer\n"
+            "    \"blocks_rerequested\": n,   (numeric) The number of blocks asked from this peer after a slower peer was late with them\n"
+            "    \"txreconciliation\": {     (json object, only if transactions are reconciled with this peer)\n"
+            "       \"initiator\": true|false, (boolean) Whether we send the sketches\n"
+            "       \"flood\": true|false,    (boolean) Whether the peer is still sent an inv for every transaction\n"
+            "       \"rounds\": n,            (numeric) Reconciliation rounds\n"
+            "       \"pending\": n,           (numeric) Transactions waiting for a round to finish\n"
+            "       \"announced\": n,         (numeric) Transactions announced after a round\n"
+            "       \"skipped\": n,           (numeric) Transactions not announced because the peer had them\n"
+            "       \"sketch_bytes\": n,      (numeric) Bytes of sketches and differing buckets sent and received\n"
+            "       \"bytes_saved\": n        (numeric) Inv bytes saved less the sketch bytes, negative if it cost more\n"
+            "    },\n"
+            "    \"sendqueues\": {         (json object) Messages sent per priority class\n"
+            "       \"high\": {              (json object) Class name, one of high, normal or bulk\n"
+            "          \"messages\": n,       (numeric) Messages sent from this class\n"
+            "          \"bytes\": n,          (numeric) Bytes sent from this class\n"
+            "          \"avg_queuetime\": n,  (numeric) Average time in milliseconds a message waited to be written\n"
+            "          \"max_queuetime\": n,  (numeric) Longest time in milliseconds a message waited to be written\n"
+            "          \"queuetime_hist\": [  (json array) Messages that waited under 1, 10, 100 and 1000 milliseconds, and longer\n"
+            "             n, ...\n"
+            "          ]\n"
+            "       },\n"
+            "       ...\n"
+            "    },\n"
             "    \"bytessent_per_msg\": {\n"
             "       \"addr\": n,             (numeric) The total bytes sent aggregated by message type\n"
             "       ...\n"
@@ -132,6 +160,7 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
         obj.push_back(Pair("lastrecv", stats.nLastRecv));
         obj.push_back(Pair("bytessent", stats.nSendBytes));
         obj.push_back(Pair("bytesrecv", stats.nRecvBytes));
+        obj.push_back(Pair("sendsyscalls", stats.nSendSyscalls));
         obj.push_back(Pair("conntime", stats.nTimeConnected));
         obj.push_back(Pair("timeoffset", stats.nTimeOffset));
         if (stats.dPingTime > 0.0)
@@ -156,9 +185,42 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
                 heights.push_back(height);
             }
             obj.push_back(Pair("inflight", heights));
+            obj.push_back(Pair("inflight_target", statestats.nBlocksInFlightTarget));
+            obj.push_back(Pair("block_interval", statestats.nBlockIntervalAvg / 1000));
+            obj.push_back(Pair("block_latency", statestats.nBlockLatencyAvg / 1000));
+            obj.push_back(Pair("blocks_received", statestats.nBlocksReceived));
+            obj.push_back(Pair("blocks_rerequested", statestats.nBlocksReRequested));
+            if (statestats.fTxRecon) {
+                UniValue recon(UniValue::VOBJ);
+                recon.push_back(Pair("initiator", statestats.fTxReconInitiator));
+                recon.push_back(Pair("flood", statestats.fTxReconFlood));
+                recon.push_back(Pair("rounds", statestats.nTxReconRounds));
+                recon.push_back(Pair("pending", statestats.nTxReconPending));
+                recon.push_back(Pair("announced", statestats.nTxReconAnnounced));
+                recon.push_back(Pair("skipped", statestats.nTxReconSkipped));
+                recon.push_back(Pair("sketch_bytes", statestats.nTxReconSketchBytes));
+                recon.push_back(Pair("bytes_saved", statestats.nTxReconBytesSaved));
+                obj.push_back(Pair("txreconciliation", recon));
+            }
         }
         obj.push_back(Pair("whitelisted", stats.fWhitelisted));
 
+        UniValue sendQueues(UniValue::VOBJ);
+        for (int nPriority = 0; nPriority < NUM_SEND_PRIORITIES; nPriority++) {
+            const CSendQueueStats& queueStats = stats.sendQueueStats[nPriority];
+            UniValue queue(UniValue::VOBJ);
+            queue.push_back(Pair("messages", queueStats.nMessages));
+            queue.push_back(Pair("bytes", queueStats.nBytes));
+            queue.push_back(Pair("avg_queuetime", queueStats.nMessages ? queueStats.nQueueTimeTotal / (double)queueStats.nMessages / 1000.0 : 0.0));
+            queue.push_back(Pair("max_queuetime", queueStats.nQueueTimeMax / 1000.0));
+            UniValue hist(UniValue::VARR);
+            for (int nBucket = 0; nBucket < CSendQueueStats::NUM_BUCKETS; nBucket++)
+                hist.push_back(queueStats.vBuckets[nBucket]);
+            queue.push_back(Pair("queuetime_hist", hist));
+            sendQueues.push_back(Pair(SendPriorityName(nPriority), queue));
+        }
+        obj.push_back(Pair("sendqueues", sendQueues));
+
         UniValue sendPerMsgCmd(UniValue::VOBJ);
         BOOST_FOREACH (const mapMsgCmdSize::value_type& i, stats.mapSendBytesPerMsgCmd) {
             if (i.second > 0)
@@ -566,6 +628,89 @@ UniValue setnetworkactive(const JSONRPCRequest& request)
     return g_connman->GetNetworkActive();
 }
 
+UniValue getblockreconstructionstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 0)
+        throw std::runtime_error(
+            "getblockreconstructionstats\n"
+            "\nReturns where the transactions of recently received compact blocks were found.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"blocks\": n,              (numeric) Number of recent compact blocks below\n"
+            "  \"transactions\": n,        (numeric) Transactions in these blocks\n"
+            "  \"prefilled\": n,           (numeric) Transactions sent along with the compact blocks\n"
+            "  \"found\": n,               (numeric) Transactions found locally\n"
+            "  \"extrapool\": n,           (numeric) Of which orphaned, conflicted or evicted transactions\n"
+            "  \"sources\": {              (json object) Of which transactions found in other stores\n"
+            "    \"name\": n,              (numeric) Transactions found in this store\n"
+            "    ...\n"
+            "  },\n"
+            "  \"requested\": n,           (numeric) Transactions requested from the peer\n"
+            "  \"hitrate\": x.xxx,         (numeric) Share of the transactions not prefilled that were found locally\n"
+            "  \"recent\": [               (json array) Recent compact blocks, oldest first\n"
+            "    {\n"
+            "      \"hash\": \"hash\",       (string) The block hash\n"
+            "      \"time\": t,            (numeric) The time in seconds since epoch (Jan 1 1970 GMT) the block was received\n"
+            "      \"transactions\": n,    (numeric) Same as above, for this block\n"
+            "      \"prefilled\": n,\n"
+            "      \"found\": n,\n"
+            "      \"extrapool\": n,\n"
+            "      \"sources\": {...},\n"
+            "      \"requested\": n,\n"
+            "      \"hitrate\": x.xxx\n"
+            "    },\n"
+            "    ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getblockreconstructionstats", "") + HelpExampleRpc("getblockreconstructionstats", ""));
+
+    std::vector<CBlockReconstructionStats> vStats = GetBlockReconstructionStats();
+
+    auto fnToJSON = [](UniValue& obj, const CBlockReconstructionStats& stats) {
+        UniValue sources(UniValue::VOBJ);
+        for (const auto& source : stats.vSources)
+            sources.push_back(Pair(source.first, (uint64_t)source.second));
+        obj.push_back(Pair("transactions", (uint64_t)stats.nTxCount));
+        obj.push_back(Pair("prefilled", (uint64_t)stats.nPrefilled));
+        obj.push_back(Pair("found", (uint64_t)stats.nMempool));
+        obj.push_back(Pair("extrapool", (uint64_t)stats.nExtra));
+        obj.push_back(Pair("sources", sources));
+        obj.push_back(Pair("requested", (uint64_t)stats.nRequested));
+        size_t nNotPrefilled = stats.nTxCount - stats.nPrefilled;
+        obj.push_back(Pair("hitrate", nNotPrefilled ? (double)stats.nMempool / nNotPrefilled : 1.0));
+    };
+
+    CBlockReconstructionStats total;
+    total.nTxCount = total.nPrefilled = total.nMempool = total.nExtra = total.nRequested = 0;
+    UniValue recent(UniValue::VARR);
+    for (const CBlockReconstructionStats& stats : vStats) {
+        total.nTxCount += stats.nTxCount;
+        total.nPrefilled += stats.nPrefilled;
+        total.nMempool += stats.nMempool;
+        total.nExtra += stats.nExtra;
+        total.nRequested += stats.nRequested;
+        if (total.vSources.empty())
+            total.vSources = stats.vSources;
+        else {
+            for (size_t i = 0; i < stats.vSources.size(); i++)
+                total.vSources[i].second += stats.vSources[i].second;
+        }
+
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("hash", stats.hash.GetHex()));
+        obj.push_back(Pair("time", stats.nTime));
+        fnToJSON(obj, stats);
+        recent.push_back(obj);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("blocks", (uint64_t)vStats.size()));
+    fnToJSON(ret, total);
+    ret.push_back(Pair("recent", recent));
+    return ret;
+}
+
 UniValue ntptime(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() > 1)
@@ -590,6 +735,84 @@ UniValue ntptime(const UniValue& params, bool fHelp)
     return obj;
 }
 
+static UniValue MsgProcessStatsToJSON(const mapMsgCmdProcessStats& mapStats)
+{
+    UniValue obj(UniValue::VOBJ);
+    for (const auto& item : mapStats) {
+        const CMsgProcessStats& stats = item.second;
+        UniValue cmd(UniValue::VOBJ);
+        cmd.push_back(Pair("count", stats.nCount));
+        cmd.push_back(Pair("wall_us", stats.nWallMicros));
+        cmd.push_back(Pair("cpu_us", stats.nCPUMicros));
+        cmd.push_back(Pair("lockwait_us", stats.nLockWaitMicros));
+        cmd.push_back(Pair("max_wall_us", stats.nMaxWallMicros));
+        cmd.push_back(Pair("avg_wall_us", stats.nCount ? stats.nWallMicros / (int64_t)stats.nCount : 0));
+        obj.push_back(Pair(item.first, cmd));
+    }
+    return obj;
+}
+
+UniValue getmsgstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getmsgstats ( reset )\n"
+            "\nReturns the time spent processing received messages, per command, in total and per connected peer.\n"
+            "Times are in microseconds. Processing a getdata message includes serving it later on.\n"
+            "\nArguments:\n"
+            "1. reset        (boolean, optional, default=false) Clear the stats after returning them\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"totals\": {             (json object) All peers since startup or the last reset, including disconnected ones\n"
+            "    \"command\": {          (json object) Only commands that were received are listed, unknown ones under \"*other*\"\n"
+            "      \"count\": n,         (numeric) Messages processed\n"
+            "      \"wall_us\": n,       (numeric) Wall clock time spent processing them\n"
+            "      \"cpu_us\": n,        (numeric) CPU time of the message handler thread, 0 where not supported\n"
+            "      \"lockwait_us\": n,   (numeric) Time spent waiting for locks held by other threads, included in wall_us\n"
+            "      \"max_wall_us\": n,   (numeric) Longest time spent on one message\n"
+            "      \"avg_wall_us\": n    (numeric) Average time spent on one message\n"
+            "    },\n"
+            "    ...\n"
+            "  },\n"
+            "  \"peers\": [              (json array) Connected peers\n"
+            "    {\n"
+            "      \"id\": n,            (numeric) Peer index\n"
+            "      \"addr\": \"host:port\", (string) The ip address and port of the peer\n"
+            "      \"commands\": {...}   (json object) Same as totals, for this peer\n"
+            "    },\n"
+            "    ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getmsgstats", "") + HelpExampleCli("getmsgstats", "true") + HelpExampleRpc("getmsgstats", "true"));
+
+    if (!g_connman)
+        throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
+
+    bool fReset = request.params.size() > 0 && request.params[0].get_bool();
+
+    std::vector<CNodeStats> vstats;
+    g_connman->GetNodeStats(vstats);
+
+    UniValue peers(UniValue::VARR);
+    for (const CNodeStats& stats : vstats) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("id", stats.nodeid));
+        obj.push_back(Pair("addr", stats.addrName));
+        obj.push_back(Pair("commands", MsgProcessStatsToJSON(stats.mapProcessStatsPerMsgCmd)));
+        peers.push_back(obj);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("totals", MsgProcessStatsToJSON(g_connman->GetMessageProcessingStats())));
+    ret.push_back(Pair("peers", peers));
+
+    if (fReset)
+        g_connman->ResetMessageProcessingStats();
+
+    return ret;
+}
+
 static const CRPCCommand commands[] =
     {
         //  category              name                      actor (function)         okSafe argNames
@@ -606,6 +829,8 @@ static const CRPCCommand commands[] =
         {"network", "listbanned", &listbanned, true, {}},
         {"network", "clearbanned", &clearbanned, true, {}},
         {"network", "setnetworkactive", &setnetworkactive, true, {"state"}},
+        {"network", "getblockreconstructionstats", &getblockreconstructionstats, true, {}},
+        {"network", "getmsgstats", &getmsgstats, true, {"reset"}},
 };
 
 void RegisterNetRPCCommands(CRPCTable& t)
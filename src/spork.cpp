@@ -17,8 +17,6 @@
 
 const std::string CSporkManager::SERIALIZATION_VERSION_STRING = "CSporkManager-Version-2";
 
-CSporkManager sporkManager;
-
 std::map<int, int64_t> mapSporkDefaults = {
     {SPORK_2_INSTANTSEND_ENABLED, 0},                    // ON
     {SPORK_3_INSTANTSEND_BLOCK_FILTERING, 0},            // ON
@@ -33,6 +31,9 @@ std::map<int, int64_t> mapSporkDefaults = {
     {SPORK_30_ACTIVATE_BDAP, 4070908800ULL},             // OFF
 };
 
+// defined after mapSporkDefaults, the constructor publishes the defaults
+CSporkManager sporkManager;
+
 bool CSporkManager::SporkValueIsActive(int nSporkID, int64_t& nActiveValueRet) const
 {
     LOCK(cs);
@@ -52,11 +53,57 @@ bool CSporkManager::SporkValueIsActive(int nSporkID, int64_t& nActiveValueRet) c
     return false;
 }
 
+static std::shared_ptr<CSporkValues> MakeDefaultSporkValues()
+{
+    std::shared_ptr<CSporkValues> pValues = std::make_shared<CSporkValues>();
+    for (const auto& pair : mapSporkDefaults) {
+        if (pair.first >= SPORK_START && pair.first <= SPORK_END) {
+            pValues->vValues[pair.first - SPORK_START] = pair.second;
+            pValues->vKnown[pair.first - SPORK_START] = true;
+        }
+    }
+    return pValues;
+}
+
+CSporkManager::CSporkManager() : nMinSporkKeys(0)
+{
+    // nothing is signed yet, start from the defaults without taking cs during static init
+    pSporkValues = MakeDefaultSporkValues();
+}
+
+void CSporkManager::UpdateSporkValues()
+{
+    LOCK(cs);
+    std::shared_ptr<CSporkValues> pValues = MakeDefaultSporkValues();
+    for (int nSporkID = SPORK_START; nSporkID <= SPORK_END; nSporkID++) {
+        int64_t nValue = -1;
+        if (SporkValueIsActive(nSporkID, nValue)) {
+            pValues->vValues[nSporkID - SPORK_START] = nValue;
+            pValues->vKnown[nSporkID - SPORK_START] = true;
+        }
+    }
+    std::atomic_store(&pSporkValues, std::shared_ptr<const CSporkValues>(pValues));
+}
+
+bool CSporkManager::GetSporkValueFromSnapshot(int nSporkID, int64_t& nValueRet) const
+{
+    if (nSporkID < SPORK_START || nSporkID > SPORK_END)
+        return false;
+
+    std::shared_ptr<const CSporkValues> pValues = std::atomic_load(&pSporkValues);
+    if (!pValues->vKnown[nSporkID - SPORK_START])
+        return false;
+
+    nValueRet = pValues->vValues[nSporkID - SPORK_START];
+    return true;
+}
+
 void CSporkManager::Clear()
 {
     LOCK(cs);
     mapSporksActive.clear();
     mapSporksByHash.clear();
+    UpdateSporkValues();
     // sporkPubKeyID and sporkPrivKey should be set in init.cpp,
     // we should not alter them here.
 }
@@ -106,6 +153,8 @@ void CSporkManager::CheckAndRemove()
         }
         ++itByHash;
     }
+
+    UpdateSporkValues();
 }
 
 void CSporkManager::ProcessSpork(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, CConnman& connman)
@@ -164,6 +213,7 @@ void CSporkManager::ProcessSpork(CNode* pfrom, const std::string& strCommand, CD
             LOCK(cs); // make sure to not lock this together with cs_main
             mapSporksByHash[hash] = spork;
             mapSporksActive[spork.nSporkID][keyIDSigner] = spork;
+            UpdateSporkValues();
         }
         spork.Relay(connman);
 
@@ -226,6 +276,7 @@ bool CSporkManager::UpdateSpork(int nSporkID, int64_t nValue, CConnman& connman)
         LOCK(cs);
         mapSporksByHash[spork.GetHash()] = spork;
         mapSporksActive[nSporkID][keyIDSigner] = spork;
+        UpdateSporkValues();
         return true;
     }
 
@@ -234,32 +285,22 @@ bool CSporkManager::UpdateSpork(int nSporkID, int64_t nValue, CConnman& connman)
 
 bool CSporkManager::IsSporkActive(int nSporkID)
 {
-    LOCK(cs);
     int64_t nSporkValue = -1;
-
-    if (SporkValueIsActive(nSporkID, nSporkValue)) {
+    if (GetSporkValueFromSnapshot(nSporkID, nSporkValue)) {
         return nSporkValue < GetAdjustedTime();
     }
 
-    if (mapSporkDefaults.count(nSporkID)) {
-        return mapSporkDefaults[nSporkID] < GetAdjustedTime();
-    }
     LogPrint("spork", "CSporkManager::IsSporkActive -- Unknown Spork ID %d\n", nSporkID);
     return false;
 }
 
 int64_t CSporkManager::GetSporkValue(int nSporkID)
 {
-    LOCK(cs);
     int64_t nSporkValue = -1;
-    if (SporkValueIsActive(nSporkID, nSporkValue)) {
+    if (GetSporkValueFromSnapshot(nSporkID, nSporkValue)) {
         return nSporkValue;
     }
 
-    if (mapSporkDefaults.count(nSporkID)) {
-        return mapSporkDefaults[nSporkID];
-    }
-
     LogPrint("spork", "CSporkManager::GetSporkValue -- Unknown Spork ID %d\n", nSporkID);
     return -1;
 }
@@ -357,7 +398,11 @@ bool CSporkManager::SetMinSporkKeys(int minSporkKeys)
         LogPrintf("CSporkManager::SetMinSporkKeys -- Invalid min spork signers number: %d\n", minSporkKeys);
         return false;
     }
-    nMinSporkKeys = minSporkKeys;
+    {
+        LOCK(cs);
+        nMinSporkKeys = minSporkKeys;
+        UpdateSporkValues();
+    }
     return true;
 }
 
@@ -11,6 +11,9 @@
 #include "net.h"
 #include "utilstrencodings.h"
 
+#include <array>
+#include <memory>
+
 class CSporkManager;
 class CSporkMessage;
 
@@ -33,6 +36,7 @@ static const int SPORK_30_ACTIVATE_BDAP = 10030;
 
 static const int SPORK_START = SPORK_2_INSTANTSEND_ENABLED;
 static const int SPORK_END = SPORK_30_ACTIVATE_BDAP;
+static const int SPORK_COUNT = SPORK_END - SPORK_START + 1;
 
 extern std::map<int, int64_t> mapSporkDefaults;
 extern CSporkManager sporkManager;
@@ -127,6 +131,21 @@ public:
     void Relay(CConnman& connman);
 };
 
+/**
+ * CSporkValues is an immutable view of the value in effect for every spork
+ * ID, either the value agreed upon by the spork signers or the default.
+ */
+struct CSporkValues {
+    std::array<int64_t, SPORK_COUNT> vValues;
+    std::array<bool, SPORK_COUNT> vKnown;
+
+    CSporkValues()
+    {
+        vValues.fill(-1);
+        vKnown.fill(false);
+    }
+};
+
 /**
  * CSporkManager is a higher-level class which manages the node's spork
  * messages, rules for which sporks should be considered active/inactive, and
@@ -145,14 +164,32 @@ private:
     int nMinSporkKeys;
     CKey sporkPrivKey;
 
+    /**
+     * Spork values read by IsSporkActive and GetSporkValue without taking cs.
+     * Only ever replaced as a whole by UpdateSporkValues, use std::atomic_load
+     * and std::atomic_store to access it.
+     */
+    std::shared_ptr<const CSporkValues> pSporkValues;
+
     /**
      * SporkValueIsActive is used to get the value agreed upon by the majority
      * of signed spork messages for a given Spork ID.
      */
     bool SporkValueIsActive(int nSporkID, int64_t& nActiveValueRet) const;
 
+    /**
+     * UpdateSporkValues recalculates the published spork values, it must be
+     * called whenever the active spork messages or the signer threshold change.
+     */
+    void UpdateSporkValues();
+
+    /**
+     * GetSporkValueFromSnapshot looks up a spork ID in the published values.
+     */
+    bool GetSporkValueFromSnapshot(int nSporkID, int64_t& nValueRet) const;
+
 public:
-    CSporkManager() {}
+    CSporkManager();
 
     ADD_SERIALIZE_METHODS;
     template <typename Stream, typename Operation>
@@ -174,6 +211,9 @@ public:
         READWRITE(mapSporksByHash);
         READWRITE(mapSporksActive);
         // we don't serialize private key to prevent its leakage
+        if (ser_action.ForRead()) {
+            UpdateSporkValues();
+        }
     }
 
     /**
@@ -224,12 +264,16 @@ public:
      * value should not be considered a timestamp, but an integer value
      * instead, and therefore this method doesn't make sense and should not be
      * used.
+     *
+     * Reads the published spork values and never blocks on cs.
      */
     bool IsSporkActive(int nSporkID);
 
     /**
      * GetSporkValue returns the spork value given a Spork ID. If no active spork
      * message has yet been received by the node, it returns the default value.
+     *
+     * Reads the published spork values and never blocks on cs.
      */
     int64_t GetSporkValue(int nSporkID);
 
@@ -203,6 +203,12 @@ public:
         vch.clear();
         nReadPos = 0;
     }
+    // Exchange the underlying buffer, keeps the allocation of both sides
+    void SwapBuffer(vector_type& vchOther)
+    {
+        vch.swap(vchOther);
+        nReadPos = 0;
+    }
     iterator insert(iterator it, const char& x = char()) { return vch.insert(it, x); }
     void insert(iterator it, size_type n, const char& x) { vch.insert(it, n, x); }
     value_type* data() { return vch.data() + nReadPos; }
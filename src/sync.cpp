@@ -26,6 +26,18 @@ void PrintLockContention(const char* pszName, const char* pszFile, int nLine)
 }
 #endif /* DEBUG_LOCKCONTENTION */
 
+static thread_local int64_t g_nLockWaitMicros = 0;
+
+int64_t GetThreadLockWaitMicros()
+{
+    return g_nLockWaitMicros;
+}
+
+void AddThreadLockWait(int64_t nMicros)
+{
+    g_nLockWaitMicros += nMicros;
+}
+
 #ifdef DEBUG_LOCKORDER
 //
 // Early deadlock detection.
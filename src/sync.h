@@ -8,6 +8,7 @@
 #define DYNAMIC_SYNC_H
 
 #include <threadsafety.h>
+#include <utiltime.h>
 
 #include <condition_variable>
 #include <thread>
@@ -114,6 +115,10 @@ typedef AnnotatedMixin<std::mutex> Mutex;
 void PrintLockContention(const char* pszName, const char* pszFile, int nLine);
 #endif
 
+/** Time in microseconds the calling thread has spent waiting for contended locks */
+int64_t GetThreadLockWaitMicros();
+void AddThreadLockWait(int64_t nMicros);
+
 /** Wrapper around std::unique_lock style lock for Mutex. */
 template <typename Mutex, typename Base = typename Mutex::UniqueLock>
 class SCOPED_LOCKABLE UniqueLock : public Base
@@ -122,14 +127,14 @@ private:
     void Enter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(Base::mutex()));
-#ifdef DEBUG_LOCKCONTENTION
         if (!Base::try_lock()) {
+#ifdef DEBUG_LOCKCONTENTION
             PrintLockContention(pszName, pszFile, nLine);
 #endif
+            int64_t nWaitStart = GetTimeMicros();
             Base::lock();
-#ifdef DEBUG_LOCKCONTENTION
+            AddThreadLockWait(GetTimeMicros() - nWaitStart);
         }
-#endif
     }
 
     bool TryEnter(const char* pszName, const char* pszFile, int nLine)
@@ -314,6 +314,51 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+class TestTxSource : public CCompactBlockTxSource
+{
+public:
+    std::vector<CTransactionRef> vtx;
+    std::string GetName() const override { return "test"; }
+    void ForEachTx(const std::function<bool(const CTransactionRef&)>& fn) const override
+    {
+        for (const CTransactionRef& tx : vtx) {
+            if (!fn(tx))
+                return;
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE(ExtraSourcesRoundTripTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    CBlock block(BuildBlockTestCase());
+
+    // one transaction in the extra pool, one in a source and an unrelated one before it
+    std::vector<std::pair<uint256, CTransactionRef>> extra(2);
+    extra[1] = std::make_pair(block.vtx[1]->GetHash(), block.vtx[1]);
+    TestTxSource source;
+    CMutableTransaction unrelated;
+    unrelated.vout.resize(1);
+    source.vtx.push_back(MakeTransactionRef(unrelated));
+    source.vtx.push_back(block.vtx[2]);
+
+    CBlockHeaderAndShortTxIDs shortIDs(block);
+    PartiallyDownloadedBlock partialBlock(&pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs, extra, {&source}) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.IsTxAvailable(1));
+    BOOST_CHECK(partialBlock.IsTxAvailable(2));
+    BOOST_CHECK_EQUAL(partialBlock.GetPrefilledCount(), 1U);
+    BOOST_CHECK_EQUAL(partialBlock.GetFoundCount(), 2U);
+    BOOST_CHECK_EQUAL(partialBlock.GetExtraCount(), 1U);
+    BOOST_REQUIRE_EQUAL(partialBlock.GetSourceCounts().size(), 1U);
+    BOOST_CHECK_EQUAL(partialBlock.GetSourceCounts()[0], 1U);
+
+    CBlock block2;
+    std::vector<CTransactionRef> vtx_missing;
+    BOOST_CHECK(partialBlock.FillBlock(block2, vtx_missing) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = GetRandHash();
@@ -326,4 +326,106 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
 
 
 
+BOOST_AUTO_TEST_CASE(staged_dbwrapper)
+{
+    // Perform tests both obfuscated and non-obfuscated.
+    for (int i = 0; i < 2; i++) {
+        bool obfuscate = (bool)i;
+        path ph = temp_directory_path() / unique_path();
+        CStagedDBWrapper dbw(ph, (1 << 20), true, false, obfuscate);
+
+        char key = 'i';
+        uint256 in = GetRandHash();
+        char key2 = 'j';
+        uint256 in2 = GetRandHash();
+        uint256 res;
+
+        // Staged values are visible before they are committed
+        BOOST_CHECK(dbw.Write(key, in));
+        BOOST_CHECK(dbw.Write(key2, in2));
+        BOOST_CHECK(dbw.HasStaged());
+        BOOST_CHECK(dbw.Read(key, res));
+        BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+        BOOST_CHECK(!dbw.CDBWrapper::Exists(key));
+
+        BOOST_CHECK(dbw.CommitStaged());
+        BOOST_CHECK(!dbw.HasStaged());
+        BOOST_CHECK(dbw.CDBWrapper::Read(key, res));
+        BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+
+        // A staged erase hides the committed value until it is committed too
+        BOOST_CHECK(dbw.Erase(key2));
+        BOOST_CHECK(!dbw.Exists(key2));
+        BOOST_CHECK(dbw.CDBWrapper::Exists(key2));
+        BOOST_CHECK(dbw.CommitStaged());
+        BOOST_CHECK(!dbw.CDBWrapper::Exists(key2));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(staged_dbwrapper_block_scope)
+{
+    path ph = temp_directory_path() / unique_path();
+    CStagedDBWrapper dbw(ph, (1 << 20), true, false, false);
+
+    char key = 'i';
+    uint256 in = GetRandHash();
+    char key2 = 'j';
+    uint256 in2 = GetRandHash();
+    uint256 res;
+
+    // Dropped block scope leaves nothing behind
+    dbw.BeginBlockScope();
+    BOOST_CHECK(dbw.Write(key, in));
+    BOOST_CHECK(dbw.Exists(key));
+    dbw.EndBlockScope(false);
+    BOOST_CHECK(!dbw.Exists(key));
+    BOOST_CHECK(!dbw.HasStaged());
+    BOOST_CHECK_EQUAL(dbw.DynamicMemoryUsage(), 0U);
+
+    // Kept block scope overrides earlier staged changes
+    BOOST_CHECK(dbw.Write(key, in2));
+    dbw.BeginBlockScope();
+    BOOST_CHECK(dbw.Write(key, in));
+    BOOST_CHECK(dbw.Write(key2, in2));
+    dbw.EndBlockScope(true);
+    BOOST_CHECK(dbw.CommitStaged());
+    BOOST_CHECK(dbw.Read(key, res));
+    BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+    BOOST_CHECK(dbw.Read(key2, res));
+    BOOST_CHECK_EQUAL(res.ToString(), in2.ToString());
+    BOOST_CHECK_EQUAL(dbw.DynamicMemoryUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(staged_dbwrapper_iterator)
+{
+    path ph = temp_directory_path() / unique_path();
+    CStagedDBWrapper dbw(ph, (1 << 20), true, false, false);
+
+    // Committed: b, d, f. Staged: a, c, overwrite d, erase f.
+    for (char key : {'b', 'd', 'f'})
+        BOOST_CHECK(dbw.Write(key, (uint32_t)key));
+    BOOST_CHECK(dbw.CommitStaged());
+    BOOST_CHECK(dbw.Write('a', (uint32_t)'a'));
+    BOOST_CHECK(dbw.Write('c', (uint32_t)'c'));
+    BOOST_CHECK(dbw.Write('d', (uint32_t)'D'));
+    BOOST_CHECK(dbw.Erase('f'));
+
+    const std::vector<std::pair<char, uint32_t> > expected = {{'a', 'a'}, {'b', 'b'}, {'c', 'c'}, {'d', 'D'}};
+    std::unique_ptr<CDBIterator> it(dbw.NewIterator());
+    it->Seek('a');
+    for (const auto& exp : expected) {
+        char key_res;
+        uint32_t val_res;
+        BOOST_CHECK(it->Valid());
+        if (!it->Valid())
+            break;
+        BOOST_CHECK(it->GetKey(key_res));
+        BOOST_CHECK(it->GetValue(val_res));
+        BOOST_CHECK_EQUAL(key_res, exp.first);
+        BOOST_CHECK_EQUAL(val_res, exp.second);
+        it->Next();
+    }
+    BOOST_CHECK(!it->Valid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
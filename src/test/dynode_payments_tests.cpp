@@ -0,0 +1,87 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "dynode-payments.h"
+#include "streams.h"
+#include "version.h"
+
+#include "test/test_dynamic.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(dynode_payments_tests, BasicTestingSetup)
+
+static CScript PayeeScript(unsigned char n)
+{
+    return CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, n) << OP_EQUALVERIFY << OP_CHECKSIG;
+}
+
+static CDynodePaymentVote Vote(unsigned char nVoter, const CScript& payee)
+{
+    return CDynodePaymentVote(COutPoint(uint256S(strprintf("%02x", nVoter)), 0), 1000, payee);
+}
+
+BOOST_AUTO_TEST_CASE(block_payees_best_payee)
+{
+    CDynodeBlockPayees payees(1000);
+    CScript payeeA = PayeeScript(1);
+    CScript payeeB = PayeeScript(2);
+    CScript payee;
+
+    BOOST_CHECK(!payees.GetBestPayee(payee));
+    BOOST_CHECK_EQUAL(payees.GetBestPayeeVoteCount(), 0);
+
+    payees.AddPayee(Vote(1, payeeA));
+    payees.AddPayee(Vote(2, payeeB));
+    // a tie goes to the payee that was voted for first
+    BOOST_CHECK(payees.GetBestPayee(payee));
+    BOOST_CHECK(payee == payeeA);
+
+    payees.AddPayee(Vote(3, payeeB));
+    BOOST_CHECK(payees.GetBestPayee(payee));
+    BOOST_CHECK(payee == payeeB);
+    BOOST_CHECK_EQUAL(payees.GetBestPayeeVoteCount(), 2);
+
+    payees.AddPayee(Vote(4, payeeA));
+    BOOST_CHECK(payees.GetBestPayee(payee));
+    BOOST_CHECK(payee == payeeA);
+
+    BOOST_CHECK(payees.HasPayeeWithVotes(payeeA, 2));
+    BOOST_CHECK(!payees.HasPayeeWithVotes(payeeA, 3));
+    BOOST_CHECK(!payees.HasPayeeWithVotes(PayeeScript(3), 1));
+
+    BOOST_CHECK(payees.GetVoterPayee(Vote(3, payeeB).dynodeOutpoint, payee));
+    BOOST_CHECK(payee == payeeB);
+    BOOST_CHECK(payees.HasAllVoters());
+}
+
+BOOST_AUTO_TEST_CASE(block_payees_serialization)
+{
+    CDynodeBlockPayees payees(1000);
+    CScript payeeA = PayeeScript(1);
+    CScript payeeB = PayeeScript(2);
+    payees.AddPayee(Vote(1, payeeA));
+    payees.AddPayee(Vote(2, payeeB));
+    payees.AddPayee(Vote(3, payeeB));
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << payees;
+    CDynodeBlockPayees payeesRead;
+    ss >> payeesRead;
+
+    CScript payee;
+    BOOST_CHECK(payeesRead.GetBestPayee(payee));
+    BOOST_CHECK(payee == payeeB);
+    BOOST_CHECK(payeesRead.HasPayeeWithVotes(payeeB, 2));
+    // voters are not part of the serialized form
+    BOOST_CHECK(!payeesRead.HasAllVoters());
+    BOOST_CHECK(!payeesRead.GetVoterPayee(Vote(1, payeeA).dynodeOutpoint, payee));
+
+    payeesRead.AddPayee(Vote(4, payeeA));
+    payeesRead.AddPayee(Vote(5, payeeA));
+    BOOST_CHECK(payeesRead.GetBestPayee(payee));
+    BOOST_CHECK(payee == payeeA);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
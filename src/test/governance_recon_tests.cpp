@@ -0,0 +1,95 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "governance-recon.h"
+#include "random.h"
+#include "streams.h"
+#include "version.h"
+
+#include "test/test_dynamic.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(governance_recon_tests, BasicTestingSetup)
+
+static std::vector<uint256> RandomHashes(size_t nCount)
+{
+    std::vector<uint256> vecHashes;
+    for (size_t i = 0; i < nCount; ++i) {
+        vecHashes.push_back(GetRandHash());
+    }
+    return vecHashes;
+}
+
+BOOST_AUTO_TEST_CASE(recon_bucket_count)
+{
+    BOOST_CHECK_EQUAL(CGovernanceReconRequest::GetBucketCount(0), 1U);
+    BOOST_CHECK_EQUAL(CGovernanceReconRequest::GetBucketCount(1), 1U);
+    BOOST_CHECK_EQUAL(CGovernanceReconRequest::GetBucketCount(GOVERNANCE_RECON_VOTES_PER_BUCKET), 1U);
+    BOOST_CHECK_EQUAL(CGovernanceReconRequest::GetBucketCount(GOVERNANCE_RECON_VOTES_PER_BUCKET + 1), 2U);
+    BOOST_CHECK_EQUAL(CGovernanceReconRequest::GetBucketCount(100 * GOVERNANCE_RECON_VOTES_PER_BUCKET * GOVERNANCE_RECON_MAX_BUCKETS), GOVERNANCE_RECON_MAX_BUCKETS);
+}
+
+BOOST_AUTO_TEST_CASE(recon_same_votes)
+{
+    std::vector<uint256> vecVotes = RandomHashes(1000);
+
+    CGovernanceReconRequest request;
+    request.InitKeys();
+    request.AddObject(GetRandHash(), vecVotes);
+    BOOST_CHECK(request.vecSketches[0].IsValid());
+
+    // order doesn't matter
+    std::reverse(vecVotes.begin(), vecVotes.end());
+    std::vector<bool> vecDiffer = request.GetDifferingBuckets(request.vecSketches[0], vecVotes);
+    BOOST_CHECK_EQUAL(vecDiffer.size(), request.vecSketches[0].vecBucketDigests.size());
+    BOOST_CHECK(std::find(vecDiffer.begin(), vecDiffer.end(), true) == vecDiffer.end());
+}
+
+BOOST_AUTO_TEST_CASE(recon_missing_votes)
+{
+    std::vector<uint256> vecPeerVotes = RandomHashes(2000);
+    std::vector<uint256> vecOurVotes(vecPeerVotes.begin() + 10, vecPeerVotes.end());
+
+    CGovernanceReconRequest request;
+    request.InitKeys();
+    request.AddObject(GetRandHash(), vecOurVotes);
+
+    // round trip over the wire
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << request;
+    CGovernanceReconRequest received;
+    ss >> received;
+    BOOST_CHECK_EQUAL(received.nKey0, request.nKey0);
+    BOOST_CHECK_EQUAL(received.nKey1, request.nKey1);
+    BOOST_REQUIRE_EQUAL(received.vecSketches.size(), 1U);
+
+    const CGovernanceReconSketch& sketch = received.vecSketches[0];
+    std::vector<bool> vecDiffer = received.GetDifferingBuckets(sketch, vecPeerVotes);
+
+    std::set<uint256> setSent;
+    for (const auto& nHash : vecPeerVotes) {
+        if (vecDiffer[received.GetBucket(sketch, nHash)]) {
+            setSent.insert(nHash);
+        }
+    }
+
+    // every missing vote is sent, along with at most a few buckets worth of votes we already have
+    for (size_t i = 0; i < 10; ++i) {
+        BOOST_CHECK(setSent.count(vecPeerVotes[i]));
+    }
+    BOOST_CHECK(setSent.size() < 10 * 4 * GOVERNANCE_RECON_VOTES_PER_BUCKET);
+}
+
+BOOST_AUTO_TEST_CASE(recon_invalid_sketch)
+{
+    CGovernanceReconSketch sketch;
+    BOOST_CHECK(!sketch.IsValid());
+    sketch.vecBucketDigests.resize(GOVERNANCE_RECON_MAX_BUCKETS + 1);
+    BOOST_CHECK(!sketch.IsValid());
+    sketch.vecBucketDigests.resize(GOVERNANCE_RECON_MAX_BUCKETS);
+    BOOST_CHECK(sketch.IsValid());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,213 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "arith_uint256.h"
+#include "chainparams.h"
+#include "header-ranges.h"
+#include "validation.h"
+
+#include "test/test_dynamic.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(header_ranges_tests, BasicTestingSetup)
+
+// Headers linked to hashStart, with made up hashes that meet the proof of work limit
+static void MakeHeaders(const uint256& hashStart, size_t nCount, std::vector<CBlockHeader>& headers, std::vector<uint256>& vHashes)
+{
+    unsigned int nBits = UintToArith256(Params().GetConsensus().powLimit).GetCompact();
+    uint256 hashPrev = hashStart;
+    for (size_t i = 0; i < nCount; i++) {
+        CBlockHeader header;
+        header.hashPrevBlock = hashPrev;
+        header.nBits = nBits;
+        headers.push_back(header);
+        vHashes.push_back(ArithToUint256(arith_uint256(i + 1)));
+        hashPrev = vHashes.back();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(header_ranges_init)
+{
+    MapCheckpoints mapCheckpoints;
+    mapCheckpoints[0] = uint256S("0x10");
+    mapCheckpoints[200] = uint256S("0x11");
+    mapCheckpoints[1000] = uint256S("0x12");
+    mapCheckpoints[4000] = uint256S("0x13");
+    mapCheckpoints[10000] = uint256S("0x14");
+    mapCheckpoints[11000] = uint256S("0x15");
+
+    CHeaderRangeSync ranges;
+    ranges.Init(mapCheckpoints, 0);
+    BOOST_CHECK(ranges.IsInitialized());
+    BOOST_CHECK(ranges.IsActive());
+
+    // the close checkpoints are merged, so is the short stretch at the end
+    const CHeaderRange* range = ranges.Assign(1, 20000, 0);
+    BOOST_REQUIRE(range);
+    BOOST_CHECK_EQUAL(range->nStartHeight, 200);
+    BOOST_CHECK(range->hashStart == uint256S("0x11"));
+    BOOST_CHECK_EQUAL(range->nEndHeight, 4000);
+
+    // a peer gets one range at a time, and only one its chain reaches the end of
+    BOOST_CHECK(!ranges.Assign(1, 20000, 0));
+    BOOST_CHECK(!ranges.Assign(2, 10000, 0));
+    range = ranges.Assign(2, 11000, 0);
+    BOOST_REQUIRE(range);
+    BOOST_CHECK_EQUAL(range->nStartHeight, 4000);
+    BOOST_CHECK_EQUAL(range->nEndHeight, 11000);
+    BOOST_CHECK(!ranges.Assign(3, 20000, 0));
+
+    BOOST_CHECK(ranges.IsDownloadingAfter(uint256S("0x13")));
+    ranges.Release(2);
+    BOOST_CHECK(!ranges.IsDownloadingAfter(uint256S("0x13")));
+    BOOST_CHECK(ranges.Assign(3, 20000, 0));
+
+    // nothing to do once the best header is past the last checkpoint
+    CHeaderRangeSync done;
+    done.Init(mapCheckpoints, 11000);
+    BOOST_CHECK(done.IsInitialized());
+    BOOST_CHECK(!done.IsActive());
+}
+
+BOOST_AUTO_TEST_CASE(header_ranges_download)
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    uint256 hashStart = uint256S("0xabcdef");
+
+    std::vector<CBlockHeader> headers;
+    std::vector<uint256> vHashes;
+    MakeHeaders(hashStart, 2 * MAX_HEADERS_RESULTS, headers, vHashes);
+
+    MapCheckpoints mapCheckpoints;
+    mapCheckpoints[10] = hashStart;
+    mapCheckpoints[10 + 2 * MAX_HEADERS_RESULTS] = vHashes.back();
+
+    CHeaderRangeSync ranges;
+    ranges.Init(mapCheckpoints, 0);
+    BOOST_REQUIRE(ranges.Assign(1, 1000000, 0));
+    BOOST_CHECK(ranges.IsRangeReply(1, hashStart));
+    BOOST_CHECK(!ranges.IsRangeReply(2, hashStart));
+
+    int nDoS = 0;
+    std::string strError;
+    std::vector<CBlockHeader> batch(headers.begin(), headers.begin() + MAX_HEADERS_RESULTS);
+    std::vector<uint256> vBatchHashes(vHashes.begin(), vHashes.begin() + MAX_HEADERS_RESULTS);
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(1, batch, vBatchHashes, consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_CONTINUE);
+    BOOST_CHECK(ranges.IsRangeReply(1, vBatchHashes.back()));
+
+    // nothing connects while the start of the range is unknown
+    std::vector<CBlockHeader> connect;
+    std::vector<uint256> vConnectHashes;
+    NodeId nodeidSource = -1;
+    auto fnStartKnown = [&](const uint256& hash) { return hash == hashStart; };
+    BOOST_CHECK(!ranges.PopConnectable([](const uint256&) { return false; }, connect, vConnectHashes, nodeidSource));
+
+    // the verified part connects once the start is known, the rest of the range is still downloaded
+    BOOST_CHECK(ranges.PopConnectable(fnStartKnown, connect, vConnectHashes, nodeidSource));
+    BOOST_CHECK_EQUAL(nodeidSource, 1);
+    BOOST_CHECK_EQUAL(connect.size(), MAX_HEADERS_RESULTS);
+    BOOST_CHECK(vConnectHashes == vBatchHashes);
+    BOOST_CHECK(ranges.IsActive());
+    BOOST_CHECK(ranges.IsDownloadingAfter(vBatchHashes.back()));
+
+    batch.assign(headers.begin() + MAX_HEADERS_RESULTS, headers.end());
+    vBatchHashes.assign(vHashes.begin() + MAX_HEADERS_RESULTS, vHashes.end());
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(1, batch, vBatchHashes, consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_DONE);
+
+    const uint256 hashConnected = vConnectHashes.back();
+    BOOST_CHECK(ranges.PopConnectable([&](const uint256& hash) { return hash == hashConnected; }, connect, vConnectHashes, nodeidSource));
+    BOOST_CHECK_EQUAL(connect.size(), MAX_HEADERS_RESULTS);
+    BOOST_CHECK(vConnectHashes.back() == vHashes.back());
+    BOOST_CHECK(!ranges.IsActive());
+}
+
+BOOST_AUTO_TEST_CASE(header_ranges_invalid)
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    uint256 hashStart = uint256S("0xabcdef");
+
+    std::vector<CBlockHeader> headers;
+    std::vector<uint256> vHashes;
+    MakeHeaders(hashStart, 3000, headers, vHashes);
+
+    MapCheckpoints mapCheckpoints;
+    mapCheckpoints[10] = hashStart;
+    mapCheckpoints[3010] = uint256S("0x1234"); // doesn't match the headers
+
+    CHeaderRangeSync ranges;
+    ranges.Init(mapCheckpoints, 0);
+    int nDoS = 0;
+    std::string strError;
+
+    // broken link
+    BOOST_REQUIRE(ranges.Assign(1, 1000000, 0));
+    std::vector<CBlockHeader> broken(headers.begin(), headers.begin() + 5);
+    broken[3].hashPrevBlock = uint256();
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(1, broken, std::vector<uint256>(vHashes.begin(), vHashes.begin() + 5), consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_FAILED);
+    BOOST_CHECK_EQUAL(nDoS, 20);
+    BOOST_CHECK(!ranges.GetRange(1));
+
+    // the peer ran out of headers, not its fault
+    BOOST_REQUIRE(ranges.Assign(2, 1000000, 0));
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(2, std::vector<CBlockHeader>(headers.begin(), headers.begin() + 5), std::vector<uint256>(vHashes.begin(), vHashes.begin() + 5), consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_FAILED);
+    BOOST_CHECK_EQUAL(nDoS, 0);
+
+    // the headers it sent don't reach the checkpoint, the next peer starts over
+    BOOST_REQUIRE(ranges.Assign(3, 1000000, 0));
+    BOOST_CHECK(ranges.IsRangeReply(3, hashStart));
+    BOOST_CHECK(!ranges.IsRangeReply(3, vHashes[4]));
+    BOOST_CHECK(ranges.GetRange(3)->vHeaders.empty());
+
+    // a peer that times out loses what it sent as well
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(3, std::vector<CBlockHeader>(headers.begin(), headers.begin() + MAX_HEADERS_RESULTS), std::vector<uint256>(vHashes.begin(), vHashes.begin() + MAX_HEADERS_RESULTS), consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_CONTINUE);
+    ranges.Release(3);
+    BOOST_REQUIRE(ranges.Assign(4, 1000000, 0));
+    BOOST_CHECK(ranges.IsRangeReply(4, hashStart));
+
+    // the checkpoint doesn't match
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(4, headers, vHashes, consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_FAILED);
+    BOOST_CHECK_EQUAL(nDoS, 100);
+    BOOST_REQUIRE(ranges.Assign(5, 1000000, 0));
+    BOOST_CHECK(ranges.IsRangeReply(5, hashStart));
+}
+
+BOOST_AUTO_TEST_CASE(header_ranges_reset)
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    uint256 hashStart = uint256S("0xabcdef");
+
+    std::vector<CBlockHeader> headers;
+    std::vector<uint256> vHashes;
+    MakeHeaders(hashStart, 2 * MAX_HEADERS_RESULTS, headers, vHashes);
+
+    MapCheckpoints mapCheckpoints;
+    mapCheckpoints[10] = hashStart;
+    mapCheckpoints[10 + 2 * MAX_HEADERS_RESULTS] = vHashes.back();
+
+    CHeaderRangeSync ranges;
+    ranges.Init(mapCheckpoints, 0);
+    BOOST_REQUIRE(ranges.Assign(1, 1000000, 0));
+    int nDoS = 0;
+    std::string strError;
+    BOOST_CHECK_EQUAL(ranges.AddHeaders(1, std::vector<CBlockHeader>(headers.begin(), headers.begin() + MAX_HEADERS_RESULTS), std::vector<uint256>(vHashes.begin(), vHashes.begin() + MAX_HEADERS_RESULTS), consensusParams, nDoS, strError), CHeaderRangeSync::RANGE_CONTINUE);
+
+    std::vector<CBlockHeader> connect;
+    std::vector<uint256> vConnectHashes;
+    NodeId nodeidSource = -1;
+    BOOST_REQUIRE(ranges.PopConnectable([&](const uint256& hash) { return hash == hashStart; }, connect, vConnectHashes, nodeidSource));
+    BOOST_CHECK_EQUAL(nodeidSource, 1);
+    BOOST_CHECK(ranges.IsRangeReply(1, vConnectHashes.back()));
+
+    // the headers failed to connect, the range goes back to where they started and the peer loses it
+    ranges.Reset(connect, vConnectHashes);
+    BOOST_CHECK(!ranges.GetRange(1));
+    const CHeaderRange* range = ranges.Assign(2, 1000000, 0);
+    BOOST_REQUIRE(range);
+    BOOST_CHECK_EQUAL(range->nStartHeight, 10);
+    BOOST_CHECK(range->hashStart == hashStart);
+    BOOST_CHECK(range->vHeaders.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,7 @@
 #include "test/test_dynamic.h"
 
 #include <boost/test/unit_test.hpp>
+#include <limits>
 #include <list>
 #include <vector>
 
@@ -428,6 +429,35 @@ BOOST_AUTO_TEST_CASE(MempoolAncestorIndexingTest)
     CheckSort<ancestor_score>(pool, sortedOrder);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolFreeHeightTest)
+{
+    TestMemPoolEntryHelper entry;
+    entry.nHeight = 100;
+
+    CMutableTransaction tx = CMutableTransaction();
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_11;
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx.vout[0].nValue = 10 * COIN;
+
+    // free from the start
+    CTxMemPoolEntry entryFree = entry.Priority(AllowFreeThreshold() + 1).FromTx(tx);
+    BOOST_CHECK_EQUAL(entryFree.GetFreeHeight(), 100U);
+    BOOST_CHECK(AllowFree(entryFree.GetPriority(100)));
+
+    // free once the coins aged enough, and not a block earlier than one later
+    CTxMemPoolEntry entryAging = entry.Priority(0.0).FromTx(tx);
+    unsigned int nFreeHeight = entryAging.GetFreeHeight();
+    BOOST_CHECK(nFreeHeight > 100 && nFreeHeight < std::numeric_limits<unsigned int>::max());
+    BOOST_CHECK(!AllowFree(entryAging.GetPriority(nFreeHeight - 1)));
+    BOOST_CHECK(AllowFree(entryAging.GetPriority(nFreeHeight + 1)));
+
+    // never free without coins in the chain
+    tx.vout[0].nValue = 0;
+    CTxMemPoolEntry entryNever = entry.FromTx(tx);
+    BOOST_CHECK_EQUAL(entryNever.GetFreeHeight(), std::numeric_limits<unsigned int>::max());
+}
 
 BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
 {
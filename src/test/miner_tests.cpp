@@ -10,6 +10,7 @@
 #include "consensus/validation.h"
 #include "validation.h"
 #include "dynode-payments.h"
+#include "miner/internal/hash-rate-counter.h"
 #include "miner/miner.h"
 #include "pubkey.h"
 #include "script/standard.h"
@@ -419,4 +420,84 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     fCheckpointsEnabled = true;
 }
 
+BOOST_AUTO_TEST_CASE(IncrementExtraNonce_branch)
+{
+    CBlockIndex indexPrev;
+    indexPrev.nHeight = 100;
+
+    // the coinbase branch gives the same root as hashing all transactions, whatever their number
+    for (int nTxs : {1, 2, 7, 16}) {
+        CBlock block;
+        CMutableTransaction txCoinbase;
+        txCoinbase.vin.resize(1);
+        txCoinbase.vin[0].prevout.SetNull();
+        txCoinbase.vout.resize(1);
+        block.vtx.push_back(MakeTransactionRef(txCoinbase));
+        for (int i = 1; i < nTxs; i++) {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].prevout = COutPoint(GetRandHash(), 0);
+            tx.vout.resize(1);
+            block.vtx.push_back(MakeTransactionRef(tx));
+        }
+        std::vector<uint256> vBranch = BlockMerkleBranch(block, 0);
+
+        unsigned int nExtraNonce = 5 * (1 << 22);
+        for (int i = 0; i < 3; i++) {
+            uint256 hashPrevRoot = block.hashMerkleRoot;
+            IncrementExtraNonce(block, &indexPrev, nExtraNonce, vBranch);
+            BOOST_CHECK_EQUAL(nExtraNonce, (unsigned int)(5 * (1 << 22) + i + 1));
+            BOOST_CHECK(block.hashMerkleRoot != hashPrevRoot);
+            BOOST_CHECK(block.hashMerkleRoot == BlockMerkleRoot(block));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(HashRateCounter_windows)
+{
+    HashRateCounterRef root = std::make_shared<HashRateCounter>();
+    HashRateCounterRef group = root->MakeChild();
+    HashRateCounterRef thread0 = group->MakeChild();
+    HashRateCounterRef thread1 = group->MakeChild();
+    thread0->set_device(0);
+    thread1->set_device(1);
+
+    // 15 minutes of 1000 and 3000 hashes per second, in a batch every second
+    const int64_t nStart = 1000 * 1000 * 1000;
+    for (int64_t i = 0; i < 15 * 60; i++) {
+        thread0->Increment(1000, nStart + i * 1000);
+        thread1->Increment(3000, nStart + i * 1000);
+    }
+    int64_t nNow = nStart + 15 * 60 * 1000;
+    HashRates rates = root->GetRates(nNow);
+    BOOST_CHECK_EQUAL(rates.last_1m, 4000);
+    BOOST_CHECK_EQUAL(rates.last_5m, 4000);
+    BOOST_CHECK_EQUAL(rates.last_15m, 4000);
+    std::map<int, HashRates> devices = group->GetDeviceRates(nNow);
+    BOOST_CHECK_EQUAL(devices.size(), 2U);
+    BOOST_CHECK_EQUAL(devices[0].last_5m, 1000);
+    BOOST_CHECK_EQUAL(devices[1].last_5m, 3000);
+
+    // a stopped thread is still counted until its hashes leave the windows
+    thread1.reset();
+    BOOST_CHECK_EQUAL(root->GetRates(nNow).last_1m, 4000);
+    nNow += 5 * 60 * 1000;
+    rates = root->GetRates(nNow);
+    BOOST_CHECK_EQUAL(rates.last_1m, 0);
+    BOOST_CHECK_EQUAL(rates.last_5m, 0);
+    BOOST_CHECK_EQUAL(rates.last_15m, 595LL * 4000 * 1000 / 895000);
+    BOOST_CHECK_EQUAL(group->GetDeviceRates(nNow)[1].last_15m, 595LL * 3000 * 1000 / 895000);
+
+    // after a reset the windows start with the first hashes
+    group->Reset();
+    BOOST_CHECK_EQUAL(root->GetRates(nNow).last_15m, 0);
+    BOOST_CHECK(group->GetDeviceRates(nNow).empty());
+    for (int64_t i = 0; i < 10; i++) {
+        thread0->Increment(2000, nNow + i * 1000);
+    }
+    rates = root->GetRates(nNow + 10 * 1000);
+    BOOST_CHECK_EQUAL(rates.last_1m, 2000);
+    BOOST_CHECK_EQUAL(rates.last_15m, 2000);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,9 +1,13 @@
 // Copyright (c) 2012-2016 The Bitcoin Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "addrdb.h"
 #include "addrman.h"
 #include "test/test_dynamic.h"
+#include <atomic>
 #include <string>
+#include <thread>
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include "hash.h"
 #include "serialize.h"
@@ -148,6 +152,122 @@ BOOST_AUTO_TEST_CASE(caddrdb_read_corrupted)
     BOOST_CHECK(addrman2.size() == 0);
 }
 
+class CAddrManJournalTest : public CAddrMan
+{
+public:
+    using CAddrMan::Find;
+};
+
+// Uses TestingSetup for its temporary data directory
+BOOST_FIXTURE_TEST_CASE(caddrdb_journal, TestingSetup)
+{
+    CService source, addr1, addr2;
+    Lookup("252.5.1.1", source, 8333, false);
+    Lookup("250.7.1.1", addr1, 8333, false);
+    Lookup("250.7.2.2", addr2, 33300, false);
+
+    CAddrManJournalTest addrman;
+    addrman.Add(CAddress(addr1, NODE_NONE), source);
+    CAddrDB adb;
+    BOOST_CHECK(adb.NeedsCompaction()); // no snapshot yet
+    BOOST_CHECK(adb.Write(addrman));
+    BOOST_CHECK(!adb.NeedsCompaction());
+
+    // changes after the snapshot are journaled and replayed on top of it
+    addrman.SetRecordChanges(true);
+    addrman.Add(CAddress(addr2, NODE_NONE), source);
+    addrman.Good(addr2);
+    std::vector<CAddrManChange> vChanges = addrman.TakeChanges();
+    BOOST_CHECK_EQUAL(vChanges.size(), 2U);
+    BOOST_CHECK(addrman.TakeChanges().empty());
+    BOOST_CHECK(adb.AppendChanges(vChanges));
+
+    CAddrMan addrman2;
+    BOOST_CHECK(adb.Read(addrman2));
+    BOOST_CHECK_EQUAL(addrman2.size(), 2U);
+
+    // attempts, connections and services are journaled too
+    addrman.Attempt(addr1, true, 1000);
+    addrman.Connected(addr2, GetAdjustedTime() + 60 * 60);
+    addrman.SetServices(addr2, NODE_NETWORK);
+    vChanges = addrman.TakeChanges();
+    BOOST_CHECK_EQUAL(vChanges.size(), 3U);
+    BOOST_CHECK(adb.AppendChanges(vChanges));
+    CAddrManJournalTest addrman4;
+    BOOST_CHECK(adb.Read(addrman4));
+    CAddrInfo* pinfo1 = addrman4.Find(addr1);
+    CAddrInfo* pinfo2 = addrman4.Find(addr2);
+    BOOST_REQUIRE(pinfo1 && pinfo2);
+    BOOST_CHECK_EQUAL(pinfo1->nLastTry, 1000);
+    BOOST_CHECK_EQUAL(pinfo2->nTime, addrman.Find(addr2)->nTime);
+    BOOST_CHECK_EQUAL(pinfo2->nServices, NODE_NETWORK);
+
+    // changes that could not be journaled are put back in order
+    addrman.Attempt(addr1, false, 2000);
+    vChanges = addrman.TakeChanges();
+    addrman.Attempt(addr2, false, 3000);
+    addrman.RequeueChanges(vChanges);
+    vChanges = addrman.TakeChanges();
+    BOOST_REQUIRE_EQUAL(vChanges.size(), 2U);
+    BOOST_CHECK_EQUAL(vChanges[0].nTime, 2000);
+    BOOST_CHECK_EQUAL(vChanges[1].nTime, 3000);
+
+    // a torn record at the end is cut off
+    boost::filesystem::path pathJournal = GetDataDir() / "peers.journal";
+    uint64_t nJournalSize = boost::filesystem::file_size(pathJournal);
+    FILE* file = fopen(pathJournal.string().c_str(), "ab");
+    BOOST_REQUIRE(file);
+    fwrite("torn", 1, 4, file);
+    fclose(file);
+    CAddrMan addrman3;
+    BOOST_CHECK(adb.Read(addrman3));
+    BOOST_CHECK_EQUAL(addrman3.size(), 2U);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(pathJournal), nJournalSize);
+
+    // a new snapshot replaces the journal
+    BOOST_CHECK(adb.Write(addrman3));
+    BOOST_CHECK(!boost::filesystem::exists(pathJournal));
+}
+
+BOOST_FIXTURE_TEST_CASE(cbandb_journal, TestingSetup)
+{
+    CNetAddr addr1, addr2;
+    LookupHost("250.7.1.1", addr1, false);
+    LookupHost("250.7.2.2", addr2, false);
+    CSubNet subNet1(addr1), subNet2(addr2);
+
+    banmap_t banmap;
+    banmap[subNet1] = CBanEntry(GetTime());
+    CBanDB bandb;
+    BOOST_CHECK(bandb.Write(banmap));
+
+    std::vector<CBanChange> vChanges;
+    vChanges.emplace_back(CBanChange::SET, subNet2, CBanEntry(GetTime()));
+    vChanges.emplace_back(CBanChange::ERASE, subNet1);
+    BOOST_CHECK(bandb.AppendChanges(vChanges));
+
+    banmap_t banmapRead;
+    BOOST_CHECK(bandb.Read(banmapRead));
+    BOOST_CHECK_EQUAL(banmapRead.size(), 1U);
+    BOOST_CHECK(banmapRead.count(subNet2));
+
+    // a journal left behind by an older snapshot is ignored
+    boost::filesystem::path pathJournal = GetDataDir() / "banlist.journal";
+    boost::filesystem::copy_file(pathJournal, GetDataDir() / "banlist.journal.old");
+    BOOST_CHECK(bandb.Write(banmap));
+    boost::filesystem::rename(GetDataDir() / "banlist.journal.old", pathJournal);
+    banmapRead.clear();
+    BOOST_CHECK(bandb.Read(banmapRead));
+    BOOST_CHECK_EQUAL(banmapRead.size(), 1U);
+    BOOST_CHECK(banmapRead.count(subNet1));
+    BOOST_CHECK(!boost::filesystem::exists(pathJournal));
+
+    vChanges.assign(1, CBanChange(CBanChange::CLEAR));
+    BOOST_CHECK(bandb.AppendChanges(vChanges));
+    BOOST_CHECK(bandb.Read(banmapRead));
+    BOOST_CHECK(banmapRead.empty());
+}
+
 BOOST_AUTO_TEST_CASE(cnode_simple_test)
 {
     SOCKET hSocket = INVALID_SOCKET;
@@ -172,4 +292,120 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+BOOST_AUTO_TEST_CASE(netmessage_buffer_pool)
+{
+    BOOST_CHECK_EQUAL(CNetMessageBufferPool::GetSizeClass(1), 0);
+    BOOST_CHECK_EQUAL(CNetMessageBufferPool::GetSizeClass(256), 0);
+    BOOST_CHECK_EQUAL(CNetMessageBufferPool::GetSizeClass(257), 1);
+    BOOST_CHECK_EQUAL(CNetMessageBufferPool::GetSizeClass(256 * 1024), CNetMessageBufferPool::NUM_SIZE_CLASSES - 1);
+    BOOST_CHECK_EQUAL(CNetMessageBufferPool::GetSizeClass(256 * 1024 + 1), -1);
+
+    CNetMessageBufferPool pool;
+    CSerializeData vch;
+    BOOST_CHECK_EQUAL(pool.Acquire(vch, 0), -1);
+    BOOST_CHECK_EQUAL(pool.Acquire(vch, 1024 * 1024), -1);
+
+    int nClass = pool.Acquire(vch, 1000);
+    BOOST_CHECK_EQUAL(nClass, 1);
+    BOOST_CHECK(vch.empty());
+    BOOST_CHECK(vch.capacity() >= 1000);
+    const char* pBuffer = vch.data();
+    vch.resize(1000);
+    pool.Release(vch, nClass);
+
+    // the released buffer is handed out again, empty
+    CSerializeData vchReused;
+    BOOST_CHECK_EQUAL(pool.Acquire(vchReused, 600), 1);
+    BOOST_CHECK(vchReused.empty());
+    BOOST_CHECK(vchReused.data() == pBuffer);
+
+    // a buffer that shrank below its class size is not kept
+    CSerializeData vchSmall;
+    vchSmall.reserve(10);
+    pool.Release(vchSmall, 1);
+
+    CNetMessageBufferPool::Stats stats = pool.GetStats();
+    BOOST_CHECK_EQUAL(stats.nAllocated, 1U);
+    BOOST_CHECK_EQUAL(stats.nReused, 1U);
+    BOOST_CHECK_EQUAL(stats.nReturned, 1U);
+    BOOST_CHECK_EQUAL(stats.nDiscarded, 1U);
+    BOOST_CHECK_EQUAL(stats.nUnclassed, 1U);
+    BOOST_CHECK_EQUAL(stats.nBuffersCached, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(msg_process_stats)
+{
+    // waiting for a lock held by another thread is counted as lock wait
+    CCriticalSection cs;
+    std::atomic<bool> fLocked(false);
+    std::thread holder([&] {
+        LOCK(cs);
+        fLocked = true;
+        MilliSleep(50);
+    });
+    while (!fLocked)
+        MilliSleep(1);
+
+    CMsgProcessTimer timer;
+    {
+        LOCK(cs);
+    }
+    CMsgProcessStats stats = timer.Elapsed();
+    holder.join();
+    BOOST_CHECK_EQUAL(stats.nCount, 1U);
+    BOOST_CHECK(stats.nLockWaitMicros > 0);
+    BOOST_CHECK(stats.nWallMicros >= stats.nLockWaitMicros);
+    BOOST_CHECK_EQUAL(stats.nMaxWallMicros, stats.nWallMicros);
+
+    // an uncontended lock isn't
+    CMsgProcessTimer timerFree;
+    {
+        LOCK(cs);
+    }
+    CMsgProcessStats statsFree = timerFree.Elapsed(false);
+    BOOST_CHECK_EQUAL(statsFree.nCount, 0U);
+    BOOST_CHECK_EQUAL(statsFree.nLockWaitMicros, 0);
+
+    CMsgProcessStats total;
+    total.Add(stats);
+    total.Add(statsFree);
+    BOOST_CHECK_EQUAL(total.nCount, 1U);
+    BOOST_CHECK_EQUAL(total.nWallMicros, stats.nWallMicros + statsFree.nWallMicros);
+    BOOST_CHECK_EQUAL(total.nLockWaitMicros, stats.nLockWaitMicros);
+    BOOST_CHECK_EQUAL(total.nMaxWallMicros, std::max(stats.nWallMicros, statsFree.nWallMicros));
+}
+
+BOOST_AUTO_TEST_CASE(send_priority)
+{
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::PING), SEND_PRIORITY_HIGH);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::CMPCTBLOCK), SEND_PRIORITY_HIGH);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::TXLOCKVOTE), SEND_PRIORITY_HIGH);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::INV), SEND_PRIORITY_NORMAL);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::MERKLEBLOCK), SEND_PRIORITY_NORMAL);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::TX), SEND_PRIORITY_NORMAL);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::BLOCK), SEND_PRIORITY_BULK);
+    BOOST_CHECK_EQUAL(GetSendPriority(NetMsgType::DNGOVERNANCEOBJECT), SEND_PRIORITY_BULK);
+    BOOST_CHECK_EQUAL(GetSendPriority("unknown"), SEND_PRIORITY_NORMAL);
+    BOOST_CHECK_EQUAL(std::string(SendPriorityName(SEND_PRIORITY_BULK)), "bulk");
+
+    // queue times go into buckets under 1ms, 10ms, 100ms, 1s and the rest
+    BOOST_CHECK_EQUAL(CSendQueueStats::GetBucketBound(0), 1000);
+    BOOST_CHECK_EQUAL(CSendQueueStats::GetBucketBound(3), 1000000);
+    BOOST_CHECK_EQUAL(CSendQueueStats::GetBucketBound(CSendQueueStats::NUM_BUCKETS - 1), -1);
+    CSendQueueStats stats;
+    stats.Add(0, 10);
+    stats.Add(999, 10);
+    stats.Add(1000, 10);
+    stats.Add(250000, 10);
+    stats.Add(5000000, 10);
+    BOOST_CHECK_EQUAL(stats.nMessages, 5U);
+    BOOST_CHECK_EQUAL(stats.nBytes, 50U);
+    BOOST_CHECK_EQUAL(stats.nQueueTimeMax, 5000000);
+    BOOST_CHECK_EQUAL(stats.vBuckets[0], 2U);
+    BOOST_CHECK_EQUAL(stats.vBuckets[1], 1U);
+    BOOST_CHECK_EQUAL(stats.vBuckets[2], 0U);
+    BOOST_CHECK_EQUAL(stats.vBuckets[3], 1U);
+    BOOST_CHECK_EQUAL(stats.vBuckets[4], 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
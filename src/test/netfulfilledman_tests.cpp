@@ -0,0 +1,79 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "netbase.h"
+#include "netfulfilledman.h"
+#include "streams.h"
+#include "utiltime.h"
+#include "version.h"
+
+#include "test/test_dynamic.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(netfulfilledman_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(netfulfilled_add_has)
+{
+    CNetFulfilledRequestManager man;
+    CService addr1 = LookupNumeric("1.2.3.4", 33300);
+    CService addr2 = LookupNumeric("5.6.7.8", 33300);
+
+    BOOST_CHECK(!man.HasFulfilledRequest(addr1, "spork-sync"));
+    man.AddFulfilledRequest(addr1, "spork-sync");
+    BOOST_CHECK(man.HasFulfilledRequest(addr1, "spork-sync"));
+    BOOST_CHECK(!man.HasFulfilledRequest(addr1, "full-sync"));
+    BOOST_CHECK(!man.HasFulfilledRequest(addr2, "spork-sync"));
+
+    // mainnet squashes the port
+    BOOST_CHECK(man.HasFulfilledRequest(LookupNumeric("1.2.3.4", 12345), "spork-sync"));
+}
+
+BOOST_AUTO_TEST_CASE(netfulfilled_expiry)
+{
+    int64_t nTime = GetTime();
+    SetMockTime(nTime);
+
+    CNetFulfilledRequestManager man;
+    CService addr1 = LookupNumeric("1.2.3.4", 33300);
+    CService addr2 = LookupNumeric("5.6.7.8", 33300);
+    man.AddFulfilledRequest(addr1, "full-sync");
+    man.AddFulfilledRequest(addr2, "full-sync");
+
+    // re-adding extends the request past the first expiry
+    SetMockTime(nTime + 10);
+    man.AddFulfilledRequest(addr2, "full-sync");
+
+    SetMockTime(nTime + Params().FulfilledRequestExpireTime() + 1);
+    BOOST_CHECK(!man.HasFulfilledRequest(addr1, "full-sync"));
+    BOOST_CHECK(man.HasFulfilledRequest(addr2, "full-sync"));
+    man.CheckAndRemove();
+    BOOST_CHECK(man.HasFulfilledRequest(addr2, "full-sync"));
+
+    SetMockTime(nTime + Params().FulfilledRequestExpireTime() + 11);
+    man.CheckAndRemove();
+    BOOST_CHECK(!man.HasFulfilledRequest(addr2, "full-sync"));
+
+    SetMockTime(0);
+}
+
+BOOST_AUTO_TEST_CASE(netfulfilled_serialize)
+{
+    CNetFulfilledRequestManager man;
+    CService addr1 = LookupNumeric("1.2.3.4", 33300);
+    man.AddFulfilledRequest(addr1, "dynode-list-sync");
+    man.AddFulfilledRequest(addr1, "governance-sync");
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << man;
+
+    CNetFulfilledRequestManager loaded;
+    ss >> loaded;
+    BOOST_CHECK(loaded.HasFulfilledRequest(addr1, "dynode-list-sync"));
+    BOOST_CHECK(loaded.HasFulfilledRequest(addr1, "governance-sync"));
+    BOOST_CHECK(!loaded.HasFulfilledRequest(addr1, "full-sync"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "random.h"
+#include "streams.h"
+#include "tx-recon.h"
+#include "version.h"
+
+#include "test/test_dynamic.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(tx_recon_tests, BasicTestingSetup)
+
+static std::vector<uint256> RandomHashes(size_t nCount)
+{
+    std::vector<uint256> vecHashes;
+    for (size_t i = 0; i < nCount; ++i) {
+        vecHashes.push_back(GetRandHash());
+    }
+    return vecHashes;
+}
+
+// Run one round between an initiator and a responder, the announced transactions are returned
+static void Reconcile(CTxReconState& initiator, CTxReconState& responder, std::vector<uint256>& vecInitiatorAnnounce, std::vector<uint256>& vecResponderAnnounce)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << initiator.StartRound();
+    CTxReconSketch sketch;
+    ss >> sketch;
+    BOOST_REQUIRE(sketch.IsValid());
+
+    std::vector<uint32_t> vecDiffering;
+    responder.Respond(sketch, vecResponderAnnounce, vecDiffering);
+    BOOST_CHECK(initiator.FinishRound(vecDiffering, vecInitiatorAnnounce));
+}
+
+BOOST_AUTO_TEST_CASE(txrecon_bucket_count)
+{
+    BOOST_CHECK_EQUAL(CTxReconState::GetBucketCount(0), 1U);
+    BOOST_CHECK_EQUAL(CTxReconState::GetBucketCount(TXRECON_TXS_PER_BUCKET), 1U);
+    BOOST_CHECK_EQUAL(CTxReconState::GetBucketCount(TXRECON_TXS_PER_BUCKET + 1), 2U);
+    BOOST_CHECK_EQUAL(CTxReconState::GetBucketCount(100 * TXRECON_MAX_SET_SIZE), TXRECON_MAX_BUCKETS);
+}
+
+BOOST_AUTO_TEST_CASE(txrecon_keys)
+{
+    // both sides derive the same short ids, whatever order the salts are in
+    CTxReconState a(true, false, 1, 2);
+    CTxReconState b(false, false, 2, 1);
+    CTxReconState c(false, false, 2, 3);
+    uint256 hash = GetRandHash();
+    BOOST_CHECK_EQUAL(a.GetShortId(hash), b.GetShortId(hash));
+    BOOST_CHECK(a.GetShortId(hash) != c.GetShortId(hash));
+}
+
+BOOST_AUTO_TEST_CASE(txrecon_round)
+{
+    CTxReconState initiator(true, false, 7, 11);
+    CTxReconState responder(false, false, 11, 7);
+
+    // both got most transactions from elsewhere, each has a few of its own
+    std::vector<uint256> vecShared = RandomHashes(500);
+    std::vector<uint256> vecInitiatorOnly = RandomHashes(10);
+    std::vector<uint256> vecResponderOnly = RandomHashes(10);
+    initiator.setToReconcile.insert(vecShared.begin(), vecShared.end());
+    initiator.setToReconcile.insert(vecInitiatorOnly.begin(), vecInitiatorOnly.end());
+    responder.setToReconcile.insert(vecShared.begin(), vecShared.end());
+    responder.setToReconcile.insert(vecResponderOnly.begin(), vecResponderOnly.end());
+
+    std::vector<uint256> vecInitiatorAnnounce, vecResponderAnnounce;
+    Reconcile(initiator, responder, vecInitiatorAnnounce, vecResponderAnnounce);
+
+    // every transaction the other side lacks is announced
+    std::set<uint256> setInitiatorAnnounce(vecInitiatorAnnounce.begin(), vecInitiatorAnnounce.end());
+    std::set<uint256> setResponderAnnounce(vecResponderAnnounce.begin(), vecResponderAnnounce.end());
+    for (const uint256& hash : vecInitiatorOnly)
+        BOOST_CHECK(setInitiatorAnnounce.count(hash));
+    for (const uint256& hash : vecResponderOnly)
+        BOOST_CHECK(setResponderAnnounce.count(hash));
+
+    // and most of the shared ones aren't
+    BOOST_CHECK(initiator.nSkipped > 400);
+    BOOST_CHECK(responder.nSkipped > 400);
+    BOOST_CHECK_EQUAL(initiator.nAnnounced + initiator.nSkipped, 510U);
+    BOOST_CHECK_EQUAL(responder.nAnnounced + responder.nSkipped, 510U);
+    BOOST_CHECK(initiator.setToReconcile.empty());
+    BOOST_CHECK(initiator.vecInFlight.empty());
+    BOOST_CHECK(responder.setToReconcile.empty());
+
+    // a second answer for the same round is rejected
+    std::vector<uint256> vecAnnounce;
+    BOOST_CHECK(!initiator.FinishRound(std::vector<uint32_t>(), vecAnnounce));
+}
+
+BOOST_AUTO_TEST_CASE(txrecon_empty_and_invalid)
+{
+    CTxReconState initiator(true, false, 1, 2);
+    CTxReconState responder(false, false, 2, 1);
+
+    // nothing on our side, the peer announces everything it has
+    std::vector<uint256> vecResponderOnly = RandomHashes(20);
+    responder.setToReconcile.insert(vecResponderOnly.begin(), vecResponderOnly.end());
+    std::vector<uint256> vecInitiatorAnnounce, vecResponderAnnounce;
+    Reconcile(initiator, responder, vecInitiatorAnnounce, vecResponderAnnounce);
+    BOOST_CHECK(vecInitiatorAnnounce.empty());
+    BOOST_CHECK_EQUAL(vecResponderAnnounce.size(), vecResponderOnly.size());
+
+    // a bucket index out of range ends nothing
+    initiator.setToReconcile.insert(GetRandHash());
+    initiator.StartRound();
+    std::vector<uint256> vecAnnounce;
+    BOOST_CHECK(!initiator.FinishRound(std::vector<uint32_t>(1, TXRECON_MAX_BUCKETS), vecAnnounce));
+
+    // an unanswered round is announced in full
+    BOOST_CHECK_EQUAL(initiator.AbandonRound().size(), 1U);
+    BOOST_CHECK(!initiator.FinishRound(std::vector<uint32_t>(), vecAnnounce));
+
+    CTxReconSketch sketch;
+    BOOST_CHECK(!sketch.IsValid());
+    sketch.vecBucketDigests.resize(TXRECON_MAX_BUCKETS + 1);
+    BOOST_CHECK(!sketch.IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(txrecon_flood_initiator)
+{
+    // only the initiator picked flooding, the responder collected a set meanwhile
+    CTxReconState initiator(true, true, 3, 5);
+    CTxReconState responder(false, false, 5, 3);
+    std::vector<uint256> vecResponderOnly = RandomHashes(20);
+    responder.setToReconcile.insert(vecResponderOnly.begin(), vecResponderOnly.end());
+
+    // the initiator runs no rounds but tells the responder with an empty sketch
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << CTxReconSketch();
+    CTxReconSketch sketch;
+    ss >> sketch;
+    BOOST_CHECK(sketch.IsFloodNotice());
+    BOOST_CHECK(!sketch.IsValid());
+
+    // the responder floods from now on and announces what it held back
+    std::vector<uint256> vecAnnounce = responder.StartFlooding();
+    BOOST_CHECK(responder.fFlood);
+    BOOST_CHECK(responder.setToReconcile.empty());
+    BOOST_CHECK(std::set<uint256>(vecAnnounce.begin(), vecAnnounce.end()) == std::set<uint256>(vecResponderOnly.begin(), vecResponderOnly.end()));
+    BOOST_CHECK_EQUAL(responder.nAnnounced, vecResponderOnly.size());
+
+    // a real round is never taken for the notice
+    CTxReconState other(true, false, 3, 5);
+    other.setToReconcile.insert(GetRandHash());
+    BOOST_CHECK(!other.StartRound().IsFloodNotice());
+    BOOST_CHECK(!CTxReconState(true, false, 3, 5).StartRound().IsFloodNotice());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
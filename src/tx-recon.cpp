@@ -0,0 +1,119 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "tx-recon.h"
+
+#include "hash.h"
+#include "protocol.h"
+#include "version.h"
+
+#include <algorithm>
+
+CTxReconState::CTxReconState(bool fInitiatorIn, bool fFloodIn, uint64_t nLocalSalt, uint64_t nRemoteSalt)
+    : fInitiator(fInitiatorIn), fFlood(fFloodIn), nInFlightBuckets(0), nNextRound(0), nRounds(0), nSketchBytes(0), nAnnounced(0), nSkipped(0)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << std::min(nLocalSalt, nRemoteSalt) << std::max(nLocalSalt, nRemoteSalt);
+    uint256 hash = ss.GetHash();
+    nKey0 = hash.GetUint64(0);
+    nKey1 = hash.GetUint64(1);
+}
+
+size_t CTxReconState::GetBucketCount(size_t nSetSize)
+{
+    size_t nBuckets = (nSetSize + TXRECON_TXS_PER_BUCKET - 1) / TXRECON_TXS_PER_BUCKET;
+    return std::min(std::max(nBuckets, size_t(1)), TXRECON_MAX_BUCKETS);
+}
+
+uint64_t CTxReconState::GetShortId(const uint256& hash) const
+{
+    return SipHashUint256(nKey0, nKey1, hash);
+}
+
+CTxReconSketch CTxReconState::StartRound()
+{
+    vecInFlight.assign(setToReconcile.begin(), setToReconcile.end());
+    setToReconcile.clear();
+    nInFlightBuckets = GetBucketCount(vecInFlight.size());
+
+    CTxReconSketch sketch;
+    sketch.nSetSize = vecInFlight.size();
+    sketch.vecBucketDigests.assign(nInFlightBuckets, 0);
+    for (const uint256& hash : vecInFlight) {
+        uint64_t nShortId = GetShortId(hash);
+        sketch.vecBucketDigests[nShortId % nInFlightBuckets] ^= nShortId;
+    }
+    nRounds++;
+    return sketch;
+}
+
+void CTxReconState::Respond(const CTxReconSketch& sketch, std::vector<uint256>& vecAnnounce, std::vector<uint32_t>& vecDiffering)
+{
+    const size_t nBuckets = sketch.vecBucketDigests.size();
+    std::vector<uint64_t> vecOurDigests(nBuckets, 0);
+    for (const uint256& hash : setToReconcile) {
+        uint64_t nShortId = GetShortId(hash);
+        vecOurDigests[nShortId % nBuckets] ^= nShortId;
+    }
+
+    for (size_t i = 0; i < nBuckets; i++) {
+        if (vecOurDigests[i] != sketch.vecBucketDigests[i])
+            vecDiffering.push_back(i);
+    }
+    for (const uint256& hash : setToReconcile) {
+        size_t nBucket = GetShortId(hash) % nBuckets;
+        if (vecOurDigests[nBucket] != sketch.vecBucketDigests[nBucket])
+            vecAnnounce.push_back(hash);
+    }
+    nSkipped += setToReconcile.size() - vecAnnounce.size();
+    nAnnounced += vecAnnounce.size();
+    setToReconcile.clear();
+    nRounds++;
+}
+
+bool CTxReconState::FinishRound(const std::vector<uint32_t>& vecDiffering, std::vector<uint256>& vecAnnounce)
+{
+    if (nInFlightBuckets == 0)
+        return false;
+
+    std::vector<bool> vecDiffer(nInFlightBuckets, false);
+    for (uint32_t nBucket : vecDiffering) {
+        if (nBucket >= nInFlightBuckets)
+            return false;
+        vecDiffer[nBucket] = true;
+    }
+    for (const uint256& hash : vecInFlight) {
+        if (vecDiffer[GetShortId(hash) % nInFlightBuckets])
+            vecAnnounce.push_back(hash);
+    }
+    nSkipped += vecInFlight.size() - vecAnnounce.size();
+    nAnnounced += vecAnnounce.size();
+    vecInFlight.clear();
+    nInFlightBuckets = 0;
+    return true;
+}
+
+std::vector<uint256> CTxReconState::AbandonRound()
+{
+    std::vector<uint256> vecAnnounce;
+    vecAnnounce.swap(vecInFlight);
+    nInFlightBuckets = 0;
+    nAnnounced += vecAnnounce.size();
+    return vecAnnounce;
+}
+
+std::vector<uint256> CTxReconState::StartFlooding()
+{
+    std::vector<uint256> vecAnnounce(setToReconcile.begin(), setToReconcile.end());
+    setToReconcile.clear();
+    fFlood = true;
+    nAnnounced += vecAnnounce.size();
+    return vecAnnounce;
+}
+
+int64_t CTxReconState::GetBytesSaved() const
+{
+    static const int64_t nInvSize = ::GetSerializeSize(CInv(MSG_TX, uint256()), SER_NETWORK, PROTOCOL_VERSION);
+    return (int64_t)nSkipped * nInvSize - (int64_t)nSketchBytes;
+}
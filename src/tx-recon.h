@@ -0,0 +1,143 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef TX_RECON_H
+#define TX_RECON_H
+
+#include "serialize.h"
+#include "uint256.h"
+
+#include <set>
+#include <vector>
+
+/** Peers at this version or later can reconcile transactions instead of announcing all of them */
+static const int TXRECON_PROTO_VERSION = 71300;
+/** Version of the reconciliation protocol sent in sendtxrcncl */
+static const uint32_t TXRECON_VERSION = 1;
+/** Default for -txreconciliation */
+static const bool DEFAULT_TXRECONCILIATION = false;
+/** Default for -txreconfloodpeers, outbound reconciling peers that are still sent every inv */
+static const unsigned int DEFAULT_TXRECON_FLOOD_PEERS = 2;
+/** Average number of transactions summarized by one bucket digest */
+static const size_t TXRECON_TXS_PER_BUCKET = 2;
+/** Upper bound on the number of bucket digests in a sketch */
+static const size_t TXRECON_MAX_BUCKETS = 8192;
+/** Transactions beyond this many waiting for the next round are announced with inv */
+static const size_t TXRECON_MAX_SET_SIZE = TXRECON_MAX_BUCKETS * TXRECON_TXS_PER_BUCKET;
+/** Average delay in seconds between reconciliation rounds with an outbound peer */
+static const int TXRECON_INTERVAL = 2;
+/** Time in seconds a peer gets to answer a reconciliation request */
+static const int TXRECON_ROUND_TIMEOUT = 30;
+
+/**
+ * Summary of the transactions a node would have announced to a peer since
+ * the last round. Transactions are spread over buckets by their salted short
+ * id and every bucket carries the XOR of the short ids that fell into it.
+ */
+class CTxReconSketch
+{
+public:
+    uint32_t nSetSize;
+    std::vector<uint64_t> vecBucketDigests;
+
+    CTxReconSketch() : nSetSize(0), vecBucketDigests() {}
+
+    bool IsValid() const
+    {
+        return !vecBucketDigests.empty() && vecBucketDigests.size() <= TXRECON_MAX_BUCKETS;
+    }
+
+    /** Sent by the initiator instead of rounds when the link keeps flooding */
+    bool IsFloodNotice() const
+    {
+        return nSetSize == 0 && vecBucketDigests.empty();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(nSetSize);
+        READWRITE(vecBucketDigests);
+    }
+};
+
+/**
+ * Transaction reconciliation with one peer (sendtxrcncl, reqrecon, reconcildiff).
+ *
+ * Instead of an inv for every transaction, both sides collect the
+ * transactions they would announce to each other. Every TXRECON_INTERVAL
+ * the outbound side, the initiator, sends a sketch of its set. The other
+ * side compares it with its own set, announces its transactions in the
+ * buckets that differ and answers with the differing bucket indexes, for
+ * which the initiator announces its own. Transactions both sides have fall
+ * into matching buckets and are never announced on this link.
+ *
+ * Only the initiator picks the links that keep flooding. It tells the
+ * responder with an empty sketch, after which both sides announce every
+ * transaction with inv and no rounds are run.
+ */
+class CTxReconState
+{
+public:
+    //! we send the sketches, the peer compares them with its set
+    const bool fInitiator;
+    //! the peer is still sent an inv for every transaction, the set is unused
+    bool fFlood;
+    //! transactions to reconcile in the next round
+    std::set<uint256> setToReconcile;
+    //! initiator: our set of the round waiting for an answer, and the number of buckets it was sketched with
+    std::vector<uint256> vecInFlight;
+    size_t nInFlightBuckets;
+    //! initiator: when the next round starts, or when the outstanding one times out (in microseconds)
+    int64_t nNextRound;
+
+    // Stats, the bandwidth saved is what invs for the skipped transactions would have taken less the sketches
+    uint64_t nRounds;
+    uint64_t nSketchBytes;  //!< reqrecon and reconcildiff sent and received
+    uint64_t nAnnounced;    //!< our transactions announced after a round
+    uint64_t nSkipped;      //!< our transactions the peer turned out to have
+
+private:
+    uint64_t nKey0;
+    uint64_t nKey1;
+
+public:
+    /** Both sides derive the same short id keys from the two salts */
+    CTxReconState(bool fInitiatorIn, bool fFloodIn, uint64_t nLocalSalt, uint64_t nRemoteSalt);
+
+    /** Number of buckets used to summarize sets of these sizes */
+    static size_t GetBucketCount(size_t nSetSize);
+
+    uint64_t GetShortId(const uint256& hash) const;
+
+    /** Initiator: move the set into a new round and sketch it */
+    CTxReconSketch StartRound();
+
+    /**
+     * Compare the peer's sketch with our set, which is cleared.
+     * @param[out] vecAnnounce  our transactions in differing buckets
+     * @param[out] vecDiffering indexes of the differing buckets, for the peer
+     */
+    void Respond(const CTxReconSketch& sketch, std::vector<uint256>& vecAnnounce, std::vector<uint32_t>& vecDiffering);
+
+    /**
+     * Initiator: end the round with the peer's differing buckets.
+     * @param[out] vecAnnounce  our transactions of the round in those buckets
+     * @return false if no round was outstanding or a bucket index is out of range
+     */
+    bool FinishRound(const std::vector<uint32_t>& vecDiffering, std::vector<uint256>& vecAnnounce);
+
+    /** Initiator: give up on an unanswered round, its transactions are announced with inv */
+    std::vector<uint256> AbandonRound();
+
+    /** Responder: the initiator keeps flooding, so do we. Returns the set, to be announced with inv */
+    std::vector<uint256> StartFlooding();
+
+    /** Bytes of inv the reconciliation saved on this link, negative if it cost more */
+    int64_t GetBytesSaved() const;
+};
+
+#endif // TX_RECON_H
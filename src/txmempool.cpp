@@ -22,6 +22,8 @@
 #include "validation.h"
 #include "version.h"
 
+#include <limits>
+
 CTxMemPoolEntry::CTxMemPoolEntry(const CTransactionRef& _tx, const CAmount& _nFee, int64_t _nTime, double _entryPriority, unsigned int _entryHeight, CAmount _inChainInputValue, bool _spendsCoinbase, unsigned int _sigOps, LockPoints lp) : tx(_tx), nFee(_nFee), nTime(_nTime), entryPriority(_entryPriority), entryHeight(_entryHeight),
                                                                                                                                                                                                                                               inChainInputValue(_inChainInputValue),
                                                                                                                                                                                                                                               spendsCoinbase(_spendsCoinbase), sigOpCount(_sigOps), lockPoints(lp)
@@ -38,6 +40,19 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTransactionRef& _tx, const CAmount& _nFe
 
     feeDelta = 0;
 
+    if (entryPriority > AllowFreeThreshold()) {
+        nFreeHeight = entryHeight;
+    } else if (inChainInputValue == 0 || nModSize == 0) {
+        nFreeHeight = std::numeric_limits<unsigned int>::max();
+    } else {
+        // rounded down, the exact priority is checked when mining
+        double dHeights = (AllowFreeThreshold() - entryPriority) * nModSize / inChainInputValue;
+        if (dHeights >= std::numeric_limits<unsigned int>::max() - entryHeight)
+            nFreeHeight = std::numeric_limits<unsigned int>::max();
+        else
+            nFreeHeight = entryHeight + (unsigned int)dHeights;
+    }
+
     nCountWithAncestors = 1;
     nSizeWithAncestors = nTxSize;
     nModFeesWithAncestors = nFee;
@@ -1220,8 +1235,8 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint& outpoint, Coin& coin) const
 size_t CTxMemPool::DynamicMemoryUsage() const
 {
     LOCK(cs);
-    // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    // Estimate the overhead of mapTx to be 18 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 18 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
 }
 
 double CTxMemPool::UsedMemoryShare() const
@@ -98,6 +98,7 @@ private:
     bool spendsCoinbase;       //!< keep track of transactions that spend a coinbase
     unsigned int sigOpCount;   //!< Legacy sig ops plus P2SH sig op count
     int64_t feeDelta;          //!< Used for determining the priority of the transaction for mining in a block
+    unsigned int nFreeHeight;  //!< First height the priority may allow mining for free, ignoring priority deltas
     LockPoints lockPoints;     //!< Track the height and time at which tx was final
 
     // Information about descendants of this transaction that are in the
@@ -127,6 +128,11 @@ public:
      * from entry priority. Only inputs that were originally in-chain will age.
      */
     double GetPriority(unsigned int currentHeight) const;
+    /**
+     * Priority grows linearly with the height, so the height it passes
+     * AllowFreeThreshold() is known when entering the mempool.
+     */
+    unsigned int GetFreeHeight() const { return nFreeHeight; }
     const CAmount& GetFee() const { return nFee; }
     size_t GetTxSize() const { return nTxSize; }
     int64_t GetTime() const { return nTime; }
@@ -221,6 +227,15 @@ struct mempoolentry_txid {
     }
 };
 
+// extracts the height a TxMemPoolEntry's priority allows mining for free
+struct mempoolentry_free_height {
+    typedef unsigned int result_type;
+    result_type operator()(const CTxMemPoolEntry& entry) const
+    {
+        return entry.GetFreeHeight();
+    }
+};
+
 /** \class CompareTxMemPoolEntryByDescendantScore
  *
  *  Sort an entry by max(score/size of entry's tx, score/size with all descendants).
@@ -317,6 +332,8 @@ struct mining_score {
 };
 struct ancestor_score {
 };
+struct free_height {
+};
 
 class CBlockPolicyEstimator;
 
@@ -488,7 +505,11 @@ public:
             boost::multi_index::ordered_non_unique<
                 boost::multi_index::tag<ancestor_score>,
                 boost::multi_index::identity<CTxMemPoolEntry>,
-                CompareTxMemPoolEntryByAncestorFee> > >
+                CompareTxMemPoolEntryByAncestorFee>,
+            // sorted by height the priority allows mining for free
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<free_height>,
+                mempoolentry_free_height> > >
         indexed_transaction_set;
 
     mutable CCriticalSection cs;
@@ -14,6 +14,7 @@
 
 class CBasicKeyStore;
 class CBlockIndex;
+class COutPoint;
 class CWallet;
 class uint256;
 
@@ -86,6 +87,12 @@ public:
     /** Number of Dynodes changed. */
     boost::signals2::signal<void(int newNumDynodes)> NotifyStrDynodeCountChanged;
 
+    /**
+     * Dynode added to, updated in or removed from the Dynode list.
+     * @note called with CDynodeMan::cs held, handlers must not call back into CDynodeMan.
+     */
+    boost::signals2::signal<void(const COutPoint& outpoint, ChangeType status)> NotifyDynodeChanged;
+
     /**
      * New, updated or cancelled alert.
      * @note called with lock cs_mapAlerts held.
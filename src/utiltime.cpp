@@ -18,6 +18,12 @@
 
 #include <ctime>
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 static int64_t nMockTime = 0; //! For unit testing
 
 int64_t GetTime()
@@ -53,6 +59,26 @@ int64_t GetTimeMicros()
     return now;
 }
 
+int64_t GetThreadCPUTimeMicros()
+{
+#ifdef WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return 0;
+    // 100 nanosecond intervals
+    uint64_t nKernel = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    uint64_t nUser = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (nKernel + nUser) / 10;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    return 0;
+#endif
+}
+
 int64_t GetSystemTimeInSeconds()
 {
     return GetTimeMicros() / 1000000;
@@ -13,6 +13,7 @@
 #include "bdap/fees.h"
 #include "bdap/linking.h"
 #include "bdap/linkingdb.h"
+#include "bdap/parsedtx.h"
 #include "bdap/utils.h"
 #include "blockencodings.h"
 #include "chainparams.h"
@@ -31,6 +32,7 @@
 #include "fluid/fluiddynode.h"
 #include "fluid/fluidmining.h"
 #include "fluid/fluidmint.h"
+#include "fluid/fluidsovereign.h"
 #include "hash.h"
 #include "init.h"
 #include "instantsend.h"
@@ -797,26 +799,44 @@ static bool IsCurrentForFeeEstimation()
     return true;
 }
 
-// Check if BDAP entry is valid
-bool ValidateBDAPInputs(const CTransactionRef& tx, CValidationState& state, const CCoinsViewCache& inputs, const CBlock& block, bool fJustCheck, int nHeight, bool bSanity)
+static bool IsBDAPValidationActive(bool fJustCheck)
 {
     if (!CheckDomainEntryDB())
-        return true;
+        return false;
 
     std::string statusRpc = "";
     if (fJustCheck && (IsInitialBlockDownload() || RPCIsInWarmup(&statusRpc)))
+        return false;
+
+    return true;
+}
+
+// Check if BDAP entry is valid
+bool ValidateBDAPInputs(const CTransactionRef& tx, CValidationState& state, const CCoinsViewCache& inputs, const CBlock& block, bool fJustCheck, int nHeight, bool bSanity)
+{
+    CBDAPParsedTx parsed;
+    return ValidateBDAPInputs(tx, parsed, state, block, fJustCheck, nHeight, bSanity);
+}
+
+bool ValidateBDAPInputs(const CTransactionRef& tx, const CBDAPParsedTx& parsedIn, CValidationState& state, const CBlock& block, bool fJustCheck, int nHeight, bool bSanity)
+{
+    if (!IsBDAPValidationActive(fJustCheck))
         return true;
 
-    std::vector<std::vector<unsigned char> > vvchBDAPArgs;
-    int op1 = -1;
-    int op2 = -1;
+    CBDAPParsedTx parsedLocal;
+    if (!parsedIn.fParsed)
+        ParseBDAPTx(tx, parsedLocal);
+    const CBDAPParsedTx& parsed = parsedIn.fParsed ? parsedIn : parsedLocal;
+
+    const std::vector<std::vector<unsigned char> >& vvchBDAPArgs = parsed.vvchArgs;
+    const int op1 = parsed.op1;
+    const int op2 = parsed.op2;
     if (nHeight == 0) {
         nHeight = chainActive.Height() + 1;
     }
     bool bValid = false;
     if (tx->nVersion == BDAP_TX_VERSION) {
-        CScript scriptOp;
-        if (GetBDAPOpScript(tx, scriptOp, vvchBDAPArgs, op1, op2)) {
+        if (parsed.fBDAPOp) {
             std::string errorMessage;
             if (vvchBDAPArgs.size() > 3) {
                 errorMessage = "Too many BDAP parameters in operation transactions.";
@@ -827,9 +847,9 @@ bool ValidateBDAPInputs(const CTransactionRef& tx, CValidationState& state, cons
                 return state.DoS(100, false, REJECT_INVALID, errorMessage);
             }
 
-            std::string strOpType = GetBDAPOpTypeString(op1, op2);
+            const std::string& strOpType = parsed.strOpType;
             if (strOpType == "bdap_new_account" || strOpType == "bdap_update_account" || strOpType == "bdap_delete_account") {
-                bValid = CheckDomainEntryTx(tx, scriptOp, op1, op2, vvchBDAPArgs, fJustCheck, nHeight, block.nTime, bSanity, errorMessage);
+                bValid = CheckDomainEntryTx(tx, parsed, fJustCheck, nHeight, block.nTime, bSanity, errorMessage);
                 if (!bValid) {
                     errorMessage = "ValidateBDAPInputs: " + errorMessage;
                     return state.DoS(100, false, REJECT_INVALID, errorMessage);
@@ -840,7 +860,7 @@ bool ValidateBDAPInputs(const CTransactionRef& tx, CValidationState& state, cons
             else if (strOpType == "bdap_new_link_request") {
                 std::vector<unsigned char> vchPubKey = vvchBDAPArgs[0];
                 LogPrint("bdap", "%s -- New Link Request vchPubKey = %s\n", __func__, stringFromVch(vchPubKey));
-                bValid = CheckLinkTx(tx, op1, op2, vvchBDAPArgs, fJustCheck, nHeight, block.nTime, bSanity, errorMessage);
+                bValid = CheckLinkTx(tx, parsed, fJustCheck, nHeight, block.nTime, bSanity, errorMessage);
                 if (!bValid) {
                     errorMessage = "ValidateBDAPInputs: CheckLinkTx failed: " + errorMessage;
                     return state.DoS(100, false, REJECT_INVALID, errorMessage);
@@ -858,7 +878,7 @@ bool ValidateBDAPInputs(const CTransactionRef& tx, CValidationState& state, cons
             else if (strOpType == "bdap_new_link_accept") {
                 std::vector<unsigned char> vchPubKey = vvchBDAPArgs[0];
                 LogPrint("bdap", "%s -- New Link Accept vchPubKey = %s\n", __func__, stringFromVch(vchPubKey));
-                bValid = CheckLinkTx(tx, op1, op2, vvchBDAPArgs, fJustCheck, nHeight, block.nTime, bSanity, errorMessage);
+                bValid = CheckLinkTx(tx, parsed, fJustCheck, nHeight, block.nTime, bSanity, errorMessage);
                 if (!bValid) {
                     errorMessage = "ValidateBDAPInputs: CheckLinkTx failed: " + errorMessage;
                     return state.DoS(100, false, REJECT_INVALID, errorMessage);
@@ -2377,6 +2397,20 @@ void ThreadScriptCheck()
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CBDAPPreCheck> bdapcheckqueue(128);
+
+void ThreadBDAPCheck()
+{
+    RenameThread("dynamic-bdapch");
+    bdapcheckqueue.Thread();
+}
+
+bool CBDAPPreCheck::operator()()
+{
+    ParseBDAPTx(ptx, *pparsed);
+    return true;
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2457,6 +2491,58 @@ static int64_t nTimeIndex = 0;
 static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
 
+/** BDAP, link and fluid databases whose writes are staged in memory and committed with the coins cache */
+static std::vector<CStagedDBWrapper*> GetStagedSideDBs()
+{
+    std::vector<CStagedDBWrapper*> vDBs = {pDomainEntryDB, pLinkDB, pBanAccountDB, pFluidMintDB, pFluidMiningDB, pFluidDynodeDB, pFluidSovereignDB};
+    vDBs.erase(std::remove(vDBs.begin(), vDBs.end(), nullptr), vDBs.end());
+    return vDBs;
+}
+
+static size_t SideDBsDynamicMemoryUsage()
+{
+    size_t nUsage = 0;
+    for (const CStagedDBWrapper* pdb : GetStagedSideDBs())
+        nUsage += pdb->DynamicMemoryUsage();
+    return nUsage;
+}
+
+static bool CommitSideDBs()
+{
+    for (CStagedDBWrapper* pdb : GetStagedSideDBs()) {
+        if (!pdb->CommitStaged())
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Collects the side database writes of one ConnectBlock call. They are
+ * dropped when the block fails or is only being checked, and otherwise kept
+ * until the next full flush in FlushStateToDisk.
+ */
+class CSideDBBlockScope
+{
+private:
+    std::vector<CStagedDBWrapper*> vDBs;
+    bool fKeep;
+
+public:
+    CSideDBBlockScope() : vDBs(GetStagedSideDBs()), fKeep(false)
+    {
+        for (CStagedDBWrapper* pdb : vDBs)
+            pdb->BeginBlockScope();
+    }
+
+    ~CSideDBBlockScope()
+    {
+        for (CStagedDBWrapper* pdb : vDBs)
+            pdb->EndBlockScope(fKeep);
+    }
+
+    void Keep() { fKeep = true; }
+};
+
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
@@ -2464,6 +2550,8 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
 {
     AssertLockHeld(cs_main);
 
+    CSideDBBlockScope sideDBScope;
+
     int64_t nTimeStart = GetTimeMicros();
 
     // Check it again in case a previous version let a bad block in
@@ -2542,6 +2630,29 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
 
     CBlockUndo blockundo;
 
+    // Parse the BDAP transactions and run their context-free checks up front, in
+    // parallel when script check threads are enabled. Only the checks that read
+    // or write the BDAP databases are left to the serial loop below.
+    int64_t nTimeBDAPStart = GetTimeMicros();
+    std::vector<CBDAPParsedTx> vBDAPParsed(block.vtx.size());
+    if (IsBDAPValidationActive(fJustCheck)) {
+        std::vector<CBDAPPreCheck> vBDAPChecks;
+        for (unsigned int i = 0; i < block.vtx.size(); i++) {
+            if (block.vtx[i]->nVersion == BDAP_TX_VERSION)
+                vBDAPChecks.push_back(CBDAPPreCheck(block.vtx[i], &vBDAPParsed[i]));
+        }
+        if (nScriptCheckThreads && vBDAPChecks.size() > 1) {
+            CCheckQueueControl<CBDAPPreCheck> bdapControl(&bdapcheckqueue);
+            bdapControl.Add(vBDAPChecks);
+            bdapControl.Wait();
+        } else {
+            for (CBDAPPreCheck& check : vBDAPChecks)
+                check();
+        }
+        if (!vBDAPChecks.empty())
+            LogPrint("bench", "    - BDAP pre-validation of %u transactions: %.2fms\n", (unsigned)vBDAPChecks.size(), 0.001 * (GetTimeMicros() - nTimeBDAPStart));
+    }
+
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
 
     std::vector<uint256> vOrphanErase;
@@ -2679,10 +2790,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
             }
         }
 
-        CCoinsViewCache viewCoinCache(pcoinsTip);
-        CTransactionRef ptx = MakeTransactionRef(tx);
-
-        if (tx.nVersion == BDAP_TX_VERSION && !ValidateBDAPInputs(ptx, state, viewCoinCache, block, fJustCheck, pindex->nHeight)) {
+        if (tx.nVersion == BDAP_TX_VERSION && !ValidateBDAPInputs(block.vtx[i], vBDAPParsed[i], state, block, fJustCheck, pindex->nHeight)) {
             return error("ConnectBlock(): ValidateBDAPInputs on block %s failed\n", block.GetHash().ToString());
         }
 
@@ -2880,6 +2988,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     nTimeCallbacks += nTime6 - nTime5;
     LogPrint("bench", "    - Callbacks: %.2fms [%.2fs]\n", 0.001 * (nTime6 - nTime5), nTimeCallbacks * 0.000001);
 
+    sideDBScope.Keep();
     return true;
 }
 
@@ -2927,7 +3036,7 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode, int n
             nLastSetChain = nNow;
         }
         int64_t nMempoolSizeMax = GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
-        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() * DB_PEAK_USAGE_FACTOR;
+        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() * DB_PEAK_USAGE_FACTOR + SideDBsDynamicMemoryUsage();
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
@@ -2978,6 +3087,11 @@ bool static FlushStateToDisk(CValidationState& state, FlushStateMode mode, int n
             // overwrite one. Still, use a conservative safety factor of 2.
             if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
                 return state.Error("out of disk space");
+            // Commit the staged BDAP, link and fluid changes first. Should we
+            // crash before the coins flush, reconnecting the same blocks on
+            // top of them is harmless.
+            if (!CommitSideDBs())
+                return AbortNode(state, "Failed to write to BDAP and fluid databases");
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
@@ -3611,10 +3725,10 @@ bool ResetBlockFailureFlags(CBlockIndex* pindex)
     return true;
 }
 
-CBlockIndex* AddToBlockIndex(const CBlockHeader& block)
+CBlockIndex* AddToBlockIndex(const CBlockHeader& block, const uint256* phash = NULL)
 {
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    uint256 hash = phash ? *phash : block.GetHash();
     BlockMap::iterator it = mapBlockIndex.find(hash);
     if (it != mapBlockIndex.end())
         return it->second;
@@ -3777,10 +3891,10 @@ bool FindUndoPos(CValidationState& state, int nFile, CDiskBlockPos& pos, unsigne
     return true;
 }
 
-bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW)
+bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, const uint256* phash)
 {
     // Check proof of work matches claimed amount
-    if (fCheckPOW && !CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
+    if (fCheckPOW && !CheckProofOfWork(phash ? *phash : block.GetHash(), block.nBits, consensusParams))
         return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
 
     return true;
@@ -4000,11 +4114,11 @@ bool ContextualCheckBlock(const CBlock& block, CValidationState& state, const Co
     return true;
 }
 
-static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, const uint256* phash = NULL)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    uint256 hash = phash ? *phash : block.GetHash();
     BlockMap::iterator miSelf = mapBlockIndex.find(hash);
     CBlockIndex* pindex = NULL;
 
@@ -4023,7 +4137,7 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), true, &hash))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -4043,7 +4157,7 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
             return error("%s: Consensus::ContextualCheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
     }
     if (pindex == NULL)
-        pindex = AddToBlockIndex(block);
+        pindex = AddToBlockIndex(block, &hash);
 
     if (ppindex)
         *ppindex = pindex;
@@ -4057,13 +4171,15 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
 }
 
 // Exposed wrapper for AcceptBlockHeader
-bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex)
+bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex, const std::vector<uint256>* pvHashes)
 {
+    assert(!pvHashes || pvHashes->size() == headers.size());
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < headers.size(); i++) {
+            const CBlockHeader& header = headers[i];
             CBlockIndex* pindex = NULL; // Use a temp pindex instead of ppindex to avoid a const_cast
-            if (!AcceptBlockHeader(header, state, chainparams, &pindex)) {
+            if (!AcceptBlockHeader(header, state, chainparams, &pindex, pvHashes ? &(*pvHashes)[i] : NULL)) {
                 return false;
             }
             if (ppindex) {
@@ -43,6 +43,7 @@ class CCoinsViewDB;
 class CInv;
 class CConnman;
 class CScriptCheck;
+struct CBDAPParsedTx;
 class CTxMemPool;
 class CValidationInterface;
 class CValidationState;
@@ -91,6 +92,15 @@ static const int MAX_SCRIPTCHECK_THREADS = 16;
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 128;
+/** Fewest blocks kept in flight from a single peer that has blocks we need, however slow it is. */
+static const int MIN_BLOCKS_IN_TRANSIT_PER_PEER = 2;
+/** Number of blocks requested from a peer before its delivery rate is known. */
+static const int DEFAULT_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Seconds of downloading, at the rate a peer delivers blocks, that we keep in flight from it. */
+static const int64_t BLOCK_DOWNLOAD_QUEUE_SECONDS = 5;
+/** A block holding back the download window is requested from a faster peer once it has been in flight
+ *  for this many times the average latency of the faster peer. */
+static const int BLOCK_REREQUEST_LATENCY_FACTOR = 3;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
 static const unsigned int BLOCK_STALLING_TIMEOUT = 2;
 /** Number of headers sent in one getheaders result. We rely on the assumption that if a peer sends
@@ -258,8 +268,9 @@ bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<cons
  * @param[out] state This may be set to an Error state if any error occurred processing them
  * @param[in]  chainparams The params for the chain we want to connect to
  * @param[out] ppindex If set, the pointer will be set to point to the last new block index object for the given headers
+ * @param[in]  pvHashes If set, the hashes of the headers, as computed by the caller, so the (expensive) header hash isn't recomputed
  */
-bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& block, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex = NULL);
+bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& block, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex = NULL, const std::vector<uint256>* pvHashes = NULL);
 
 /** Check whether enough disk space is available for an incoming block */
 bool CheckDiskSpace(uint64_t nAdditionalBytes = 0);
@@ -279,6 +290,8 @@ bool LoadBlockIndex(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the BDAP pre-validation thread */
+void ThreadBDAPCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Format a string that describes several potential problems detected by the core.
@@ -335,6 +348,8 @@ void PruneBlockFilesManual(int nPruneUpToHeight);
 
 /** Checks inputs for a BDAP transaction. */
 bool ValidateBDAPInputs(const CTransactionRef& tx, CValidationState& state, const CCoinsViewCache& inputs, const CBlock& block, bool fJustCheck, int nHeight, bool bSanity = false);
+/** Checks inputs for a BDAP transaction already run through ParseBDAPTx. Parses it first if not. */
+bool ValidateBDAPInputs(const CTransactionRef& tx, const CBDAPParsedTx& parsed, CValidationState& state, const CBlock& block, bool fJustCheck, int nHeight, bool bSanity = false);
 /** (try to) add transaction to memory pool
  * plTxnReplaced will be appended to with all transactions replaced from mempool **/
 
@@ -479,6 +494,30 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure that parses one BDAP transaction and runs its context-free checks.
+ * The result is written to the CBDAPParsedTx slot owned by the caller; the
+ * closure itself always succeeds so that failures are reported in block order.
+ */
+class CBDAPPreCheck
+{
+private:
+    CTransactionRef ptx;
+    CBDAPParsedTx* pparsed;
+
+public:
+    CBDAPPreCheck() : pparsed(NULL) {}
+    CBDAPPreCheck(const CTransactionRef& ptxIn, CBDAPParsedTx* pparsedIn) : ptx(ptxIn), pparsed(pparsedIn) {}
+
+    bool operator()();
+
+    void swap(CBDAPPreCheck& check)
+    {
+        ptx.swap(check.ptx);
+        std::swap(pparsed, check.pparsed);
+    }
+};
+
 bool GetTimestampIndex(const unsigned int& high, const unsigned int& low, std::vector<uint256>& hashes);
 bool GetSpentIndex(CSpentIndexKey& key, CSpentIndexValue& value);
 bool GetAddressIndex(uint160 addressHash, int type, std::vector<std::pair<CAddressIndexKey, CAmount> >& addressIndex, int start = 0, int end = 0);
@@ -496,7 +535,7 @@ bool DisconnectBlocks(int blocks);
 void ReprocessBlocks(int nBlocks);
 
 /** Context-independent validity checks */
-bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true);
+bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, const uint256* phash = NULL);
 bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true);
 
 /** Context-dependent validity checks */
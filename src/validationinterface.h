@@ -12,6 +12,7 @@
 #include <memory>
 
 class CBlock;
+class CBDAPNotification;
 class CBlockIndex;
 struct CBlockLocator;
 class CConnman;
@@ -52,7 +53,9 @@ protected:
     virtual void GetScriptForMining(std::shared_ptr<CReserveScript>&){};
     virtual void ResetRequestCount(const uint256& hash){};
     virtual void NewPoWValidBlock(const CBlockIndex* pindex, const std::shared_ptr<const CBlock>& block) {}
-    virtual void NotifyBDAPUpdate(const char* value, const char* action) {}
+    virtual void NotifyBDAPUpdate(const CBDAPNotification& notification) {}
+    /** Only interfaces returning true are connected to NotifyBDAPUpdate */
+    virtual bool WantsBDAPUpdates() const { return false; }
     friend void ::RegisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterAllValidationInterfaces();
@@ -102,8 +105,8 @@ struct CMainSignals {
      * Notifies listeners that a block which builds directly on our current tip
      * has been received and connected to the headers tree, though not validated yet */
     boost::signals2::signal<void(const CBlockIndex*, const std::shared_ptr<const CBlock>&)> NewPoWValidBlock;
-    /** Notifies listeners of an updated BDAP action */
-    boost::signals2::signal<void(const char* value, const char* action)> NotifyBDAPUpdate;
+    /** Notifies listeners of an added or modified BDAP account. Empty unless a listener wants BDAP updates. */
+    boost::signals2::signal<void(const CBDAPNotification&)> NotifyBDAPUpdate;
 };
 
 CMainSignals& GetMainSignals();
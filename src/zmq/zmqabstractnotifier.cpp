@@ -40,3 +40,8 @@ bool CZMQAbstractNotifier::NotifyInstantSendDoubleSpendAttempt(const CTransactio
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyBDAPUpdate(const CBDAPNotification& /*notification*/)
+{
+    return true;
+}
@@ -7,6 +7,7 @@
 
 #include "zmqconfig.h"
 
+class CBDAPNotification;
 class CBlockIndex;
 class CGovernanceObject;
 class CGovernanceVote;
@@ -40,6 +41,7 @@ public:
     virtual bool NotifyGovernanceVote(const CGovernanceVote &vote);
     virtual bool NotifyGovernanceObject(const CGovernanceObject &object);
     virtual bool NotifyInstantSendDoubleSpendAttempt(const CTransaction &currentTx, const CTransaction &previousTx);
+    virtual bool NotifyBDAPUpdate(const CBDAPNotification &notification);
 
 
 protected:
@@ -15,7 +15,7 @@ void zmqError(const char *str)
     LogPrint("zmq", "zmq: Error: %s, errno=%s\n", str, zmq_strerror(errno));
 }
 
-CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(NULL)
+CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(NULL), fBDAPNotifiers(false)
 {
 }
 
@@ -34,6 +34,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     CZMQNotificationInterface* notificationInterface = NULL;
     std::map<std::string, CZMQNotifierFactory> factories;
     std::list<CZMQAbstractNotifier*> notifiers;
+    bool fBDAPNotifiers = false;
 
     factories["pubhashblock"] = CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>;
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
@@ -47,6 +48,9 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubrawgovernancevote"] = CZMQAbstractNotifier::Create<CZMQPublishRawGovernanceVoteNotifier>;
     factories["pubrawgovernanceobject"] = CZMQAbstractNotifier::Create<CZMQPublishRawGovernanceObjectNotifier>;
     factories["pubrawinstantsenddoublespend"] = CZMQAbstractNotifier::Create<CZMQPublishRawInstantSendDoubleSpendNotifier>;
+    factories["pubbdaprecord"] = CZMQAbstractNotifier::Create<CZMQPublishBDAPRecordNotifier>;
+    factories["pubbdaphistory"] = CZMQAbstractNotifier::Create<CZMQPublishBDAPHistoryNotifier>;
+    factories["pubrawbdaprecord"] = CZMQAbstractNotifier::Create<CZMQPublishRawBDAPRecordNotifier>;
 
     for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
     {
@@ -59,6 +63,8 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
             notifier->SetType(i->first);
             notifier->SetAddress(address);
             notifiers.push_back(notifier);
+            if (i->first.find("bdap") != std::string::npos)
+                fBDAPNotifiers = true;
         }
     }
 
@@ -66,6 +72,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     {
         notificationInterface = new CZMQNotificationInterface();
         notificationInterface->notifiers = notifiers;
+        notificationInterface->fBDAPNotifiers = fBDAPNotifiers;
 
         if (!notificationInterface->Initialize())
         {
@@ -232,3 +239,16 @@ void CZMQNotificationInterface::NotifyGovernanceObject(const CGovernanceObject &
         }
     }
 }
+
+void CZMQNotificationInterface::NotifyBDAPUpdate(const CBDAPNotification& notification)
+{
+    for (auto it = notifiers.begin(); it != notifiers.end();) {
+        CZMQAbstractNotifier *notifier = *it;
+        if (notifier->NotifyBDAPUpdate(notification)) {
+            ++it;
+        } else {
+            notifier->Shutdown();
+            it = notifiers.erase(it);
+        }
+    }
+}
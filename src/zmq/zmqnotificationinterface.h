@@ -30,13 +30,15 @@ protected:
     void NotifyGovernanceVote(const CGovernanceVote& vote) override;
     void NotifyGovernanceObject(const CGovernanceObject& object) override;
     void NotifyInstantSendDoubleSpendAttempt(const CTransaction &currentTx, const CTransaction &previousTx) override;
-
+    void NotifyBDAPUpdate(const CBDAPNotification& notification) override;
+    bool WantsBDAPUpdates() const override { return fBDAPNotifiers; }
 
 private:
     CZMQNotificationInterface();
 
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
+    bool fBDAPNotifiers;
 };
 
 #endif // DYNAMIC_ZMQ_ZMQNOTIFICATIONINTERFACE_H
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "bdap/domainentrydb.h"
 #include "chainparams.h"
 #include "streams.h"
 #include "zmqpublishnotifier.h"
@@ -22,6 +23,9 @@ static const char *MSG_RAWTXLOCK  = "rawtxlock";
 static const char *MSG_RAWGVOTE   = "rawgovernancevote";
 static const char *MSG_RAWGOBJ    = "rawgovernanceobject";
 static const char *MSG_RAWISCON   = "rawinstantsenddoublespend";
+static const char *MSG_BDAPRECORD = "bdaprecord";
+static const char *MSG_BDAPHIST   = "bdaphistory";
+static const char *MSG_RAWBDAPREC = "rawbdaprecord";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -212,6 +216,20 @@ bool CZMQPublishHashInstantSendDoubleSpendNotifier::NotifyInstantSendDoubleSpend
         && SendMessage(MSG_HASHISCON, dataPreviousHash, 32);
 }
 
+bool CZMQPublishBDAPRecordNotifier::NotifyBDAPUpdate(const CBDAPNotification &notification)
+{
+    LogPrint("zmq", "zmq: Publish bdaprecord %s (%s)\n", notification.GetEntry().GetFullObjectPath(), notification.GetOpString());
+    const std::string& strJson = notification.GetRecordJson();
+    return SendMessage(MSG_BDAPRECORD, strJson.data(), strJson.size());
+}
+
+bool CZMQPublishBDAPHistoryNotifier::NotifyBDAPUpdate(const CBDAPNotification &notification)
+{
+    LogPrint("zmq", "zmq: Publish bdaphistory %s (%s)\n", notification.GetEntry().GetFullObjectPath(), notification.GetOpString());
+    const std::string& strJson = notification.GetHistoryJson();
+    return SendMessage(MSG_BDAPHIST, strJson.data(), strJson.size());
+}
+
 bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     LogPrint("zmq", "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
@@ -279,3 +297,9 @@ bool CZMQPublishRawInstantSendDoubleSpendNotifier::NotifyInstantSendDoubleSpendA
         && SendMessage(MSG_RAWISCON, &(*ssPrevious.begin()), ssPrevious.size());
 }
 
+bool CZMQPublishRawBDAPRecordNotifier::NotifyBDAPUpdate(const CBDAPNotification &notification)
+{
+    LogPrint("zmq", "zmq: Publish rawbdaprecord %s (%s)\n", notification.GetEntry().GetFullObjectPath(), notification.GetOpString());
+    const std::vector<unsigned char>& vchRaw = notification.GetRaw();
+    return SendMessage(MSG_RAWBDAPREC, vchRaw.data(), vchRaw.size());
+}
@@ -66,6 +66,18 @@ public:
     bool NotifyInstantSendDoubleSpendAttempt(const CTransaction &currentTx, const CTransaction &previousTx) override;
 };
 
+class CZMQPublishBDAPRecordNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBDAPUpdate(const CBDAPNotification &notification) override;
+};
+
+class CZMQPublishBDAPHistoryNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBDAPUpdate(const CBDAPNotification &notification) override;
+};
+
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -101,4 +113,10 @@ class CZMQPublishRawInstantSendDoubleSpendNotifier : public CZMQAbstractPublishN
 public:
     bool NotifyInstantSendDoubleSpendAttempt(const CTransaction &currentTx, const CTransaction &previousTx) override;
 };
+
+class CZMQPublishRawBDAPRecordNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBDAPUpdate(const CBDAPNotification &notification) override;
+};
 #endif // DYNAMIC_ZMQ_ZMQPUBLISHNOTIFIER_H